@@ -36,11 +36,15 @@
 #include <QDate>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QSettings>
 #include <QString>
+#include <QThread>
+#include <QtConcurrent>
 
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 #include "StelModule.hpp"
 
@@ -980,6 +984,420 @@ QList<SsoElements> SolarSystemEditor::readMpcOneLineMinorPlanetElementsFromFile(
 	}
 }
 
+namespace
+{
+	// Size of the blocks read from the files of orbital elements
+	const qint64 IMPORT_BLOCK_SIZE = 8*1024*1024;
+
+	// Parses a decimal number in the columns [begin, end[ of a line, ignoring
+	// the blanks around it. Unlike QString::toDouble(), it does not allocate,
+	// and unlike strtod() it does not depend on the locale.
+	bool parseColumn(const char* line, int length, int begin, int end, double& value)
+	{
+		end = qMin(end, length);
+		while (begin<end && line[begin]==' ')
+			++begin;
+		while (end>begin && line[end-1]==' ')
+			--end;
+		if (begin>=end)
+			return false;
+		bool negative = false;
+		if (line[begin]=='-' || line[begin]=='+')
+		{
+			negative = line[begin]=='-';
+			++begin;
+		}
+		double mantissa = 0.;
+		double scale = 1.;
+		bool point = false;
+		int digits = 0;
+		for (int i=begin;i<end;++i)
+		{
+			const char c = line[i];
+			if (c>='0' && c<='9')
+			{
+				mantissa = mantissa*10. + (c-'0');
+				if (point)
+					scale *= 10.;
+				++digits;
+			}
+			else if (c=='.' && !point)
+				point = true;
+			else
+				return false;
+		}
+		if (digits==0)
+			return false;
+		value = negative ? -mantissa/scale : mantissa/scale;
+		return true;
+	}
+
+	// Converts a digit of the MPC packed formats: 0-9, then A-Z for 10 to 35
+	// and a-z for 36 to 61. Returns -1 for other characters.
+	int unpackDigit(char c)
+	{
+		if (c>='0' && c<='9')
+			return c-'0';
+		if (c>='A' && c<='Z')
+			return 10+c-'A';
+		if (c>='a' && c<='z')
+			return 36+c-'a';
+		return -1;
+	}
+
+	// Century of the MPC packed dates and provisional designations
+	int unpackCentury(char c)
+	{
+		switch (c)
+		{
+			case 'I': return 1800;
+			case 'J': return 1900;
+			case 'K': return 2000;
+			default: return -1;
+		}
+	}
+
+	bool isDigit(char c)
+	{
+		return c>='0' && c<='9';
+	}
+
+	// Unpacks a minor planet number, see http://www.minorplanetcenter.org/iau/info/PackedDes.html
+	// Returns 0 if the designation is not a packed number.
+	int unpackMinorPlanetNumber(const char* designation, int length)
+	{
+		if (length==5 && designation[0]=='~')
+		{
+			// Numbers from 620000, in base 62
+			int number = 0;
+			for (int i=1;i<5;++i)
+			{
+				const int digit = unpackDigit(designation[i]);
+				if (digit<0)
+					return 0;
+				number = number*62 + digit;
+			}
+			return 620000 + number;
+		}
+		if (length!=5)
+			return 0;
+		for (int i=1;i<5;++i)
+		{
+			if (!isDigit(designation[i]))
+				return 0;
+		}
+		const int prefix = unpackDigit(designation[0]);
+		if (prefix<0)
+			return 0;
+		return prefix*10000 + (designation[1]-'0')*1000 + (designation[2]-'0')*100 + (designation[3]-'0')*10 + (designation[4]-'0');
+	}
+
+	// Unpacks a provisional designation like "K07Tf8A" to "2007 TA418".
+	// Returns an empty string if the designation has another form.
+	QString unpackProvisionalDesignation(const char* designation, int length)
+	{
+		if (length!=7)
+			return QString();
+		const int century = unpackCentury(designation[0]);
+		const int cycle = unpackDigit(designation[4]);
+		if (century<0 || !isDigit(designation[1]) || !isDigit(designation[2]) || designation[3]<'A' || designation[3]>'Z'
+			|| cycle<0 || !isDigit(designation[5]) || designation[6]<'A' || designation[6]>'Z')
+			return QString();
+		const int year = century + (designation[1]-'0')*10 + (designation[2]-'0');
+		QString result = QString("%1 %2%3").arg(year).arg(QLatin1Char(designation[3])).arg(QLatin1Char(designation[6]));
+		const int cycleCount = cycle*10 + (designation[5]-'0');
+		if (cycleCount!=0)
+			result.append(QString::number(cycleCount));
+		return result;
+	}
+
+	// Trims the columns [begin, end[ of a line
+	QByteArray trimmedColumn(const char* line, int length, int begin, int end)
+	{
+		end = qMin(end, length);
+		if (begin>=end)
+			return QByteArray();
+		return QByteArray(line+begin, end-begin).trimmed();
+	}
+}
+
+struct SolarSystemEditor::CatalogImportJob
+{
+	const char* begin;
+	const char* end;
+	bool comets;
+	QVector<MinorBodyCatalog::Body> bodies;
+	int lineCount;
+};
+
+bool SolarSystemEditor::parseMpcMinorPlanetLine(const char* line, int length, MinorBodyCatalog::Body& body)
+{
+	//Same columns as readMpcOneLineMinorPlanetElements()
+	if (length<103)
+		return false;
+
+	const QByteArray designation = trimmedColumn(line, length, 0, 7);
+	if (designation.isEmpty())
+		return false;
+	const int minorPlanetNumber = unpackMinorPlanetNumber(designation.constData(), designation.size());
+
+	//Epoch, in packed form
+	const int century = unpackCentury(line[20]);
+	const int month = unpackDigit(line[23]);
+	const int day = unpackDigit(line[24]);
+	if (century<0 || !isDigit(line[21]) || !isDigit(line[22]) || month<1 || month>12 || day<1 || day>31)
+		return false;
+	double epochJD;
+	if (!StelUtils::getJDFromDate(&epochJD, century + (line[21]-'0')*10 + (line[22]-'0'), month, day, 0, 0, 0))
+		return false;
+
+	double absoluteMagnitude, slopeParameter, meanAnomaly, argumentOfPerihelion, ascendingNode, inclination;
+	double eccentricity, meanDailyMotion, semiMajorAxis;
+	if (!parseColumn(line, length, 8, 13, absoluteMagnitude)
+		|| !parseColumn(line, length, 26, 35, meanAnomaly)
+		|| !parseColumn(line, length, 37, 46, argumentOfPerihelion)
+		|| !parseColumn(line, length, 48, 57, ascendingNode)
+		|| !parseColumn(line, length, 59, 68, inclination)
+		|| !parseColumn(line, length, 70, 79, eccentricity)
+		|| !parseColumn(line, length, 80, 91, meanDailyMotion)
+		|| !parseColumn(line, length, 92, 103, semiMajorAxis))
+		return false;
+	//The slope parameter is missing for some objects
+	if (!parseColumn(line, length, 14, 19, slopeParameter))
+		slopeParameter = 0.15;
+	if (eccentricity<0. || eccentricity>=1. || semiMajorAxis<=0. || meanDailyMotion<=0.)
+		return false;
+
+	//Name, as in readMpcOneLineMinorPlanetElements()
+	const QByteArray readableName = trimmedColumn(line, length, 166, 194);
+	QString name;
+	if (minorPlanetNumber)
+	{
+		const int nameStart = readableName.startsWith('(') ? readableName.indexOf(") ") : -1;
+		if (nameStart>0)
+			name = QString::fromUtf8(readableName.mid(nameStart+2).trimmed());
+		else if (!readableName.isEmpty())
+			name = QString::fromUtf8(readableName);
+		else
+			name = QString::number(minorPlanetNumber);
+	}
+	else if (!readableName.isEmpty())
+		name = QString::fromUtf8(readableName);
+	else
+	{
+		name = unpackProvisionalDesignation(designation.constData(), designation.size());
+		//Survey designations
+		if (name.isEmpty())
+			name = unpackMinorPlanetProvisionalDesignation(QString::fromLatin1(designation));
+	}
+	if (name.isEmpty())
+		return false;
+
+	body.name = name;
+	body.q = semiMajorAxis*(1.-eccentricity);
+	body.e = eccentricity;
+	body.i = inclination*(M_PI/180.);
+	body.Om = ascendingNode*(M_PI/180.);
+	body.w = argumentOfPerihelion*(M_PI/180.);
+	body.t0 = epochJD - meanAnomaly/meanDailyMotion;
+	body.n = meanDailyMotion*(M_PI/180.);
+	body.H = absoluteMagnitude;
+	body.slope = slopeParameter;
+	body.comet = false;
+	return true;
+}
+
+bool SolarSystemEditor::parseMpcCometLine(const char* line, int length, MinorBodyCatalog::Body& body)
+{
+	//Columns of http://www.minorplanetcenter.org/iau/info/CometOrbitFormat.html
+	if (length<103)
+		return false;
+
+	QString name = QString::fromUtf8(trimmedColumn(line, length, 102, 158));
+	if (name.isEmpty())
+		return false;
+	//Fragment suffix
+	const QByteArray provisionalDesignation = trimmedColumn(line, length, 5, 12);
+	if (provisionalDesignation.size()==1)
+	{
+		name.append(' ');
+		name.append(QChar(QLatin1Char(provisionalDesignation.at(0))).toUpper());
+	}
+
+	double year, month, day, perihelionDistance, eccentricity, argumentOfPerihelion, ascendingNode, inclination;
+	double absoluteMagnitude, slopeParameter;
+	if (!parseColumn(line, length, 14, 18, year)
+		|| !parseColumn(line, length, 19, 21, month)
+		|| !parseColumn(line, length, 22, 29, day)
+		|| !parseColumn(line, length, 30, 39, perihelionDistance)
+		|| !parseColumn(line, length, 41, 49, eccentricity)
+		|| !parseColumn(line, length, 51, 59, argumentOfPerihelion)
+		|| !parseColumn(line, length, 61, 69, ascendingNode)
+		|| !parseColumn(line, length, 71, 79, inclination)
+		|| !parseColumn(line, length, 91, 95, absoluteMagnitude)
+		|| !parseColumn(line, length, 96, 100, slopeParameter))
+		return false;
+	if (perihelionDistance<=0. || eccentricity<0. || month<1. || month>12. || day<1. || day>=32.)
+		return false;
+	double jdPerihelionPassage;
+	if (!StelUtils::getJDFromDate(&jdPerihelionPassage, (int)year, (int)month, (int)day, 0, 0, 0))
+		return false;
+
+	body.name = name;
+	body.q = perihelionDistance;
+	body.e = eccentricity;
+	body.i = inclination*(M_PI/180.);
+	body.Om = ascendingNode*(M_PI/180.);
+	body.w = argumentOfPerihelion*(M_PI/180.);
+	body.t0 = jdPerihelionPassage + (day - std::floor(day));
+	body.n = MinorBodyCatalog::meanMotion(perihelionDistance, eccentricity);
+	body.H = absoluteMagnitude;
+	body.slope = slopeParameter;
+	body.comet = true;
+	return true;
+}
+
+void SolarSystemEditor::runCatalogImportJob(CatalogImportJob& job)
+{
+	job.bodies.clear();
+	job.lineCount = 0;
+	MinorBodyCatalog::Body body;
+	for (const char* line=job.begin;line<job.end;)
+	{
+		const char* next = static_cast<const char*>(memchr(line, '\n', job.end-line));
+		if (!next)
+			next = job.end;
+		int length = next-line;
+		if (length>0 && line[length-1]=='\r')
+			--length;
+		if (length>0)
+		{
+			++job.lineCount;
+			if (job.comets ? parseMpcCometLine(line, length, body) : parseMpcMinorPlanetLine(line, length, body))
+				job.bodies.append(body);
+		}
+		line = next+1;
+	}
+}
+
+bool SolarSystemEditor::readMpcOneLineElementsForCatalog(const QString& filePath, bool comets, MinorBodyCatalog::Writer& writer,
+							 qint64& bytesRead, qint64 bytesTotal, int& lineCount)
+{
+	QFile mpcElementsFile(filePath);
+	if (!mpcElementsFile.open(QFile::ReadOnly))
+	{
+		qWarning() << "Unable to open for reading" << QDir::toNativeSeparators(filePath);
+		qWarning() << "File error:" << mpcElementsFile.errorString();
+		return false;
+	}
+
+	const int nbJobs = qMax(1, QThread::idealThreadCount());
+	QVector<CatalogImportJob> jobs(nbJobs);
+	for (int j=0;j<nbJobs;++j)
+		jobs[j].comets = comets;
+	QByteArray block;
+	bool atEnd = false;
+	while (!atEnd)
+	{
+		const QByteArray data = mpcElementsFile.read(IMPORT_BLOCK_SIZE);
+		if (data.isEmpty() && mpcElementsFile.error()!=QFileDevice::NoError)
+		{
+			qWarning() << "Error while reading" << QDir::toNativeSeparators(filePath) << ":" << mpcElementsFile.errorString();
+			return false;
+		}
+		atEnd = data.isEmpty();
+		bytesRead += data.size();
+		block.append(data);
+
+		//Only complete lines are parsed, the end of the block is kept for the next one
+		const int size = atEnd ? block.size() : block.lastIndexOf('\n')+1;
+		const char* begin = block.constData();
+		const char* jobBegin = begin;
+		for (int j=0;j<nbJobs;++j)
+		{
+			const char* jobEnd = begin + (qint64)size*(j+1)/nbJobs;
+			if (jobEnd<jobBegin)
+				jobEnd = jobBegin;
+			if (j<nbJobs-1)
+			{
+				const char* newline = static_cast<const char*>(memchr(jobEnd, '\n', begin+size-jobEnd));
+				jobEnd = newline ? newline+1 : begin+size;
+			}
+			jobs[j].begin = jobBegin;
+			jobs[j].end = jobEnd;
+			jobBegin = jobEnd;
+		}
+		if (nbJobs>1)
+			QtConcurrent::blockingMap(jobs, runCatalogImportJob);
+		else
+			runCatalogImportJob(jobs[0]);
+
+		for (int j=0;j<nbJobs;++j)
+		{
+			const QVector<MinorBodyCatalog::Body>& bodies = jobs.at(j).bodies;
+			for (int i=0;i<bodies.size();++i)
+				writer.append(bodies.at(i));
+			lineCount += jobs.at(j).lineCount;
+		}
+		block.remove(0, size);
+		emit catalogImportProgress(bytesRead, bytesTotal);
+	}
+	return true;
+}
+
+int SolarSystemEditor::importMpcOneLineElementsToCatalog(QString minorPlanetsFilePath, QString cometsFilePath)
+{
+	const int count = writeMpcOneLineElementsToCatalog(minorPlanetsFilePath, cometsFilePath);
+	if (count>=0)
+		reloadSolarSystem();
+	return count;
+}
+
+void SolarSystemEditor::reloadSolarSystem()
+{
+	solarSystem->reloadPlanets();
+	emit solarSystemChanged();
+}
+
+int SolarSystemEditor::writeMpcOneLineElementsToCatalog(QString minorPlanetsFilePath, QString cometsFilePath)
+{
+	QElapsedTimer timer;
+	timer.start();
+	qint64 bytesTotal = 0;
+	if (!minorPlanetsFilePath.isEmpty())
+		bytesTotal += QFileInfo(minorPlanetsFilePath).size();
+	if (!cometsFilePath.isEmpty())
+		bytesTotal += QFileInfo(cometsFilePath).size();
+
+	qint64 bytesRead = 0;
+	int lineCount = 0;
+	MinorBodyCatalog::Writer writer;
+	if (!minorPlanetsFilePath.isEmpty() && !readMpcOneLineElementsForCatalog(minorPlanetsFilePath, false, writer, bytesRead, bytesTotal, lineCount))
+		return -1;
+	if (!cometsFilePath.isEmpty() && !readMpcOneLineElementsForCatalog(cometsFilePath, true, writer, bytesRead, bytesTotal, lineCount))
+		return -1;
+	const qint64 parsingTime = timer.elapsed();
+
+	const QString dataDir = StelFileMgr::getUserDir() + "/data";
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(dataDir);
+	}
+	catch (std::runtime_error &e)
+	{
+		qWarning() << "SolarSystemEditor: cannot write the minor body catalogue:" << e.what();
+		return -1;
+	}
+	if (!writer.write(dataDir + "/minor_bodies.cat"))
+		return -1;
+
+	const qint64 totalTime = qMax((qint64)1, timer.elapsed());
+	qDebug() << "SolarSystemEditor: imported" << writer.size() << "objects out of" << lineCount << "lines"
+		 << "(" << bytesRead/(1024*1024) << "MB ) in" << totalTime << "ms, parsing" << parsingTime << "ms:"
+		 << qRound64(1000.*writer.size()/totalTime) << "objects/s";
+	return writer.size();
+}
+
 bool SolarSystemEditor::appendToSolarSystemConfigurationFile(QList<SsoElements> objectList)
 {
 	qDebug() << "appendToSolarSystemConfigurationFile begin ... ";
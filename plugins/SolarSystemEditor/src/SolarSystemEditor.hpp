@@ -30,8 +30,10 @@
 #include <QList>
 #include <QString>
 #include <QVariant>
+#include <QVector>
 
 #include "SolarSystem.hpp"
+#include "MinorBodyCatalog.hpp"
 
 //! Convenience type for storage of SSO properties in ssystem_minor.ini format.
 //! This is an easy way of storing data in the format used in Stellarium's
@@ -207,9 +209,37 @@ public slots:
 	//! \todo Return a bool and make the GUI display a message if it was not successful.
 	void resetSolarSystemToDefault();
 
+	//! Imports whole files of MPC one-line orbital elements into the minor
+	//! body catalogue of the user data directory, replacing it.
+	//! Unlike readMpcOneLineMinorPlanetElementsFromFile(), this is meant for
+	//! files with up to millions of objects, like MPCORB.DAT: the files are
+	//! read by blocks, the lines of each block are parsed in parallel by
+	//! column cuts, and the catalogue is written in a single pass. The
+	//! objects are drawn as points by SolarSystem, without Planet objects.
+	//! The Solar System is reloaded once the catalogue is written.
+	//! \param minorPlanetsFilePath file in the MPCORB format, or empty.
+	//! \param cometsFilePath file in the MPC comet format, or empty.
+	//! \returns the number of objects in the catalogue, or -1 on error.
+	int importMpcOneLineElementsToCatalog(QString minorPlanetsFilePath, QString cometsFilePath);
+
+	//! Reloads the Solar System, e.g. after a call of
+	//! writeMpcOneLineElementsToCatalog() by another thread.
+	void reloadSolarSystem();
+
+public:
+	//! Same as importMpcOneLineElementsToCatalog(), without reloading the
+	//! Solar System. It can run in a worker thread, catalogImportProgress()
+	//! being then emitted from that thread. The parsed objects are appended
+	//! block by block to a MinorBodyCatalog::Writer, which only keeps the
+	//! columns of the file in memory.
+	int writeMpcOneLineElementsToCatalog(QString minorPlanetsFilePath, QString cometsFilePath);
+
 signals:
 	//TODO: This should be part of SolarSystem::reloadPlanets()
 	void solarSystemChanged();
+	//! Emitted after each block of a file read by importMpcOneLineElementsToCatalog()
+	//! or writeMpcOneLineElementsToCatalog(), from the thread which reads it.
+	void catalogImportProgress(qint64 bytesRead, qint64 bytesTotal);
 
 private slots:
 	void updateI18n();
@@ -275,6 +305,20 @@ private:
 	//! provisional designation.
 	static QString unpackMinorPlanetProvisionalDesignation(QString packedDesignation);
 
+	//! Parsing of the lines of a part of a block, run by a worker thread.
+	struct CatalogImportJob;
+	static void runCatalogImportJob(CatalogImportJob& job);
+	//! Reads a file of MPC one-line orbital elements by blocks and appends
+	//! the objects of each block to writer.
+	bool readMpcOneLineElementsForCatalog(const QString& filePath, bool comets, MinorBodyCatalog::Writer& writer,
+					      qint64& bytesRead, qint64 bytesTotal, int& lineCount);
+	//! Converts a line of minor planet orbital elements in MPC format, without
+	//! creating a SsoElements hash. Returns false if it is not a valid line.
+	static bool parseMpcMinorPlanetLine(const char* line, int length, MinorBodyCatalog::Body& body);
+	//! Converts a line of comet orbital elements in MPC format, without
+	//! creating a SsoElements hash. Returns false if it is not a valid line.
+	static bool parseMpcCometLine(const char* line, int length, MinorBodyCatalog::Body& body);
+
 	//! Updates a value in a configuration file with a value with the same key in a SsoElements hash.
 	static void updateSsoProperty(QSettings& configuration, SsoElements& properties, QString key);
 
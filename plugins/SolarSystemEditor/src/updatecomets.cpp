@@ -6,6 +6,9 @@ UpdateComets::UpdateComets()
     , queryReply(Q_NULLPTR)
     , downloadProgressBar(Q_NULLPTR)
     , queryProgressBar(Q_NULLPTR)
+    , importProgressBar(Q_NULLPTR)
+    , catalogFile(Q_NULLPTR)
+    , importWatcher(Q_NULLPTR)
 {
 //    ssoManager = GETSTELMODULE(SolarSystemEditor);
     ssoManager = new SolarSystemEditor();
@@ -53,6 +56,39 @@ void UpdateComets::startDownload(QString urlString)
     connect(downloadReply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(updateDownloadProgress(qint64,qint64)));
 }
 
+void UpdateComets::startCatalogDownload(QString urlString)
+{
+    //The file is kept until the end of its import
+    if (downloadReply || catalogFile)
+        return;
+
+    catalogFile = new QTemporaryFile(this);
+    if (!catalogFile->open())
+    {
+        qWarning() << "Unable to open a temporary file. Aborting operation.";
+        delete catalogFile;
+        catalogFile = Q_NULLPTR;
+        return;
+    }
+
+    startDownload(urlString);
+    if (downloadReply)
+    {
+        connect(downloadReply, SIGNAL(readyRead()), this, SLOT(writeCatalogData()));
+    }
+    else
+    {
+        delete catalogFile;
+        catalogFile = Q_NULLPTR;
+    }
+}
+
+void UpdateComets::writeCatalogData()
+{
+    if (catalogFile && downloadReply)
+        catalogFile->write(downloadReply->readAll());
+}
+
 void UpdateComets::deleteDownloadProgressBar()
 {
     disconnect(this, SLOT(updateDownloadProgress(qint64,qint64)));
@@ -64,6 +100,14 @@ void UpdateComets::deleteDownloadProgressBar()
     }
 }
 
+void UpdateComets::updateImportProgress(qint64 bytesRead, qint64 bytesTotal)
+{
+    if (importProgressBar == Q_NULLPTR)
+        return;
+
+    importProgressBar->setValue(bytesTotal > 0 ? (int)(100 * bytesRead / bytesTotal) : 0);
+}
+
 void UpdateComets::updateDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
 {
     if (downloadProgressBar == Q_NULLPTR)
@@ -94,6 +138,12 @@ void UpdateComets::downloadComplete(QNetworkReply *reply)
     deleteDownloadProgressBar();
 //    ui->pushButtonAbortDownload->setVisible(false);
 
+    if (catalogFile)
+    {
+        importCatalog(reply);
+        return;
+    }
+
     /*
     qDebug() << "reply->isOpen():" << reply->isOpen()
         << "reply->isReadable():" << reply->isReadable()
@@ -162,6 +212,64 @@ void UpdateComets::downloadComplete(QNetworkReply *reply)
     addObjects();
 }
 
+void UpdateComets::importCatalog(QNetworkReply *reply)
+{
+    if (reply->error())
+    {
+        qWarning() << "Download error: While downloading"
+                   << reply->url().toString()
+                   << "the following error occured:"
+                   << reply->errorString();
+    }
+    else
+    {
+        catalogFile->write(reply->readAll());
+        catalogFile->close();
+
+        importProgressBar = StelApp::getInstance().addProgressBar();
+        importProgressBar->setFormat("Importing minor planets %p%");
+        importProgressBar->setRange(0, 100);
+        importProgressBar->setValue(0);
+        //The progress is emitted by the worker thread, and queued to this one
+        connect(ssoManager, SIGNAL(catalogImportProgress(qint64,qint64)), this, SLOT(updateImportProgress(qint64,qint64)), Qt::QueuedConnection);
+
+        //MPCORB.DAT takes seconds to parse, so it is imported in a worker
+        //thread and the Solar System is reloaded by catalogImportFinished()
+        importWatcher = new QFutureWatcher<int>(this);
+        connect(importWatcher, SIGNAL(finished()), this, SLOT(catalogImportFinished()));
+        importWatcher->setFuture(QtConcurrent::run(ssoManager, &SolarSystemEditor::writeMpcOneLineElementsToCatalog, catalogFile->fileName(), QString()));
+
+        reply->deleteLater();
+        downloadReply = Q_NULLPTR;
+        return;
+    }
+
+    reply->deleteLater();
+    downloadReply = Q_NULLPTR;
+    delete catalogFile;
+    catalogFile = Q_NULLPTR;
+}
+
+void UpdateComets::catalogImportFinished()
+{
+    disconnect(ssoManager, SIGNAL(catalogImportProgress(qint64,qint64)), this, SLOT(updateImportProgress(qint64,qint64)));
+    StelApp::getInstance().removeProgressBar(importProgressBar);
+    importProgressBar = Q_NULLPTR;
+
+    const int count = importWatcher->result();
+    importWatcher->deleteLater();
+    importWatcher = Q_NULLPTR;
+    delete catalogFile;
+    catalogFile = Q_NULLPTR;
+
+    if (count <= 0)
+    {
+        qWarning() << "No objects imported from the downloaded minor planet file";
+        return;
+    }
+    ssoManager->reloadSolarSystem();
+}
+
 //填充候选对象
 void UpdateComets::populateCandidateObjects(QList<SsoElements> objects)
 {
@@ -14,6 +14,7 @@
 #include <QGuiApplication>
 #include <QClipboard>
 #include <QDesktopServices>
+#include <QFutureWatcher>
 //#include <QFileDialog>
 #include <QSortFilterProxyModel>
 #include <QHash>
@@ -28,6 +29,7 @@
 #include <QUrl>
 #include <QUrlQuery>
 #include <QDir>
+#include <QtConcurrent>
 
 #include <QColor>
 //#include <QColorDialog>
@@ -123,18 +125,34 @@ public:
     QNetworkReply * queryReply;//
     class StelProgressController * downloadProgressBar;//
     class StelProgressController * queryProgressBar;//
+    class StelProgressController * importProgressBar;
+    //! Set while downloading a file for the minor body catalogue
+    QTemporaryFile * catalogFile;
+    //! Set while the downloaded file is imported by a worker thread
+    QFutureWatcher<int> * importWatcher;
 
 public slots:
     void startDownload(QString urlString);
+    //! Downloads a file of minor planet orbital elements in the MPCORB format
+    //! and imports it with SolarSystemEditor::writeMpcOneLineElementsToCatalog()
+    //! in a worker thread. The file is written to disk while downloading, as
+    //! MPCORB.DAT is too large to be kept in memory.
+    void startCatalogDownload(QString urlString);
     void downloadComplete(QNetworkReply *reply);
     void deleteDownloadProgressBar();
 
     void updateDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void writeCatalogData();
+    void updateImportProgress(qint64 bytesRead, qint64 bytesTotal);
+    //! Reloads the Solar System once the worker thread wrote the catalogue.
+    void catalogImportFinished();
     QList<SsoElements> readElementsFromFile(QString filePath);
 
     void populateCandidateObjects(QList<SsoElements> objects);
     void addObjects();
 
+private:
+    void importCatalog(QNetworkReply *reply);
 };
 
 
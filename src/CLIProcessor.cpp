@@ -72,7 +72,12 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 		          << "--projection-type       : Specify projection type, e.g. stereographic\n"
 		          << "--restore-defaults      : Delete existing config.ini and use defaults\n"
 		          << "--multires-image        : With filename / URL argument, specify a\n"
-		          << "                          multi-resolution image to load\n";
+		          << "                          multi-resolution image to load\n"
+		          << "--benchmark             : Render the scenes of the given JSON file\n"
+		          << "                          offscreen and report the frame times\n"
+		          << "--benchmark-frames      : Number of frames to render for each scene\n"
+		          << "--benchmark-output      : File where to write the JSON report, by\n"
+		          << "                          default the standard output\n";
 		exit(0);
 	}
 
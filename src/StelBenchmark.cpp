@@ -0,0 +1,797 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelBenchmark.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelActionMgr.hpp"
+#include "EphemerisCache.hpp"
+#include "EventSearch.hpp"
+#include "MinorBodyCatalog.hpp"
+#include "StelFileMgr.hpp"
+#include "StelJsonParser.hpp"
+#include "StelLocationMgr.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelNameIndex.hpp"
+#include "StelObjectMgr.hpp"
+#include "StelPainter.hpp"
+#include "SolarSystem.hpp"
+#include "StelSphereGeometry.hpp"
+#include "StelUtils.hpp"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QSettings>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+// Simulated time between 2 frames, in seconds
+static const double DELTA_TIME = 1./60.;
+static const int DEFAULT_WARMUP_FRAMES = 20;
+static const int DEFAULT_FRAMES = 300;
+// Number of shifted copies tested for intersection with a footprint
+static const int FOOTPRINT_INTERSECTIONS = 100;
+
+namespace
+{
+	// Reproducible pseudo random numbers in [0, 1[, so that two runs test the same points
+	double nextRandom(quint32& state)
+	{
+		state = state*1664525u + 1013904223u;
+		return (state>>8)/16777216.;
+	}
+
+	Vec3d fromRaDec(double ra, double dec)
+	{
+		Vec3d v;
+		StelUtils::spheToRect(ra, dec, v);
+		return v;
+	}
+}
+
+StelBenchmark::StelBenchmark(QSettings* conf)
+	: conf(conf), surface(NULL), context(NULL), fbo(NULL), stelApp(NULL), syncModules(true)
+{
+}
+
+StelBenchmark::~StelBenchmark()
+{
+	if (context)
+		context->makeCurrent(surface);
+	if (stelApp)
+	{
+		delete stelApp;
+		StelApp::deinitStatic();
+		StelPainter::deinitGLShaders();
+	}
+	delete fbo;
+	if (context)
+		context->doneCurrent();
+	delete context;
+	delete surface;
+}
+
+bool StelBenchmark::init(int width, int height)
+{
+	QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+	format.setDepthBufferSize(24);
+	format.setStencilBufferSize(8);
+	surface = new QOffscreenSurface();
+	surface->setFormat(format);
+	surface->create();
+	context = new QOpenGLContext();
+	context->setFormat(format);
+	if (!surface->isValid() || !context->create() || !context->makeCurrent(surface))
+	{
+		qWarning() << "ERROR: Could not create an offscreen OpenGL context for the benchmark";
+		return false;
+	}
+	QOpenGLFramebufferObjectFormat fboFormat;
+	fboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+	fbo = new QOpenGLFramebufferObject(width, height, fboFormat);
+	if (!fbo->isValid() || !fbo->bind())
+	{
+		qWarning() << "ERROR: Could not create a" << width << "x" << height << "framebuffer for the benchmark";
+		return false;
+	}
+
+	// Same initialization as in StelQuickView
+	stelApp = new StelApp();
+	StelApp::initStatic();
+	stelApp->init(conf);
+	StelPainter::initGLShaders();
+	stelApp->glWindowHasBeenResized(0, 0, width, height);
+	return true;
+}
+
+void StelBenchmark::setupScene(const QVariantMap& scene)
+{
+	StelCore* core = stelApp->getCore();
+	StelMovementMgr* mvmgr = core->getMovementMgr();
+
+	if (scene.contains("location"))
+	{
+		const QString id = scene.value("location").toString();
+		const StelLocation loc = stelApp->getLocationMgr().locationForString(id);
+		if (loc.isValid())
+			core->moveObserverTo(loc, 0., 0.);
+		else
+			qWarning() << "WARNING: Unknown benchmark location:" << id;
+	}
+	if (scene.contains("jday"))
+		core->setJDay(scene.value("jday").toDouble());
+	core->setTimeRate(scene.value("timeRate", 0.).toDouble());
+
+	const QVariantMap actions = scene.value("actions").toMap();
+	for (QVariantMap::const_iterator iter=actions.constBegin();iter!=actions.constEnd();++iter)
+	{
+		StelAction* action = stelApp->getStelActionManager()->findAction(iter.key());
+		if (action && action->isCheckable())
+			action->setChecked(iter.value().toBool());
+		else
+			qWarning() << "WARNING: Unknown or not checkable benchmark action:" << iter.key();
+	}
+
+	stelApp->getStelObjectMgr().unSelect();
+	mvmgr->setFlagTracking(false);
+	if (scene.contains("fov"))
+		mvmgr->setFov(scene.value("fov").toDouble());
+	if (scene.contains("altitude") || scene.contains("azimuth"))
+	{
+		Vec3d aim;
+		const double alt = scene.value("altitude", 0.).toDouble()*M_PI/180.;
+		const double az = M_PI - scene.value("azimuth", 0.).toDouble()*M_PI/180.;
+		StelUtils::spheToRect(az, alt, aim);
+		mvmgr->setViewDirectionJ2000(core->altAzToJ2000(aim, StelCore::RefractionOff));
+	}
+}
+
+double StelBenchmark::renderFrame(QMap<QString, QVector<double> >* updateTimes, QMap<QString, QVector<double> >* drawTimes)
+{
+	StelCore* core = stelApp->getCore();
+	StelModuleMgr& moduleMgr = stelApp->getModuleMgr();
+	QOpenGLFunctions* gl = context->functions();
+	QElapsedTimer frameTimer;
+	QElapsedTimer timer;
+	frameTimer.start();
+
+	// Same sequence as StelApp::update() and StelApp::draw()
+	timer.start();
+	core->update(DELTA_TIME);
+	moduleMgr.update();
+	double coreUpdateTime = timer.nsecsElapsed()/1e6;
+	foreach (StelModule* module, moduleMgr.getCallOrders(StelModule::ActionUpdate))
+	{
+		timer.start();
+		module->update(DELTA_TIME);
+		if (updateTimes)
+			(*updateTimes)[module->objectName()].append(timer.nsecsElapsed()/1e6);
+	}
+	timer.start();
+	stelApp->getStelObjectMgr().update(DELTA_TIME);
+	coreUpdateTime += timer.nsecsElapsed()/1e6;
+
+	timer.start();
+	core->preDraw();
+	double coreDrawTime = timer.nsecsElapsed()/1e6;
+	foreach (StelModule* module, moduleMgr.getCallOrders(StelModule::ActionDraw))
+	{
+		timer.start();
+		module->draw(core);
+		if (syncModules)
+			gl->glFinish();
+		if (drawTimes)
+			(*drawTimes)[module->objectName()].append(timer.nsecsElapsed()/1e6);
+	}
+	timer.start();
+	core->postDraw();
+	gl->glFinish();
+	coreDrawTime += timer.nsecsElapsed()/1e6;
+
+	if (updateTimes)
+		(*updateTimes)["StelCore"].append(coreUpdateTime);
+	if (drawTimes)
+		(*drawTimes)["StelCore"].append(coreDrawTime);
+	const double frameTime = frameTimer.nsecsElapsed()/1e6;
+
+	// Deliver the textures loaded in the background and the other queued events outside of the measure
+	QCoreApplication::processEvents();
+	return frameTime;
+}
+
+QVariantMap StelBenchmark::runScene(const QVariantMap& scene, int warmupFrames, int frames)
+{
+	setupScene(scene);
+	for (int i=0;i<warmupFrames;++i)
+		renderFrame(NULL, NULL);
+
+	QVector<double> frameTimes;
+	frameTimes.reserve(frames);
+	QMap<QString, QVector<double> > updateTimes;
+	QMap<QString, QVector<double> > drawTimes;
+	for (int i=0;i<frames;++i)
+		frameTimes.append(renderFrame(&updateTimes, &drawTimes));
+
+	QVariantMap modules;
+	for (QMap<QString, QVector<double> >::const_iterator iter=updateTimes.constBegin();iter!=updateTimes.constEnd();++iter)
+	{
+		const QVariantMap stats = statistics(iter.value());
+		QVariantMap module;
+		module["updateMean"] = stats.value("mean");
+		module["updateP95"] = stats.value("p95");
+		modules[iter.key()] = module;
+	}
+	for (QMap<QString, QVector<double> >::const_iterator iter=drawTimes.constBegin();iter!=drawTimes.constEnd();++iter)
+	{
+		const QVariantMap stats = statistics(iter.value());
+		QVariantMap module = modules.value(iter.key()).toMap();
+		module["drawMean"] = stats.value("mean");
+		module["drawP95"] = stats.value("p95");
+		modules[iter.key()] = module;
+	}
+
+	QVariantMap report;
+	report["name"] = scene.value("name");
+	report["warmupFrames"] = warmupFrames;
+	report["frames"] = frames;
+	report["frameTime"] = statistics(frameTimes);
+	report["modules"] = modules;
+	return report;
+}
+
+QVariantMap StelBenchmark::runEventSearch(const QVariantMap& search)
+{
+	setupScene(search);
+	EventSearch::EventTypes types;
+	foreach (const QVariant& v, search.value("types").toList())
+	{
+		const EventSearch::EventType type = EventSearch::getType(v.toString());
+		if (!type)
+			qWarning() << "WARNING: Unknown benchmark event type:" << v.toString();
+		types |= type;
+	}
+	if (!search.contains("types"))
+		types = EventSearch::AllEvents;
+
+	EventSearch eventSearch(stelApp->getCore(), search.value("objects").toStringList());
+	foreach (const QString& name, eventSearch.getUnknownNames())
+		qWarning() << "WARNING: Unknown benchmark object:" << name;
+	const double jdStart = search.value("jdStart", stelApp->getCore()->getJDay()).toDouble();
+	const double jdEnd = search.value("jdEnd", jdStart+365.25).toDouble();
+	QElapsedTimer timer;
+	timer.start();
+	const QVector<EventSearch::Event> events = eventSearch.search(jdStart, jdEnd, types);
+	const double seconds = timer.nsecsElapsed()/1e9;
+
+	QVariantMap counts;
+	foreach (const EventSearch::Event& e, events)
+	{
+		const QString name = EventSearch::getTypeName(e.type);
+		counts[name] = counts.value(name, 0).toInt()+1;
+	}
+	QVariantMap report;
+	report["name"] = search.value("name");
+	report["objects"] = eventSearch.getNames();
+	report["days"] = jdEnd-jdStart;
+	report["events"] = events.size();
+	report["counts"] = counts;
+	report["seconds"] = seconds;
+	report["eventsPerSecond"] = seconds>0. ? events.size()/seconds : 0.;
+	return report;
+}
+
+QVariantMap StelBenchmark::runFootprint(const QVariantMap& footprint)
+{
+	const int nbVertices = qMax(3, footprint.value("vertices", 1000).toInt());
+	const int nbContours = qMax(1, footprint.value("contours", 1).toInt());
+	const double radius = qBound(0.1, footprint.value("radius", 10.).toDouble(), 80.)*M_PI/180.;
+	const int nbPoints = qMax(1, footprint.value("points", 100000).toInt());
+
+	// Star shaped contours with a wavy border, spread in right ascension along the equator
+	quint32 state = 1;
+	QVector<QVector<Vec3d> > contours;
+	for (int c=0;c<nbContours;++c)
+	{
+		const double ra0 = 2.*M_PI*c/nbContours;
+		QVector<Vec3d> contour;
+		contour.reserve(nbVertices);
+		for (int i=0;i<nbVertices;++i)
+		{
+			// Counterclockwise as seen from the center of the sphere, like the contours of all the regions
+			const double a = -2.*M_PI*i/nbVertices;
+			const double r = radius*(1.+0.2*std::sin(7.*a)+0.05*(nextRandom(state)-0.5));
+			contour.append(fromRaDec(ra0+r*std::cos(a), r*std::sin(a)));
+		}
+		contours.append(contour);
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	SphericalPolygon region(contours);
+	const double buildTime = timer.nsecsElapsed()/1e6;
+	timer.start();
+	const int nbTriangles = region.getFillVertexArray().vertex.size()/3;
+	const double tesselateTime = timer.nsecsElapsed()/1e6;
+
+	// Random points in the bounding cap, where the test is not trivially rejected
+	const SphericalCap cap = region.getBoundingCap();
+	Vec3d u = cap.n^Vec3d(0,0,1);
+	if (u.lengthSquared()<1e-6)
+		u = cap.n^Vec3d(1,0,0);
+	u.normalize();
+	const Vec3d w = cap.n^u;
+	QVector<Vec3d> points;
+	points.reserve(nbPoints);
+	for (int i=0;i<nbPoints;++i)
+	{
+		const double z = cap.d+(1.-cap.d)*nextRandom(state);
+		const double a = 2.*M_PI*nextRandom(state);
+		const double s = std::sqrt(qMax(0., 1.-z*z));
+		points.append(cap.n*z+u*(s*std::cos(a))+w*(s*std::sin(a)));
+	}
+	int inside = 0;
+	timer.start();
+	foreach (const Vec3d& p, points)
+	{
+		if (region.contains(p))
+			++inside;
+	}
+	const double containsTime = timer.nsecsElapsed()/1e6;
+
+	// Copies of the region shifted along the equator, half of them overlapping it
+	QList<SphericalPolygon> shifted;
+	for (int i=0;i<FOOTPRINT_INTERSECTIONS;++i)
+	{
+		const Mat4d rotation = Mat4d::zrotation(4.*radius*i/FOOTPRINT_INTERSECTIONS);
+		QVector<QVector<Vec3d> > shiftedContours = contours;
+		for (int c=0;c<shiftedContours.size();++c)
+		{
+			for (int j=0;j<shiftedContours[c].size();++j)
+				shiftedContours[c][j].transfo4d(rotation);
+		}
+		shifted.append(SphericalPolygon(shiftedContours));
+	}
+	int intersecting = 0;
+	timer.start();
+	foreach (const SphericalPolygon& other, shifted)
+	{
+		if (region.intersects(other))
+			++intersecting;
+	}
+	const double intersectsTime = timer.nsecsElapsed()/1e6;
+
+	QVariantMap report;
+	report["name"] = footprint.value("name");
+	report["vertices"] = nbVertices*nbContours;
+	report["triangles"] = nbTriangles;
+	report["buildTime"] = buildTime;
+	report["tesselateTime"] = tesselateTime;
+	report["points"] = nbPoints;
+	report["pointsInside"] = inside;
+	report["containsTime"] = containsTime;
+	report["containsPerSecond"] = containsTime>0. ? nbPoints/(containsTime/1e3) : 0.;
+	report["intersections"] = FOOTPRINT_INTERSECTIONS;
+	report["intersecting"] = intersecting;
+	report["intersectsTime"] = intersectsTime;
+	return report;
+}
+
+QVariantMap StelBenchmark::runEphemeris(const QVariantMap& ephemeris)
+{
+	QVariantMap report;
+	report["name"] = ephemeris.value("name");
+	const QString name = ephemeris.value("object").toString();
+	const PlanetP planet = GETSTELMODULE(SolarSystem)->searchByEnglishName(name);
+	const EphemerisCache* planetCache = planet.isNull() ? NULL : planet->getEphemerisCache();
+	if (!planetCache)
+	{
+		qWarning() << "WARNING: No ephemeris cache for benchmark object:" << name;
+		return report;
+	}
+	const double jdStart = ephemeris.value("jdStart", stelApp->getCore()->getJDay()).toDouble();
+	const double step = ephemeris.value("step", 1./24.).toDouble();
+	const int nbDates = qMax(1, ephemeris.value("dates", 100000).toInt());
+	const posFuncType func = planetCache->getFunction();
+
+	// The sums keep the compiler from dropping the computations
+	double xyz[3];
+	double seriesSum = 0.;
+	QElapsedTimer timer;
+	timer.start();
+	for (int i=0;i<nbDates;++i)
+	{
+		func(jdStart+i*step, xyz, NULL);
+		seriesSum += xyz[0];
+	}
+	const double seriesTime = timer.nsecsElapsed()/1e6;
+
+	EphemerisCache cache(func, planetCache->getPeriod());
+	double cacheSum = 0.;
+	timer.start();
+	for (int i=0;i<nbDates;++i)
+	{
+		cache.computePosition(jdStart+i*step, xyz);
+		cacheSum += xyz[0];
+	}
+	const double cacheTime = timer.nsecsElapsed()/1e6;
+
+	report["object"] = name;
+	report["dates"] = nbDates;
+	report["step"] = step;
+	report["segmentLength"] = cache.getSegmentLength();
+	report["seriesTime"] = seriesTime;
+	report["cacheTime"] = cacheTime;
+	report["speedup"] = cacheTime>0. ? seriesTime/cacheTime : 0.;
+	report["cachedEvaluations"] = cache.getCachedEvaluations();
+	report["seriesEvaluations"] = cache.getSeriesEvaluations();
+	report["skippedFits"] = cache.getSkippedFits();
+	report["rejectedSegments"] = cache.getRejectedSegments();
+	report["fitAfterCalls"] = cache.getFitAfterCalls();
+	// Mean difference of the x coordinates between the cache and the series, in AU
+	report["meanDifference"] = std::fabs(cacheSum-seriesSum)/nbDates;
+	return report;
+}
+
+QVariantMap StelBenchmark::runMinorBodies(const QVariantMap& minorBodies)
+{
+	QVariantMap report;
+	report["name"] = minorBodies.value("name");
+	const QString path = minorBodies.contains("file") ? minorBodies.value("file").toString() : StelFileMgr::findFile("data/minor_bodies.cat");
+	setupScene(minorBodies);
+	StelCore* core = stelApp->getCore();
+	const double jdStart = minorBodies.value("jdStart", core->getJDay()).toDouble();
+	const double step = minorBodies.value("step", 1.).toDouble();
+	const int nbDates = qMax(1, minorBodies.value("dates", 20).toInt());
+
+	MinorBodyCatalog catalog;
+	QElapsedTimer timer;
+	timer.start();
+	if (path.isEmpty() || !catalog.open(path))
+	{
+		qWarning() << "WARNING: Could not open benchmark minor body catalogue:" << QDir::toNativeSeparators(path);
+		return report;
+	}
+	const double loadTime = timer.nsecsElapsed()/1e6;
+	catalog.setThreadCount(conf->value("astro/minor_body_threads", QThread::idealThreadCount()).toInt());
+
+	// Positions of the whole catalogue, as when searching bodies
+	const int nbBodies = catalog.size();
+	QVector<int> indexes(nbBodies);
+	for (int i=0;i<nbBodies;++i)
+		indexes[i] = i;
+	QVector<Vec3f> positions(nbBodies);
+	QVector<double> positionTimes;
+	for (int d=0;d<nbDates;++d)
+	{
+		timer.start();
+		catalog.computePositions(jdStart+d*step, indexes.constData(), nbBodies, positions.data());
+		positionTimes.append(timer.nsecsElapsed()/1e6);
+	}
+
+	// Points of the bodies brighter than the limiting magnitude, as in the frames of SolarSystem
+	QOpenGLFunctions* gl = context->functions();
+	QVector<double> pointTimes;
+	for (int d=0;d<nbDates;++d)
+	{
+		core->setJDay(jdStart+d*step);
+		core->update(0.);
+		core->preDraw();
+		timer.start();
+		catalog.draw(core, 1.f);
+		gl->glFinish();
+		pointTimes.append(timer.nsecsElapsed()/1e6);
+		core->postDraw();
+	}
+
+	const QVariantMap positionStats = statistics(positionTimes);
+	report["bodies"] = nbBodies;
+	report["dates"] = nbDates;
+	report["step"] = step;
+	report["loadTime"] = loadTime;
+	report["positionTime"] = positionStats;
+	report["positionsPerSecond"] = positionStats.value("mean").toDouble()>0. ? nbBodies/(positionStats.value("mean").toDouble()/1e3) : 0.;
+	report["pointTime"] = statistics(pointTimes);
+	return report;
+}
+
+QVariantMap StelBenchmark::runSphereMesh(const QVariantMap& sphereMesh)
+{
+	const int slices = qBound(3, sphereMesh.value("slices", 40).toInt(), 255);
+	const int stacks = qBound(2, sphereMesh.value("stacks", 40).toInt(), 255);
+	const float radius = sphereMesh.value("radius", 1.).toFloat();
+	const float oneMinusOblateness = 1.f-sphereMesh.value("oblateness", 0.).toFloat();
+	const int nbDraws = qMax(1, sphereMesh.value("draws", 1000).toInt());
+
+	StelCore* core = stelApp->getCore();
+	QOpenGLFunctions* gl = context->functions();
+	core->update(0.);
+	core->preDraw();
+	StelPainter sPainter(core->getProjection(StelCore::FrameJ2000));
+
+	// Without the cache, as sSphere() did: the mesh is computed again for each draw
+	QElapsedTimer timer;
+	double meshTime = 0.;
+	int nbTriangles = 0;
+	timer.start();
+	for (int i=0;i<nbDraws;++i)
+	{
+		QElapsedTimer meshTimer;
+		meshTimer.start();
+		const StelVertexArray mesh = StelPainter::computeSphereNoLight(radius, oneMinusOblateness, slices, stacks);
+		meshTime += meshTimer.nsecsElapsed()/1e6;
+		nbTriangles = mesh.indices.size()/3;
+		sPainter.setArrays(mesh.vertex.constData(), mesh.texCoords.constData());
+		sPainter.drawFromArray(StelPainter::Triangles, mesh.indices.size(), 0, true, mesh.indices.constData());
+	}
+	gl->glFinish();
+	const double uncachedTime = timer.nsecsElapsed()/1e6;
+
+	// With the cache, which computes the mesh on the first draw only
+	timer.start();
+	for (int i=0;i<nbDraws;++i)
+		sPainter.sSphere(radius, oneMinusOblateness, slices, stacks);
+	gl->glFinish();
+	const double cachedTime = timer.nsecsElapsed()/1e6;
+	core->postDraw();
+
+	QVariantMap report;
+	report["name"] = sphereMesh.value("name");
+	report["slices"] = slices;
+	report["stacks"] = stacks;
+	report["triangles"] = nbTriangles;
+	report["draws"] = nbDraws;
+	report["meshTime"] = meshTime;
+	report["uncachedTime"] = uncachedTime;
+	report["cachedTime"] = cachedTime;
+	report["speedup"] = cachedTime>0. ? uncachedTime/cachedTime : 0.;
+	return report;
+}
+
+QVariantMap StelBenchmark::runNameSearch(const QVariantMap& nameSearch)
+{
+	const int maxNbItem = qMax(1, nameSearch.value("maxItems", 5).toInt());
+	const bool wordStarts = nameSearch.value("wordStarts", true).toBool();
+	const int repeats = qMax(1, nameSearch.value("repeats", 1000).toInt());
+	QStringList prefixes = nameSearch.value("prefixes").toStringList();
+	if (prefixes.isEmpty())
+		prefixes << "A" << "AL" << "SIR" << "M3" << "NGC 7" << "HIP 1" << "ALPHA";
+
+	// English names of all the objects, as searched by the search dialog
+	StelObjectMgr& objectMgr = stelApp->getStelObjectMgr();
+	QStringList names;
+	foreach (const QString& moduleId, objectMgr.objectModulesMap().keys())
+		names << objectMgr.listAllModuleObjects(moduleId, true);
+
+	QElapsedTimer timer;
+	timer.start();
+	StelNameIndex index;
+	foreach (const QString& name, names)
+		index.insert(name, name);
+	index.build();
+	const double buildTime = timer.nsecsElapsed()/1e6;
+
+	int indexMatches = 0;
+	timer.start();
+	for (int r=0;r<repeats;++r)
+	{
+		foreach (const QString& prefix, prefixes)
+			indexMatches += index.listMatching(prefix, maxNbItem, wordStarts).size();
+	}
+	const double indexTime = timer.nsecsElapsed()/1e6;
+
+	// Linear scan of the names, as the modules searched before the index
+	int scanMatches = 0;
+	timer.start();
+	for (int r=0;r<repeats;++r)
+	{
+		foreach (const QString& prefix, prefixes)
+		{
+			QStringList result;
+			foreach (const QString& name, names)
+			{
+				if (result.size()>=maxNbItem)
+					break;
+				bool found = name.startsWith(prefix, Qt::CaseInsensitive);
+				// Same word starts as StelNameIndex
+				for (int i=1;!found && wordStarts && i<name.size();++i)
+				{
+					if (name.at(i).isLetterOrNumber() && !name.at(i-1).isLetterOrNumber())
+						found = name.midRef(i).startsWith(prefix, Qt::CaseInsensitive);
+				}
+				if (found && !result.contains(name))
+					result << name;
+			}
+			scanMatches += result.size();
+		}
+	}
+	const double scanTime = timer.nsecsElapsed()/1e6;
+
+	// Search of all the modules, as the search dialog does for each key press
+	int objectMatches = 0;
+	timer.start();
+	for (int r=0;r<repeats;++r)
+	{
+		foreach (const QString& prefix, prefixes)
+			objectMatches += objectMgr.listMatchingObjects(prefix, maxNbItem, wordStarts).size();
+	}
+	const double objectMgrTime = timer.nsecsElapsed()/1e6;
+
+	const int nbSearches = repeats*prefixes.size();
+	QVariantMap report;
+	report["name"] = nameSearch.value("name");
+	report["names"] = names.size();
+	report["searches"] = nbSearches;
+	report["buildTime"] = buildTime;
+	report["indexTime"] = indexTime;
+	report["indexMatches"] = indexMatches;
+	report["scanTime"] = scanTime;
+	report["scanMatches"] = scanMatches;
+	report["speedup"] = indexTime>0. ? scanTime/indexTime : 0.;
+	report["objectMgrTime"] = objectMgrTime;
+	report["objectMgrMatches"] = objectMatches;
+	report["objectMgrSearchTime"] = objectMgrTime/nbSearches;
+	return report;
+}
+
+QVariantMap StelBenchmark::statistics(QVector<double> times)
+{
+	QVariantMap stats;
+	if (times.isEmpty())
+		return stats;
+	std::sort(times.begin(), times.end());
+	double sum = 0.;
+	for (int i=0;i<times.size();++i)
+		sum += times[i];
+	// Nearest rank percentiles
+	const int n = times.size();
+	const int p[] = {50, 90, 95, 99};
+	for (int i=0;i<4;++i)
+	{
+		const int rank = qBound(1, (int)std::ceil(p[i]/100.*n), n);
+		stats[QString("p%1").arg(p[i])] = times[rank-1];
+	}
+	stats["mean"] = sum/n;
+	stats["min"] = times.first();
+	stats["max"] = times.last();
+	return stats;
+}
+
+bool StelBenchmark::run(const QString& sceneFile, int frames, const QString& outputFile)
+{
+	QVariantMap scenes;
+	QFile input(sceneFile);
+	if (!input.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "ERROR: Could not open benchmark scene file:" << QDir::toNativeSeparators(sceneFile);
+		return false;
+	}
+	try
+	{
+		scenes = StelJsonParser::parse(&input).toMap();
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "ERROR: Could not parse benchmark scene file" << QDir::toNativeSeparators(sceneFile) << ":" << e.what();
+		return false;
+	}
+	input.close();
+
+	const int width = scenes.value("width", conf->value("video/screen_w", 480)).toInt();
+	const int height = scenes.value("height", conf->value("video/screen_h", 700)).toInt();
+	syncModules = scenes.value("syncModules", true).toBool();
+	if (!init(width, height))
+		return false;
+
+	QVariantList sceneReports;
+	foreach (const QVariant& v, scenes.value("scenes").toList())
+	{
+		const QVariantMap scene = v.toMap();
+		const int warmupFrames = scene.value("warmupFrames", scenes.value("warmupFrames", DEFAULT_WARMUP_FRAMES)).toInt();
+		const int sceneFrames = frames>0 ? frames : scene.value("frames", scenes.value("frames", DEFAULT_FRAMES)).toInt();
+		qDebug() << "Benchmarking scene" << scene.value("name").toString() << "with" << sceneFrames << "frames";
+		sceneReports.append(runScene(scene, warmupFrames, qMax(1, sceneFrames)));
+	}
+
+	QVariantList searchReports;
+	foreach (const QVariant& v, scenes.value("eventSearches").toList())
+	{
+		const QVariantMap search = v.toMap();
+		qDebug() << "Benchmarking event search" << search.value("name").toString();
+		searchReports.append(runEventSearch(search));
+	}
+
+	QVariantList footprintReports;
+	foreach (const QVariant& v, scenes.value("footprints").toList())
+	{
+		const QVariantMap footprint = v.toMap();
+		qDebug() << "Benchmarking footprint" << footprint.value("name").toString();
+		footprintReports.append(runFootprint(footprint));
+	}
+
+	QVariantList ephemerisReports;
+	foreach (const QVariant& v, scenes.value("ephemerides").toList())
+	{
+		const QVariantMap ephemeris = v.toMap();
+		qDebug() << "Benchmarking ephemeris" << ephemeris.value("name").toString();
+		ephemerisReports.append(runEphemeris(ephemeris));
+	}
+
+	QVariantList minorBodyReports;
+	foreach (const QVariant& v, scenes.value("minorBodies").toList())
+	{
+		const QVariantMap minorBodies = v.toMap();
+		qDebug() << "Benchmarking minor bodies" << minorBodies.value("name").toString();
+		minorBodyReports.append(runMinorBodies(minorBodies));
+	}
+
+	QVariantList sphereMeshReports;
+	foreach (const QVariant& v, scenes.value("sphereMeshes").toList())
+	{
+		const QVariantMap sphereMesh = v.toMap();
+		qDebug() << "Benchmarking sphere mesh" << sphereMesh.value("name").toString();
+		sphereMeshReports.append(runSphereMesh(sphereMesh));
+	}
+
+	QVariantList nameSearchReports;
+	foreach (const QVariant& v, scenes.value("nameSearches").toList())
+	{
+		const QVariantMap nameSearch = v.toMap();
+		qDebug() << "Benchmarking name search" << nameSearch.value("name").toString();
+		nameSearchReports.append(runNameSearch(nameSearch));
+	}
+
+	QOpenGLFunctions* gl = context->functions();
+	QVariantMap report;
+	report["version"] = StelUtils::getApplicationVersion();
+	report["renderer"] = QString((const char*)gl->glGetString(GL_RENDERER));
+	report["width"] = width;
+	report["height"] = height;
+	report["syncModules"] = syncModules;
+	report["scenes"] = sceneReports;
+	report["eventSearches"] = searchReports;
+	report["footprints"] = footprintReports;
+	report["ephemerides"] = ephemerisReports;
+	report["minorBodies"] = minorBodyReports;
+	report["sphereMeshes"] = sphereMeshReports;
+	report["nameSearches"] = nameSearchReports;
+
+	QFile output(outputFile);
+	const bool ok = outputFile.isEmpty() ? output.open(stdout, QIODevice::WriteOnly) : output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	if (!ok)
+	{
+		qWarning() << "ERROR: Could not write benchmark report:" << QDir::toNativeSeparators(outputFile);
+		return false;
+	}
+	StelJsonParser::write(report, &output);
+	output.write("\n");
+	return true;
+}
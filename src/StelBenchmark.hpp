@@ -0,0 +1,156 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef _STELBENCHMARK_HPP_
+#define _STELBENCHMARK_HPP_
+
+#include <QMap>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+class QOffscreenSurface;
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+class QSettings;
+class StelApp;
+
+//! @class StelBenchmark
+//! Render scenes without any window and measure the time spent in each frame and in each module.
+//! It is started with the --benchmark option instead of the main view. StelApp is initialized
+//! on an offscreen surface, and each frame runs the same update and draw sequence as StelApp,
+//! timing the modules one by one. The deltaTime of the updates is fixed, so that two runs render
+//! the same frames.
+//!
+//! The scenes are read from a JSON file:
+//! @code
+//! {
+//! 	"width": 1280, "height": 720,
+//! 	"warmupFrames": 20, "frames": 300,
+//! 	"scenes": [
+//! 		{
+//! 			"name": "Milky Way from Paris",
+//! 			"location": "Paris, Western Europe",
+//! 			"jday": 2457000.5,
+//! 			"timeRate": 0,
+//! 			"fov": 120, "altitude": 30, "azimuth": 180,
+//! 			"actions": {"actionShow_Atmosphere": false, "actionShow_MilkyWay": true}
+//! 		}
+//! 	],
+//! 	"eventSearches": [
+//! 		{
+//! 			"name": "Planets over a century",
+//! 			"location": "Paris, Western Europe",
+//! 			"jdStart": 2451545.0, "jdEnd": 2488070.0,
+//! 			"objects": ["Mercury", "Venus", "Mars", "Jupiter", "Saturn", "Regulus"],
+//! 			"types": ["rise", "set", "conjunction", "opposition", "occultation", "solar-eclipse", "lunar-eclipse"]
+//! 		}
+//! 	],
+//! 	"footprints": [
+//! 		{"name": "Survey field", "vertices": 4000, "contours": 1, "radius": 10, "points": 100000}
+//! 	],
+//! 	"ephemerides": [
+//! 		{"name": "Io at 1 hour per frame", "object": "Io", "jdStart": 2451545.0, "step": 0.041667, "dates": 100000}
+//! 	],
+//! 	"minorBodies": [
+//! 		{"name": "MPCORB from Paris", "location": "Paris, Western Europe", "jdStart": 2457000.5, "step": 1, "dates": 20, "fov": 60}
+//! 	],
+//! 	"sphereMeshes": [
+//! 		{"name": "Planet sphere", "slices": 40, "stacks": 40, "radius": 1, "oblateness": 0.1, "draws": 1000}
+//! 	],
+//! 	"nameSearches": [
+//! 		{"name": "Search dialog", "prefixes": ["A", "SIR", "M3", "NGC 7"], "maxItems": 5, "wordStarts": true, "repeats": 1000}
+//! 	]
+//! }
+//! @endcode
+//! All the scene fields are optional, and "warmupFrames" and "frames" can be given per scene.
+//! The optional event searches are run after the scenes with EventSearch, without rendering. Their
+//! "types" are the names of StelMainScriptAPI::searchEvents(), all the types being searched if
+//! there are none. The report gives the number of events of each type and the search time.
+//! The optional footprints are synthetic SphericalPolygon regions like survey coverage maps, made of
+//! "contours" star shaped contours of "vertices" vertices with a mean radius of "radius" degrees.
+//! The report gives the time to build each region, to tesselate it as when it is first drawn, to test
+//! whether it contains "points" random points, and to test whether it intersects shifted copies of itself.
+//! The optional ephemerides compute the position of a body whose theory is cached by EphemerisCache at
+//! "dates" dates, "step" days apart like the dates of successive frames, with the series and with a new
+//! cache. The report gives both times and the number of positions computed from the series by the cache.
+//! The optional minor bodies open the MinorBodyCatalog "file", by default data/minor_bodies.cat as loaded by
+//! SolarSystem, then compute the positions of all its bodies and draw its points at "dates" dates, "step" days
+//! apart. The report gives the loading time, and the statistics of the position and point times per date.
+//! The optional sphere meshes draw "draws" times a sphere like a planet with StelPainter, first computing its
+//! mesh for each draw as without the mesh cache, then with sSphere() and the cache. The report gives both
+//! times and the time spent computing the meshes.
+//! The optional name searches put the English names of all the objects in a StelNameIndex, then search each of
+//! the "prefixes" "repeats" times in the index, by a linear scan of the names, and with StelObjectMgr like the
+//! search dialog. The report gives the time to build the index and the time and number of matches of each search.
+//! "timeRate" is in days per second of simulated time, and "azimuth" is counted from the north
+//! towards the east. If "syncModules" is false, the runner only waits for the GPU at the end of
+//! each frame: the frame times are then closer to the real ones, but the draw times of the modules
+//! no longer include their rendering. The report gives, per scene, the percentiles of the frame times and the mean
+//! and 95th percentile of the update and draw times of each module, in ms.
+class StelBenchmark
+{
+public:
+	StelBenchmark(QSettings* conf);
+	~StelBenchmark();
+
+	//! Render all the scenes of a scene file and write the report.
+	//! @param frames if positive, overrides the number of frames of all the scenes.
+	//! @param outputFile where to write the JSON report, or empty for the standard output.
+	//! @return false if the scene file could not be read or no OpenGL context could be created.
+	bool run(const QString& sceneFile, int frames, const QString& outputFile);
+
+private:
+	//! Create the OpenGL context, the surface and the framebuffer, and initialize StelApp.
+	bool init(int width, int height);
+	//! Set the location, date, view and actions of a scene.
+	void setupScene(const QVariantMap& scene);
+	//! Render a frame, appending the times spent in each module in ms to the lists of each module.
+	//! Nothing is appended if the lists are NULL.
+	//! @return the time of the whole frame in ms.
+	double renderFrame(QMap<QString, QVector<double> >* updateTimes, QMap<QString, QVector<double> >* drawTimes);
+	//! Render the frames of a scene and return its report.
+	QVariantMap runScene(const QVariantMap& scene, int warmupFrames, int frames);
+	//! Run an event search and return its report.
+	QVariantMap runEventSearch(const QVariantMap& search);
+	//! Run the region benchmarks of a footprint and return its report.
+	QVariantMap runFootprint(const QVariantMap& footprint);
+	//! Compare the series and the ephemeris cache of a body and return the report.
+	QVariantMap runEphemeris(const QVariantMap& ephemeris);
+	//! Load a minor body catalogue, time its positions and points, and return the report.
+	QVariantMap runMinorBodies(const QVariantMap& minorBodies);
+	//! Compare the drawing of a sphere with and without the mesh cache of StelPainter and return the report.
+	QVariantMap runSphereMesh(const QVariantMap& sphereMesh);
+	//! Compare the prefix searches of a name index and of a linear scan and return the report.
+	QVariantMap runNameSearch(const QVariantMap& nameSearch);
+
+	//! Get the mean, min, max and percentiles of a list of times.
+	static QVariantMap statistics(QVector<double> times);
+
+	QSettings* conf;
+	QOffscreenSurface* surface;
+	QOpenGLContext* context;
+	QOpenGLFramebufferObject* fbo;
+	StelApp* stelApp;
+	//! Whether to wait for the GPU after each module, so that its draw time includes the rendering.
+	bool syncModules;
+};
+
+#endif // _STELBENCHMARK_HPP_
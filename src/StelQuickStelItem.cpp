@@ -353,6 +353,10 @@ void MainThreadProxy::setManualPosition(double latitude, double longitude)
 	loc.planetName = "Earth";
 	loc.latitude = latitude;
 	loc.longitude = longitude;
+	// Take the altitude of the nearest known location within about 25 km
+	const StelLocation nearby = StelApp::getInstance().getLocationMgr().locationNearest(loc.planetName, longitude, latitude, 0.25f);
+	if (nearby.isValid())
+		loc.altitude = nearby.altitude;
 	StelApp::getInstance().getCore()->moveObserverTo(loc, 0.);
 	StelApp::getInstance().getCore()->setDefaultLocationID(loc.getID());
 }
@@ -479,7 +483,13 @@ QString StelQuickStelItem::getLocation() const
 	StelCore* core = StelApp::getInstance().getCore();
 	const StelLocation& location = core->getCurrentLocation();
 	if (location.name.isEmpty())
+	{
+		// Name the place with the nearest known location within about 25 km
+		const StelLocation nearby = StelApp::getInstance().getLocationMgr().locationNearest(location.planetName, location.longitude, location.latitude, 0.25f);
+		if (nearby.isValid())
+			return QString("%1 (%2)").arg(q_("Manual"), nearby.getID());
 		return q_("Manual");
+	}
 	return location.getID();
 }
 
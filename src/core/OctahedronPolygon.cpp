@@ -24,6 +24,8 @@
 
 #include <QFile>
 
+#include <cmath>
+
 const Vec3d OctahedronPolygon::sideDirections[] = {	Vec3d(1,1,1), Vec3d(1,1,-1),Vec3d(-1,1,1),Vec3d(-1,1,-1),
 	Vec3d(1,-1,1),Vec3d(1,-1,-1),Vec3d(-1,-1,1),Vec3d(-1,-1,-1)};
 
@@ -129,8 +131,9 @@ OctahedronPolygon::OctahedronPolygon(const QList<OctahedronPolygon>& octs) : fil
 			Q_ASSERT(oct.sides.size()==8);
 			sides[i] += oct.sides[i];
 		}
-		tesselate(WindingPositive);
 	}
+	// The positive winding rule gives the union of all the contours at once
+	tesselate(WindingPositive);
 	updateVertexArray();
 }
 
@@ -378,9 +381,57 @@ void OctahedronPolygon::updateVertexArray()
 {
 	Q_ASSERT(sides.size()==8);
 	fillCachedVertexArray.vertex.clear();
+	fillCacheValid = false;
+	triangleGrids.clear();
 	outlineCachedVertexArray.vertex.clear();
 
+	for (int sidenb=0;sidenb<8;++sidenb)
+	{
+		if (sides[sidenb].isEmpty())
+			continue;
+		const Vec3d& sideDirection = sideDirections[sidenb];
+
+		// Compute the outline contours, getting rid of non edge segments
+		EdgeVertex previous;
+		foreach (const SubContour& c, sides[sidenb])
+		{
+			Q_ASSERT(!c.isEmpty());
+			previous = c.first();
+			unprojectOctahedron(previous.vertex, sideDirection);
+			for (int j=0;j<c.size()-1;++j)
+			{
+				if (previous.edgeFlag || c.at(j+1).edgeFlag)
+				{
+					outlineCachedVertexArray.vertex.append(previous.vertex);
+					previous=c.at(j+1);
+					unprojectOctahedron(previous.vertex, sideDirection);
+					outlineCachedVertexArray.vertex.append(previous.vertex);
+				}
+				else
+				{
+					previous=c.at(j+1);
+					unprojectOctahedron(previous.vertex, sideDirection);
+				}
+			}
+			// Last point connects with first point
+			if (previous.edgeFlag || c.first().edgeFlag)
+			{
+				outlineCachedVertexArray.vertex.append(previous.vertex);
+				outlineCachedVertexArray.vertex.append(c.first().vertex);
+				unprojectOctahedron(outlineCachedVertexArray.vertex.last(), sideDirection);
+			}
+		}
+	}
+	computeBoundingCap();
+}
+
+void OctahedronPolygon::updateFillVertexArray() const
+{
 	Q_ASSERT(sides.size()==8);
+	fillCachedVertexArray.vertex.clear();
+	triangleGrids.clear();
+	fillCacheValid = true;
+
 	// Use GLUES tesselation functions to transform the polygon into a list of triangles
 	GLUEStesselator* tess = gluesNewTess();
 #ifndef NDEBUG
@@ -421,40 +472,8 @@ void OctahedronPolygon::updateVertexArray()
 				//qDebug() << "Found a fucking CW triangle";
 			}
 		}
-
-		// Now compute the outline contours, getting rid of non edge segments
-		EdgeVertex previous;
-		foreach (const SubContour& c, sides[sidenb])
-		{
-			Q_ASSERT(!c.isEmpty());
-			previous = c.first();
-			unprojectOctahedron(previous.vertex, sideDirection);
-			for (int j=0;j<c.size()-1;++j)
-			{
-				if (previous.edgeFlag || c.at(j+1).edgeFlag)
-				{
-					outlineCachedVertexArray.vertex.append(previous.vertex);
-					previous=c.at(j+1);
-					unprojectOctahedron(previous.vertex, sideDirection);
-					outlineCachedVertexArray.vertex.append(previous.vertex);
-				}
-				else
-				{
-					previous=c.at(j+1);
-					unprojectOctahedron(previous.vertex, sideDirection);
-				}
-			}
-			// Last point connects with first point
-			if (previous.edgeFlag || c.first().edgeFlag)
-			{
-				outlineCachedVertexArray.vertex.append(previous.vertex);
-				outlineCachedVertexArray.vertex.append(c.first().vertex);
-				unprojectOctahedron(outlineCachedVertexArray.vertex.last(), sideDirection);
-			}
-		}
 	}
 	gluesDeleteTess(tess);
-	computeBoundingCap();
 
 #ifndef NDEBUG
 	// Check that all triangles are properly oriented
@@ -475,6 +494,96 @@ void OctahedronPolygon::updateVertexArray()
 #endif
 }
 
+void OctahedronPolygon::updateTriangleGrids() const
+{
+	const QVector<Vec3d>& vertices = getFillVertexArray().vertex;
+	const int nbTriangles = vertices.size()/3;
+	triangleGrids.fill(TriangleGrid(), 8);
+
+	// Sort the triangles by side, with their bounding boxes in the 2D coordinates of the side.
+	// A triangle lies on a single side, which is the side of its center.
+	QVector<int> triangleSides(nbTriangles);
+	QVector<double> boxes(nbTriangles*4);
+	QVector<int> nbSideTriangles(8, 0);
+	double minX[8], minY[8], maxX[8], maxY[8];
+	for (int s=0;s<8;++s)
+	{
+		minX[s] = minY[s] = 2.;
+		maxX[s] = maxY[s] = -2.;
+	}
+	for (int i=0;i<nbTriangles;++i)
+	{
+		const int s = getSideNumber(vertices.at(i*3)+vertices.at(i*3+1)+vertices.at(i*3+2));
+		triangleSides[i] = s;
+		++nbSideTriangles[s];
+		double* box = boxes.data()+i*4;
+		box[0] = box[1] = 2.;
+		box[2] = box[3] = -2.;
+		for (int j=0;j<3;++j)
+		{
+			double x, y;
+			projectOnSide(vertices.at(i*3+j), s, x, y);
+			box[0] = qMin(box[0], x);
+			box[1] = qMin(box[1], y);
+			box[2] = qMax(box[2], x);
+			box[3] = qMax(box[3], y);
+		}
+		minX[s] = qMin(minX[s], box[0]);
+		minY[s] = qMin(minY[s], box[1]);
+		maxX[s] = qMax(maxX[s], box[2]);
+		maxY[s] = qMax(maxY[s], box[3]);
+	}
+
+	for (int s=0;s<8;++s)
+	{
+		TriangleGrid& grid = triangleGrids[s];
+		if (nbSideTriangles[s]==0)
+			continue;
+		// About one triangle per cell
+		grid.size = qBound(1, (int)std::ceil(std::sqrt((double)nbSideTriangles[s])), 256);
+		grid.minX = minX[s];
+		grid.minY = minY[s];
+		grid.scaleX = maxX[s]>minX[s] ? grid.size/(maxX[s]-minX[s]) : 0.;
+		grid.scaleY = maxY[s]>minY[s] ? grid.size/(maxY[s]-minY[s]) : 0.;
+		grid.cellStart.fill(0, grid.size*grid.size+1);
+	}
+
+	// Count the triangles of each cell and accumulate the counts, then store the triangles from the end of
+	// each cell, which leaves cellStart at the start of each cell
+	for (int pass=0;pass<2;++pass)
+	{
+		if (pass==1)
+		{
+			for (int s=0;s<8;++s)
+			{
+				TriangleGrid& grid = triangleGrids[s];
+				for (int c=1;c<grid.cellStart.size();++c)
+					grid.cellStart[c] += grid.cellStart[c-1];
+				grid.cellTriangles.resize(grid.cellStart.isEmpty() ? 0 : grid.cellStart.last());
+			}
+		}
+		for (int i=0;i<nbTriangles;++i)
+		{
+			TriangleGrid& grid = triangleGrids[triangleSides[i]];
+			const double* box = boxes.constData()+i*4;
+			const int x0 = qBound(0, (int)((box[0]-grid.minX)*grid.scaleX), grid.size-1);
+			const int y0 = qBound(0, (int)((box[1]-grid.minY)*grid.scaleY), grid.size-1);
+			const int x1 = qBound(0, (int)((box[2]-grid.minX)*grid.scaleX), grid.size-1);
+			const int y1 = qBound(0, (int)((box[3]-grid.minY)*grid.scaleY), grid.size-1);
+			for (int y=y0;y<=y1;++y)
+			{
+				for (int x=x0;x<=x1;++x)
+				{
+					if (pass==0)
+						++grid.cellStart[y*grid.size+x];
+					else
+						grid.cellTriangles[--grid.cellStart[y*grid.size+x]] = i;
+				}
+			}
+		}
+	}
+}
+
 struct OctTessLineLoopCallbackData
 {
 	SubContour result;				//! Contains the resulting tesselated vertices.
@@ -623,6 +732,10 @@ bool OctahedronPolygon::intersects(const OctahedronPolygon& mpoly) const
 {
 	if (!intersectsBoundingCap(capN, capD, mpoly.capN, mpoly.capD))
 		return false;
+	// Quick accept if a point inside one polygon is inside the other one
+	if (!getFillVertexArray().vertex.isEmpty() && !mpoly.getFillVertexArray().vertex.isEmpty()
+		&& (contains(mpoly.getPointInside()) || mpoly.contains(getPointInside())))
+		return true;
 	OctahedronPolygon resOct(*this);
 	resOct.inPlaceIntersection(mpoly);
 	return !resOct.isEmpty();
@@ -632,6 +745,9 @@ bool OctahedronPolygon::contains(const OctahedronPolygon& mpoly) const
 {
 	if (!containsBoundingCap(capN, capD, mpoly.capN, mpoly.capD))
 		return false;
+	// Quick reject if a point inside the polygon is outside of this one
+	if (!mpoly.getFillVertexArray().vertex.isEmpty() && !contains(mpoly.getPointInside()))
+		return false;
 	OctahedronPolygon resOct(*this);
 	resOct.inPlaceUnion(mpoly);
 	return resOct.getArea()-getArea()<0.00000000001;
@@ -639,13 +755,29 @@ bool OctahedronPolygon::contains(const OctahedronPolygon& mpoly) const
 
 bool OctahedronPolygon::contains(const Vec3d& p) const
 {
-	if (sides[getSideNumber(p)].isEmpty())
+	const int sidenb = getSideNumber(p);
+	if (sides[sidenb].isEmpty())
+		return false;
+	if (triangleGrids.isEmpty())
+		updateTriangleGrids();
+	// Only test the triangles of the cell of the side containing the point
+	const TriangleGrid& grid = triangleGrids.at(sidenb);
+	if (grid.size==0)
+		return false;
+	double x, y;
+	projectOnSide(p, sidenb, x, y);
+	const double cx = (x-grid.minX)*grid.scaleX;
+	const double cy = (y-grid.minY)*grid.scaleY;
+	if (cx<0. || cy<0. || cx>grid.size || cy>grid.size)
 		return false;
-	for (int i=0;i<fillCachedVertexArray.vertex.size()/3;++i)
+	const int cell = qMin((int)cy, grid.size-1)*grid.size + qMin((int)cx, grid.size-1);
+	const QVector<Vec3d>& vertices = fillCachedVertexArray.vertex;
+	for (int t=grid.cellStart.at(cell);t<grid.cellStart.at(cell+1);++t)
 	{
-		if (sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3+1), fillCachedVertexArray.vertex.at(i*3), p) &&
-			sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3+2), fillCachedVertexArray.vertex.at(i*3+1), p) &&
-			sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3), fillCachedVertexArray.vertex.at(i*3+2), p))
+		const int i = grid.cellTriangles.at(t);
+		if (sideHalfSpaceContains(vertices.at(i*3+1), vertices.at(i*3), p) &&
+			sideHalfSpaceContains(vertices.at(i*3+2), vertices.at(i*3+1), p) &&
+			sideHalfSpaceContains(vertices.at(i*3), vertices.at(i*3+2), p))
 			return true;
 	}
 	return false;
@@ -881,7 +1013,7 @@ QDataStream& operator<<(QDataStream& out, const OctahedronPolygon& p)
 	{
 		out << p.sides[i];
 	}
-	out << p.fillCachedVertexArray;
+	out << p.getFillVertexArray();
 	out << p.outlineCachedVertexArray;
 	out << p.capN;
 	out << p.capD;
@@ -897,6 +1029,8 @@ QDataStream& operator>>(QDataStream& in, OctahedronPolygon& p)
 	}
 //	p.updateVertexArray();
 	in >> p.fillCachedVertexArray;
+	p.fillCacheValid = true;
+	p.triangleGrids.clear();
 	in >> p.outlineCachedVertexArray;
 	in >> p.capN;
 	in >> p.capD;
@@ -59,10 +59,13 @@ public:
 //! Manage a non-convex polygon which can extends on more than 180 deg.
 //! The contours defining the polygon are splitted and projected on the 8 sides of an Octahedron to enable 2D geometry
 //! algorithms to be used.
+//! The contours are tesselated into triangles only when the triangles are first needed, e.g. to draw the polygon,
+//! and the triangles are then kept until the polygon changes. The caches are filled by const methods, so a polygon
+//! must not be shared between threads without calling getFillVertexArray() first.
 class OctahedronPolygon
 {
 public:
-	OctahedronPolygon() : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines), capN(1,0,0), capD(-2.)
+	OctahedronPolygon() : fillCachedVertexArray(StelVertexArray::Triangles), fillCacheValid(true), outlineCachedVertexArray(StelVertexArray::Lines), capN(1,0,0), capD(-2.)
 	{sides.resize(8);}
 
 	//! Create the OctahedronContour by splitting the passed SubContour on the 8 sides of the octahedron.
@@ -76,7 +79,7 @@ public:
 	Vec3d getPointInside() const;
 
 	//! Returns the list of triangles resulting from tesselating the contours.
-	StelVertexArray getFillVertexArray() const {return fillCachedVertexArray;}
+	StelVertexArray getFillVertexArray() const {if (!fillCacheValid) updateFillVertexArray(); return fillCachedVertexArray;}
 	StelVertexArray getOutlineVertexArray() const {return outlineCachedVertexArray;}
 
 	void getBoundingCap(Vec3d& v, double& d) const {v=capN; d=capD;}
@@ -139,15 +142,39 @@ private:
 	QVector<Vec3d> tesselateOneSideTriangles(struct GLUEStesselator* tess, int sidenb) const;
 	QVarLengthArray<QVector<SubContour>,8 > sides;
 
-	//! Update the content of both cached vertex arrays.
+	//! Update the outline vertex array and the bounding cap, and invalidate the triangles.
 	void updateVertexArray();
-	StelVertexArray fillCachedVertexArray;
+	//! Tesselate the contours into the fill vertex array.
+	void updateFillVertexArray() const;
+	mutable StelVertexArray fillCachedVertexArray;
+	mutable bool fillCacheValid;
 	StelVertexArray outlineCachedVertexArray;
+
+	//! Uniform grid over the triangles of one side in the 2D coordinates of the side, used by contains().
+	struct TriangleGrid
+	{
+		TriangleGrid() : size(0), minX(0.), minY(0.), scaleX(0.), scaleY(0.) {;}
+		//! Number of cells along each axis, 0 if the side has no triangles.
+		int size;
+		double minX, minY;
+		//! Number of cells per unit along each axis.
+		double scaleX, scaleY;
+		//! Triangles overlapping each cell, as indexes in the fill vertex array divided by 3. The triangles of
+		//! the cell i are cellTriangles[cellStart[i]] to cellTriangles[cellStart[i+1]-1].
+		QVector<int> cellStart;
+		QVector<int> cellTriangles;
+	};
+	//! Build the grids of the 8 sides from the fill vertex array.
+	void updateTriangleGrids() const;
+	//! The grids of the 8 sides, or empty if they have to be built.
+	mutable QVector<TriangleGrid> triangleGrids;
 	void computeBoundingCap();
 	Vec3d capN;
 	double capD;
 
 	static const Vec3d sideDirections[];
+	//! Get the 2D coordinates of a vector projected on a side.
+	static void projectOnSide(const Vec3d& v, int sideNb, double& x, double& y) {const double d=sideDirections[sideNb]*v; x=v[0]/d; y=v[1]/d;}
 	static int getSideNumber(const Vec3d& v) {return v[0]>=0. ?  (v[1]>=0. ? (v[2]>=0.?0:1) : (v[2]>=0.?4:5))   :   (v[1]>=0. ? (v[2]>=0.?2:3) : (v[2]>=0.?6:7));}
 	static bool isTriangleConvexPositive2D(const Vec3d& a, const Vec3d& b, const Vec3d& c);
 	static bool triangleContains2D(const Vec3d& a, const Vec3d& b, const Vec3d& c, const Vec3d& p);
@@ -27,6 +27,39 @@ Extinction::Extinction() : ext_coeff(50), undergroundExtinctionMode(UndergroundE
 {
 }
 
+//Young 1994
+static inline float youngAirmass(float cosZ)
+{
+	const float nom=(1.002432f*cosZ+0.148386f)*cosZ+0.0096467f;
+	const float denum=((cosZ+0.149864f)*cosZ+0.0102963f)*cosZ+0.000303978f;
+	return nom/denum;
+}
+
+void Extinction::forward(int n, const Vec3d* altAzPos, float* mag) const
+{
+	if (undergroundExtinctionMode==UndergroundExtinctionMirror)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			float cosZ = altAzPos[i][2];
+			Q_ASSERT(std::fabs(altAzPos[i].length()-1.f)<0.001f);
+			if (cosZ<-0.035f)
+				cosZ = std::min(1.f, -0.035f - (cosZ+0.035f));
+			mag[i] += youngAirmass(cosZ) * ext_coeff;
+		}
+		return;
+	}
+
+	// Zero or maximum extinction, the same for all the underground positions
+	const float undergroundExtinction = undergroundExtinctionMode==UndergroundExtinctionMax ? 42.f * ext_coeff : 0.f;
+	for (int i=0; i<n; ++i)
+	{
+		const float cosZ = altAzPos[i][2];
+		Q_ASSERT(std::fabs(altAzPos[i].length()-1.f)<0.001f);
+		mag[i] += cosZ<-0.035f ? undergroundExtinction : youngAirmass(cosZ) * ext_coeff;
+	}
+}
+
 // airmass computation for cosine of zenith angle z
 float Extinction::airmass(float cosZ, const bool apparent_z) const
 {
@@ -50,10 +83,7 @@ float Extinction::airmass(float cosZ, const bool apparent_z) const
 	}
 	else
 	{
-		//Young 1994
-		const float nom=(1.002432f*cosZ+0.148386f)*cosZ+0.0096467f;
-		const float denum=((cosZ+0.149864f)*cosZ+0.0102963f)*cosZ+0.000303978f;
-		return nom/denum;
+		return youngAirmass(cosZ);
 	}
 }
 
@@ -72,8 +102,10 @@ static const float MIN_APP_ALTITUDE_DEG=-3.21783f;
 // this must be positive. Transition zone goes that far below the values just specified.
 static const float TRANSITION_WIDTH_GEO_DEG=1.46f;
 static const float TRANSITION_WIDTH_APP_DEG=1.78217f;
+// Number of intervals of the refraction tables
+static const int REFRACTION_TABLE_SIZE=4096;
 
-Refraction::Refraction() : pressure(1013.f), temperature(10.f),
+Refraction::Refraction() : pressure(1013.f), temperature(10.f), useTables(false),
 	preTransfoMat(Mat4d::identity()), invertPreTransfoMat(Mat4d::identity()), preTransfoMatf(Mat4f::identity()), invertPreTransfoMatf(Mat4f::identity()),
 	postTransfoMat(Mat4d::identity()), invertPostTransfoMat(Mat4d::identity()), postTransfoMatf(Mat4f::identity()), invertPostTransfoMatf(Mat4f::identity())
 {
@@ -106,10 +138,68 @@ void Refraction::updatePrecomputed()
 {
 	press_temp_corr_Bennett=pressure/1010.f * 283.f/(273.f+temperature) / 60.f;
 	press_temp_corr_Saemundson=1.02f*press_temp_corr_Bennett;
+	if (useTables)
+		computeTables();
+}
+
+void Refraction::setFlagLookupTables(bool b)
+{
+	useTables=b;
+	if (useTables)
+		computeTables();
+	else
+	{
+		forwardTable.clear();
+		backwardTable.clear();
+	}
+}
+
+void Refraction::computeTables()
+{
+	// Use the formulas while the tables are computed
+	forwardTable.clear();
+	backwardTable.clear();
+	QVector<float> forwardShift(REFRACTION_TABLE_SIZE+1);
+	QVector<float> backwardShift(REFRACTION_TABLE_SIZE+1);
+	for (int i=0; i<=REFRACTION_TABLE_SIZE; ++i)
+	{
+		const double z=-1.+2.*i/REFRACTION_TABLE_SIZE;
+		Vec3d v(std::sqrt(1.-z*z), 0., z);
+		innerRefractionForward(v);
+		forwardShift[i]=std::asin(qBound(-1., v[2], 1.))-std::asin(z);
+		v.set(std::sqrt(1.-z*z), 0., z);
+		innerRefractionBackward(v);
+		backwardShift[i]=std::asin(qBound(-1., v[2], 1.))-std::asin(z);
+	}
+	forwardTable=forwardShift;
+	backwardTable=backwardShift;
+}
+
+void Refraction::applyTable(const QVector<float>& table, Vec3d& altAzPos)
+{
+	const double length = altAzPos.length();
+	const double z=altAzPos[2]/length;
+	double p=(z+1.)*0.5*REFRACTION_TABLE_SIZE;
+	if (p<0.)
+		p=0.;
+	int i=(int)p;
+	if (i>=REFRACTION_TABLE_SIZE)
+		i=REFRACTION_TABLE_SIZE-1;
+	const float* t=table.constData()+i;
+	const double r=t[0]+(p-i)*(t[1]-t[0]);
+	// sin(asin(z)+r), using the series of sin and cos for the small angle r
+	const double c=std::sqrt(qMax(0., 1.-z*z));
+	const double refracted=z*(1.-0.5*r*r)+c*r*(1.-r*r/6.);
+	altAzPos[2]=qMin(refracted, 1.)*length;
 }
 
 void Refraction::innerRefractionForward(Vec3d& altAzPos) const
 {
+	if (!forwardTable.isEmpty())
+	{
+		applyTable(forwardTable, altAzPos);
+		return;
+	}
 	const double length = altAzPos.length();
 	double geom_alt_deg=180./M_PI*std::asin(altAzPos[2]/length);
 	if (geom_alt_deg > MIN_GEO_ALTITUDE_DEG)
@@ -133,6 +223,11 @@ void Refraction::innerRefractionForward(Vec3d& altAzPos) const
 void Refraction::innerRefractionBackward(Vec3d& altAzPos) const
 {
 	// going from observed position/magnitude to geometrical position and atmosphere-free mag.
+	if (!backwardTable.isEmpty())
+	{
+		applyTable(backwardTable, altAzPos);
+		return;
+	}
 	const double length = altAzPos.length();
 	float obs_alt_deg=180./M_PI*std::asin(altAzPos[2]/length);
 	if (obs_alt_deg > 0.22879)
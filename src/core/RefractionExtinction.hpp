@@ -31,6 +31,8 @@
 #include "VecMath.hpp"
 #include "StelProjector.hpp"
 
+#include <QVector>
+
 //! @class Extinction
 //! This class performs extinction computations, following literature from atmospheric optics and astronomy.
 //! Airmass computations are limited to meaningful altitudes.
@@ -83,6 +85,10 @@ public:
 		*mag -= airmass(altAzPos[2], false) * ext_coeff;
 	}
 
+	//! Compute extinction effect for an array of n NORMALIZED (geometrical) position vectors, and add it to
+	//! the n magnitudes. The underground mode is only tested once for the whole array.
+	void forward(int n, const Vec3d* altAzPos, float* mag) const;
+
 	//! Set visual extinction coefficient (mag/airmass), influences extinction computation.
 	//! @param k= 0.1 for highest mountains, 0.2 for very good lowland locations, 0.35 for typical lowland, 0.5 in humid climates.
 	void setExtinctionCoefficient(float k) { ext_coeff=k; }
@@ -164,9 +170,20 @@ public:
 	void setPreTransfoMat(const Mat4d& m);
 	void setPostTransfoMat(const Mat4d& m);
 
+	//! Set whether refraction is interpolated in tables of the altitude shift instead of evaluating the formulas.
+	//! The tables are computed again when the pressure or the temperature change. Above 0.6 degree of
+	//! altitude, the error on the refracted altitude is below 0.3 arcsec. Near the horizon and in the
+	//! transition zones below it, where the formulas have kinks, it is below 6 arcsec.
+	void setFlagLookupTables(bool b);
+	bool getFlagLookupTables() const {return useTables;}
+
 private:
 	//! Update precomputed variables.
 	void updatePrecomputed();
+	//! Compute the forward and backward tables from the formulas.
+	void computeTables();
+	//! Shift the altitude of a vector by the angle interpolated in a table.
+	static void applyTable(const QVector<float>& table, Vec3d& altAzPos);
 
 	void innerRefractionForward(Vec3d& altAzPos) const;
 	void innerRefractionBackward(Vec3d& altAzPos) const;
@@ -181,6 +198,11 @@ private:
 	//! Numerator of refraction formula, to be cached for speed.
 	float press_temp_corr_Bennett;
 
+	bool useTables;
+	//! Altitude shift in radian over the sine of the altitude in [-1, 1], empty if the tables are not used.
+	QVector<float> forwardTable;
+	QVector<float> backwardTable;
+
 	//! Used to pretransform coordinates into AltAz frame.
 	Mat4d preTransfoMat;
 	Mat4d invertPreTransfoMat;
@@ -58,6 +58,7 @@
 #include "StelVideoMgr.hpp"
 #include "StelGuiBase.hpp"
 #include "StelPainter.hpp"
+#include "StelProfiler.hpp"
 #ifndef DISABLE_SCRIPTING
  #include "StelScriptMgr.hpp"
  #include "StelMainScriptAPIProxy.hpp"
@@ -217,6 +218,7 @@ StelApp::StelApp(QObject* parent)
 	moduleMgr=NULL;
 	networkAccessManager=NULL;
 	actionMgr = NULL;
+	profiler = NULL;
 
 	// Can't create 2 StelApp instances
 	Q_ASSERT(!singleton);
@@ -253,6 +255,7 @@ StelApp::~StelApp()
 	delete planetLocationMgr; planetLocationMgr=NULL;
 	delete moduleMgr; moduleMgr=NULL; // Delete the secondary instance
 	delete actionMgr; actionMgr = NULL;
+	delete profiler; profiler = NULL;
 
 	Q_ASSERT(singleton);
 	singleton = NULL;
@@ -380,6 +383,9 @@ void StelApp::init(QSettings* conf)
 	skyCultureMgr = new StelSkyCultureMgr();
 	planetLocationMgr = new StelLocationMgr();
 	actionMgr = new StelActionMgr();
+	profiler = new StelProfiler();
+	profiler->setFlagEnabled(confSettings->value("devel/flag_profiler", false).toBool());
+	profiler->setFlagShowOverlay(confSettings->value("devel/flag_profiler_overlay", false).toBool());
 
 	localeMgr->init();
 
@@ -509,6 +515,7 @@ void StelApp::init(QSettings* conf)
 
 	// Init actions.
 	actionMgr->addAction("actionShow_Night_Mode", N_("Display Options"), N_("Night mode"), this, "nightMode");
+	actionMgr->addAction("actionShow_Profiler", N_("Display Options"), N_("Profiler statistics"), profiler, "overlayVisible");
 
 	initialized = true;
 }
@@ -579,16 +586,24 @@ void StelApp::update(double deltaTime)
 		timeBase+=1.;
 	}
 		
-	core->update(deltaTime);
+	static const int coreSection = StelProfiler::getSectionId("StelCore::update");
+	static const int objectMgrSection = StelProfiler::getSectionId("StelObjectMgr::update");
+	profiler->beginFrame();
+	{
+		StelProfiler::Scope scope(coreSection);
+		core->update(deltaTime);
+	}
 
 	moduleMgr->update();
 
 	// Send the event to every StelModule
 	foreach (StelModule* i, moduleMgr->getCallOrders(StelModule::ActionUpdate))
 	{
+		StelProfiler::Scope scope(i->objectName(), "update");
 		i->update(deltaTime);
 	}
 
+	StelProfiler::Scope scope(objectMgrSection);
 	stelObjectMgr->update(deltaTime);
 }
 
@@ -602,9 +617,12 @@ void StelApp::draw()
 	const QList<StelModule*> modules = moduleMgr->getCallOrders(StelModule::ActionDraw);
 	foreach(StelModule* module, modules)
 	{
+		StelProfiler::Scope scope(module->objectName(), "draw");
 		module->draw(core);
 	}
+	profiler->drawOverlay(core);
 	core->postDraw();
+	profiler->endFrame();
 }
 
 /*************************************************************************
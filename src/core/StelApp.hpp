@@ -44,6 +44,7 @@ class StelGuiBase;
 class StelMainScriptAPIProxy;
 class StelScriptMgr;
 class StelActionMgr;
+class StelProfiler;
 class StelProgressController;
 
 //! @class StelApp
@@ -125,6 +126,9 @@ public:
 	//! Get the video manager
 	StelVideoMgr* getStelVideoMgr() {return videoMgr;}
 
+	//! Get the profiler timing the modules and the stages of the frame
+	StelProfiler* getProfiler() {return profiler;}
+
 	//! Get the core of the program.
 	//! It is the one which provide the projection, navigation and tone converter.
 	//! @return the StelCore instance of the program
@@ -252,6 +256,9 @@ private:
 	//Actions manager fot the application.  Will replace shortcutMgr.
 	StelActionMgr* actionMgr;
 
+	// Profiler of the modules
+	StelProfiler* profiler;
+
 	// Textures manager for the application
 	StelTextureMgr* textureMgr;
 
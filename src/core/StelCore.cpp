@@ -225,6 +225,8 @@ void StelCore::init()
 
     actionsMgr->addAction("action_updatecomets2", "Plugins", N_("Update Comets (MPC)"), this, "UpdateCometsCore2()");
 
+    actionsMgr->addAction("action_updateminorplanets", "Plugins", N_("Update Minor Planets (MPCORB)"), this, "UpdateMinorPlanetsCore()");
+
 //    actionsMgr->addAction("actionShow_Telrad", "Plugins", N_("Show_Telrad"), this, "Show_Telrad()");
 
 }
@@ -1251,6 +1253,14 @@ void StelCore::UpdateCometsCore3()
     uc->startDownload("https://www.minorplanetcenter.net/iau/MPCORB/CometEls.txt");
 }
 
+//! Replace the minor body catalogue with the whole MPC orbit database
+void StelCore::UpdateMinorPlanetsCore()
+{
+    qDebug()<<"update minor planets now!";
+    UpdateComets * uc = new UpdateComets();
+    uc->startCatalogDownload("https://www.minorplanetcenter.net/iau/MPCORB/MPCORB.DAT");
+}
+
 //! Decrease the time speed
 void StelCore::decreaseTimeSpeed()
 {
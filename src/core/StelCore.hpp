@@ -520,6 +520,7 @@ public slots:
     void UpdateCometsCore1();
     void UpdateCometsCore2();
     void UpdateCometsCore3();
+    void UpdateMinorPlanetsCore();
     void Show_Telrad();
 
 signals:
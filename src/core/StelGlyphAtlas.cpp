@@ -0,0 +1,226 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelGlyphAtlas.hpp"
+
+#include <QFontMetrics>
+#include <QGlyphRun>
+#include <QImage>
+#include <QOpenGLContext>
+#include <QPainter>
+#include <QTextLayout>
+
+#include <cmath>
+
+// Number of glyphs of all the cached layouts
+static const int LAYOUT_CACHE_LIMIT = 50000;
+// Transparent border around each glyph image, so that linear filtering does not pick up the neighbours
+static const int GLYPH_PADDING = 1;
+
+StelGlyphAtlas::StelGlyphAtlas()
+	: layouts(LAYOUT_CACHE_LIMIT),
+	  pixels(MinSize*MinSize*2, 0),
+	  size(MinSize),
+	  penX(0), penY(0), rowHeight(0),
+	  dirtyTop(0), dirtyBottom(MinSize),
+	  id(0),
+	  glSize(0)
+{
+}
+
+StelGlyphAtlas::~StelGlyphAtlas()
+{
+	if (id && QOpenGLContext::currentContext())
+		QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &id);
+	id = 0;
+}
+
+const StelGlyphAtlas::Layout* StelGlyphAtlas::getLayout(const QString& str, const QFont& font, const QByteArray& fontKey)
+{
+	QByteArray key = str.toUtf8();
+	key.append('\0');
+	key.append(fontKey);
+	Layout* layout = layouts.object(key);
+	if (layout)
+		return layout;
+
+	layout = new Layout;
+	layout->bounds = QFontMetrics(font).boundingRect(str);
+	QTextLayout textLayout(str, font);
+	textLayout.beginLayout();
+	QTextLine line = textLayout.createLine();
+	if (line.isValid())
+		line.setNumColumns(str.length());
+	textLayout.endLayout();
+	const qreal baseline = line.isValid() ? line.ascent() : 0.;
+
+	const QList<QGlyphRun> runs = textLayout.glyphRuns();
+	for (int r=0;r<runs.size();++r)
+	{
+		const QRawFont rawFont = runs[r].rawFont();
+		const quint64 fontId = getFontId(rawFont);
+		const QVector<quint32> indexes = runs[r].glyphIndexes();
+		const QVector<QPointF> positions = runs[r].positions();
+		for (int i=0;i<indexes.size();++i)
+		{
+			Layout::Item item;
+			item.key = (fontId<<32) | indexes[i];
+			item.index = indexes[i];
+			item.font = layout->fonts.size();
+			item.position = QPointF(positions[i].x(), positions[i].y()-baseline);
+			layout->items.append(item);
+		}
+		layout->fonts.append(rawFont);
+	}
+	// The layout is deleted at once if it is bigger than the whole cache
+	if (!layouts.insert(key, layout, layout->items.size()+1))
+		return NULL;
+	return layout;
+}
+
+int StelGlyphAtlas::getFontId(const QRawFont& font)
+{
+	const QString key = QString("%1\n%2\n%3\n%4\n%5").arg(font.familyName(), font.styleName())
+		.arg(font.pixelSize()).arg(font.weight()).arg((int)font.style());
+	QHash<QString, int>::const_iterator it = fontIds.constFind(key);
+	if (it!=fontIds.constEnd())
+		return it.value();
+	const int fontId = fontIds.size();
+	fontIds.insert(key, fontId);
+	return fontId;
+}
+
+bool StelGlyphAtlas::getGlyph(const Layout& layout, int i, Glyph& glyph)
+{
+	const Layout::Item& item = layout.items[i];
+	QHash<quint64, Glyph>::const_iterator it = glyphs.constFind(item.key);
+	if (it!=glyphs.constEnd())
+	{
+		glyph = it.value();
+		return true;
+	}
+
+	const QRawFont& rawFont = layout.fonts[item.font];
+	const QRectF rect = rawFont.boundingRect(item.index);
+	if (rect.isEmpty())
+	{
+		glyph.x = glyph.y = glyph.left = glyph.top = glyph.width = glyph.height = 0;
+		glyphs.insert(item.key, glyph);
+		return true;
+	}
+	const int left = (int)std::floor(rect.left()) - GLYPH_PADDING;
+	const int top = (int)std::floor(rect.top()) - GLYPH_PADDING;
+	const int w = (int)std::ceil(rect.right()) + GLYPH_PADDING - left;
+	const int h = (int)std::ceil(rect.bottom()) + GLYPH_PADDING - top;
+	if (!allocate(w, h, glyph.x, glyph.y))
+		return false;
+	glyph.left = left;
+	glyph.top = top;
+	glyph.width = w;
+	glyph.height = h;
+
+	QImage image(w, h, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+	{
+		QGlyphRun run;
+		run.setRawFont(rawFont);
+		run.setGlyphIndexes(QVector<quint32>(1, item.index));
+		run.setPositions(QVector<QPointF>(1, QPointF(-left, -top)));
+		QPainter painter(&image);
+		painter.setRenderHints(QPainter::TextAntialiasing);
+		painter.setPen(Qt::white);
+		painter.drawGlyphRun(QPointF(0, 0), run);
+	}
+	// White, with the coverage in the alpha channel
+	for (int y=0;y<h;++y)
+	{
+		const QRgb* src = (const QRgb*)image.constScanLine(y);
+		uchar* dst = (uchar*)pixels.data() + ((glyph.y+y)*size + glyph.x)*2;
+		for (int x=0;x<w;++x)
+		{
+			dst[2*x] = 255;
+			dst[2*x+1] = qAlpha(src[x]);
+		}
+	}
+	dirtyTop = qMin(dirtyTop, (int)glyph.y);
+	dirtyBottom = qMax(dirtyBottom, glyph.y+h);
+
+	glyphs.insert(item.key, glyph);
+	return true;
+}
+
+bool StelGlyphAtlas::allocate(int w, int h, short& x, short& y)
+{
+	if (w>size || h>size)
+		return false;
+	if (penX+w>size)
+	{
+		penX = 0;
+		penY += rowHeight;
+		rowHeight = 0;
+	}
+	if (penY+h>size)
+		return false;
+	x = penX;
+	y = penY;
+	penX += w;
+	rowHeight = qMax(rowHeight, h);
+	return true;
+}
+
+void StelGlyphAtlas::reset()
+{
+	if (size<MaxSize)
+		size *= 2;
+	pixels.fill(0, size*size*2);
+	glyphs.clear();
+	penX = penY = rowHeight = 0;
+	dirtyTop = 0;
+	dirtyBottom = size;
+}
+
+void StelGlyphAtlas::bind()
+{
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	if (!id)
+	{
+		gl->glGenTextures(1, &id);
+		gl->glBindTexture(GL_TEXTURE_2D, id);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	else
+		gl->glBindTexture(GL_TEXTURE_2D, id);
+
+	// Rows are size*2 bytes long, which is a multiple of the default unpack alignment of 4
+	if (glSize!=size)
+	{
+		gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, size, size, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, pixels.constData());
+		glSize = size;
+	}
+	else if (dirtyTop<dirtyBottom)
+	{
+		gl->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, dirtyTop, size, dirtyBottom-dirtyTop, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE,
+				    pixels.constData() + dirtyTop*size*2);
+	}
+	dirtyTop = size;
+	dirtyBottom = 0;
+}
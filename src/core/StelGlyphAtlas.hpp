@@ -0,0 +1,125 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELGLYPHATLAS_HPP_
+#define _STELGLYPHATLAS_HPP_
+
+#include "StelOpenGL.hpp"
+
+#include <QByteArray>
+#include <QCache>
+#include <QFont>
+#include <QHash>
+#include <QPointF>
+#include <QRawFont>
+#include <QRect>
+#include <QVector>
+
+//! @class StelGlyphAtlas
+//! Texture holding the glyphs of all the fonts used for drawing text, and cache of the shaped strings.
+//! Strings are shaped once with QTextLayout, so that bidirectional text and complex scripts are
+//! handled like with QPainter. Each glyph is rasterized once, at the first time it is drawn, and
+//! packed in rows into a single luminance-alpha texture. The texture starts at MinSize pixels and
+//! doubles each time it is full, up to MaxSize. When the largest texture is full, it is cleared and
+//! the glyphs are rasterized again as they are drawn.
+//! StelPainter uses it to draw all the labels with the same texture, in a single draw call.
+class StelGlyphAtlas
+{
+public:
+	//! Position of a glyph in the texture.
+	struct Glyph
+	{
+		//! Top left corner in the texture, in texels.
+		short x, y;
+		//! Offset of the top left corner of the glyph image from the pen position on the baseline, y down.
+		short left, top;
+		//! Size of the glyph image in pixels. It is 0 for glyphs without pixels, like spaces.
+		short width, height;
+	};
+
+	//! A string shaped with a given font.
+	struct Layout
+	{
+		struct Item
+		{
+			//! Key of the glyph in the atlas.
+			quint64 key;
+			//! Glyph index in the font.
+			quint32 index;
+			//! Index of the font in fonts.
+			int font;
+			//! Pen position relative to the start of the baseline, y down.
+			QPointF position;
+		};
+		QVector<Item> items;
+		QVector<QRawFont> fonts;
+		//! Bounding rectangle of the string relative to the start of the baseline, as given by QFontMetrics.
+		QRect bounds;
+	};
+
+	StelGlyphAtlas();
+	~StelGlyphAtlas();
+
+	//! Get the layout of a string.
+	//! @param fontKey a key identifying the font, e.g. QFont::key().
+	const Layout* getLayout(const QString& str, const QFont& font, const QByteArray& fontKey);
+
+	//! Get a glyph of a layout, rasterizing it in the texture if needed.
+	//! @return false if there is no room left in the texture. It is then up to the caller to draw the
+	//! text using the texture, and to call reset().
+	bool getGlyph(const Layout& layout, int item, Glyph& glyph);
+
+	//! Remove all the glyphs from the texture. The texture is made bigger if it is not at MaxSize.
+	void reset();
+
+	//! Upload the glyphs rasterized since the last call and bind the texture to the current texture unit.
+	void bind();
+
+	//! Get the width and height of the texture in texels.
+	int getSize() const {return size;}
+
+	//! Initial size of the texture.
+	static const int MinSize = 512;
+	//! Maximum size of the texture. At 2 bytes per texel, the texture uses at most 8 MB.
+	static const int MaxSize = 2048;
+
+private:
+	//! Get the id of a raw font, used in glyph keys.
+	int getFontId(const QRawFont& font);
+	//! Find room for a glyph of the given size in the texture.
+	bool allocate(int w, int h, short& x, short& y);
+
+	QCache<QByteArray, Layout> layouts;
+	QHash<QString, int> fontIds;
+	QHash<quint64, Glyph> glyphs;
+
+	//! Luminance-alpha copy of the texture.
+	QByteArray pixels;
+	int size;
+	//! Position of the next glyph, and height of the current row.
+	int penX, penY, rowHeight;
+	//! Rows of pixels modified since the last upload.
+	int dirtyTop, dirtyBottom;
+
+	GLuint id;
+	//! Size of the texture currently allocated in GL, 0 if none.
+	int glSize;
+};
+
+#endif // _STELGLYPHATLAS_HPP_
@@ -0,0 +1,354 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelLocationDB.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QHash>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const char Magic[4] = {'S', 'L', 'D', 'B'};
+static const quint32 ByteOrderMark = 0x01020304;
+
+struct StelLocationDB::Header
+{
+	char magic[4];
+	quint32 version;
+	quint32 byteOrder;
+	quint32 nbLocations;
+	//! Number of slots of the hash table, a power of 2.
+	quint32 hashSize;
+	quint32 stringsSize;
+	qint64 sourceSize;
+	qint64 sourceModified;
+};
+
+struct StelLocationDB::Record
+{
+	//! Unit vector of the position, used by the k-d tree.
+	float v[3];
+	float longitude;
+	float latitude;
+	float bortleScaleIndex;
+	qint32 altitude;
+	qint32 population;
+	//! Offsets of the strings in the pool.
+	quint32 name;
+	quint32 state;
+	quint32 country;
+	quint32 planetName;
+	quint32 landscapeKey;
+	quint16 role;
+	quint16 reserved;
+};
+
+namespace
+{
+	// FNV-1a, which unlike qHash() does not depend on the Qt version or on a random seed
+	quint32 hashId(const QByteArray& id)
+	{
+		quint32 h = 2166136261u;
+		for (int i=0;i<id.size();++i)
+		{
+			h ^= (uchar)id[i];
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	quint32 addString(QByteArray& pool, QHash<QString, quint32>& offsets, const QString& s)
+	{
+		if (s.isEmpty())
+			return 0;
+		QHash<QString, quint32>::const_iterator it = offsets.constFind(s);
+		if (it!=offsets.constEnd())
+			return it.value();
+		const quint32 offset = pool.size();
+		pool.append(s.toUtf8());
+		pool.append('\0');
+		offsets.insert(s, offset);
+		return offset;
+	}
+
+	// Compare the positions of 2 locations along an axis
+	struct AxisLessThan
+	{
+		AxisLessThan(const QVector<float>& positions, int axis) : positions(positions), axis(axis) {}
+		bool operator()(int a, int b) const {return positions[3*a+axis] < positions[3*b+axis];}
+		const QVector<float>& positions;
+		int axis;
+	};
+
+	// Order the locations as a balanced k-d tree: the median along the axis is in the middle
+	// of the range, and each half is a k-d tree along the next axis.
+	void buildKdTree(QVector<int>& order, const QVector<float>& positions, int begin, int end, int axis)
+	{
+		if (end-begin<2)
+			return;
+		const int mid = (begin+end)/2;
+		std::nth_element(order.begin()+begin, order.begin()+mid, order.begin()+end, AxisLessThan(positions, axis));
+		buildKdTree(order, positions, begin, mid, (axis+1)%3);
+		buildKdTree(order, positions, mid+1, end, (axis+1)%3);
+	}
+}
+
+StelLocationDB::StelLocationDB() : header(NULL), records(NULL), hashTable(NULL), strings(NULL)
+{
+}
+
+StelLocationDB::~StelLocationDB()
+{
+	close();
+}
+
+void StelLocationDB::toUnitVector(float longitude, float latitude, float v[3])
+{
+	const float lon = longitude*M_PI/180.;
+	const float lat = latitude*M_PI/180.;
+	v[0] = std::cos(lat)*std::cos(lon);
+	v[1] = std::cos(lat)*std::sin(lon);
+	v[2] = std::sin(lat);
+}
+
+bool StelLocationDB::write(const QString& path, const QMap<QString, StelLocation>& locations, qint64 sourceSize, qint64 sourceModified)
+{
+	const int n = locations.size();
+	QVector<Record> unsorted(n);
+	QVector<float> positions(3*n);
+	QVector<QString> ids(n);
+	// Offset 0 is the empty string
+	QByteArray pool(1, '\0');
+	QHash<QString, quint32> offsets;
+	int i = 0;
+	for (QMap<QString, StelLocation>::const_iterator iter=locations.constBegin();iter!=locations.constEnd();++iter, ++i)
+	{
+		const StelLocation& loc = iter.value();
+		Record& r = unsorted[i];
+		toUnitVector(loc.longitude, loc.latitude, r.v);
+		positions[3*i] = r.v[0];
+		positions[3*i+1] = r.v[1];
+		positions[3*i+2] = r.v[2];
+		r.longitude = loc.longitude;
+		r.latitude = loc.latitude;
+		r.bortleScaleIndex = loc.bortleScaleIndex;
+		r.altitude = loc.altitude;
+		r.population = loc.population;
+		r.name = addString(pool, offsets, loc.name);
+		r.state = addString(pool, offsets, loc.state);
+		r.country = addString(pool, offsets, loc.country);
+		r.planetName = addString(pool, offsets, loc.planetName);
+		r.landscapeKey = addString(pool, offsets, loc.landscapeKey);
+		r.role = loc.role.unicode();
+		r.reserved = 0;
+		ids[i] = iter.key();
+	}
+
+	QVector<int> order(n);
+	for (i=0;i<n;++i)
+		order[i] = i;
+	buildKdTree(order, positions, 0, n, 0);
+
+	QVector<Record> sorted(n);
+	quint32 hashSize = 16;
+	while (hashSize < 2*(quint32)n)
+		hashSize *= 2;
+	QVector<quint32> table(hashSize, 0);
+	for (i=0;i<n;++i)
+	{
+		sorted[i] = unsorted[order[i]];
+		quint32 h = hashId(ids[order[i]].toUtf8()) & (hashSize-1);
+		while (table[h]!=0)
+			h = (h+1) & (hashSize-1);
+		table[h] = i+1;
+	}
+
+	Header h;
+	memcpy(h.magic, Magic, 4);
+	h.version = Version;
+	h.byteOrder = ByteOrderMark;
+	h.nbLocations = n;
+	h.hashSize = hashSize;
+	h.stringsSize = pool.size();
+	h.sourceSize = sourceSize;
+	h.sourceModified = sourceModified;
+
+	// Write to a temporary file, so that a partial file is never opened
+	const QString tmpPath = path + ".tmp";
+	QFile out(tmpPath);
+	if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "ERROR: Could not write location database: " << QDir::toNativeSeparators(tmpPath);
+		return false;
+	}
+	bool ok = out.write((const char*)&h, sizeof(h)) == sizeof(h);
+	ok = ok && out.write((const char*)sorted.constData(), n*sizeof(Record)) == (qint64)(n*sizeof(Record));
+	ok = ok && out.write((const char*)table.constData(), hashSize*sizeof(quint32)) == (qint64)(hashSize*sizeof(quint32));
+	ok = ok && out.write(pool) == pool.size();
+	out.close();
+	QFile::remove(path);
+	if (!ok || !QFile::rename(tmpPath, path))
+	{
+		qWarning() << "ERROR: Could not write location database: " << QDir::toNativeSeparators(path);
+		QFile::remove(tmpPath);
+		return false;
+	}
+	return true;
+}
+
+bool StelLocationDB::open(const QString& path, qint64 sourceSize, qint64 sourceModified)
+{
+	close();
+	file.setFileName(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	const qint64 fileSize = file.size();
+	if (fileSize < (qint64)sizeof(Header))
+	{
+		close();
+		return false;
+	}
+	const uchar* data = file.map(0, fileSize);
+	if (!data)
+	{
+		buffer = file.readAll();
+		data = (const uchar*)buffer.constData();
+	}
+
+	header = (const Header*)data;
+	const qint64 expectedSize = sizeof(Header) + (qint64)header->nbLocations*sizeof(Record)
+			+ (qint64)header->hashSize*sizeof(quint32) + header->stringsSize;
+	if (memcmp(header->magic, Magic, 4)!=0 || header->version!=Version || header->byteOrder!=ByteOrderMark
+		|| header->sourceSize!=sourceSize || header->sourceModified!=sourceModified
+		|| header->hashSize==0 || (header->hashSize & (header->hashSize-1))!=0
+		|| header->stringsSize==0 || fileSize!=expectedSize || data[fileSize-1]!='\0')
+	{
+		close();
+		return false;
+	}
+	records = (const Record*)(data+sizeof(Header));
+	hashTable = (const quint32*)(records+header->nbLocations);
+	strings = (const char*)(hashTable+header->hashSize);
+	return true;
+}
+
+void StelLocationDB::close()
+{
+	if (header && buffer.isEmpty())
+		file.unmap((uchar*)header);
+	buffer.clear();
+	file.close();
+	header = NULL;
+	records = NULL;
+	hashTable = NULL;
+	strings = NULL;
+}
+
+int StelLocationDB::size() const
+{
+	return header ? header->nbLocations : 0;
+}
+
+StelLocation StelLocationDB::at(int i) const
+{
+	Q_ASSERT(i>=0 && i<size());
+	const Record& r = records[i];
+	StelLocation loc;
+	loc.name = QString::fromUtf8(string(r.name));
+	loc.state = QString::fromUtf8(string(r.state));
+	loc.country = QString::fromUtf8(string(r.country));
+	loc.planetName = QString::fromUtf8(string(r.planetName));
+	loc.landscapeKey = QString::fromUtf8(string(r.landscapeKey));
+	loc.longitude = r.longitude;
+	loc.latitude = r.latitude;
+	loc.altitude = r.altitude;
+	loc.bortleScaleIndex = r.bortleScaleIndex;
+	loc.population = r.population;
+	loc.role = QChar(r.role);
+	loc.isUserLocation = false;
+	return loc;
+}
+
+QString StelLocationDB::idAt(int i) const
+{
+	return at(i).getID();
+}
+
+int StelLocationDB::indexOf(const QString& id) const
+{
+	if (!header)
+		return -1;
+	const quint32 mask = header->hashSize-1;
+	for (quint32 h=hashId(id.toUtf8()) & mask;hashTable[h]!=0;h=(h+1) & mask)
+	{
+		const int i = hashTable[h]-1;
+		if (idAt(i)==id)
+			return i;
+	}
+	return -1;
+}
+
+int StelLocationDB::nearest(const QString& planetName, float longitude, float latitude, float* distance) const
+{
+	float v[3];
+	toUnitVector(longitude, latitude, v);
+	int best = -1;
+	// Squared chord length, at most 4 between 2 unit vectors
+	float bestDistance = 5.f;
+	nearest(0, size(), 0, planetName.toUtf8().constData(), v, best, bestDistance);
+	if (distance && best>=0)
+		*distance = 2.*std::asin(qMin(1.f, 0.5f*std::sqrt(bestDistance)))*180./M_PI;
+	return best;
+}
+
+void StelLocationDB::nearest(int begin, int end, int axis, const char* planetName, const float v[3], int& best, float& bestDistance) const
+{
+	if (begin>=end)
+		return;
+	const int mid = (begin+end)/2;
+	const Record& r = records[mid];
+	const float dx = v[0]-r.v[0];
+	const float dy = v[1]-r.v[1];
+	const float dz = v[2]-r.v[2];
+	const float d = dx*dx+dy*dy+dz*dz;
+	if (d<bestDistance && qstrcmp(string(r.planetName), planetName)==0)
+	{
+		best = mid;
+		bestDistance = d;
+	}
+	// Search first the half containing the position, then the other one if it can be closer
+	const float diff = v[axis]-r.v[axis];
+	const int next = (axis+1)%3;
+	if (diff<0)
+	{
+		nearest(begin, mid, next, planetName, v, best, bestDistance);
+		if (diff*diff<bestDistance)
+			nearest(mid+1, end, next, planetName, v, best, bestDistance);
+	}
+	else
+	{
+		nearest(mid+1, end, next, planetName, v, best, bestDistance);
+		if (diff*diff<bestDistance)
+			nearest(begin, mid, next, planetName, v, best, bestDistance);
+	}
+}
@@ -0,0 +1,94 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELLOCATIONDB_HPP_
+#define _STELLOCATIONDB_HPP_
+
+#include "StelLocation.hpp"
+
+#include <QByteArray>
+#include <QFile>
+#include <QMap>
+#include <QString>
+
+//! @class StelLocationDB
+//! Read only list of locations stored in a flat binary file, which is mapped in memory.
+//! The locations are only converted to StelLocation when they are requested, so that opening the
+//! file costs nothing more than mapping it.
+//!
+//! The file is made of:
+//! - a header with a version number, and the size and date of the text file it was created from;
+//! - the location records, in the order of a balanced k-d tree over the unit vectors of their positions;
+//! - an open addressing hash table of the record indexes, with the location IDs as keys;
+//! - a pool of the null terminated UTF-8 strings used by the records, each string being stored once.
+//!
+//! The file uses the byte order of the machine which writes it. It is meant to be created on the
+//! device from the text file, and it is rejected if it was written with another byte order.
+class StelLocationDB
+{
+public:
+	StelLocationDB();
+	~StelLocationDB();
+
+	//! Write the locations to a database file.
+	//! @param sourceSize, sourceModified the size of the text file the locations come from, and its
+	//! modification date in ms since epoch. They are checked by open().
+	static bool write(const QString& path, const QMap<QString, StelLocation>& locations, qint64 sourceSize, qint64 sourceModified);
+
+	//! Open a database file.
+	//! @return false if the file is missing, has an unknown version, or was not created from a
+	//! text file of the given size and modification date.
+	bool open(const QString& path, qint64 sourceSize, qint64 sourceModified);
+	void close();
+	bool isOpen() const {return header!=NULL;}
+
+	//! Get the number of locations.
+	int size() const;
+	//! Get a location by index, in [0, size()[.
+	StelLocation at(int i) const;
+	//! Get the ID of a location, as returned by StelLocation::getID().
+	QString idAt(int i) const;
+	//! Get the index of the location with the given ID, or -1.
+	int indexOf(const QString& id) const;
+	//! Get the index of the location nearest to the given position on a planet, or -1 if there is no
+	//! location on this planet.
+	//! @param distance if not NULL, receives the angular distance to the location in degrees.
+	int nearest(const QString& planetName, float longitude, float latitude, float* distance=NULL) const;
+
+	//! Version of the file format.
+	static const quint32 Version = 1;
+
+private:
+	struct Header;
+	struct Record;
+
+	const char* string(quint32 offset) const {return strings+offset;}
+	static void toUnitVector(float longitude, float latitude, float v[3]);
+	void nearest(int begin, int end, int axis, const char* planetName, const float v[3], int& best, float& bestDistance) const;
+
+	QFile file;
+	//! Copy of the file, used when it cannot be mapped.
+	QByteArray buffer;
+	const Header* header;
+	const Record* records;
+	const quint32* hashTable;
+	const char* strings;
+};
+
+#endif // _STELLOCATIONDB_HPP_
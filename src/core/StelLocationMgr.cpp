@@ -22,72 +22,43 @@
 #include "StelUtils.hpp"
 
 #include <QStringListModel>
-#include <QDataStream>
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QDir>
+#include <QDateTime>
 
-StelLocationMgr::StelLocationMgr()
+StelLocationMgr::StelLocationMgr() : modelAllLocation(NULL)
 {
 	qRegisterMetaType<StelLocation>("StelLocation");
-	// The line below allows to re-generate the location file, you still need to gunzip it manually afterward.
-    // generateBinaryLocationFile("data/base_locations.txt", false, "data/base_locations.bin");
-
-#ifdef Q_OS_ANDROID
-	// The .gz is removed in the assets to avoid double compression.
-    // Modified: loadCitiesBin won't work properly, resort to loadCities (Cheng Xinlun, Feb 20, 2017)
-    locations = loadCities("data/base_locations.txt", true);
-#else
-	locations = loadCitiesBin("data/base_locations.bin.gz");
-#endif
+
+	if (!openBaseLocations("data/base_locations.txt"))
+		locations = loadCities("data/base_locations.txt", false);
 	locations.unite(loadCities("data/user_locations.txt", true));
 
-	modelAllLocation = new QStringListModel(this);
-	modelAllLocation->setStringList(locations.keys());
-	
 	// Init to Paris France because it's the center of the world.
 	lastResortLocation = locationForString("Paris, France");
 }
 
-void StelLocationMgr::generateBinaryLocationFile(const QString& fileName, bool isUserLocation, const QString& binFilePath) const
-{
-	const QMap<QString, StelLocation>& cities = loadCities(fileName, isUserLocation);
-	QFile binfile(binFilePath);
-	binfile.open(QIODevice::WriteOnly);
-	QDataStream out(&binfile);
-	out.setVersion(QDataStream::Qt_4_6);
-	out << cities;
-	binfile.close();
-}
-
-QMap<QString, StelLocation> StelLocationMgr::loadCitiesBin(const QString& fileName) const
+bool StelLocationMgr::openBaseLocations(const QString& fileName)
 {
-	QMap<QString, StelLocation> res;
-	QString cityDataPath = StelFileMgr::findFile(fileName);
+	const QString cityDataPath = StelFileMgr::findFile(fileName);
 	if (cityDataPath.isEmpty())
-		return res;
-
-	QFile sourcefile(cityDataPath);
-	if (!sourcefile.open(QIODevice::ReadOnly))
-	{
-		qWarning() << "ERROR: Could not open location data file: " << QDir::toNativeSeparators(cityDataPath);
-		return res;
-	}
+		return false;
 
-	if (fileName.endsWith(".gz"))
-	{
-		QDataStream in(StelUtils::uncompress(sourcefile.readAll()));
-		in.setVersion(QDataStream::Qt_4_6);
-		in >> res;
-		return res;
-	}
-	else
-	{
-		QDataStream in(&sourcefile);
-		in.setVersion(QDataStream::Qt_4_6);
-		in >> res;
-		return res;
-	}
+	// The database is created in the cache the first time, and again when the text file changes
+	const QFileInfo info(cityDataPath);
+	const qint64 modified = info.lastModified().isValid() ? info.lastModified().toMSecsSinceEpoch() : 0;
+	const QString cacheDir = StelFileMgr::getCacheDir();
+	const QString dbPath = cacheDir + "/base_locations.db";
+	if (baseLocations.open(dbPath, info.size(), modified))
+		return true;
+
+	qDebug() << "Creating location database" << QDir::toNativeSeparators(dbPath);
+	QDir().mkpath(cacheDir);
+	if (!StelLocationDB::write(dbPath, loadCities(fileName, false), info.size(), modified))
+		return false;
+	return baseLocations.open(dbPath, info.size(), modified);
 }
 
 QMap<QString, StelLocation> StelLocationMgr::loadCities(const QString& fileName, bool isUserLocation) const
@@ -172,6 +143,35 @@ static float parseAngle(const QString& s, bool* ok)
 	return 0;
 }
 
+QStringListModel* StelLocationMgr::getModelAll()
+{
+	if (!modelAllLocation)
+	{
+		modelAllLocation = new QStringListModel(this);
+		modelAllLocation->setStringList(getAllIDs());
+	}
+	return modelAllLocation;
+}
+
+QList<StelLocation> StelLocationMgr::getAll() const
+{
+	QList<StelLocation> ret = locations.values();
+	ret.reserve(ret.size()+baseLocations.size());
+	for (int i=0;i<baseLocations.size();++i)
+		ret.append(baseLocations.at(i));
+	return ret;
+}
+
+QStringList StelLocationMgr::getAllIDs() const
+{
+	QStringList ret = locations.keys();
+	ret.reserve(ret.size()+baseLocations.size());
+	for (int i=0;i<baseLocations.size();++i)
+		ret.append(baseLocations.idAt(i));
+	ret.sort();
+	return ret;
+}
+
 const StelLocation StelLocationMgr::locationForString(const QString& s) const
 {
 	QMap<QString, StelLocation>::const_iterator iter = locations.find(s);
@@ -179,6 +179,11 @@ const StelLocation StelLocationMgr::locationForString(const QString& s) const
 	{
 		return iter.value();
 	}
+	const int index = baseLocations.indexOf(s);
+	if (index>=0)
+	{
+		return baseLocations.at(index);
+	}
 	StelLocation ret;
 	// Maybe it is a coordinate set ? (e.g. GPS 25.107363,121.558807 )
 	QRegExp reg("(?:(.+)\\s+)?(.+),(.+)");
@@ -198,10 +203,46 @@ const StelLocation StelLocationMgr::locationForString(const QString& s) const
 	return ret;
 }
 
+const StelLocation StelLocationMgr::locationNearest(const QString& planetName, float longitude, float latitude, float maxDistance) const
+{
+	StelLocation ret;
+	float distance;
+	const int index = baseLocations.nearest(planetName, longitude, latitude, &distance);
+	if (index>=0 && distance<=maxDistance)
+	{
+		ret = baseLocations.at(index);
+		maxDistance = distance;
+	}
+	else
+	{
+		ret.role = '!';
+	}
+
+	// The user locations are few
+	Vec3d v, w;
+	StelUtils::spheToRect(longitude*M_PI/180., latitude*M_PI/180., v);
+	const double cosMaxDistance = std::cos(maxDistance*M_PI/180.);
+	double bestCos = -2.;
+	for (QMap<QString, StelLocation>::const_iterator iter=locations.constBegin();iter!=locations.constEnd();++iter)
+	{
+		const StelLocation& loc = iter.value();
+		if (loc.planetName!=planetName)
+			continue;
+		StelUtils::spheToRect(loc.longitude*M_PI/180., loc.latitude*M_PI/180., w);
+		const double c = v*w;
+		if (c>=cosMaxDistance && c>bestCos)
+		{
+			bestCos = c;
+			ret = loc;
+		}
+	}
+	return ret;
+}
+
 // Get whether a location can be permanently added to the list of user locations
 bool StelLocationMgr::canSaveUserLocation(const StelLocation& loc) const
 {
-	return loc.isValid() && locations.find(loc.getID())==locations.end();
+	return loc.isValid() && locations.find(loc.getID())==locations.end() && baseLocations.indexOf(loc.getID())<0;
 }
 
 // Add permanently a location to the list of user locations
@@ -214,7 +255,8 @@ bool StelLocationMgr::saveUserLocation(const StelLocation& loc)
 	locations[loc.getID()]=loc;
 
 	// Append in the Qt model
-	modelAllLocation->setStringList(locations.keys());
+	if (modelAllLocation)
+		modelAllLocation->setStringList(getAllIDs());
 
 	// Append to the user location file
 	QString cityDataPath = StelFileMgr::findFile("data/user_locations.txt", StelFileMgr::Flags(StelFileMgr::Writable|StelFileMgr::File));
@@ -271,7 +313,8 @@ bool StelLocationMgr::deleteUserLocation(const QString& id)
 
 	locations.remove(id);
 	// Remove in the Qt model file
-	modelAllLocation->setStringList(locations.keys());
+	if (modelAllLocation)
+		modelAllLocation->setStringList(getAllIDs());
 
 	// Resave the whole remaining user locations file
 	QString cityDataPath = StelFileMgr::findFile("data/user_locations.txt", StelFileMgr::Writable);
@@ -20,10 +20,12 @@
 #define _STELLOCATIONMGR_HPP_
 
 #include "StelLocation.hpp"
+#include "StelLocationDB.hpp"
 #include <QString>
 #include <QObject>
 #include <QMetaType>
 #include <QMap>
+#include <QStringList>
 
 class QStringListModel;
 
@@ -40,15 +42,20 @@ public:
 	~StelLocationMgr();
 
 	//! Return the model containing all the city
-	QStringListModel* getModelAll() {return modelAllLocation;}
+	QStringListModel* getModelAll();
 
 	//! Return the list of all loaded locations
-	QList<StelLocation> getAll() const {return locations.values();}
+	QList<StelLocation> getAll() const;
 
 	//! Return the StelLocation for a given string
 	//! Can match location name, or coordinates
 	const StelLocation locationForString(const QString& s) const;
 
+	//! Return the location nearest to the given position on a planet.
+	//! @param maxDistance the maximum angular distance to the location in degrees.
+	//! @return an invalid location if there is no location within maxDistance.
+	const StelLocation locationNearest(const QString& planetName, float longitude, float latitude, float maxDistance=180.f) const;
+
 	//! Return a valid location when no valid one was found.
 	const StelLocation& getLastResortLocation() const {return lastResortLocation;}
 	
@@ -71,16 +78,23 @@ public:
 	bool deleteUserLocation(const QString& id);
 
 private:
-	void generateBinaryLocationFile(const QString& txtFile, bool isUserLocation, const QString& binFile) const;
+	//! Open the database made from the base locations file, creating it first if it is missing or outdated.
+	//! @return false if the database could not be created.
+	bool openBaseLocations(const QString& fileName);
 
 	//! Load cities from a file
 	QMap<QString, StelLocation> loadCities(const QString& fileName, bool isUserLocation) const;
-	QMap<QString, StelLocation> loadCitiesBin(const QString& fileName) const;
 
-	//! Model containing all the city information
+	//! Return the IDs of all the locations, sorted.
+	QStringList getAllIDs() const;
+
+	//! Model containing all the city information, created on first use
 	QStringListModel* modelAllLocation;
 
-	//! The list of all loaded locations
+	//! The base locations
+	StelLocationDB baseLocations;
+
+	//! The user locations, and the base locations if their database could not be created
 	QMap<QString, StelLocation> locations;
 	
 	StelLocation lastResortLocation;
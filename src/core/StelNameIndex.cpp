@@ -0,0 +1,117 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelNameIndex.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	//! Order entries by their key.
+	struct EntryLessThan
+	{
+		EntryLessThan(const QStringList& keys) : keys(keys) {}
+		template<class Entry> QStringRef key(const Entry& e) const
+		{
+			return QStringRef(&keys.at(e.key), e.offset, keys.at(e.key).size()-e.offset);
+		}
+		template<class Entry> bool operator()(const Entry& a, const Entry& b) const
+		{
+			return QStringRef::compare(key(a), key(b))<0;
+		}
+		template<class Entry> bool operator()(const Entry& a, const QString& b) const
+		{
+			return QStringRef::compare(key(a), b)<0;
+		}
+		const QStringList& keys;
+	};
+
+	//! Collect the names not found yet.
+	struct ListNamesFuncObject
+	{
+		ListNamesFuncObject(QStringList& result, int maxNbItem) : result(result), maxNbItem(maxNbItem) {}
+		bool operator()(const QString& name, int)
+		{
+			if (!result.contains(name))
+				result << name;
+			return result.size()<maxNbItem;
+		}
+		QStringList& result;
+		const int maxNbItem;
+	};
+}
+
+void StelNameIndex::clear()
+{
+	keys.clear();
+	names.clear();
+	items.clear();
+	keyEntries.clear();
+	wordEntries.clear();
+}
+
+void StelNameIndex::insert(const QString& key, const QString& name, KeyType type, int item)
+{
+	const QString k = key.toUpper();
+	if (k.isEmpty())
+		return;
+	const int i = keys.size();
+	keys << k;
+	names << name;
+	items << item;
+	Entry e;
+	e.key = i;
+	e.offset = 0;
+	keyEntries << e;
+	wordEntries << e;
+	if (type!=Name)
+		return;
+	// A word starts with a letter or a digit following another character
+	for (int j=1;j<k.size();++j)
+	{
+		if (k.at(j).isLetterOrNumber() && !k.at(j-1).isLetterOrNumber())
+		{
+			e.offset = j;
+			wordEntries << e;
+		}
+	}
+}
+
+void StelNameIndex::build()
+{
+	const EntryLessThan lessThan(keys);
+	std::sort(keyEntries.begin(), keyEntries.end(), lessThan);
+	std::sort(wordEntries.begin(), wordEntries.end(), lessThan);
+}
+
+QVector<StelNameIndex::Entry>::const_iterator StelNameIndex::lowerBound(const QVector<Entry>& entries, const QString& prefix) const
+{
+	return std::lower_bound(entries.constBegin(), entries.constEnd(), prefix, EntryLessThan(keys));
+}
+
+QStringList StelNameIndex::listMatching(const QString& prefix, int maxNbItem, bool wordStarts) const
+{
+	QStringList result;
+	if (maxNbItem<=0)
+		return result;
+	ListNamesFuncObject func(result, maxNbItem);
+	processMatching(prefix.toUpper(), wordStarts, func);
+	return result;
+}
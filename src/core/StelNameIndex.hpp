@@ -0,0 +1,104 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef _STELNAMEINDEX_HPP_
+#define _STELNAMEINDEX_HPP_
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+//! @class StelNameIndex
+//! Sorted index of object names for auto-completion.
+//! Each name is stored with an uppercase key, which is either the name itself
+//! or another string finding it (e.g. the English name of an object whose
+//! translated name is shown). Searching for a prefix is a binary search in
+//! sorted arrays of references to the keys, so that it does not depend on the
+//! number of names and does not convert or compare any other string.
+//! Keys of type Name can also be found by the start of each of their words,
+//! keys of type Designation (catalog numbers) only by their start.
+//! The index is filled with clear(), insert() and build(), usually when the
+//! objects are loaded or translated.
+class StelNameIndex
+{
+public:
+	enum KeyType
+	{
+		Name,		//!< Found by its start and by the start of its words
+		Designation	//!< Only found by its start
+	};
+
+	//! Remove all the names.
+	void clear();
+	//! Add a name. It can only be found after the next call to build().
+	//! @param key the string found by the search, any case.
+	//! @param name the name returned by the search.
+	//! @param type how the key can be found.
+	//! @param item an integer passed back by processMatching(), e.g. the index of the object.
+	void insert(const QString& key, const QString& name, KeyType type=Name, int item=-1);
+	//! Sort the keys inserted since the last clear().
+	void build();
+	//! Get the number of names.
+	int size() const {return names.size();}
+
+	//! Process the names whose key, or a word of the key when wordStarts is true,
+	//! starts with prefix, in alphabetical order of the matched keys.
+	//! The function object is called as func(name, item) and returns false to stop.
+	//! A name may be processed several times when several of its words match.
+	//! @param prefix the searched prefix, in uppercase.
+	template<class FuncObject> void processMatching(const QString& prefix, bool wordStarts, FuncObject& func) const
+	{
+		const QVector<Entry>& entries = wordStarts ? wordEntries : keyEntries;
+		for (QVector<Entry>::const_iterator it=lowerBound(entries, prefix);it!=entries.constEnd();++it)
+		{
+			if (!getKey(*it).startsWith(prefix))
+				return;
+			if (!func(names.at(it->key), items.at(it->key)))
+				return;
+		}
+	}
+
+	//! Return at most maxNbItem different names matching the prefix, see processMatching().
+	//! @param prefix the searched prefix, any case.
+	QStringList listMatching(const QString& prefix, int maxNbItem, bool wordStarts) const;
+
+private:
+	//! Reference to a key, or to a word of a key.
+	struct Entry
+	{
+		int key;
+		int offset;
+	};
+
+	QStringRef getKey(const Entry& e) const {return QStringRef(&keys.at(e.key), e.offset, keys.at(e.key).size()-e.offset);}
+	//! Return the first entry not lesser than prefix.
+	QVector<Entry>::const_iterator lowerBound(const QVector<Entry>& entries, const QString& prefix) const;
+
+	//! Uppercase keys.
+	QStringList keys;
+	QStringList names;
+	QVector<int> items;
+	//! Whole keys, sorted.
+	QVector<Entry> keyEntries;
+	//! Whole keys and words of the Name keys, sorted.
+	QVector<Entry> wordEntries;
+};
+
+#endif // _STELNAMEINDEX_HPP_
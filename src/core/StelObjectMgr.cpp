@@ -28,6 +28,8 @@
 #include "RefractionExtinction.hpp"
 #include "StelSkyDrawer.hpp"
 
+#include <cmath>
+
 #include <QMouseEvent>
 #include <QString>
 #include <QDebug>
@@ -117,53 +119,65 @@ bool StelObjectMgr::findAndSelect(const StelCore* core, int x, int y, StelModule
 	return setSelectedObject(tempselect, action);
 }
 
+namespace
+{
+	//! Keep the candidate minimizing distance (in pixel) + priority.
+	class PickObjectVisitor : public StelObjectVisitor
+	{
+	public:
+		PickObjectVisitor(const StelCore* core, const StelProjectorP& prj, const Vec3d& v, float limitMag, float distanceWeight)
+			: core(core), prj(prj), limitMag(limitMag), distanceWeight(distanceWeight), bestValue(100000.f)
+		{
+			prj->project(v, winpos);
+			xpos = winpos[0];
+			ypos = winpos[1];
+		}
+
+		virtual bool visit(const StelObjectP& obj)
+		{
+			// The distance is positive, so objects fainter than the best value
+			// can be rejected before projecting them.
+			const float priority = obj->getSelectPriority(core);
+			if (priority>limitMag || priority>=bestValue)
+				return true;
+			prj->project(obj->getJ2000EquatorialPos(core), winpos);
+			const float distance = std::sqrt((xpos-winpos[0])*(xpos-winpos[0]) + (ypos-winpos[1])*(ypos-winpos[1]))*distanceWeight;
+			if (distance + priority < bestValue)
+			{
+				bestValue = distance + priority;
+				best = obj;
+			}
+			return true;
+		}
+
+		StelObjectP best;
+
+	private:
+		const StelCore* core;
+		const StelProjectorP& prj;
+		const float limitMag;
+		const float distanceWeight;
+		float bestValue;
+		float xpos, ypos;
+		Vec3d winpos;
+	};
+}
+
 // Find an object in a "clever" way, v in J2000 frame
 StelObjectP StelObjectMgr::cleverFind(const StelCore* core, const Vec3d& v) const
 {
-	StelObjectP sobj;
-	QList<StelObjectP> candidates;
-
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 
 	// Field of view for a searchRadiusPixel pixel diameter circle on screen
 	float fov_around = core->getMovementMgr()->getCurrentFov()/qMin(prj->getViewportWidth(), prj->getViewportHeight()) * prj->getDevicePixelsPerPixel() * searchRadiusPixel;
 
-	// Collect the objects inside the range
+	// Select among the objects inside the range the object minimizing
+	// the function y = distance(in pixel) + magnitude
+	PickObjectVisitor visitor(core, prj, v, core->getSkyDrawer()->getLimitMagnitude()-2.f, distanceWeight);
 	foreach (const StelObjectModule* m, objectsModule)
-		candidates += m->searchAround(v, fov_around, core);
-
-	float limitMag = core->getSkyDrawer()->getLimitMagnitude()-2.f;
-	QList<StelObjectP> tmp;
-	foreach (const StelObjectP& obj, candidates)
-	{
-		if (obj->getSelectPriority(core)<=limitMag)
-			tmp.append(obj);
-	}
-	
-	candidates = tmp;
-	
-	// Now select the object minimizing the function y = distance(in pixel) + magnitude
-	Vec3d winpos;
-	prj->project(v, winpos);
-	float xpos = winpos[0];
-	float ypos = winpos[1];
-
-	float best_object_value;
-	best_object_value = 100000.f;
-	foreach (const StelObjectP& obj, candidates)
-	{
-		prj->project(obj->getJ2000EquatorialPos(core), winpos);
-		float distance = sqrt((xpos-winpos[0])*(xpos-winpos[0]) + (ypos-winpos[1])*(ypos-winpos[1]))*distanceWeight;
-		float priority =  obj->getSelectPriority(core);
-		// qDebug() << (*iter).getShortInfoString(core) << ": " << priority << " " << distance;
-		if (distance + priority < best_object_value)
-		{
-			best_object_value = distance + priority;
-			sobj = obj;
-		}
-	}
+		m->visitAround(v, fov_around, core, visitor);
 
-	return sobj;
+	return visitor.best;
 }
 
 /*************************************************************************
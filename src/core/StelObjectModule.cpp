@@ -29,4 +29,13 @@ StelObjectModule::~StelObjectModule()
 {
 }
 
+void StelObjectModule::visitAround(const Vec3d& v, double limitFov, const StelCore* core, StelObjectVisitor& visitor) const
+{
+	foreach (const StelObjectP& obj, searchAround(v, limitFov, core))
+	{
+		if (!visitor.visit(obj))
+			return;
+	}
+}
+
 
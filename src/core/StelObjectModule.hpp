@@ -27,6 +27,26 @@
 #include "StelObjectType.hpp"
 #include "VecMath.hpp"
 
+//! @class StelObjectVisitor
+//! Receives the objects found by StelObjectModule::visitAround().
+class StelObjectVisitor
+{
+public:
+	virtual ~StelObjectVisitor() {}
+	//! Called for each object found.
+	//! @return false to stop the search.
+	virtual bool visit(const StelObjectP& obj) = 0;
+};
+
+//! @class StelObjectListVisitor
+//! Visitor collecting all the objects in a list, for implementing searchAround() with visitAround().
+class StelObjectListVisitor : public StelObjectVisitor
+{
+public:
+	virtual bool visit(const StelObjectP& obj) {result.append(obj); return true;}
+	QList<StelObjectP> result;
+};
+
 //! @class StelObjectModule
 //! Specialization of StelModule which manages a collection of StelObject.
 //! Instances deriving from the StelObjectModule class can be managed by the StelObjectMgr.
@@ -45,6 +65,16 @@ public:
 	//! @param core the core instance to use.
 	//! @return the list of all the displayed objects contained in the defined zone.
 	virtual QList<StelObjectP> searchAround(const Vec3d& v, double limitFov, const StelCore* core) const = 0;
+
+	//! Pass the objects which searchAround() would return to a visitor, until it stops the search.
+	//! Unlike searchAround(), no list is built, so that picking an object does not allocate
+	//! memory for all the candidates. Modules with many objects should reimplement it with
+	//! a spatial index. The default implementation calls searchAround().
+	//! @param v equatorial position at epoch J2000.
+	//! @param limitFov same as for searchAround().
+	//! @param core the core instance to use.
+	//! @param visitor the visitor called for each object found.
+	virtual void visitAround(const Vec3d& v, double limitFov, const StelCore* core, StelObjectVisitor& visitor) const;
 	
 	//! Find a StelObject by name.
 	//! @param nameI18n The translated name for the current sky locale.
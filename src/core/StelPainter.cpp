@@ -20,11 +20,14 @@
 #include "StelPainter.hpp"
 
 #include "StelApp.hpp"
+#include "StelGlyphAtlas.hpp"
 #include "StelLocaleMgr.hpp"
+#include "StelProfiler.hpp"
 #include "StelProjector.hpp"
 #include "StelProjectorClasses.hpp"
 #include "StelUtils.hpp"
 
+#include <QCache>
 #include <QDebug>
 #include <QString>
 #include <QSettings>
@@ -33,91 +36,14 @@
 #include <QMutex>
 #include <QVarLengthArray>
 #include <QPaintEngine>
-#include <QCache>
 #include <QOpenGLPaintDevice>
 #include <QOpenGLShader>
-#include <QOpenGLTexture>
-#include <QtEndian>
-
-// QOpenGLTexture has a bug on android, this is a temporary fix using a very simple
-// minimal implemetation of it.
-#if defined Q_OS_ANDROID || defined Q_OS_IOS
-#define QOpenGLTexture OpenGLTexture
-
-static QByteArray convertToGLFormat(const QImage& image)
-{
-    QByteArray ret;
-    const int width = image.width();
-    const int height = image.height();
-    int bpp = 4;
-    ret.reserve(width * height * bpp);
-    QImage tmp = image.convertToFormat(QImage::Format_ARGB32);
-
-    for (int i = 0; i < height; ++i)
-    {
-        uint *p = (uint *) tmp.scanLine(i);
-        for (int x = 0; x < width; ++x)
-        {
-            uint c = qToBigEndian(p[x]);
-            const char* ptr = (const char*)&c;
-            ret.append(ptr + 1, 3);
-            ret.append(ptr, 1);
-        }
-    }
-    return ret;
-}
-
-class OpenGLTexture
-{
-public:
-    OpenGLTexture(const QImage& img);
-    ~OpenGLTexture();
-    void bind();
-    void release();
-    int width() const {return m_width;}
-    int height() const {return m_height;}
-private:
-    GLuint id;
-    int m_width;
-    int m_height;
-};
-
-OpenGLTexture::OpenGLTexture(const QImage& img) : id(0)
-{
-    m_width = img.width();
-    m_height = img.height();
-    QByteArray data = convertToGLFormat(img);
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA,
-                 GL_UNSIGNED_BYTE, data.constData());
-}
-
-OpenGLTexture::~OpenGLTexture()
-{
-    if (id)
-        glDeleteTextures(1, &id);
-}
-
-void OpenGLTexture::bind()
-{
-    glBindTexture(GL_TEXTURE_2D, id);
-}
-
-void OpenGLTexture::release()
-{
-}
-
-
-#endif // End of the fix for android.
-
-static const int TEX_CACHE_LIMIT = 7000000;
 
 #ifndef NDEBUG
 QMutex* StelPainter::globalMutex = new QMutex();
 #endif
 
-QCache<QByteArray, StringTexture> StelPainter::texCache(TEX_CACHE_LIMIT);
+StelGlyphAtlas* StelPainter::glyphAtlas=NULL;
 QOpenGLShaderProgram* StelPainter::texturesShaderProgram=NULL;
 QOpenGLShaderProgram* StelPainter::basicShaderProgram=NULL;
 QOpenGLShaderProgram* StelPainter::colorShaderProgram=NULL;
@@ -192,7 +118,9 @@ StelPainter::StelPainter(const StelProjectorP& proj) : prj(proj)
 
 void StelPainter::setProjector(const StelProjectorP& p)
 {
+    drawQueuedText();
     prj=p;
+    textFontKey.clear();
     // Init GL viewport to current projector values
     glViewport(prj->viewportXywh[0], prj->viewportXywh[1], prj->viewportXywh[2], prj->viewportXywh[3]);
     glFrontFace(prj->needGlFrontFaceCW()?GL_CW:GL_CCW);
@@ -200,6 +128,8 @@ void StelPainter::setProjector(const StelProjectorP& p)
 
 StelPainter::~StelPainter()
 {
+    drawQueuedText();
+
 #ifndef NDEBUG
     GLenum er = glGetError();
     if (er!=GL_NO_ERROR)
@@ -219,6 +149,7 @@ StelPainter::~StelPainter()
 void StelPainter::setFont(const QFont& font)
 {
     currentFont = font;
+    textFontKey.clear();
 }
 
 void StelPainter::setColor(float r, float g, float b, float a)
@@ -560,90 +491,124 @@ void StelPainter::sRing(float rMin, float rMax, int slices, int stacks, int orie
     }
 }
 
-static void sSphereMapTexCoordFast(float rho_div_fov, float costheta, float sintheta, QVector<float>& out)
+static void sSphereMapTexCoordFast(float rho_div_fov, float costheta, float sintheta, Vec2f& out)
 {
     if (rho_div_fov>0.5f)
         rho_div_fov=0.5f;
-    out << 0.5f + rho_div_fov * costheta << 0.5f + rho_div_fov * sintheta;
+    out.set(0.5f + rho_div_fov * costheta, 0.5f + rho_div_fov * sintheta);
 }
 
-void StelPainter::sSphereMap(float radius, int slices, int stacks, float textureFov, int orientInside)
+// Generate the mesh drawn by sSphereMap(). Unlike sSphere(), the rows of vertices are shared by the stacks above and below them.
+static StelVertexArray computeSphereMap(float radius, int slices, int stacks, float textureFov, int orientInside)
 {
-    float rho,x,y,z;
-    int i, j;
-    float drho = M_PI / stacks;
+    StelVertexArray result(StelVertexArray::Triangles);
+    const float drho = M_PI / stacks;
     Q_ASSERT(stacks<=MAX_STACKS);
     ComputeCosSinRho(drho,stacks);
-    float* cos_sin_rho_p;
-
     const float dtheta = 2.f * M_PI / slices;
     Q_ASSERT(slices<=MAX_SLICES);
-
     ComputeCosSinTheta(dtheta,slices);
-    float* cos_sin_theta_p;
-
-    drho/=textureFov;
+    Q_ASSERT((stacks+1)*(slices+1)<=65536);
 
     // texturing: s goes from 0.0/0.25/0.5/0.75/1.0 at +y/+x/-y/-x/+y axis
     // t goes from -1.0/+1.0 at z = -radius/+radius (linear along longitudes)
-    // cannot use triangle fan on texturing (s coord. at top/bottom tip varies)
-
-    const int imax = stacks;
-
-    static QVector<double> vertexArr;
-    static QVector<float> texCoordArr;
+    // from inside the texture is mirrored
+    const float tsign = orientInside ? -1.f : 1.f;
+    result.vertex.resize((stacks+1)*(slices+1));
+    result.texCoords.resize((stacks+1)*(slices+1));
+    Vec3d* vertex = result.vertex.data();
+    Vec2f* texCoord = result.texCoords.data();
+    const float* cos_sin_rho_p = cos_sin_rho;
+    for (int i = 0; i <= stacks; ++i,cos_sin_rho_p+=2)
+    {
+        const float rho = i*drho/textureFov;
+        const float* cos_sin_theta_p = cos_sin_theta;
+        for (int j = 0; j <= slices; ++j,cos_sin_theta_p+=2)
+        {
+            vertex->set(-cos_sin_theta_p[1] * cos_sin_rho_p[1] * radius, cos_sin_theta_p[0] * cos_sin_rho_p[1] * radius, cos_sin_rho_p[0] * radius);
+            sSphereMapTexCoordFast(rho, cos_sin_theta_p[0], tsign*cos_sin_theta_p[1], *texCoord);
+            ++vertex;
+            ++texCoord;
+        }
+    }
 
-    // draw intermediate stacks as quad strips
-    if (!orientInside) // nsign==1
+    // Same triangles as the former strips of one stack, with the same orientation
+    for (int i = 0; i < stacks; ++i)
     {
-        for (i = 0,cos_sin_rho_p=cos_sin_rho,rho=0.f; i < imax; ++i,cos_sin_rho_p+=2,rho+=drho)
+        const unsigned short top = i*(slices+1);
+        const unsigned short bottom = top+slices+1;
+        for (int j = 0; j < slices; ++j)
         {
-            vertexArr.resize(0);
-            texCoordArr.resize(0);
-            for (j=0,cos_sin_theta_p=cos_sin_theta;j<=slices;++j,cos_sin_theta_p+=2)
+            if (!orientInside)
             {
-                x = -cos_sin_theta_p[1] * cos_sin_rho_p[1];
-                y = cos_sin_theta_p[0] * cos_sin_rho_p[1];
-                z = cos_sin_rho_p[0];
-                sSphereMapTexCoordFast(rho, cos_sin_theta_p[0], cos_sin_theta_p[1], texCoordArr);
-                vertexArr << x*radius << y*radius << z*radius;
-
-                x = -cos_sin_theta_p[1] * cos_sin_rho_p[3];
-                y = cos_sin_theta_p[0] * cos_sin_rho_p[3];
-                z = cos_sin_rho_p[2];
-                sSphereMapTexCoordFast(rho + drho, cos_sin_theta_p[0], cos_sin_theta_p[1], texCoordArr);
-                vertexArr << x*radius << y*radius << z*radius;
+                result.indices << top+j << bottom+j << top+j+1;
+                result.indices << top+j+1 << bottom+j << bottom+j+1;
+            }
+            else
+            {
+                result.indices << bottom+j << top+j << bottom+j+1;
+                result.indices << bottom+j+1 << top+j << top+j+1;
             }
-            setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData());
-            drawFromArray(TriangleStrip, vertexArr.size()/3);
         }
     }
-    else
+    return result;
+}
+
+namespace
+{
+    // Parameters of a sphere mesh
+    struct SphereMeshKey
     {
-        for (i = 0,cos_sin_rho_p=cos_sin_rho,rho=0.f; i < imax; ++i,cos_sin_rho_p+=2,rho+=drho)
+        enum Type {Sphere, SphereMap};
+        int type;
+        int slices;
+        int stacks;
+        int orientInside;
+        int flipTexture;
+        float radius;
+        float oneMinusOblateness;
+        float textureFov;
+
+        bool operator==(const SphereMeshKey& o) const
         {
-            vertexArr.resize(0);
-            texCoordArr.resize(0);
-            for (j=0,cos_sin_theta_p=cos_sin_theta;j<=slices;++j,cos_sin_theta_p+=2)
-            {
-                x = -cos_sin_theta_p[1] * cos_sin_rho_p[3];
-                y = cos_sin_theta_p[0] * cos_sin_rho_p[3];
-                z = cos_sin_rho_p[2];
-                sSphereMapTexCoordFast(rho + drho, cos_sin_theta_p[0], -cos_sin_theta_p[1], texCoordArr);
-                vertexArr << x*radius << y*radius << z*radius;
-
-                x = -cos_sin_theta_p[1] * cos_sin_rho_p[1];
-                y = cos_sin_theta_p[0] * cos_sin_rho_p[1];
-                z = cos_sin_rho_p[0];
-                sSphereMapTexCoordFast(rho, cos_sin_theta_p[0], -cos_sin_theta_p[1], texCoordArr);
-                vertexArr << x*radius << y*radius << z*radius;
-            }
-            setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData());
-            drawFromArray(TriangleStrip, vertexArr.size()/3);
+            return type==o.type && slices==o.slices && stacks==o.stacks && orientInside==o.orientInside && flipTexture==o.flipTexture
+                && radius==o.radius && oneMinusOblateness==o.oneMinusOblateness && textureFov==o.textureFov;
         }
+    };
+
+    uint qHash(const SphereMeshKey& k)
+    {
+        return ::qHash(k.type) ^ ::qHash(k.slices<<8) ^ ::qHash(k.stacks<<16) ^ ::qHash((k.orientInside<<1) | k.flipTexture)
+            ^ ::qHash(k.radius) ^ ::qHash(k.oneMinusOblateness) ^ ::qHash(k.textureFov);
     }
 }
 
+// Meshes drawn by sSphere() and sSphereMap(), with their number of vertices as cost.
+// A mesh has at most 65536 vertices because of the 16 bits indices, so it always fits.
+static QCache<SphereMeshKey, StelVertexArray> sphereMeshes(4*65536);
+
+// Get a sphere mesh from the cache, computing it if it is not there.
+static const StelVertexArray* getSphereMesh(const SphereMeshKey& key)
+{
+    StelVertexArray* mesh = sphereMeshes.object(key);
+    if (mesh)
+        return mesh;
+    if (key.type==SphereMeshKey::SphereMap)
+        mesh = new StelVertexArray(computeSphereMap(key.radius, key.slices, key.stacks, key.textureFov, key.orientInside));
+    else
+        mesh = new StelVertexArray(StelPainter::computeSphereNoLight(key.radius, key.oneMinusOblateness, key.slices, key.stacks, key.orientInside, key.flipTexture));
+    sphereMeshes.insert(key, mesh, mesh->vertex.size());
+    return mesh;
+}
+
+void StelPainter::sSphereMap(float radius, int slices, int stacks, float textureFov, int orientInside)
+{
+    const SphereMeshKey key = {SphereMeshKey::SphereMap, slices, stacks, orientInside, 0, radius, 1.f, textureFov};
+    const StelVertexArray* mesh = getSphereMesh(key);
+    setArrays(mesh->vertex.constData(), mesh->texCoords.constData());
+    drawFromArray(Triangles, mesh->indices.size(), 0, true, mesh->indices.constData());
+}
+
 void StelPainter::drawTextGravity180(float x, float y, const QString& ws, float xshift, float yshift)
 {
     float dx, dy, d, theta, psi;
@@ -699,47 +664,20 @@ void StelPainter::drawText(const Vec3d& v, const QString& str, float angleDeg, f
  Draw the string at the given position and angle with the given font
 *************************************************************************/
 
-// Container for one cached string texture
-struct StringTexture
-{
-    QOpenGLTexture* texture;
-    QSize size;
-    QSizeF getTexSize() const {
-        return QSizeF((float)size.width() / texture->width(),
-                      (float)size.height() / texture->height());
-    }
-
-    StringTexture(QOpenGLTexture* tex, const QSize& size) :
-         texture(tex), size(size) {}
-    ~StringTexture() {delete texture;}
-};
-
+// Text queued by drawText(), in window coordinates
+static QVector<Vec2f> textVertexArray;
+static QVector<Vec2f> textTexCoordArray;
+static QVector<Vec4f> textColorArray;
 
-StringTexture* StelPainter::getTexTexture(const QString& str, int pixelSize)
+const QFont& StelPainter::getTextFont()
 {
-    // Render first the text into a QPixmap, then create a QOpenGLTexture
-    // from it.  We could optimize by directly using a QImage, but for some
-    // reason the result is not exactly the same than with a QPixmap.
-    QByteArray hash = str.toUtf8() + QByteArray::number(pixelSize);
-    StringTexture* cachedTex = texCache.object(hash);
-    if (cachedTex)
-        return cachedTex;
-    QFont tmpFont = currentFont;
-    tmpFont.setPixelSize(currentFont.pixelSize()*prj->getDevicePixelsPerPixel()*StelApp::getInstance().getGlobalScalingRatio());
-    QRect strRect = QFontMetrics(tmpFont).boundingRect(str);
-    int w = strRect.width()+1+(int)(0.02f*strRect.width());
-    int h = strRect.height();
-
-    QPixmap strImage = QPixmap(StelUtils::getBiggerPowerOfTwo(w), StelUtils::getBiggerPowerOfTwo(h));
-    strImage.fill(Qt::transparent);
-    QPainter painter(&strImage);
-    painter.setFont(tmpFont);
-    painter.setRenderHints(QPainter::TextAntialiasing);
-    painter.setPen(Qt::white);
-    painter.drawText(-strRect.x(), -strRect.y(), str);
-    StringTexture* newTex = new StringTexture(new QOpenGLTexture(strImage.toImage()), QSize(w, h));
-    texCache.insert(hash, newTex, 3*w*h);
-    return newTex;
+    if (textFontKey.isEmpty())
+    {
+        textFont = currentFont;
+        textFont.setPixelSize(currentFont.pixelSize()*prj->getDevicePixelsPerPixel()*StelApp::getInstance().getGlobalScalingRatio());
+        textFontKey = textFont.key().toUtf8();
+    }
+    return textFont;
 }
 
 void StelPainter::drawText(float x, float y, const QString& str, float angleDeg, float xshift, float yshift, bool noGravity)
@@ -749,54 +687,131 @@ void StelPainter::drawText(float x, float y, const QString& str, float angleDeg,
         drawTextGravity180(x, y, str, xshift, yshift);
         return;
     }
-    StringTexture* tex = getTexTexture(str, currentFont.pixelSize());
-    Q_ASSERT(tex);
+    Q_ASSERT(glyphAtlas);
+    const QFont& font = getTextFont();
+    const StelGlyphAtlas::Layout* layout = glyphAtlas->getLayout(str, font, textFontKey);
+    if (!layout)
+        return;
     if (!noGravity)
         angleDeg += prj->defautAngleForGravityText;
-    tex->texture->bind();
 
-    enableTexture2d(true);
-    static float vertexData[8];
-    // compute the vertex coordinates applying the translation and the rotation
-    static const float vertexBase[] = {0., 0., 1., 0., 0., 1., 1., 1.};
-    if (std::fabs(angleDeg)>1.f*M_PI/180.f)
-    {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        const float cosr = std::cos(angleDeg * M_PI/180.);
-        const float sinr = std::sin(angleDeg * M_PI/180.);
-        for (int i = 0; i < 8; i+=2)
+    // The text used to be drawn at once with this blending, and callers may rely on it
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);
+
+    const int nbGlyphs = layout->items.size();
+    QVarLengthArray<StelGlyphAtlas::Glyph, 64> glyphs(nbGlyphs);
+    for (int i=0;i<nbGlyphs;++i)
+    {
+        if (glyphAtlas->getGlyph(*layout, i, glyphs[i]))
+            continue;
+        // The atlas is full: draw the queued text while its glyphs are still there, and start again
+        drawQueuedText();
+        glyphAtlas->reset();
+        for (i=0;i<nbGlyphs;++i)
         {
-            vertexData[i] = int(x + (tex->size.width()*vertexBase[i]+xshift) * cosr - (tex->size.height()*vertexBase[i+1]+yshift) * sinr);
-            vertexData[i+1] = int(y  + (tex->size.width()*vertexBase[i]+xshift) * sinr + (tex->size.height()*vertexBase[i+1]+yshift) * cosr);
+            if (!glyphAtlas->getGlyph(*layout, i, glyphs[i]))
+                return;
         }
     }
-    else
-    {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        for (int i = 0; i < 8; i+=2)
+
+    const bool rotated = std::fabs(angleDeg)>1.f*M_PI/180.f;
+    const float cosr = rotated ? std::cos(angleDeg * M_PI/180.) : 1.f;
+    const float sinr = rotated ? std::sin(angleDeg * M_PI/180.) : 0.f;
+    const float texScale = 1.f/glyphAtlas->getSize();
+    // Glyph positions are relative to the lower left corner of the bounding rectangle, y up
+    const float left = layout->bounds.left();
+    const float bottom = layout->bounds.top() + layout->bounds.height();
+    for (int i=0;i<nbGlyphs;++i)
+    {
+        const StelGlyphAtlas::Glyph& g = glyphs[i];
+        if (g.width==0)
+            continue;
+        const QPointF& pos = layout->items[i].position;
+        const float u0 = pos.x() + g.left - left + xshift;
+        const float v1 = bottom - (pos.y() + g.top) + yshift;
+        const float u1 = u0 + g.width;
+        const float v0 = v1 - g.height;
+        Vec2f corners[4];
+        if (rotated)
+        {
+            corners[0].set(x + u0*cosr - v0*sinr, y + u0*sinr + v0*cosr);
+            corners[1].set(x + u1*cosr - v0*sinr, y + u1*sinr + v0*cosr);
+            corners[2].set(x + u0*cosr - v1*sinr, y + u0*sinr + v1*cosr);
+            corners[3].set(x + u1*cosr - v1*sinr, y + u1*sinr + v1*cosr);
+        }
+        else
+        {
+            // Whole pixels, so that the texels are not filtered
+            const float px = int(x + u0);
+            const float py = int(y + v0);
+            corners[0].set(px, py);
+            corners[1].set(px + g.width, py);
+            corners[2].set(px, py + g.height);
+            corners[3].set(px + g.width, py + g.height);
+        }
+        const float s0 = g.x*texScale;
+        const float s1 = (g.x+g.width)*texScale;
+        const float t0 = (g.y+g.height)*texScale;
+        const float t1 = g.y*texScale;
+        const Vec2f texCoords[4] = {Vec2f(s0, t0), Vec2f(s1, t0), Vec2f(s0, t1), Vec2f(s1, t1)};
+        // Two counterclockwise triangles
+        static const int order[6] = {0, 1, 2, 2, 1, 3};
+        for (int j=0;j<6;++j)
         {
-            vertexData[i] = int(x + tex->size.width()*vertexBase[i]+xshift);
-            vertexData[i+1] = int(y  + tex->size.height()*vertexBase[i+1]+yshift);
+            textVertexArray.append(corners[order[j]]);
+            textTexCoordArray.append(texCoords[order[j]]);
+            textColorArray.append(currentColor);
         }
     }
+}
 
-    float* texCoords = new float[8];
-    for (int i=0;i<4;i++)
-    {
-        texCoords[i*2+0] = tex->getTexSize().width() * (i % 2);
-        texCoords[i*2+1] = tex->getTexSize().height() * (1 - i / 2);
-    }
-    setTexCoordPointer(2, GL_FLOAT, texCoords);
+void StelPainter::drawQueuedText()
+{
+    if (textVertexArray.isEmpty())
+        return;
+    static const int textSection = StelProfiler::getSectionId("StelPainter::text");
+    StelProfiler::Scope textScope(textSection);
+
+    // Restore the state of the caller afterwards, as the text may be drawn in the middle of its drawing
+    GLint texture;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    GLint blendSrcRGB, blendDstRGB, blendSrcAlpha, blendDstAlpha;
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blendSrcRGB);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blendDstRGB);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendSrcAlpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &blendDstAlpha);
+
+    glyphAtlas->bind();
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_BLEND);
-    enableClientStates(true, true);
-    setVertexPointer(2, GL_FLOAT, vertexData);
-    drawFromArray(TriangleStrip, 4, 0, false);
-    enableClientStates(false, false);
-    tex->texture->release();
-    delete[] texCoords;
+
+    const Mat4f& m = getProjector()->getProjectionMatrix();
+    const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+    QOpenGLShaderProgram* pr = texturesColorShaderProgram;
+    pr->bind();
+    pr->setAttributeArray(texturesColorShaderVars.vertex, (const GLfloat*)textVertexArray.constData(), 2);
+    pr->enableAttributeArray(texturesColorShaderVars.vertex);
+    pr->setUniformValue(texturesColorShaderVars.projectionMatrix, qMat);
+    pr->setAttributeArray(texturesColorShaderVars.texCoord, (const GLfloat*)textTexCoordArray.constData(), 2);
+    pr->enableAttributeArray(texturesColorShaderVars.texCoord);
+    pr->setAttributeArray(texturesColorShaderVars.color, (const GLfloat*)textColorArray.constData(), 4);
+    pr->enableAttributeArray(texturesColorShaderVars.color);
+    glDrawArrays(GL_TRIANGLES, 0, textVertexArray.size());
+    pr->disableAttributeArray(texturesColorShaderVars.texCoord);
+    pr->disableAttributeArray(texturesColorShaderVars.vertex);
+    pr->disableAttributeArray(texturesColorShaderVars.color);
+    pr->release();
+
+    textVertexArray.clear();
+    textTexCoordArray.clear();
+    textColorArray.clear();
+
+    glBlendFuncSeparate(blendSrcRGB, blendDstRGB, blendSrcAlpha, blendDstAlpha);
+    if (!blend)
+        glDisable(GL_BLEND);
+    glBindTexture(GL_TEXTURE_2D, texture);
 }
 
 // Recursive method cutting a small circle in small segments
@@ -1633,94 +1648,31 @@ void StelPainter::sSphere(float radius, float oneMinusOblateness, int slices, in
         diffuseLight = light.getDiffuse();
     }
 
-    GLfloat x, y, z;
-    GLfloat s=0.f, t=0.f;
-    GLint i, j;
-    GLfloat nsign;
-
-    if (orientInside)
-    {
-        nsign = -1.f;
-        t=0.f; // from inside texture is reversed
-    }
-    else
-    {
-        nsign = 1.f;
-        t=1.f;
-    }
-
-    const float drho = M_PI / stacks;
-    Q_ASSERT(stacks<=MAX_STACKS);
-    ComputeCosSinRho(drho,stacks);
-    float* cos_sin_rho_p;
-
-    const float dtheta = 2.f * M_PI / slices;
-    Q_ASSERT(slices<=MAX_SLICES);
-    ComputeCosSinTheta(dtheta,slices);
-    const float *cos_sin_theta_p;
-
-    // texturing: s goes from 0.0/0.25/0.5/0.75/1.0 at +y/+x/-y/-x/+y axis
-    // t goes from -1.0/+1.0 at z = -radius/+radius (linear along longitudes)
-    // cannot use triangle fan on texturing (s coord. at top/bottom tip varies)
-    // If the texture is flipped, we iterate the coordinates backward.
-    const GLfloat ds = (flipTexture ? -1.f : 1.f) / slices;
-    const GLfloat dt = nsign / stacks; // from inside texture is reversed
+    const SphereMeshKey key = {SphereMeshKey::Sphere, slices, stacks, orientInside, flipTexture, radius, oneMinusOblateness, 0.f};
+    const StelVertexArray* mesh = getSphereMesh(key);
 
-    // draw intermediate  as quad strips
-    static QVector<double> vertexArr;
-    static QVector<float> texCoordArr;
-    static QVector<float> colorArr;
-    static QVector<unsigned short> indiceArr;
-
-    texCoordArr.resize(0);
-    vertexArr.resize(0);
-    colorArr.resize(0);
-    indiceArr.resize(0);
-
-    for (i = 0,cos_sin_rho_p = cos_sin_rho; i < stacks; ++i,cos_sin_rho_p+=2)
+    if (isLightOn)
     {
-        s = !flipTexture ? 0.f : 1.f;
-        for (j = 0,cos_sin_theta_p = cos_sin_theta; j<=slices;++j,cos_sin_theta_p+=2)
-        {
-            x = -cos_sin_theta_p[1] * cos_sin_rho_p[1];
-            y = cos_sin_theta_p[0] * cos_sin_rho_p[1];
-            z = nsign * cos_sin_rho_p[0];
-            texCoordArr << s << t;
-            if (isLightOn)
-            {
-                c = nsign * (lightPos3[0]*x*oneMinusOblateness + lightPos3[1]*y*oneMinusOblateness + lightPos3[2]*z);
-                if (c<0) {c=0;}
-                colorArr << c*diffuseLight[0] + ambientLight[0] << c*diffuseLight[1] + ambientLight[1] << c*diffuseLight[2] + ambientLight[2];
-            }
-            vertexArr << x * radius << y * radius << z * oneMinusOblateness * radius;
-            x = -cos_sin_theta_p[1] * cos_sin_rho_p[3];
-            y = cos_sin_theta_p[0] * cos_sin_rho_p[3];
-            z = nsign * cos_sin_rho_p[2];
-            texCoordArr << s << t - dt;
-            if (isLightOn)
-            {
-                c = nsign * (lightPos3[0]*x*oneMinusOblateness + lightPos3[1]*y*oneMinusOblateness + lightPos3[2]*z);
-                if (c<0) {c=0;}
-                colorArr << c*diffuseLight[0] + ambientLight[0] << c*diffuseLight[1] + ambientLight[1] << c*diffuseLight[2] + ambientLight[2];
-            }
-            vertexArr << x * radius << y * radius << z * oneMinusOblateness * radius;
-            s += ds;
-        }
-        unsigned int offset = i*(slices+1)*2;
-        for (j = 2;j<slices*2+2;j+=2)
+        // The lighting is computed from the unit sphere point of each vertex, before the oblateness is applied
+        const float nsign = orientInside ? -1.f : 1.f;
+        const double a0 = nsign*lightPos3[0]*oneMinusOblateness/radius;
+        const double a1 = nsign*lightPos3[1]*oneMinusOblateness/radius;
+        const double a2 = nsign*lightPos3[2]/(oneMinusOblateness*radius);
+        static QVector<Vec3f> colorArr;
+        colorArr.resize(mesh->vertex.size());
+        const Vec3d* v = mesh->vertex.constData();
+        Vec3f* color = colorArr.data();
+        for (int i = 0; i < colorArr.size(); ++i)
         {
-            indiceArr << offset+j-2 << offset+j-1 << offset+j;
-            indiceArr << offset+j << offset+j-1 << offset+j+1;
+            c = a0*v[i][0] + a1*v[i][1] + a2*v[i][2];
+            if (c<0) {c=0;}
+            color[i].set(c*diffuseLight[0] + ambientLight[0], c*diffuseLight[1] + ambientLight[1], c*diffuseLight[2] + ambientLight[2]);
         }
-        t -= dt;
+        setArrays(mesh->vertex.constData(), mesh->texCoords.constData(), colorArr.constData());
     }
-
-    // Draw the array now
-    if (isLightOn)
-        setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData(), (Vec3f*)colorArr.constData());
     else
-        setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData());
-    drawFromArray(Triangles, indiceArr.size(), 0, true, indiceArr.constData());
+        setArrays(mesh->vertex.constData(), mesh->texCoords.constData());
+    drawFromArray(Triangles, mesh->indices.size(), 0, true, mesh->indices.constData());
 }
 
 StelVertexArray StelPainter::computeSphereNoLight(float radius, float oneMinusOblateness, int slices, int stacks, int orientInside, bool flipTexture)
@@ -1969,6 +1921,8 @@ void StelPainter::initGLShaders()
     texturesColorShaderVars.color = texturesColorShaderProgram->attributeLocation("color");
     texturesColorShaderVars.texture = texturesColorShaderProgram->uniformLocation("tex");
 
+    glyphAtlas = new StelGlyphAtlas();
+
     qWarning() << "StelPainter: initGLShaders()... done";
 
 }
@@ -1984,7 +1938,9 @@ void StelPainter::deinitGLShaders()
     texturesShaderProgram = NULL;
     delete texturesColorShaderProgram;
     texturesColorShaderProgram = NULL;
-    texCache.clear();
+    delete glyphAtlas;
+    glyphAtlas = NULL;
+    sphereMeshes.clear();
 }
 
 
@@ -2016,6 +1972,9 @@ void StelPainter::enableClientStates(bool vertex, bool texture, bool color, bool
 
 void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool doProj, const unsigned short* indices)
 {
+    // Keep the text under what is drawn after it
+    drawQueuedText();
+
     ArrayDesc projectedVertexArray = vertexArray;
     if (doProj)
     {
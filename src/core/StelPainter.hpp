@@ -104,6 +104,8 @@ public:
 
     //! Draw the string at the given position and angle with the given font.
     //! If the gravity label flag is set, uses drawTextGravity180.
+    //! The text is queued, and all the queued text is drawn at once before the next drawFromArray(),
+    //! before the projector is changed, and when the painter is destroyed.
     //! @param x horizontal position of the lower left corner of the first character of the text in pixel.
     //! @param y horizontal position of the lower left corner of the first character of the text in pixel.
     //! @param str the text to print.
@@ -322,8 +324,12 @@ private:
         GLfloat lineWidth;
     }glState;
 
-    static QCache<QByteArray, struct StringTexture> texCache;
-    struct StringTexture* getTexTexture(const QString& str, int pixelSize);
+    //! Glyphs and shaped strings used for drawing text.
+    static class StelGlyphAtlas* glyphAtlas;
+    //! Get the current font, scaled to device pixels.
+    const QFont& getTextFont();
+    //! Draw the text queued by drawText() in a single draw call.
+    void drawQueuedText();
 
     //! Struct describing one opengl array
     typedef struct
@@ -364,6 +370,10 @@ private:
 
     //! The used for text drawing
     QFont currentFont;
+    //! The current font scaled to device pixels, valid when textFontKey is not empty.
+    QFont textFont;
+    //! The key of textFont in the glyph atlas.
+    QByteArray textFontKey;
 
     Vec4f currentColor;
     bool texture2dEnabled;
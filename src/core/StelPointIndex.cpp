@@ -0,0 +1,116 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelPointIndex.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelGeodesicGrid.hpp"
+
+#include <cmath>
+
+StelPointIndex::StelPointIndex(int level) : level(level)
+{
+}
+
+void StelPointIndex::clear()
+{
+	// resize() keeps the allocated memory for the next build
+	inserted.resize(0);
+	points.resize(0);
+}
+
+void StelPointIndex::insert(int item, const Vec3d& pos)
+{
+	const StelGeodesicGrid* grid = StelApp::getInstance().getCore()->getGeodesicGrid(level);
+	Point p;
+	p.item = item;
+	p.zone = grid->getZoneNumberForPoint(Vec3f(pos[0], pos[1], pos[2]), level);
+	p.pos = pos;
+	inserted.append(p);
+}
+
+void StelPointIndex::build()
+{
+	// Counting sort of the points by zone
+	const int nbZones = StelGeodesicGrid::nrOfZones(level);
+	zoneStart.fill(0, nbZones+1);
+	foreach (const Point& p, inserted)
+		++zoneStart[p.zone+1];
+	for (int z=1;z<=nbZones;++z)
+		zoneStart[z] += zoneStart[z-1];
+	points.resize(inserted.size());
+	foreach (const Point& p, inserted)
+		points[zoneStart[p.zone]++] = p;
+	// Each start was moved to the start of the next zone
+	for (int z=nbZones;z>0;--z)
+		zoneStart[z] = zoneStart[z-1];
+	zoneStart[0] = 0;
+	inserted.resize(0);
+}
+
+bool StelPointIndex::findZones(const Vec3d& v, double cosRadius) const
+{
+	if (cosRadius<0.5)
+		return false;
+
+	// Same construction as StarMgr::searchAround(): a square circumscribing the cap,
+	// whose sides are great circles as required by StelGeodesicGrid::search().
+	// Find h0 and h1 so that h0*v=h1*v=h0*h1=0
+	int i;
+	const double a0 = std::fabs(v[0]);
+	const double a1 = std::fabs(v[1]);
+	const double a2 = std::fabs(v[2]);
+	if (a0 <= a1)
+		i = (a0 <= a2) ? 0 : 2;
+	else
+		i = (a1 <= a2) ? 1 : 2;
+	Vec3d h0(0.,0.,0.);
+	h0[i] = 1.;
+	Vec3d h1 = h0 ^ v;
+	h1.normalize();
+	h0 = h1 ^ v;
+	h0.normalize();
+
+	const double f = 1.4142136 * std::sqrt(1.-cosRadius*cosRadius)/cosRadius;
+	h0 *= f;
+	h1 *= f;
+	Vec3d e0 = v + h0;
+	Vec3d e1 = v + h1;
+	Vec3d e2 = v - h0;
+	Vec3d e3 = v - h1;
+	e0.normalize();
+	e1.normalize();
+	e2.normalize();
+	e3.normalize();
+	searchRegion.resize(4);
+	searchRegion[0] = SphericalCap(e2^e3, 0);
+	searchRegion[1] = SphericalCap(e1^e2, 0);
+	searchRegion[2] = SphericalCap(e0^e1, 0);
+	searchRegion[3] = SphericalCap(e3^e0, 0);
+
+	const GeodesicSearchResult* result = StelApp::getInstance().getCore()->getGeodesicGrid(level)->search(searchRegion, level);
+	searchZones.resize(0);
+	int zone;
+	for (GeodesicSearchInsideIterator it(*result, level);(zone = it.next()) >= 0;)
+		searchZones.append(zone);
+	for (GeodesicSearchBorderIterator it(*result, level);(zone = it.next()) >= 0;)
+		searchZones.append(zone);
+	return true;
+}
@@ -0,0 +1,109 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef _STELPOINTINDEX_HPP_
+#define _STELPOINTINDEX_HPP_
+
+#include "StelSphereGeometry.hpp"
+
+#include <QVector>
+
+//! @class StelPointIndex
+//! Container allowing to find the points around a given direction.
+//! The points are sorted by zone of a level of the shared StelGeodesicGrid,
+//! so that a search only visits the zones intersecting the searched cap.
+//! Each point comes with an integer chosen by the owner, usually the index
+//! of the object in its own list.
+//! The index is filled with clear(), insert() and build(). Once its arrays
+//! have grown, it can be rebuilt and searched without memory allocation,
+//! which makes it cheap enough to be rebuilt every frame for moving objects.
+class StelPointIndex
+{
+public:
+	//! @param level the level of the geodesic grid used for the zones.
+	StelPointIndex(int level=DefaultLevel);
+
+	//! Remove all the points.
+	void clear();
+	//! Add a point. It can only be found after the next call to build().
+	//! @param item the integer passed back by processAround().
+	//! @param pos the direction of the point, normalized.
+	void insert(int item, const Vec3d& pos);
+	//! Sort the points inserted since the last clear() by zone.
+	void build();
+	//! Get the number of points.
+	int size() const {return points.size();}
+
+	//! Process all the points with pos*v>=cosRadius using the passed function object.
+	//! The function object is called with the item of each point and returns false
+	//! to stop the search.
+	//! @return false if the search was stopped by the function object.
+	template<class FuncObject> bool processAround(const Vec3d& v, double cosRadius, FuncObject& func) const
+	{
+		if (!findZones(v, cosRadius))
+		{
+			// Large cap, check all the points
+			for (int i=0;i<points.size();++i)
+			{
+				if (points.at(i).pos*v>=cosRadius && !func(points.at(i).item))
+					return false;
+			}
+			return true;
+		}
+		foreach (int zone, searchZones)
+		{
+			for (int i=zoneStart.at(zone);i<zoneStart.at(zone+1);++i)
+			{
+				if (points.at(i).pos*v>=cosRadius && !func(points.at(i).item))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	//! Default grid level, 5120 zones of about 3 degrees.
+	static const int DefaultLevel = 4;
+
+private:
+	struct Point
+	{
+		int item;
+		int zone;
+		Vec3d pos;
+	};
+
+	//! Fill searchZones with the zones which may contain points of the cap.
+	//! @return false if the cap is too large to use the zones.
+	bool findZones(const Vec3d& v, double cosRadius) const;
+
+	int level;
+	//! Points inserted since the last clear().
+	QVector<Point> inserted;
+	//! Points sorted by zone.
+	QVector<Point> points;
+	//! Index in points of the first point of each zone, with a last entry for the end.
+	QVector<int> zoneStart;
+	//! Zones found by the last search.
+	mutable QVector<int> searchZones;
+	//! Sides of the last searched region.
+	mutable QVector<SphericalCap> searchRegion;
+};
+
+#endif // _STELPOINTINDEX_HPP_
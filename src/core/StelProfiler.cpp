@@ -0,0 +1,305 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "StelProfiler.hpp"
+#include "StelCore.hpp"
+#include "StelPainter.hpp"
+#include "StelProjector.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFont>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+
+// Upper bounds of the histogram buckets, in ms per frame
+static const float HISTOGRAM_BOUNDS[] = {0.05f, 0.1f, 0.25f, 0.5f, 1.f, 2.f, 4.f, 8.f, 16.f, 33.f, 66.f};
+static const int NB_HISTOGRAM_BOUNDS = sizeof(HISTOGRAM_BOUNDS)/sizeof(HISTOGRAM_BOUNDS[0]);
+// About 100 MB of events, i.e. several minutes of frames
+static const int MAX_TRACE_EVENTS = 4*1024*1024;
+// Number of frames between two refreshes of the overlay
+static const int OVERLAY_REFRESH_FRAMES = 30;
+static const int OVERLAY_LINES = 24;
+
+StelProfiler* StelProfiler::singleton = NULL;
+QVector<QString> StelProfiler::sectionNames;
+QHash<QString, int> StelProfiler::sectionIds;
+
+namespace
+{
+	// Escape a section name for a JSON string
+	QString escapeJson(const QString& s)
+	{
+		QString escaped = s;
+		escaped.replace('\\', "\\\\");
+		escaped.replace('"', "\\\"");
+		return escaped;
+	}
+
+	// Compare the sections by decreasing mean time per frame
+	struct MeanGreaterThan
+	{
+		MeanGreaterThan(const QVariantMap& stats) : stats(stats) {}
+		bool operator()(const QString& a, const QString& b) const
+		{
+			return stats.value(a).toMap().value("mean").toDouble() > stats.value(b).toMap().value("mean").toDouble();
+		}
+		const QVariantMap& stats;
+	};
+}
+
+StelProfiler::StelProfiler()
+	: enabled(false),
+	  overlayVisible(false),
+	  frameCount(0),
+	  frameStart(-1),
+	  tracing(false)
+{
+	setObjectName("StelProfiler");
+	Q_ASSERT(!singleton);
+	singleton = this;
+	clock.start();
+}
+
+StelProfiler::~StelProfiler()
+{
+	singleton = NULL;
+}
+
+int StelProfiler::getSectionId(const QString& name)
+{
+	QHash<QString, int>::const_iterator it = sectionIds.constFind(name);
+	if (it!=sectionIds.constEnd())
+		return it.value();
+	const int id = sectionNames.size();
+	sectionNames.append(name);
+	sectionIds.insert(name, id);
+	return id;
+}
+
+void StelProfiler::setFlagEnabled(bool b)
+{
+	if (b==enabled)
+		return;
+	enabled = b;
+	if (enabled)
+	{
+		sections.clear();
+		overlayLines.clear();
+		frameCount = 0;
+	}
+	frameStart = -1;
+	emit enabledChanged(b);
+	if (!enabled && overlayVisible)
+		setFlagShowOverlay(false);
+}
+
+void StelProfiler::setFlagShowOverlay(bool b)
+{
+	if (b==overlayVisible)
+		return;
+	overlayVisible = b;
+	if (overlayVisible)
+		setFlagEnabled(true);
+	emit overlayVisibleChanged(b);
+}
+
+void StelProfiler::add(int section, qint64 start, qint64 end)
+{
+	if (section>=sections.size())
+	{
+		const int oldSize = sections.size();
+		sections.resize(section+1);
+		for (int i=oldSize;i<=section;++i)
+		{
+			Section& s = sections[i];
+			s.frameTime = 0;
+			s.frameCalls = 0;
+			s.history.fill(0.f, HistorySize);
+			s.calls.fill(0, HistorySize);
+		}
+	}
+	Section& s = sections[section];
+	s.frameTime += end-start;
+	++s.frameCalls;
+	if (tracing && trace.size()<MAX_TRACE_EVENTS)
+	{
+		TraceEvent e;
+		e.section = section;
+		e.start = start;
+		e.duration = end-start;
+		trace.append(e);
+	}
+}
+
+void StelProfiler::beginFrame()
+{
+	frameStart = enabled ? clock.nsecsElapsed() : -1;
+}
+
+void StelProfiler::endFrame()
+{
+	if (!enabled || frameStart<0)
+		return;
+	static const int frameSection = getSectionId("frame");
+	add(frameSection, frameStart, clock.nsecsElapsed());
+	frameStart = -1;
+
+	const int pos = frameCount % HistorySize;
+	for (int i=0;i<sections.size();++i)
+	{
+		Section& s = sections[i];
+		s.history[pos] = s.frameTime/1e6;
+		s.calls[pos] = s.frameCalls;
+		s.frameTime = 0;
+		s.frameCalls = 0;
+	}
+	++frameCount;
+
+	if (overlayVisible && (overlayLines.isEmpty() || frameCount%OVERLAY_REFRESH_FRAMES==0))
+	{
+		const QVariantMap stats = getStatistics();
+		QStringList names = stats.keys();
+		std::sort(names.begin(), names.end(), MeanGreaterThan(stats));
+		overlayLines.clear();
+		overlayLines << QString("%1 %2 %3 %4 %5").arg("section", -32).arg("mean", 7).arg("p95", 7).arg("max", 7).arg("calls", 6);
+		for (int i=0;i<names.size() && i<OVERLAY_LINES;++i)
+		{
+			const QVariantMap s = stats.value(names[i]).toMap();
+			overlayLines << QString("%1 %2 %3 %4 %5").arg(names[i].left(32), -32)
+				.arg(s.value("mean").toDouble(), 7, 'f', 2)
+				.arg(s.value("p95").toDouble(), 7, 'f', 2)
+				.arg(s.value("max").toDouble(), 7, 'f', 2)
+				.arg(s.value("calls").toDouble(), 6, 'f', 1);
+		}
+	}
+}
+
+QVariantMap StelProfiler::getStatistics(const Section& s) const
+{
+	const int n = qMin(frameCount, (int)HistorySize);
+	QVector<float> times(n);
+	double sum = 0.;
+	qint64 calls = 0;
+	QVariantList histogram;
+	QVector<int> buckets(NB_HISTOGRAM_BOUNDS+1, 0);
+	for (int i=0;i<n;++i)
+	{
+		times[i] = s.history[i];
+		sum += s.history[i];
+		calls += s.calls[i];
+		buckets[std::upper_bound(HISTOGRAM_BOUNDS, HISTOGRAM_BOUNDS+NB_HISTOGRAM_BOUNDS, s.history[i])-HISTOGRAM_BOUNDS]++;
+	}
+	if (calls==0)
+		return QVariantMap();
+	std::sort(times.begin(), times.end());
+	for (int i=0;i<buckets.size();++i)
+		histogram << buckets[i];
+
+	QVariantMap stats;
+	stats["mean"] = sum/n;
+	stats["p50"] = times[qBound(0, (int)std::ceil(0.50*n)-1, n-1)];
+	stats["p95"] = times[qBound(0, (int)std::ceil(0.95*n)-1, n-1)];
+	stats["max"] = times.last();
+	stats["calls"] = (double)calls/n;
+	stats["histogram"] = histogram;
+	return stats;
+}
+
+QVariantMap StelProfiler::getStatistics() const
+{
+	QVariantMap result;
+	if (frameCount==0)
+		return result;
+	for (int i=0;i<sections.size();++i)
+	{
+		const QVariantMap stats = getStatistics(sections[i]);
+		if (!stats.isEmpty())
+			result[sectionNames[i]] = stats;
+	}
+	return result;
+}
+
+QVariantList StelProfiler::getHistogramBounds() const
+{
+	QVariantList bounds;
+	for (int i=0;i<NB_HISTOGRAM_BOUNDS;++i)
+		bounds << HISTOGRAM_BOUNDS[i];
+	return bounds;
+}
+
+void StelProfiler::startTrace()
+{
+	trace.clear();
+	tracing = true;
+	setFlagEnabled(true);
+}
+
+bool StelProfiler::stopTrace(const QString& path)
+{
+	tracing = false;
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+	{
+		qWarning() << "ERROR: Could not write profiler trace:" << QDir::toNativeSeparators(path);
+		trace.clear();
+		return false;
+	}
+	if (trace.size()>=MAX_TRACE_EVENTS)
+		qWarning() << "WARNING: The profiler trace is truncated to" << MAX_TRACE_EVENTS << "events";
+
+	// Complete events, with times in us
+	QTextStream out(&file);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	for (int i=0;i<trace.size();++i)
+	{
+		const TraceEvent& e = trace.at(i);
+		out << "{\"name\":\"" << escapeJson(sectionNames[e.section]) << "\",\"cat\":\"stellarium\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+		    << "\"ts\":" << QString::number(e.start/1000., 'f', 3) << ",\"dur\":" << QString::number(e.duration/1000., 'f', 3)
+		    << (i+1<trace.size() ? "},\n" : "}\n");
+	}
+	out << "]}\n";
+	trace.clear();
+	trace.squeeze();
+	return out.status()==QTextStream::Ok;
+}
+
+void StelProfiler::drawOverlay(StelCore* core)
+{
+	if (!overlayVisible || overlayLines.isEmpty())
+		return;
+	const StelProjectorP prj = core->getProjection2d();
+	StelPainter sPainter(prj);
+	QFont font("monospace");
+	font.setStyleHint(QFont::Monospace);
+	font.setPixelSize(11);
+	sPainter.setFont(font);
+	sPainter.setColor(1.f, 1.f, 0.6f, 0.9f);
+	const float lineHeight = 13.f;
+	float y = prj->getViewportHeight() - 2.f*lineHeight;
+	foreach (const QString& line, overlayLines)
+	{
+		sPainter.drawText(10.f, y, line);
+		y -= lineHeight;
+	}
+}
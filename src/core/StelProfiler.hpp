@@ -0,0 +1,181 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef _STELPROFILER_HPP_
+#define _STELPROFILER_HPP_
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+class StelCore;
+
+//! @class StelProfiler
+//! Measure the time spent in each module and in some stages of the frame.
+//! StelApp times the update() and draw() of every module, and a few costly stages are timed
+//! where they are done: the traversal of the star zones, the drawing of the labels, the texture
+//! uploads and the computation of the atmosphere grid. For each of these sections the profiler
+//! keeps the time spent per frame over the last HistorySize frames, from which getStatistics()
+//! computes the mean, percentiles and a histogram. The statistics can also be shown over the sky,
+//! and all the timed sections can be recorded to a trace file in the Chrome trace event format,
+//! which can be opened in chrome://tracing or in Perfetto.
+//!
+//! The profiler does nothing as long as it is disabled, apart from checking a flag in each Scope.
+//! It must only be used from the main thread.
+class StelProfiler : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(bool enabled READ getFlagEnabled WRITE setFlagEnabled NOTIFY enabledChanged)
+	Q_PROPERTY(bool overlayVisible READ getFlagShowOverlay WRITE setFlagShowOverlay NOTIFY overlayVisibleChanged)
+
+public:
+	//! Time the section for as long as the scope lives, or until stop() is called:
+	//! @code
+	//! static const int section = StelProfiler::getSectionId("StarMgr::zones");
+	//! StelProfiler::Scope scope(section);
+	//! @endcode
+	class Scope
+	{
+	public:
+		Scope(int section) : section(section), start(-1)
+		{
+			if (singleton && singleton->enabled)
+				start = singleton->clock.nsecsElapsed();
+		}
+		//! Time the given stage of a module, e.g. "StarMgr::draw". The name is only built when
+		//! the profiler is enabled.
+		Scope(const QString& module, const char* stage) : section(-1), start(-1)
+		{
+			if (singleton && singleton->enabled)
+			{
+				section = getSectionId(module + "::" + stage);
+				start = singleton->clock.nsecsElapsed();
+			}
+		}
+		~Scope() {stop();}
+		void stop()
+		{
+			if (start>=0)
+			{
+				singleton->add(section, start, singleton->clock.nsecsElapsed());
+				start = -1;
+			}
+		}
+	private:
+		int section;
+		qint64 start;
+	};
+
+	StelProfiler();
+	~StelProfiler();
+
+	//! Get the StelProfiler singleton instance, or NULL if there is none.
+	static StelProfiler* getInstance() {return singleton;}
+
+	//! Get the id of a section from its name, registering it the first time.
+	static int getSectionId(const QString& name);
+
+	//! Called by StelApp at the start of StelApp::update().
+	void beginFrame();
+	//! Called by StelApp at the end of StelApp::draw().
+	void endFrame();
+
+	//! Draw the statistics of the most costly sections over the sky.
+	void drawOverlay(StelCore* core);
+
+	//! Get the statistics of every section timed during the last frames.
+	//! The result maps each section name to a map with the mean, p50, p95 and max time per frame
+	//! in ms, the mean number of calls per frame, and the histogram of the times per frame in the
+	//! buckets given by getHistogramBounds().
+	Q_INVOKABLE QVariantMap getStatistics() const;
+	//! Get the upper bounds of the histogram buckets in ms. The last bucket has no upper bound.
+	Q_INVOKABLE QVariantList getHistogramBounds() const;
+
+	//! Start recording all the timed sections for a trace file.
+	Q_INVOKABLE void startTrace();
+	//! Stop recording and write the trace in the Chrome trace event JSON format.
+	//! @return false if the file could not be written.
+	Q_INVOKABLE bool stopTrace(const QString& path);
+	bool isTracing() const {return tracing;}
+
+	bool getFlagEnabled() const {return enabled;}
+	bool getFlagShowOverlay() const {return overlayVisible;}
+
+	//! Number of frames kept in the history of each section.
+	static const int HistorySize = 256;
+
+public slots:
+	//! Enable or disable the timing. The history is cleared when the profiler is enabled.
+	void setFlagEnabled(bool b);
+	//! Show or hide the statistics over the sky. Showing them enables the profiler.
+	void setFlagShowOverlay(bool b);
+
+signals:
+	void enabledChanged(bool b);
+	void overlayVisibleChanged(bool b);
+
+private:
+	struct Section
+	{
+		//! Time spent in the current frame, in ns.
+		qint64 frameTime;
+		int frameCalls;
+		//! Time per frame in ms and number of calls per frame, over the last frames.
+		QVector<float> history;
+		QVector<int> calls;
+	};
+
+	struct TraceEvent
+	{
+		int section;
+		//! Start and duration in ns.
+		qint64 start;
+		qint64 duration;
+	};
+
+	//! Add the time of a call to a section.
+	void add(int section, qint64 start, qint64 end);
+	//! Get the statistics of a section over the last frames, or an empty map if it was not called.
+	QVariantMap getStatistics(const Section& s) const;
+
+	static StelProfiler* singleton;
+	static QVector<QString> sectionNames;
+	static QHash<QString, int> sectionIds;
+
+	bool enabled;
+	bool overlayVisible;
+	QElapsedTimer clock;
+	QVector<Section> sections;
+	//! Number of frames recorded since the profiler was enabled.
+	int frameCount;
+	qint64 frameStart;
+
+	bool tracing;
+	QVector<TraceEvent> trace;
+
+	//! Lines shown by drawOverlay(), refreshed every few frames so that they can be read.
+	QStringList overlayLines;
+};
+
+#endif // _STELPROFILER_HPP_
@@ -22,9 +22,11 @@
 
 #include "StelProjector.hpp"
 #include "StelProjectorClasses.hpp"
+#include "StelSimd.hpp"
 
 #include <QDebug>
 #include <QString>
+#include <algorithm>
 
 StelProjector::Mat4dTransform::Mat4dTransform(const Mat4d& m)
     : transfoMat(m),
@@ -55,6 +57,27 @@ void StelProjector::Mat4dTransform::forward(Vec3f& v) const
 	v.transfo4d(transfoMatf);
 }
 
+void StelProjector::Mat4dTransform::forwardBatch(int n, Vec3f* v) const
+{
+	int i = 0;
+#ifdef STEL_SIMD
+	const float* m = transfoMatf.r;
+	const SimdFloat4 m0 = simdSet(m[0]), m1 = simdSet(m[1]), m2 = simdSet(m[2]);
+	const SimdFloat4 m4 = simdSet(m[4]), m5 = simdSet(m[5]), m6 = simdSet(m[6]);
+	const SimdFloat4 m8 = simdSet(m[8]), m9 = simdSet(m[9]), m10 = simdSet(m[10]);
+	const SimdFloat4 m12 = simdSet(m[12]), m13 = simdSet(m[13]), m14 = simdSet(m[14]);
+	SimdFloat4 x, y, z;
+	for (; i+4<=n; i+=4)
+	{
+		simdLoad(v+i, x, y, z);
+		// Same order of operations as Vec3f::transfo4d()
+		simdStore(v+i, m0*x + m4*y + m8*z + m12, m1*x + m5*y + m9*z + m13, m2*x + m6*y + m10*z + m14);
+	}
+#endif
+	for (; i<n; ++i)
+		v[i].transfo4d(transfoMatf);
+}
+
 void StelProjector::Mat4dTransform::backward(Vec3f& v) const
 {
 	// We need no matrix inversion because we always work with orthogonal matrices (where the transposed is the inverse).
@@ -298,31 +321,76 @@ bool StelProjector::project(const Vec3f& v, Vec3f& win) const
 	return projectInPlace(win);
 }
 
-void StelProjector::project(int n, const Vec3d* in, Vec3f* out)
+// Number of vectors transformed at once by the batch functions, small enough
+// for the block to stay in the L1 cache between the successive steps.
+static const int projectBlockSize = 256;
+
+void StelProjector::projectBatch(int n, const Vec3f* in, Vec3f* out, bool* rval) const
+{
+	for (int i=0;i<n;i+=projectBlockSize)
+	{
+		const int count = qMin(projectBlockSize, n-i);
+		if (out!=in)
+			std::copy(in+i, in+i+count, out+i);
+		modelViewTransform->forwardBatch(count, out+i);
+		forwardBatch(count, out+i, rval ? rval+i : NULL);
+		viewportBatch(count, out+i);
+	}
+}
+
+void StelProjector::project(int n, const Vec3d* in, Vec3f* out) const
 {
 	Vec3d v;
-	for (int i = 0; i < n; ++i, ++out)
+	for (int i=0;i<n;i+=projectBlockSize)
 	{
-		v = in[i];
-		modelViewTransform->forward(v);
-		out->set(v[0], v[1], v[2]);
-		forward(*out);
-		out->set(viewportCenter[0] + flipHorz * pixelPerRad * (*out)[0],
-			viewportCenter[1] + flipVert * pixelPerRad * (*out)[1],
-			((*out)[2] - zNear) * oneOverZNearMinusZFar);
+		const int count = qMin(projectBlockSize, n-i);
+		for (int j=i;j<i+count;++j)
+		{
+			v = in[j];
+			modelViewTransform->forward(v);
+			out[j].set(v[0], v[1], v[2]);
+		}
+		forwardBatch(count, out+i, NULL);
+		viewportBatch(count, out+i);
 	}
 }
 
-void StelProjector::project(int n, const Vec3f* in, Vec3f* out)
+void StelProjector::forwardBatch(int n, Vec3f* v, bool* rval) const
 {
-	for (int i = 0; i < n; ++i, ++out)
+	if (rval)
+	{
+		for (int i=0;i<n;++i)
+			rval[i] = forward(v[i]);
+	}
+	else
+	{
+		for (int i=0;i<n;++i)
+			forward(v[i]);
+	}
+}
+
+void StelProjector::viewportBatch(int n, Vec3f* v) const
+{
+	// Same order of operations as projectInPlace()
+	const float sx = flipHorz * pixelPerRad;
+	const float sy = flipVert * pixelPerRad;
+	int i = 0;
+#ifdef STEL_SIMD
+	const SimdFloat4 cx = simdSet(viewportCenter[0]), cy = simdSet(viewportCenter[1]);
+	const SimdFloat4 sx4 = simdSet(sx), sy4 = simdSet(sy);
+	const SimdFloat4 zn = simdSet(zNear), zf = simdSet(oneOverZNearMinusZFar);
+	SimdFloat4 x, y, z;
+	for (; i+4<=n; i+=4)
+	{
+		simdLoad(v+i, x, y, z);
+		simdStore(v+i, cx + sx4*x, cy + sy4*y, (z - zn)*zf);
+	}
+#endif
+	for (; i<n; ++i)
 	{
-		*out=in[i];
-		modelViewTransform->forward(*out);
-		forward(*out);
-		out->set(viewportCenter[0] + flipHorz * pixelPerRad * (*out)[0],
-			viewportCenter[1] + flipVert * pixelPerRad * (*out)[1],
-			((*out)[2] - zNear) * oneOverZNearMinusZFar);
+		v[i][0] = viewportCenter[0] + sx * v[i][0];
+		v[i][1] = viewportCenter[1] + sy * v[i][1];
+		v[i][2] = (v[i][2] - zNear) * oneOverZNearMinusZFar;
 	}
 }
 
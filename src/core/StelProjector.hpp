@@ -56,6 +56,8 @@ public:
 		virtual void backward(Vec3d&) const =0;
 		virtual void forward(Vec3f&) const =0;
 		virtual void backward(Vec3f&) const =0;
+		//! Apply forward() in place to an array of n vectors.
+		virtual void forwardBatch(int n, Vec3f* v) const {for (int i=0;i<n;++i) forward(v[i]);}
 
 		virtual void combine(const Mat4d&)=0;
 		virtual ModelViewTranformP clone() const=0;
@@ -71,6 +73,7 @@ public:
         void backward(Vec3d& v) const;
         void forward(Vec3f& v) const;
         void backward(Vec3f& v) const;
+        void forwardBatch(int n, Vec3f* v) const;
         void combine(const Mat4d& m);
         Mat4d getApproximateLinearTransfo() const;
         ModelViewTranformP clone() const;
@@ -218,9 +221,21 @@ public:
 	//! @return true if the projected coordinate is valid.
 	bool project(const Vec3f& v, Vec3f& win) const;
 
-	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	//! Project an array of n vectors from the current frame into the viewport.
+	//! This gives the same results as calling project() on each vector, but the
+	//! vectors are transformed by blocks, using SIMD instructions when available.
+	//! @param n the number of vectors.
+	//! @param in the vectors in the current frame.
+	//! @param out the projected vectors in the viewport 2D frame. Can be the same array as in.
+	//! @param rval if not NULL, set for each vector to whether the projected coordinate is valid.
+	void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* rval=NULL) const;
 
-	virtual void project(int n, const Vec3f* in, Vec3f* out);
+	//! Project an array of n vectors from the current frame into the viewport.
+	//! The model view transformation is done in double precision.
+	void project(int n, const Vec3d* in, Vec3f* out) const;
+
+	//! Project an array of n vectors from the current frame into the viewport.
+	void project(int n, const Vec3f* in, Vec3f* out) const {projectBatch(n, in, out);}
 
 	//! Project the vector v from the current frame into the viewport.
 	//! @param vd the vector in the current frame.
@@ -291,6 +306,16 @@ protected:
 	//! Initialize the bounding cap.
 	virtual void computeBoundingCap();
 
+	//! Apply forward() in place to an array of n vectors.
+	//! The default implementation calls forward() on each vector. Projections
+	//! override it to avoid the virtual calls, and to use SIMD instructions
+	//! where they give the same results as forward().
+	//! @param rval if not NULL, set for each vector to the value returned by forward().
+	virtual void forwardBatch(int n, Vec3f* v, bool* rval) const;
+
+	//! Convert an array of n vectors from the projection plane to viewport coordinates in place.
+	void viewportBatch(int n, Vec3f* v) const;
+
 	ModelViewTranformP modelViewTransform;	// Operator to apply (if not NULL) before the modelview projection step
 
 	float flipHorz,flipVert;            // Whether to flip in horizontal or vertical directions
@@ -19,6 +19,33 @@
 
 #include "StelProjectorClasses.hpp"
 #include "StelTranslator.hpp"
+#include "StelSimd.hpp"
+
+// Apply P::forward() to n vectors without going through the virtual call.
+template <class P> static void forwardEach(const P* prj, int n, Vec3f* v, bool* rval)
+{
+	if (rval)
+	{
+		for (int i=0;i<n;++i)
+			rval[i] = prj->P::forward(v[i]);
+	}
+	else
+	{
+		for (int i=0;i<n;++i)
+			prj->P::forward(v[i]);
+	}
+}
+
+#ifdef STEL_SIMD
+static inline void storeMask(bool* rval, SimdMask4 m)
+{
+	const int bits = simdMoveMask(m);
+	rval[0] = bits & 1;
+	rval[1] = (bits & 2)!=0;
+	rval[2] = (bits & 4)!=0;
+	rval[3] = (bits & 8)!=0;
+}
+#endif
 
 QString StelProjectorPerspective::getNameI18() const
 {
@@ -39,6 +66,28 @@ bool StelProjectorPerspective::backward(Vec3d &v) const
 	return true;
 }
 
+void StelProjectorPerspective::forwardBatch(int n, Vec3f* v, bool* rval) const
+{
+	int i = 0;
+#ifdef STEL_SIMD
+	const SimdFloat4 zero = simdSet(0.f);
+	const SimdFloat4 fmax = simdSet(std::numeric_limits<float>::max());
+	SimdFloat4 x, y, z;
+	for (; i+4<=n; i+=4)
+	{
+		simdLoad(v+i, x, y, z);
+		const SimdFloat4 r = simdSqrt(x*x + y*y + z*z);
+		const SimdMask4 front = z < zero;
+		const SimdMask4 onPlane = z == zero;
+		const SimdFloat4 d = simdSelect(front, -z, z);
+		simdStore(v+i, simdSelect(onPlane, fmax, x/d), simdSelect(onPlane, fmax, y/d), r);
+		if (rval)
+			storeMask(rval+i, front);
+	}
+#endif
+	forwardEach(this, n-i, v+i, rval ? rval+i : NULL);
+}
+
 float StelProjectorPerspective::fovToViewScalingFactor(float fov) const
 {
 	return std::tan(fov);
@@ -88,6 +137,25 @@ bool StelProjectorEqualArea::backward(Vec3d &v) const
 	return true;
 }
 
+void StelProjectorEqualArea::forwardBatch(int n, Vec3f* v, bool* rval) const
+{
+	int i = 0;
+#ifdef STEL_SIMD
+	const SimdFloat4 two = simdSet(2.f);
+	SimdFloat4 x, y, z;
+	for (; i+4<=n; i+=4)
+	{
+		simdLoad(v+i, x, y, z);
+		const SimdFloat4 r = simdSqrt(x*x + y*y + z*z);
+		const SimdFloat4 f = simdSqrt(two/(r*(r-z)));
+		simdStore(v+i, x*f, y*f, r);
+		if (rval)
+			rval[i] = rval[i+1] = rval[i+2] = rval[i+3] = true;
+	}
+#endif
+	forwardEach(this, n-i, v+i, rval ? rval+i : NULL);
+}
+
 float StelProjectorEqualArea::fovToViewScalingFactor(float fov) const
 {
 	return 2.f * std::sin(0.5f * fov);
@@ -121,6 +189,37 @@ bool StelProjectorStereographic::backward(Vec3d &v) const
   return true;
 }
 
+void StelProjectorStereographic::forwardBatch(int n, Vec3f* v, bool* rval) const
+{
+	int i = 0;
+#ifdef STEL_SIMD
+	const SimdFloat4 zero = simdSet(0.f);
+	const SimdFloat4 half = simdSet(0.5f);
+	const SimdFloat4 one = simdSet(1.f);
+	const SimdFloat4 fmax = simdSet(std::numeric_limits<float>::max());
+	const SimdFloat4 fmin = simdSet(-std::numeric_limits<float>::min());
+	SimdFloat4 x, y, z;
+	for (; i+4<=n; i+=4)
+	{
+		simdLoad(v+i, x, y, z);
+		const SimdFloat4 r = simdSqrt(x*x + y*y + z*z);
+		const SimdFloat4 h = half*(r-z);
+		const SimdMask4 invalid = h <= zero;
+		const SimdFloat4 f = one/h;
+		simdStore(v+i, simdSelect(invalid, fmax, x*f), simdSelect(invalid, fmax, y*f), simdSelect(invalid, fmin, r));
+		if (rval)
+		{
+			const int bits = simdMoveMask(invalid);
+			rval[i] = !(bits & 1);
+			rval[i+1] = !(bits & 2);
+			rval[i+2] = !(bits & 4);
+			rval[i+3] = !(bits & 8);
+		}
+	}
+#endif
+	forwardEach(this, n-i, v+i, rval ? rval+i : NULL);
+}
+
 float StelProjectorStereographic::fovToViewScalingFactor(float fov) const
 {
 	return 2.f * std::tan(0.5f * fov);
@@ -160,6 +259,11 @@ bool StelProjectorFisheye::backward(Vec3d &v) const
 	return (a < M_PI);
 }
 
+void StelProjectorFisheye::forwardBatch(int n, Vec3f* v, bool* rval) const
+{
+	forwardEach(this, n, v, rval);
+}
+
 float StelProjectorFisheye::fovToViewScalingFactor(float fov) const
 {
 	return fov;
@@ -201,6 +305,11 @@ bool StelProjectorHammer::backward(Vec3d &v) const
 	return ret;
 }
 
+void StelProjectorHammer::forwardBatch(int n, Vec3f* v, bool* rval) const
+{
+	forwardEach(this, n, v, rval);
+}
+
 float StelProjectorHammer::fovToViewScalingFactor(float fov) const
 {
 	return fov;
@@ -250,6 +359,11 @@ bool StelProjectorCylinder::backward(Vec3d &v) const
 	return rval;
 }
 
+void StelProjectorCylinder::forwardBatch(int n, Vec3f* v, bool* rval) const
+{
+	forwardEach(this, n, v, rval);
+}
+
 float StelProjectorCylinder::fovToViewScalingFactor(float fov) const
 {
 	return fov;
@@ -301,6 +415,11 @@ bool StelProjectorMercator::backward(Vec3d &v) const
 	return rval;
 }
 
+void StelProjectorMercator::forwardBatch(int n, Vec3f* v, bool* rval) const
+{
+	forwardEach(this, n, v, rval);
+}
+
 float StelProjectorMercator::fovToViewScalingFactor(float fov) const
 {
 	return fov;
@@ -353,6 +472,26 @@ bool StelProjectorOrthographic::backward(Vec3d &v) const
 	return true;
 }
 
+void StelProjectorOrthographic::forwardBatch(int n, Vec3f* v, bool* rval) const
+{
+	int i = 0;
+#ifdef STEL_SIMD
+	const SimdFloat4 zero = simdSet(0.f);
+	const SimdFloat4 one = simdSet(1.f);
+	SimdFloat4 x, y, z;
+	for (; i+4<=n; i+=4)
+	{
+		simdLoad(v+i, x, y, z);
+		const SimdFloat4 r = simdSqrt(x*x + y*y + z*z);
+		const SimdFloat4 h = one/r;
+		if (rval)
+			storeMask(rval+i, z <= zero);
+		simdStore(v+i, x*h, y*h, r);
+	}
+#endif
+	forwardEach(this, n-i, v+i, rval ? rval+i : NULL);
+}
+
 float StelProjectorOrthographic::fovToViewScalingFactor(float fov) const
 {
 	return std::sin(fov);
@@ -55,6 +55,7 @@ public:
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void forwardBatch(int n, Vec3f* v, bool* rval) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -81,6 +82,7 @@ public:
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void forwardBatch(int n, Vec3f* v, bool* rval) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -110,26 +112,12 @@ public:
 		return true;
 	}
 
-	virtual void project(int n, const Vec3d* in, Vec3f* out)
-	{
-		Vec3d v;
-		for (int i = 0; i < n; ++i, ++out)
-		{
-			v = in[i];
-			modelViewTransform->forward(v);
-			out->set(v[0], v[1], v[2]);
-			StelProjectorStereographic::forward(*out);
-			out->set(viewportCenter[0] + flipHorz * pixelPerRad * (*out)[0],
-				viewportCenter[1] + flipVert * pixelPerRad * (*out)[1],
-				((*out)[2] - zNear) * oneOverZNearMinusZFar);
-		}
-	}
-
 	bool backward(Vec3d &v) const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void forwardBatch(int n, Vec3f* v, bool* rval) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -169,6 +157,7 @@ public:
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void forwardBatch(int n, Vec3f* v, bool* rval) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -181,20 +170,6 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 360.f;}
-	virtual void project(int n, const Vec3d* in, Vec3f* out)
-	{
-		Vec3d v;
-		for (int i = 0; i < n; ++i)
-		{
-			v = in[i];
-			modelViewTransform->forward(v);
-			out[i].set(v[0], v[1], v[2]);
-			StelProjectorHammer::forward(out[i]);
-			out[i][0] = viewportCenter[0] + flipHorz * pixelPerRad * out[i][0];
-			out[i][1] = viewportCenter[1] + flipVert * pixelPerRad * out[i][1];
-			out[i][2] = (out[i][2] - zNear) * oneOverZNearMinusZFar;
-		}
-	}
 	bool forward(Vec3f &v) const
 	{
 		// Hammer Aitoff
@@ -212,6 +187,7 @@ public:
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void forwardBatch(int n, Vec3f* v, bool* rval) const;
 	virtual bool hasDiscontinuity() const {return true;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& p1, const Vec3d& p2) const {return p1[0]*p2[0]<0 && !(p1[2]<0 && p2[2]<0);}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& capN, double capD) const
@@ -237,6 +213,7 @@ public:
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void forwardBatch(int n, Vec3f* v, bool* rval) const;
 	virtual bool hasDiscontinuity() const {return true;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& p1, const Vec3d& p2) const
 	{
@@ -265,6 +242,7 @@ public:
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void forwardBatch(int n, Vec3f* v, bool* rval) const;
 	virtual bool hasDiscontinuity() const {return true;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& p1, const Vec3d& p2) const
 	{
@@ -293,6 +271,7 @@ public:
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void forwardBatch(int n, Vec3f* v, bool* rval) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -0,0 +1,134 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELSIMD_HPP_
+#define _STELSIMD_HPP_
+
+//! @file StelSimd.hpp
+//! Minimal wrapper around 4-wide float SIMD instructions, used by the batch
+//! code paths (e.g. StelProjector::projectBatch()).
+//! SSE2 is used on x86, NEON on AArch64. ARMv7 NEON is not used because it
+//! lacks IEEE division and square root, which would make the results differ
+//! from the scalar code. When no instruction set is available, STEL_SIMD is
+//! not defined and callers must use their scalar code.
+//! Only correctly rounded IEEE operations are wrapped, so that a computation
+//! done with SimdFloat4 gives the same result as the same computation done
+//! with floats in the same order of operations.
+
+#include "VecMath.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define STEL_SIMD_SSE2
+#define STEL_SIMD
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define STEL_SIMD_NEON
+#define STEL_SIMD
+#endif
+
+#ifdef STEL_SIMD
+
+//! 4 floats processed at once.
+struct SimdFloat4
+{
+#ifdef STEL_SIMD_SSE2
+	typedef __m128 Type;
+#else
+	typedef float32x4_t Type;
+#endif
+	SimdFloat4() {}
+	SimdFloat4(Type v) : v(v) {}
+	Type v;
+};
+
+//! Result of a comparison of 4 floats, lanes set to all ones where true.
+struct SimdMask4
+{
+#ifdef STEL_SIMD_SSE2
+	typedef __m128 Type;
+#else
+	typedef uint32x4_t Type;
+#endif
+	SimdMask4(Type v) : v(v) {}
+	Type v;
+};
+
+#ifdef STEL_SIMD_SSE2
+inline SimdFloat4 simdSet(float a) {return _mm_set1_ps(a);}
+inline SimdFloat4 simdSet(float a, float b, float c, float d) {return _mm_setr_ps(a, b, c, d);}
+inline void simdStore(float* dst, SimdFloat4 a) {_mm_storeu_ps(dst, a.v);}
+inline SimdFloat4 operator+(SimdFloat4 a, SimdFloat4 b) {return _mm_add_ps(a.v, b.v);}
+inline SimdFloat4 operator-(SimdFloat4 a, SimdFloat4 b) {return _mm_sub_ps(a.v, b.v);}
+inline SimdFloat4 operator*(SimdFloat4 a, SimdFloat4 b) {return _mm_mul_ps(a.v, b.v);}
+inline SimdFloat4 operator/(SimdFloat4 a, SimdFloat4 b) {return _mm_div_ps(a.v, b.v);}
+inline SimdFloat4 operator-(SimdFloat4 a) {return _mm_xor_ps(a.v, _mm_set1_ps(-0.f));}
+inline SimdFloat4 simdSqrt(SimdFloat4 a) {return _mm_sqrt_ps(a.v);}
+inline SimdMask4 operator<(SimdFloat4 a, SimdFloat4 b) {return _mm_cmplt_ps(a.v, b.v);}
+inline SimdMask4 operator<=(SimdFloat4 a, SimdFloat4 b) {return _mm_cmple_ps(a.v, b.v);}
+inline SimdMask4 operator>(SimdFloat4 a, SimdFloat4 b) {return _mm_cmpgt_ps(a.v, b.v);}
+inline SimdMask4 operator==(SimdFloat4 a, SimdFloat4 b) {return _mm_cmpeq_ps(a.v, b.v);}
+//! Return a where the mask is set, b elsewhere.
+inline SimdFloat4 simdSelect(SimdMask4 m, SimdFloat4 a, SimdFloat4 b) {return _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v));}
+//! Return a bit field with bit i set if lane i of the mask is set.
+inline int simdMoveMask(SimdMask4 m) {return _mm_movemask_ps(m.v);}
+#else
+inline SimdFloat4 simdSet(float a) {return vdupq_n_f32(a);}
+inline SimdFloat4 simdSet(float a, float b, float c, float d) {const float t[4] = {a, b, c, d}; return vld1q_f32(t);}
+inline void simdStore(float* dst, SimdFloat4 a) {vst1q_f32(dst, a.v);}
+inline SimdFloat4 operator+(SimdFloat4 a, SimdFloat4 b) {return vaddq_f32(a.v, b.v);}
+inline SimdFloat4 operator-(SimdFloat4 a, SimdFloat4 b) {return vsubq_f32(a.v, b.v);}
+inline SimdFloat4 operator*(SimdFloat4 a, SimdFloat4 b) {return vmulq_f32(a.v, b.v);}
+inline SimdFloat4 operator/(SimdFloat4 a, SimdFloat4 b) {return vdivq_f32(a.v, b.v);}
+inline SimdFloat4 operator-(SimdFloat4 a) {return vnegq_f32(a.v);}
+inline SimdFloat4 simdSqrt(SimdFloat4 a) {return vsqrtq_f32(a.v);}
+inline SimdMask4 operator<(SimdFloat4 a, SimdFloat4 b) {return vcltq_f32(a.v, b.v);}
+inline SimdMask4 operator<=(SimdFloat4 a, SimdFloat4 b) {return vcleq_f32(a.v, b.v);}
+inline SimdMask4 operator>(SimdFloat4 a, SimdFloat4 b) {return vcgtq_f32(a.v, b.v);}
+inline SimdMask4 operator==(SimdFloat4 a, SimdFloat4 b) {return vceqq_f32(a.v, b.v);}
+inline SimdFloat4 simdSelect(SimdMask4 m, SimdFloat4 a, SimdFloat4 b) {return vbslq_f32(m.v, a.v, b.v);}
+inline int simdMoveMask(SimdMask4 m)
+{
+	return (vgetq_lane_u32(m.v, 0) & 1) | (vgetq_lane_u32(m.v, 1) & 2)
+		| (vgetq_lane_u32(m.v, 2) & 4) | (vgetq_lane_u32(m.v, 3) & 8);
+}
+#endif
+
+//! Load 4 consecutive Vec3f as 3 SimdFloat4 holding their x, y and z components.
+inline void simdLoad(const Vec3f* p, SimdFloat4& x, SimdFloat4& y, SimdFloat4& z)
+{
+	x = simdSet(p[0][0], p[1][0], p[2][0], p[3][0]);
+	y = simdSet(p[0][1], p[1][1], p[2][1], p[3][1]);
+	z = simdSet(p[0][2], p[1][2], p[2][2], p[3][2]);
+}
+
+//! Store 3 SimdFloat4 holding x, y and z components into 4 consecutive Vec3f.
+inline void simdStore(Vec3f* p, SimdFloat4 x, SimdFloat4 y, SimdFloat4 z)
+{
+	float tx[4], ty[4], tz[4];
+	simdStore(tx, x);
+	simdStore(ty, y);
+	simdStore(tz, z);
+	for (int i=0;i<4;++i)
+		p[i].set(tx[i], ty[i], tz[i]);
+}
+
+#endif // STEL_SIMD
+
+#endif // _STELSIMD_HPP_
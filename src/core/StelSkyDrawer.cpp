@@ -25,6 +25,7 @@
 #endif
 
 #include <QOpenGLShaderProgram>
+#include <QOpenGLBuffer>
 
 #include "StelSkyDrawer.hpp"
 #include "StelProjector.hpp"
@@ -110,24 +111,56 @@ StelSkyDrawer::StelSkyDrawer(StelCore* acore) : core(acore)
 	if (!ok)
 		setAtmosphereTemperature(15.0);
 
+	refraction.setFlagLookupTables(conf->value("landscape/flag_atmosphere_lookup_tables", false).toBool());
+
 	setAtmospherePressure(conf->value("landscape/pressure_mbar",1013.0).toDouble(&ok));
 	if (!ok)
 		setAtmospherePressure(1013.0);
 
 	// Initialize buffers for use by gl vertex array
 	nbPointSources = 0;
-	maxPointSources = 1000;
-	
-	
-	vertexArray = new StarVertex[maxPointSources*6];
-	
-	textureCoordArray = new unsigned char[maxPointSources*6*2];
-	for (unsigned int i=0;i<maxPointSources; ++i)
+	maxPointSources = 0;
+	vertexArray = NULL;
+	reservePointSources(1000);
+
+	textureCoordArray = NULL;
+	textureCoordArraySize = 0;
+	reserveTextureCoords(maxPointSources);
+
+	// The GL buffers are created in init() when a GL context is available
+	starShaderProgram = NULL;
+	vertexBuffer = NULL;
+	texCoordBuffer = NULL;
+	texCoordBufferSize = 0;
+}
+
+void StelSkyDrawer::reservePointSources(unsigned int nbSources)
+{
+	if (nbSources<=maxPointSources)
+		return;
+	StarVertex* newArray = new StarVertex[nbSources*6];
+	if (vertexArray)
+	{
+		memcpy(newArray, vertexArray, nbPointSources*6*sizeof(StarVertex));
+		delete[] vertexArray;
+	}
+	vertexArray = newArray;
+	maxPointSources = nbSources;
+}
+
+void StelSkyDrawer::reserveTextureCoords(unsigned int nbSources)
+{
+	if (nbSources<=textureCoordArraySize)
+		return;
+	delete[] textureCoordArray;
+	textureCoordArray = new unsigned char[nbSources*6*2];
+	for (unsigned int i=0;i<nbSources; ++i)
 	{
 		static const unsigned char texElems[] = {0, 0, 255, 0, 255, 255, 0, 0, 255, 255, 0, 255};
 		unsigned char* elem = &textureCoordArray[i*6*2];
 		memcpy(elem, texElems, 12);
 	}
+	textureCoordArraySize = nbSources;
 }
 
 StelSkyDrawer::~StelSkyDrawer()
@@ -139,6 +172,10 @@ StelSkyDrawer::~StelSkyDrawer()
 	
 	delete starShaderProgram;
 	starShaderProgram = NULL;
+	delete vertexBuffer;
+	vertexBuffer = NULL;
+	delete texCoordBuffer;
+	texCoordBuffer = NULL;
 }
 
 // Init parameters from config file
@@ -188,7 +225,22 @@ void StelSkyDrawer::init()
 	starShaderVars.pos = starShaderProgram->attributeLocation("pos");
 	starShaderVars.color = starShaderProgram->attributeLocation("color");
 	starShaderVars.texture = starShaderProgram->uniformLocation("tex");
-			
+
+	// Buffers for the point source vertices. If they can't be created, the vertices
+	// are passed as client side arrays instead.
+	vertexBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+	vertexBuffer->setUsagePattern(QOpenGLBuffer::StreamDraw);
+	texCoordBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+	texCoordBuffer->setUsagePattern(QOpenGLBuffer::StaticDraw);
+	if (!vertexBuffer->create() || !texCoordBuffer->create())
+	{
+		qWarning() << "StelSkyDrawer::init(): cannot create vertex buffers, using client side arrays";
+		delete vertexBuffer;
+		vertexBuffer = NULL;
+		delete texCoordBuffer;
+		texCoordBuffer = NULL;
+	}
+
 	update(0);
 }
 
@@ -387,6 +439,21 @@ void StelSkyDrawer::postDrawPointSource(StelPainter* sPainter)
 
 	if (nbPointSources==0)
 		return;
+	reserveTextureCoords(nbPointSources);
+	drawVertexArray(sPainter, vertexArray, nbPointSources);
+	nbPointSources = 0;
+}
+
+void StelSkyDrawer::drawPointSources(StelPainter* sPainter, const StarVertex* vertices, int nbSources)
+{
+	if (nbSources<=0)
+		return;
+	reserveTextureCoords(nbSources);
+	drawVertexArray(sPainter, vertices, nbSources);
+}
+
+void StelSkyDrawer::drawVertexArray(StelPainter* sPainter, const StarVertex* vertices, unsigned int nbSources)
+{
 	texHalo->bind();
 	sPainter->enableTexture2d(true);
 	glBlendFunc(GL_ONE, GL_ONE);
@@ -398,22 +465,42 @@ void StelSkyDrawer::postDrawPointSource(StelPainter* sPainter)
 	Q_ASSERT(sizeof(StarVertex)==12);
 	
 	starShaderProgram->bind();
-	starShaderProgram->setAttributeArray(starShaderVars.pos, GL_FLOAT, (GLfloat*)vertexArray, 2, 12);
+	starShaderProgram->setUniformValue(starShaderVars.projectionMatrix, qMat);
+	if (vertexBuffer)
+	{
+		// Respecify the whole buffer store, so that the driver can give us a fresh
+		// one instead of waiting for the previous draw call to be finished with it.
+		vertexBuffer->bind();
+		vertexBuffer->allocate(vertices, nbSources*6*sizeof(StarVertex));
+		starShaderProgram->setAttributeBuffer(starShaderVars.pos, GL_FLOAT, 0, 2, 12);
+		starShaderProgram->setAttributeBuffer(starShaderVars.color, GL_UNSIGNED_BYTE, sizeof(Vec2f), 3, 12);
+		vertexBuffer->release();
+
+		texCoordBuffer->bind();
+		if (texCoordBufferSize<nbSources)
+		{
+			texCoordBuffer->allocate(textureCoordArray, textureCoordArraySize*6*2);
+			texCoordBufferSize = textureCoordArraySize;
+		}
+		starShaderProgram->setAttributeBuffer(starShaderVars.texCoord, GL_UNSIGNED_BYTE, 0, 2, 0);
+		texCoordBuffer->release();
+	}
+	else
+	{
+		starShaderProgram->setAttributeArray(starShaderVars.pos, GL_FLOAT, (const GLfloat*)vertices, 2, 12);
+		starShaderProgram->setAttributeArray(starShaderVars.color, GL_UNSIGNED_BYTE, (const GLubyte*)&(vertices[0].color), 3, 12);
+		starShaderProgram->setAttributeArray(starShaderVars.texCoord, GL_UNSIGNED_BYTE, (GLubyte*)textureCoordArray, 2, 0);
+	}
 	starShaderProgram->enableAttributeArray(starShaderVars.pos);
-	starShaderProgram->setAttributeArray(starShaderVars.color, GL_UNSIGNED_BYTE, (GLubyte*)&(vertexArray[0].color), 3, 12);
 	starShaderProgram->enableAttributeArray(starShaderVars.color);
-	starShaderProgram->setUniformValue(starShaderVars.projectionMatrix, qMat);
-	starShaderProgram->setAttributeArray(starShaderVars.texCoord, GL_UNSIGNED_BYTE, (GLubyte*)textureCoordArray, 2, 0);
 	starShaderProgram->enableAttributeArray(starShaderVars.texCoord);
-	
-	glDrawArrays(GL_TRIANGLES, 0, nbPointSources*6);
-	
+
+	glDrawArrays(GL_TRIANGLES, 0, nbSources*6);
+
 	starShaderProgram->disableAttributeArray(starShaderVars.pos);
 	starShaderProgram->disableAttributeArray(starShaderVars.color);
 	starShaderProgram->disableAttributeArray(starShaderVars.texCoord);
 	starShaderProgram->release();
-	
-	nbPointSources = 0;
 }
 
 // Draw a point source halo.
@@ -429,8 +516,6 @@ bool StelSkyDrawer::drawPointSource(StelPainter* sPainter, const Vec3f& v, const
 		return false;
 
 	const float radius = rcMag.radius;
-	// Random coef for star twinkling
-	const float tw = (flagStarTwinkle && flagHasAtmosphere) ? (1.f-twinkleAmount*rand()/RAND_MAX)*rcMag.luminance : rcMag.luminance;
 
 	// If the rmag is big, draw a big halo
 	if (radius>MAX_LINEAR_RADIUS+5.f)
@@ -448,30 +533,64 @@ bool StelSkyDrawer::drawPointSource(StelPainter* sPainter, const Vec3f& v, const
 		sPainter->drawSprite2dModeNoDeviceScale(win[0], win[1], rmag);
 	}
 
+	// Store the drawing instructions in the vertex arrays. They are all drawn
+	// at once in postDrawPointSource(), so grow the arrays instead of flushing them.
+	if (nbPointSources>=maxPointSources)
+		reservePointSources(maxPointSources*2);
+	fillPointSourceVertices(win, rcMag, color, &(vertexArray[nbPointSources*6]));
+	++nbPointSources;
+	return true;
+}
+
+
+bool StelSkyDrawer::computePointSource(const StelProjector* prj, const Vec3f& v, const RCMag& rcMag, unsigned int bV, bool checkInScreen,
+				       StarVertex* vertices, bool& bigHalo) const
+{
+	bigHalo = false;
+	if (rcMag.radius<=0.f)
+		return false;
+
+	Vec3f win;
+	if (!(checkInScreen ? prj->projectCheck(v, win) : prj->project(v, win)))
+		return false;
+	return computeProjectedPointSource(win, rcMag, bV, vertices, bigHalo);
+}
+
+bool StelSkyDrawer::computeProjectedPointSource(const Vec3f& win, const RCMag& rcMag, unsigned int bV, StarVertex* vertices, bool& bigHalo) const
+{
+	bigHalo = false;
+	if (rcMag.radius<=0.f)
+		return false;
+
+	if (rcMag.radius>MAX_LINEAR_RADIUS+5.f)
+	{
+		// The big halo needs GL calls
+		bigHalo = true;
+		return true;
+	}
+	fillPointSourceVertices(win, rcMag, colorTable[bV], vertices);
+	return true;
+}
+
+void StelSkyDrawer::fillPointSourceVertices(const Vec3f& win, const RCMag& rcMag, const Vec3f& color, StarVertex* vx) const
+{
+	const float radius = rcMag.radius;
+	// Random coef for star twinkling. qrand() is used as it is thread-safe.
+	const float tw = (flagStarTwinkle && flagHasAtmosphere) ? (1.f-twinkleAmount*qrand()/RAND_MAX)*rcMag.luminance : rcMag.luminance;
+
 	unsigned char starColor[3] = {0, 0, 0};
 	starColor[0] = (unsigned char)std::min((int)(color[0]*tw*255+0.5f), 255);
 	starColor[1] = (unsigned char)std::min((int)(color[1]*tw*255+0.5f), 255);
 	starColor[2] = (unsigned char)std::min((int)(color[2]*tw*255+0.5f), 255);
-	
-	// Store the drawing instructions in the vertex arrays
-	StarVertex* vx = &(vertexArray[nbPointSources*6]);
+
 	vx->pos.set(win[0]-radius,win[1]-radius); memcpy(vx->color, starColor, 3); ++vx;
 	vx->pos.set(win[0]+radius,win[1]-radius); memcpy(vx->color, starColor, 3); ++vx;
 	vx->pos.set(win[0]+radius,win[1]+radius); memcpy(vx->color, starColor, 3); ++vx;
 	vx->pos.set(win[0]-radius,win[1]-radius); memcpy(vx->color, starColor, 3); ++vx;
 	vx->pos.set(win[0]+radius,win[1]+radius); memcpy(vx->color, starColor, 3); ++vx;
-	vx->pos.set(win[0]-radius,win[1]+radius); memcpy(vx->color, starColor, 3); ++vx;
-
-	++nbPointSources;
-	if (nbPointSources>=maxPointSources)
-	{
-		// Flush the buffer (draw all buffered stars)
-		postDrawPointSource(sPainter);
-	}
-	return true;
+	vx->pos.set(win[0]-radius,win[1]+radius); memcpy(vx->color, starColor, 3);
 }
 
-
 // Terminate drawing of a 3D model, draw the halo
 void StelSkyDrawer::postDrawSky3dModel(StelPainter* painter, const Vec3f& v, float illuminatedArea, float mag, const Vec3f& color)
 {
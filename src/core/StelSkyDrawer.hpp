@@ -30,6 +30,7 @@
 class StelToneReproducer;
 class StelCore;
 class StelPainter;
+class StelProjector;
 
 //! Contains the 2 parameters necessary to draw a star on screen.
 //! the radius and luminance of the star halo texture.
@@ -78,6 +79,39 @@ public:
 
 	bool drawPointSource(StelPainter* sPainter, const Vec3f& v, const RCMag &rcMag, const Vec3f& bcolor, bool checkInScreen=false);
 
+	//! Vertex format for a point source.
+	//! Texture pos is stored in another separately.
+	struct StarVertex {
+		Vec2f pos;
+		unsigned char color[4];
+	};
+
+	//! Compute the 6 vertices of a point source halo without drawing it.
+	//! This doesn't change any state, so it can be called from worker threads.
+	//! Sources bright enough to need the big halo texture are not computed: for them
+	//! @em bigHalo is set and they must be drawn with drawPointSource() instead.
+	//! @param prj the projector to use.
+	//! @param v the 3d position of the source in the frame of the projector
+	//! @param rcMag the radius and luminance of the source as computed by computeRCMag()
+	//! @param bV the source B-V index
+	//! @param checkInScreen whether source in screen should be checked.
+	//! @param vertices where to store the 6 vertices of the halo.
+	//! @param bigHalo set to true if the source needs drawing with drawPointSource().
+	//! @return true if the source is visible
+	bool computePointSource(const StelProjector* prj, const Vec3f& v, const RCMag &rcMag, unsigned int bV, bool checkInScreen,
+				StarVertex* vertices, bool& bigHalo) const;
+
+	//! Same as computePointSource() for a source already projected, e.g. with StelProjector::projectBatch().
+	//! @param win the projected position of the source in the viewport 2D frame.
+	bool computeProjectedPointSource(const Vec3f& win, const RCMag &rcMag, unsigned int bV, StarVertex* vertices, bool& bigHalo) const;
+
+	//! Draw point sources computed with computePointSource() in a single draw call.
+	//! Must be called between preDrawPointSource() and postDrawPointSource().
+	//! @param sPainter the StelPainter to use for drawing.
+	//! @param vertices the vertices of the sources, 6 per source.
+	//! @param nbSources the number of sources.
+	void drawPointSources(StelPainter* sPainter, const StarVertex* vertices, int nbSources);
+
 	//! Terminate drawing of a 3D model, draw the halo
 	//! @param p the StelPainter instance to use for this drawing operation
 	//! @param v the 3d position of the source in J2000 reference frame
@@ -336,19 +370,34 @@ private:
 	//! The scaling applied to input luminance before they are converted by the StelToneReproducer
 	float inScale;
 
+	//! Store the 6 vertices of a point source halo centered on win.
+	void fillPointSourceVertices(const Vec3f& win, const RCMag& rcMag, const Vec3f& color, StarVertex* vx) const;
+
+	//! Make sure the texture coordinate array can hold nbSources sources.
+	void reserveTextureCoords(unsigned int nbSources);
+
+	//! Make sure the vertex array can hold nbSources sources, keeping its content.
+	void reservePointSources(unsigned int nbSources);
+
+	//! Draw the given vertex array with the star shader.
+	//! The vertices are streamed to vertexBuffer, so that all the sources are drawn with a single draw call.
+	void drawVertexArray(StelPainter* sPainter, const StarVertex* vertices, unsigned int nbSources);
+
 	// Variables used for GL optimization when displaying point sources
-	//! Vertex format for a point source.
-	//! Texture pos is stored in another separately.
-	struct StarVertex {
-		Vec2f pos;
-		unsigned char color[4];
-	};
-	
 	//! Buffer for storing the vertex array data
 	StarVertex* vertexArray;
 
 	//! Buffer for storing the texture coordinate array data.
 	unsigned char* textureCoordArray;
+	//! Number of sources the texture coordinate array can hold.
+	unsigned int textureCoordArraySize;
+
+	//! GL buffer the point source vertices are streamed to before drawing.
+	class QOpenGLBuffer* vertexBuffer;
+	//! GL buffer holding a copy of textureCoordArray.
+	class QOpenGLBuffer* texCoordBuffer;
+	//! Number of sources texCoordBuffer can hold.
+	unsigned int texCoordBufferSize;
 	
 	class QOpenGLShaderProgram* starShaderProgram;
 	struct StarShaderVars {
@@ -362,7 +411,7 @@ private:
 	
 	//! Current number of sources stored in the buffers (still to display)
 	unsigned int nbPointSources;
-	//! Maximum number of sources which can be stored in the buffers
+	//! Number of sources which can be stored in the buffers before they have to grow
 	unsigned int maxPointSources;
 
 	//! The maximum transformed luminance to apply at the next update
@@ -562,6 +562,13 @@ public:
 	virtual SphericalRegionType getType() const {return SphericalRegion::Polygon;}
 	virtual OctahedronPolygon getOctahedronPolygon() const {return octahedronPolygon;}
 
+	// Use the member rather than a copy, so that the triangles are only tesselated once.
+	virtual double getArea() const {return octahedronPolygon.getArea();}
+	virtual bool isEmpty() const {return octahedronPolygon.isEmpty();}
+	virtual Vec3d getPointInside() const {return octahedronPolygon.getPointInside();}
+	virtual StelVertexArray getFillVertexArray() const {return octahedronPolygon.getFillVertexArray();}
+	virtual StelVertexArray getOutlineVertexArray() const {return octahedronPolygon.getOutlineVertexArray();}
+
 	//! Serialize the region into a QVariant map matching the JSON format.
 	//! The format is:
 	//! @code[[[ra,dec], [ra,dec], [ra,dec], [ra,dec]], [[ra,dec], [ra,dec], [ra,dec]],[...]]@endcode
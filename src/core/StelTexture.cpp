@@ -23,6 +23,7 @@
 #include "StelApp.hpp"
 #include "StelUtils.hpp"
 #include "StelPainter.hpp"
+#include "StelProfiler.hpp"
 
 #include <QImageReader>
 #include <QSize>
@@ -345,6 +346,9 @@ QByteArray StelTexture::convertToGLFormat(const QImage& image, GLint *format, GL
 
 bool StelTexture::glLoad(const GLData& data)
 {
+    static const int uploadSection = StelProfiler::getSectionId("StelTexture::upload");
+    StelProfiler::Scope uploadScope(uploadSection);
+
     if (data.data.isEmpty())
     {
         reportError(data.loaderError.isEmpty()?"Unknown error":data.loaderError);
@@ -147,13 +147,18 @@ void ToastTile::prepareDraw(Vec3f color)
 		const Extinction& extinction=drawer->getExtinction();
 		colorArray.clear();
 
+		QVector<Vec3d> vertAltAz(vertexArray.size());
+		QVector<float> extinctionMags(vertexArray.size(), 0.f);
 		for (int i=0; i<vertexArray.size(); ++i)
 		{
-			Vec3d vertAltAz=core->j2000ToAltAz(vertexArray.at(i), StelCore::RefractionOn);
-			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
+			vertAltAz[i]=core->j2000ToAltAz(vertexArray.at(i), StelCore::RefractionOn);
+			Q_ASSERT(fabs(vertAltAz[i].lengthSquared()-1.0) < 0.001);
+		}
+		extinction.forward(vertAltAz.size(), vertAltAz.constData(), extinctionMags.data());
 
-			float oneMag=0.0f;
-			extinction.forward(vertAltAz, &oneMag);
+		for (int i=0; i<vertexArray.size(); ++i)
+		{
+			const float oneMag=extinctionMags[i];
 			// drop of one magnitude: should be factor 2.5 or 40%. We take 70% to keep it more visible.
 			// Also, for Toast, we do not observe Bortle as for the default MilkyWay.
 			float extinctionFactor=std::pow(0.7f , oneMag);
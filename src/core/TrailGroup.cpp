@@ -24,64 +24,126 @@
 #include "StelObject.hpp"
 #include "Planet.hpp"
 
-TrailGroup::TrailGroup(float te) : timeExtent(te), opacity(1.f)
+#include <cmath>
+
+TrailGroup::TrailGroup(float te, int maxPoints) : timeExtent(te), maxPoints(qMax(maxPoints, 3)), first(0), count(0), homeTrail(-1), opacity(1.f)
 {
 	j2000ToTrailNative=Mat4d::identity();
 	j2000ToTrailNativeInverted=Mat4d::identity();
+	times.resize(this->maxPoints);
 }
 
-static QVector<Vec3d> vertexArray;
+// Projected points, colors and segments of the trails drawn with one call
+static QVector<Vec3f> vertexArray;
 static QVector<Vec4f> colorArray;
+static QVector<unsigned short> indexArray;
+static QVector<float> alphaArray;
+
+static void drawTrailSegments(StelPainter* sPainter)
+{
+	if (!indexArray.isEmpty())
+	{
+		sPainter->setVertexPointer(3, GL_FLOAT, vertexArray.constData());
+		sPainter->setColorPointer(4, GL_FLOAT, colorArray.constData());
+		sPainter->enableClientStates(true, false, true);
+		sPainter->drawFromArray(StelPainter::Lines, indexArray.size(), 0, false, indexArray.constData());
+		sPainter->enableClientStates(false);
+	}
+	vertexArray.clear();
+	colorArray.clear();
+	indexArray.clear();
+}
+
 void TrailGroup::draw(StelCore* core, StelPainter* sPainter)
 {
+	if (count<2)
+		return;
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	float currentTime = core->getJDay();
+	const double currentTime = core->getJDay();
 	StelProjector::ModelViewTranformP transfo = core->getJ2000ModelViewTransform();
 	transfo->combine(j2000ToTrailNativeInverted);
 	sPainter->setProjector(core->getProjection(transfo));
-	foreach (const Trail& trail, allTrails)
+	const StelProjectorP prj = sPainter->getProjector();
+
+	// Avoid drawing the trails if the object is the home planet
+	const QString& planetName = core->getCurrentLocation().planetName;
+	if (planetName!=homePlanetName)
 	{
-		Planet* hpl = dynamic_cast<Planet*>(trail.stelObject.data());
-		if (hpl!=NULL)
+		homePlanetName = planetName;
+		homeTrail = -1;
+		for (int t=0;t<allTrails.size();++t)
 		{
-			// Avoid drawing the trails if the object is the home planet
-			QString homePlanetName = hpl==NULL ? "" : hpl->getEnglishName();
-			if (homePlanetName==StelApp::getInstance().getCore()->getCurrentLocation().planetName)
-				continue;
+			if (allTrails.at(t).planetName==planetName)
+				homeTrail = t;
 		}
-		const QList<Vec3d>& posHistory = trail.posHistory;
-		vertexArray.resize(posHistory.size());
-		colorArray.resize(posHistory.size());
-		for (int i=0;i<posHistory.size();++i)
+	}
+
+	// The points have the same dates in all the trails, and so the same transparency
+	alphaArray.resize(count);
+	for (int i=0;i<count;++i)
+		alphaArray[i] = (1.f-(currentTime-times.at(ringIndex(i)))/timeExtent)*opacity;
+
+	// The size of the ring part from the oldest point to the end of the storage
+	const int firstPart = qMin(count, maxPoints-first);
+	for (int t=0;t<allTrails.size();++t)
+	{
+		if (t==homeTrail)
+			continue;
+		// Segments are indexed with unsigned shorts
+		if (vertexArray.size()+count>65536)
+			drawTrailSegments(sPainter);
+		const Trail& trail = allTrails.at(t);
+		const int base = vertexArray.size();
+		vertexArray.resize(base+count);
+		const Vec3f* points = positions.constData()+t*maxPoints;
+		prj->project(firstPart, points+first, vertexArray.data()+base);
+		if (count>firstPart)
+			prj->project(count-firstPart, points, vertexArray.data()+base+firstPart);
+		for (int i=0;i<count;++i)
+			colorArray.append(Vec4f(trail.color[0], trail.color[1], trail.color[2], alphaArray.at(i)));
+		for (int i=0;i<count-1;++i)
 		{
-			float colorRatio = 1.f-(currentTime-times.at(i))/timeExtent;
-			colorArray[i].set(trail.color[0], trail.color[1], trail.color[2], colorRatio*opacity);
-			vertexArray[i]=posHistory.at(i);
+			indexArray.append(base+i);
+			indexArray.append(base+i+1);
 		}
-		sPainter->setVertexPointer(3, GL_DOUBLE, vertexArray.constData());
-		sPainter->setColorPointer(4, GL_FLOAT, colorArray.constData());
-		sPainter->enableClientStates(true, false, true);
-		sPainter->drawFromArray(StelPainter::LineStrip, vertexArray.size(), 0, true);
-		sPainter->enableClientStates(false);
 	}
+	drawTrailSegments(sPainter);
 }
 
 // Add 1 point to all the curves at current time and suppress too old points
 void TrailGroup::update()
 {
-	times.append(StelApp::getInstance().getCore()->getJDay());
-	for (QList<Trail>::Iterator iter=allTrails.begin();iter!=allTrails.end();++iter)
+	StelCore* core = StelApp::getInstance().getCore();
+	const double jd = core->getJDay();
+	int index;
+	if (count>=2 && std::fabs(jd-times.at(ringIndex(count-2)))<timeExtent/(maxPoints-2))
 	{
-		iter->posHistory.append(j2000ToTrailNative*iter->stelObject->getJ2000EquatorialPos(StelApp::getInstance().getCore()));
+		// Too close to the previous point: move the last one
+		index = ringIndex(count-1);
 	}
-	if (StelApp::getInstance().getCore()->getJDay()-times.at(0)>timeExtent)
+	else
 	{
-		times.pop_front();
-		for (QList<Trail>::Iterator iter=allTrails.begin();iter!=allTrails.end();++iter)
+		if (count==maxPoints)
 		{
-			iter->posHistory.pop_front();
+			first = ringIndex(1);
+			--count;
 		}
+		index = ringIndex(count);
+		++count;
+	}
+	times[index] = jd;
+	if (positions.size()!=allTrails.size()*maxPoints)
+		positions.resize(allTrails.size()*maxPoints);
+	for (int t=0;t<allTrails.size();++t)
+	{
+		const Vec3d pos = j2000ToTrailNative*allTrails.at(t).stelObject->getJ2000EquatorialPos(core);
+		positions[t*maxPoints+index].set(pos[0], pos[1], pos[2]);
+	}
+	while (count>0 && jd-times.at(first)>timeExtent)
+	{
+		first = ringIndex(1);
+		--count;
 	}
 }
 
@@ -94,14 +156,16 @@ void TrailGroup::setJ2000ToTrailNative(const Mat4d& m)
 
 void TrailGroup::addObject(const StelObjectP& obj, const Vec3f* col)
 {
-	allTrails.append(TrailGroup::Trail(obj, col==NULL ? obj->getInfoColor() : *col));
+	const Planet* planet = dynamic_cast<const Planet*>(obj.data());
+	allTrails.append(TrailGroup::Trail(obj, col==NULL ? obj->getInfoColor() : *col, planet ? planet->getEnglishName() : QString()));
+	homePlanetName.clear();
+	homeTrail = -1;
+	// The new trail has no past points
+	reset();
 }
 
 void TrailGroup::reset()
 {
-	times.clear();
-	for (QList<Trail>::Iterator iter=allTrails.begin();iter!=allTrails.end();++iter)
-	{
-		iter->posHistory.clear();
-	}
+	first = 0;
+	count = 0;
 }
@@ -26,11 +26,18 @@
 
 class StelPainter;
 
+//! @class TrailGroup
+//! Trails of a group of objects, i.e. their positions at previous dates.
+//! The points of all the trails are taken at the same dates. They are stored in a ring of maxPoints
+//! points per trail, so that the memory used does not grow over time. A new point is only added when
+//! the date moved by more than timeExtent/(maxPoints-2) since the previous one. Until then, the last
+//! point follows the object.
 class TrailGroup
 {
 public:
-	TrailGroup(float atimeExtent);
+	TrailGroup(float atimeExtent, int maxPoints=512);
 
+	//! Draw all the trails, with as few draw calls as possible.
 	void draw(StelCore* core, StelPainter*);
 
 	// Add 1 point to all the curves at current time and suppress too old points
@@ -39,6 +46,7 @@ public:
 	// Set the matrix to use to post process J2000 positions before storing in the trail
 	void setJ2000ToTrailNative(const Mat4d& m);
 
+	//! Add the trail of an object. The points of the other trails are removed.
 	void addObject(const StelObjectP&, const Vec3f* col=NULL);
 
 	void setOpacity(float op) {opacity=op;}
@@ -50,19 +58,34 @@ private:
 	class Trail
 	{
 	public:
-		Trail(const StelObjectP& obj, const Vec3f& col) : stelObject(obj), color(col) {;}
+		Trail(const StelObjectP& obj, const Vec3f& col, const QString& planetName) : stelObject(obj), color(col), planetName(planetName) {;}
 		StelObjectP stelObject;
-		// All previous positions
-		QList<Vec3d> posHistory;
 		Vec3f color;
+		//! English name if the object is a planet, used to hide the trail of the home planet.
+		QString planetName;
 	};
 
-	QList<Trail> allTrails;
+	//! Get the index in the ring of the i-th oldest point.
+	int ringIndex(int i) const {return (first+i)%maxPoints;}
+
+	QVector<Trail> allTrails;
 
 	// Maximum time extent in days
 	float timeExtent;
-
-	QList<float> times;
+	//! Number of points kept for each trail.
+	int maxPoints;
+
+	//! Dates of the points.
+	QVector<double> times;
+	//! Positions of the points, maxPoints for each trail in turn.
+	QVector<Vec3f> positions;
+	//! Index of the oldest point in the ring, and number of points.
+	int first, count;
+
+	//! Index of the trail of the home planet, which is not drawn, or -1.
+	int homeTrail;
+	//! Name of the planet homeTrail was found for.
+	QString homePlanetName;
 
 	Mat4d j2000ToTrailNative;
 	Mat4d j2000ToTrailNativeInverted;
@@ -20,6 +20,8 @@
 #include <QDebug>
 #include <QSettings>
 #include <QOpenGLShaderProgram>
+#include <QThread>
+#include <QtConcurrent>
 #include "Atmosphere.hpp"
 #include "StelUtils.hpp"
 #include "StelApp.hpp"
@@ -27,6 +29,7 @@
 #include "StelToneReproducer.hpp"
 #include "StelCore.hpp"
 #include "StelPainter.hpp"
+#include "StelProfiler.hpp"
 #include "StelFileMgr.hpp"
 
 inline bool myisnan(double value)
@@ -34,11 +37,80 @@ inline bool myisnan(double value)
 	return value != value;
 }
 
+// Change of the Sun or Moon direction (in radian) below which the grid is not computed again.
+// The Sun moves by this angle in about 1.4 second.
+static const float POSITION_THRESHOLD = 1e-4f;
+// Change of the direction of a viewport point below which the view is considered unchanged.
+static const double VIEW_THRESHOLD = 1e-7;
+
+namespace
+{
+	// A range of points of the color grid, computed in one thread
+	struct AtmosphereGridJob
+	{
+		const StelProjector* prj;
+		const Skybright* skyb;
+		const Vec2f* posGrid;
+		Vec4f* colorGrid;
+		int begin;
+		int end;
+		bool unProject;
+		float sunPos[3];
+		float moonPos[3];
+		float eclipseFactor;
+		float lightPollutionLuminance;
+		float sumLuminance;
+	};
+
+	void computeAtmosphereGrid(AtmosphereGridJob& job)
+	{
+		// Store the back projected position in the input color to the shader
+		if (job.unProject)
+		{
+			Vec3d point(1., 0., 0.);
+			for (int i=job.begin; i<job.end; ++i)
+			{
+				job.prj->unProject(job.posGrid[i][0], job.posGrid[i][1], point);
+				Q_ASSERT(fabs(point.lengthSquared()-1.0) < 1e-10);
+				// The sky below the ground is the symmetric of the one above :
+				// it looks nice and gives proper values for brightness estimation
+				job.colorGrid[i].set(point[0], point[1], fabs(point[2]), 0.f);
+			}
+		}
+
+		// Store the luminance in the 4th component. The xy part of the color is computed in the shader.
+		float sum = 0.f;
+		const float* sun = job.sunPos;
+		const float* moon = job.moonPos;
+		for (Vec4f* c=job.colorGrid+job.begin; c<job.colorGrid+job.end; ++c)
+		{
+			const float x = (*c)[0];
+			const float y = (*c)[1];
+			const float z = (*c)[2];
+			// Use the Skybright.cpp 's models for brightness which gives better results.
+			float lumi = job.skyb->getLuminance(moon[0]*x+moon[1]*y+moon[2]*z, sun[0]*x+sun[1]*y+sun[2]*z, z);
+			lumi *= job.eclipseFactor;
+			// Add star background luminance
+			lumi += 0.0001f;
+			// Add the light pollution luminance AFTER the scaling to avoid scaling it because it is the cause
+			// of the scaling itself
+			lumi += job.lightPollutionLuminance;
+			sum += lumi;
+			(*c)[3] = lumi;
+		}
+		job.sumLuminance = sum;
+	}
+}
+
 Atmosphere::Atmosphere(void) :viewport(0,0,0,0), posGrid(NULL), posGridBuffer(QOpenGLBuffer::VertexBuffer), 
-	indicesBuffer(QOpenGLBuffer::IndexBuffer), colorGrid(NULL), colorGridBuffer(QOpenGLBuffer::VertexBuffer),
+	indicesBuffer(QOpenGLBuffer::IndexBuffer), colorGrid(NULL), colorGridBufferIndex(0),
+	gridDirectionsValid(false), gridLuminanceValid(false),
 	averageLuminance(0.f), eclipseFactor(1.f), lightPollutionLuminance(0)
 {
 	setFadeDuration(1.5f);
+	QSettings* conf = StelApp::getInstance().getSettings();
+	threadCount = qMax(1, conf->value("landscape/atmosphere_threads", QThread::idealThreadCount()).toInt());
+	skyb.setFlagLookupTables(conf->value("landscape/flag_atmosphere_lookup_tables", false).toBool());
 
 	qDebug() << "Use vertex shader for atmosphere rendering.";
 	QOpenGLShader vShader(QOpenGLShader::Vertex);
@@ -164,12 +236,17 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 		delete[] indices;
 		indices=NULL;
 		
-		colorGridBuffer.destroy();
-		colorGridBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
-		colorGridBuffer.create();
-		colorGridBuffer.bind();
-		colorGridBuffer.allocate(colorGrid, (1+skyResolutionX)*(1+skyResolutionY)*4*4);
-		colorGridBuffer.release();
+		for (int b=0; b<2; ++b)
+		{
+			colorGridBuffers[b].destroy();
+			colorGridBuffers[b].setUsagePattern(QOpenGLBuffer::DynamicDraw);
+			colorGridBuffers[b].create();
+			colorGridBuffers[b].bind();
+			colorGridBuffers[b].allocate((1+skyResolutionX)*(1+skyResolutionY)*4*4);
+			colorGridBuffers[b].release();
+		}
+		gridDirectionsValid = false;
+		gridLuminanceValid = false;
 	}
 
 	if (myisnan(_sunPos.length()))
@@ -217,80 +294,103 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 	if (!fader.getInterstate())
 	{
 		averageLuminance = 0.001f + lightPollutionLuminance;
+		gridLuminanceValid = false;
 		return;
 	}
 
-	// Calculate the atmosphere RGB for each point of the grid
-	float sunPos[3];
-	sunPos[0] = _sunPos[0];
-	sunPos[1] = _sunPos[1];
-	sunPos[2] = _sunPos[2];
-
-	float moon_pos[3];
-	moon_pos[0] = moonPos[0];
-	moon_pos[1] = moonPos[1];
-	moon_pos[2] = moonPos[2];
-
-	sky.setParamsv(sunPos, 5.f);
-
-	skyb.setLocation(latitude * M_PI/180., altitude, temperature, relativeHumidity);
-	skyb.setSunMoon(moon_pos[2], sunPos[2]);
+	// The directions of the grid points only change with the view
+	const int nbPoints = (1+skyResolutionX)*(1+skyResolutionY);
+	const Vec2f probes[5] = {posGrid[0], posGrid[skyResolutionX], posGrid[nbPoints-1-skyResolutionX], posGrid[nbPoints-1],
+				 prj->getViewportCenter()};
+	for (int p=0; p<5; ++p)
+	{
+		Vec3d v(1., 0., 0.);
+		prj->unProject(probes[p][0], probes[p][1], v);
+		if ((v-viewProbes[p]).lengthSquared() > VIEW_THRESHOLD*VIEW_THRESHOLD)
+			gridDirectionsValid = false;
+		viewProbes[p] = v;
+	}
 
-	// Calculate the date from the julian day.
+	// The luminances only change with the Sun, the Moon, the date and the location
 	int year, month, day;
 	StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
-	skyb.setDate(year, month, moonPhase);
-
-	// Variables used to compute the average sky luminance
-	float sum_lum = 0.f;
-
-	Vec3d point(1., 0., 0.);
-	float lumi;
+	GridInputs inputs;
+	inputs.sunPos.set(_sunPos[0], _sunPos[1], _sunPos[2]);
+	inputs.moonPos.set(moonPos[0], moonPos[1], moonPos[2]);
+	inputs.moonPhase = moonPhase;
+	inputs.eclipseFactor = eclipseFactor;
+	inputs.lightPollutionLuminance = lightPollutionLuminance;
+	inputs.latitude = latitude;
+	inputs.altitude = altitude;
+	inputs.temperature = temperature;
+	inputs.relativeHumidity = relativeHumidity;
+	inputs.year = year;
+	inputs.month = month;
+	if (gridLuminanceValid && ((inputs.sunPos-gridInputs.sunPos).lengthSquared() > POSITION_THRESHOLD*POSITION_THRESHOLD
+		|| (inputs.moonPos-gridInputs.moonPos).lengthSquared() > POSITION_THRESHOLD*POSITION_THRESHOLD
+		|| inputs.moonPhase!=gridInputs.moonPhase || inputs.eclipseFactor!=gridInputs.eclipseFactor
+		|| inputs.lightPollutionLuminance!=gridInputs.lightPollutionLuminance
+		|| inputs.latitude!=gridInputs.latitude || inputs.altitude!=gridInputs.altitude
+		|| inputs.temperature!=gridInputs.temperature || inputs.relativeHumidity!=gridInputs.relativeHumidity
+		|| inputs.year!=gridInputs.year || inputs.month!=gridInputs.month))
+		gridLuminanceValid = false;
+
+	if (gridDirectionsValid && gridLuminanceValid)
+		return;
 
-	// Compute the sky color for every point above the ground
-	for (int i=0; i<(1+skyResolutionX)*(1+skyResolutionY); ++i)
+	if (!gridLuminanceValid)
 	{
-		const Vec2f &v(posGrid[i]);
-		prj->unProject(v[0],v[1],point);
+		gridInputs = inputs;
+		sky.setParamsv(inputs.sunPos, 5.f);
+		skyb.setLocation(latitude * M_PI/180., altitude, temperature, relativeHumidity);
+		skyb.setSunMoon(inputs.moonPos[2], inputs.sunPos[2]);
+		skyb.setDate(year, month, moonPhase);
+	}
 
-		Q_ASSERT(fabs(point.lengthSquared()-1.0) < 1e-10);
+	static const int gridSection = StelProfiler::getSectionId("Atmosphere::grid");
+	StelProfiler::Scope gridScope(gridSection);
 
-		if (point[2]<=0)
+	// Compute the sky color for every point in ranges of rows split between the threads
+	const int nbJobs = qMin(threadCount, 1+skyResolutionY);
+	QVector<AtmosphereGridJob> jobs(nbJobs);
+	for (int j=0; j<nbJobs; ++j)
+	{
+		AtmosphereGridJob& job = jobs[j];
+		job.prj = prj.data();
+		job.skyb = &skyb;
+		job.posGrid = posGrid;
+		job.colorGrid = colorGrid;
+		job.begin = (1+skyResolutionY)*j/nbJobs*(1+skyResolutionX);
+		job.end = (1+skyResolutionY)*(j+1)/nbJobs*(1+skyResolutionX);
+		job.unProject = !gridDirectionsValid;
+		for (int k=0; k<3; ++k)
 		{
-			point[2] = -point[2];
-			// The sky below the ground is the symmetric of the one above :
-			// it looks nice and gives proper values for brightness estimation
+			job.sunPos[k] = gridInputs.sunPos[k];
+			job.moonPos[k] = gridInputs.moonPos[k];
 		}
-
-		// Use the Skybright.cpp 's models for brightness which gives better results.
-		lumi = skyb.getLuminance(moon_pos[0]*point[0]+moon_pos[1]*point[1]+
-				moon_pos[2]*point[2], sunPos[0]*point[0]+sunPos[1]*point[1]+
-				sunPos[2]*point[2], point[2]);
-		lumi *= eclipseFactor;
-		// Add star background luminance
-		lumi += 0.0001f;
-		// Multiply by the input scale of the ToneConverter (is not done automatically by the xyYtoRGB method called later)
-		//lumi*=eye->getInputScale();
-
-		// Add the light pollution luminance AFTER the scaling to avoid scaling it because it is the cause
-		// of the scaling itself
-		lumi += lightPollutionLuminance;
-
-		// Store for later statistics
-		sum_lum+=lumi;
-
-		// Now need to compute the xy part of the color component
-		// This is done in the openGL shader
-		// Store the back projected position + luminance in the input color to the shader
-		colorGrid[i].set(point[0], point[1], point[2], lumi);
+		job.eclipseFactor = gridInputs.eclipseFactor;
+		job.lightPollutionLuminance = gridInputs.lightPollutionLuminance;
+		job.sumLuminance = 0.f;
 	}
-	
+	if (nbJobs>1)
+		QtConcurrent::blockingMap(jobs, computeAtmosphereGrid);
+	else
+		computeAtmosphereGrid(jobs[0]);
+	gridDirectionsValid = true;
+	gridLuminanceValid = true;
+
+	// Upload to the buffer which was not used for drawing the previous frame
+	colorGridBufferIndex = 1-colorGridBufferIndex;
+	QOpenGLBuffer& colorGridBuffer = colorGridBuffers[colorGridBufferIndex];
 	colorGridBuffer.bind();
-	colorGridBuffer.write(0, colorGrid, (1+skyResolutionX)*(1+skyResolutionY)*4*4);
+	colorGridBuffer.write(0, colorGrid, nbPoints*4*4);
 	colorGridBuffer.release();
-	
+
 	// Update average luminance
-	averageLuminance = sum_lum/((1+skyResolutionX)*(1+skyResolutionY));
+	float sum_lum = 0.f;
+	for (int j=0; j<nbJobs; ++j)
+		sum_lum += jobs[j].sumLuminance;
+	averageLuminance = sum_lum/nbPoints;
 }
 
 
@@ -340,9 +440,9 @@ void Atmosphere::draw(StelCore* core)
 	atmoShaderProgram->setUniformValue(shaderAttribLocations.projectionMatrix,
 		QMatrix4x4(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]));
 	
-	colorGridBuffer.bind();
+	colorGridBuffers[colorGridBufferIndex].bind();
 	atmoShaderProgram->setAttributeBuffer(shaderAttribLocations.skyColor, GL_FLOAT, 0, 4, 0);
-	colorGridBuffer.release();
+	colorGridBuffers[colorGridBufferIndex].release();
 	atmoShaderProgram->enableAttributeArray(shaderAttribLocations.skyColor);
 	posGridBuffer.bind();
 	atmoShaderProgram->setAttributeBuffer(shaderAttribLocations.skyVertex, GL_FLOAT, 0, 2, 0);
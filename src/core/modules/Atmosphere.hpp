@@ -86,7 +86,34 @@ private:
 	QOpenGLBuffer posGridBuffer;
 	QOpenGLBuffer indicesBuffer;
 	Vec4f* colorGrid;
-	QOpenGLBuffer colorGridBuffer;
+	//! The color grid is uploaded alternately to each buffer, so that the upload does not wait for
+	//! the end of the previous frame drawn with the other one.
+	QOpenGLBuffer colorGridBuffers[2];
+	//! Index of the buffer holding the last computed color grid.
+	int colorGridBufferIndex;
+
+	//! Parameters used for the last computation of the color grid. The grid is computed again only
+	//! when they change.
+	struct GridInputs
+	{
+		Vec3f sunPos;
+		Vec3f moonPos;
+		float moonPhase;
+		float eclipseFactor;
+		float lightPollutionLuminance;
+		float latitude, altitude, temperature, relativeHumidity;
+		int year, month;
+	};
+	GridInputs gridInputs;
+	//! Directions of a few points of the viewport in the last computed grid, used to detect a change
+	//! of the view or of the projection.
+	Vec3d viewProbes[5];
+	//! Whether the directions stored in colorGrid are up to date.
+	bool gridDirectionsValid;
+	//! Whether the luminances stored in colorGrid are up to date.
+	bool gridLuminanceValid;
+	//! Number of threads used to compute the grid.
+	int threadCount;
 
 	//! The average luminance of the atmosphere in cd/m2
 	float averageLuminance;
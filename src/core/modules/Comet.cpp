@@ -196,18 +196,16 @@ double Comet::getSiderealPeriod() const
 	return period;
 }
 
-float Comet::getVMagnitude(const StelCore* core) const
+float Comet::computeVMagnitude(const Vec3d& observerHeliocentricPosition, const Vec3d& cometHeliocentricPosition, const Vec3d& parentHelioPos, double jd, bool fromEarth) const
 {
 	//If the two parameter system is not used,
 	//use the default radius/albedo mechanism
 	if (slopeParameter < 0)
 	{
-		return Planet::getVMagnitude(core);
+		return Planet::computeVMagnitude(observerHeliocentricPosition, cometHeliocentricPosition, parentHelioPos, jd, fromEarth);
 	}
 
 	//Calculate distances
-	const Vec3d& observerHeliocentricPosition = core->getObserverHeliocentricEclipticPos();
-	const Vec3d& cometHeliocentricPosition = getHeliocentricEclipticPos();
 	const double cometSunDistance = std::sqrt(cometHeliocentricPosition.lengthSquared());
 	const double observerCometDistance = std::sqrt((observerHeliocentricPosition - cometHeliocentricPosition).lengthSquared());
 
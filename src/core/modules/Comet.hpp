@@ -66,7 +66,8 @@ public:
 	//was not designed to handle different types of objects.
 	//virtual QString getType() const {return "Comet";}
 	//! \todo Find better sources for the g,k system
-	virtual float getVMagnitude(const StelCore* core) const;
+	virtual float computeVMagnitude(const Vec3d& observerHelioPos, const Vec3d& planetHelioPos,
+					const Vec3d& parentHelioPos, double jd, bool fromEarth) const;
 
 	//! \brief sets absolute magnitude and slope parameter.
 	//! These are the parameters in the IAU's two-parameter magnitude system
@@ -0,0 +1,175 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "EphemerisCache.hpp"
+#include "stellplanet.h"
+
+#include <cmath>
+#include <limits>
+
+const double EphemerisCache::MaxRelativeError = 2e-8;
+
+EphemerisCache::EphemerisCache(posFuncType func, double period)
+	: func(func),
+	  segmentLength(std::fabs(period)/SegmentsPerPeriod),
+	  segments(MaxSegments),
+	  context(new EphemerisContext),
+	  missedSegment(0),
+	  missedCalls(0),
+	  fitAfterCalls(MinFitAfterCalls),
+	  hitsSinceFit(0),
+	  fitTime(0),
+	  directTime(0),
+	  cachedEvaluations(0),
+	  seriesEvaluations(0),
+	  rejectedSegments(0),
+	  skippedFits(0)
+{
+	Q_ASSERT(segmentLength>0.);
+	InitEphemerisContext(context);
+}
+
+EphemerisCache::~EphemerisCache()
+{
+	delete context;
+	context = NULL;
+}
+
+void EphemerisCache::computePosition(double jd, double xyz[3])
+{
+	const double index = std::floor(jd/segmentLength);
+	const qint64 key = (qint64)index;
+	Segment* segment = segments.object(key);
+	if (!segment)
+	{
+		if (key!=missedSegment)
+		{
+			missedSegment = key;
+			missedCalls = 0;
+			directTime = std::numeric_limits<qint64>::max();
+		}
+		if (++missedCalls<fitAfterCalls)
+		{
+			// The date may leave the segment before the fit pays off
+			++skippedFits;
+			++seriesEvaluations;
+			timer.start();
+			func(jd, xyz, NULL);
+			directTime = qMin(directTime, timer.nsecsElapsed());
+			return;
+		}
+		missedCalls = 0;
+		// Wait longer before the next fit if the previous one did not pay off
+		if (fitTime>0)
+		{
+			if ((double)hitsSinceFit*directTime<2.*fitTime)
+				fitAfterCalls = qMin(2*fitAfterCalls, (int)MaxFitAfterCalls);
+			else
+				fitAfterCalls = qMax(fitAfterCalls/2, (int)MinFitAfterCalls);
+		}
+		hitsSinceFit = 0;
+		timer.start();
+		segment = fitSegment(index*segmentLength);
+		fitTime = qMax(timer.nsecsElapsed(), (qint64)1);
+		segments.insert(key, segment);
+	}
+	if (!segment->valid)
+	{
+		// Same as without cache
+		++seriesEvaluations;
+		func(jd, xyz, NULL);
+		return;
+	}
+	++cachedEvaluations;
+	++hitsSinceFit;
+	evaluate(segment, 2.*(jd/segmentLength-index)-1., xyz);
+}
+
+EphemerisCache::Segment* EphemerisCache::fitSegment(double start)
+{
+	const int n = NbCoefficients;
+	const double half = 0.5*segmentLength;
+	const double mid = start+half;
+	Segment* segment = new Segment;
+
+	// Values at the Chebyshev nodes x_k = cos(pi*(k+1/2)/n)
+	double values[NbCoefficients][3];
+	for (int k=0;k<n;++k)
+		computeSeries(mid+half*std::cos(M_PI*(k+0.5)/n), values[k]);
+	for (int c=0;c<3;++c)
+	{
+		for (int j=0;j<n;++j)
+		{
+			double sum = 0.;
+			for (int k=0;k<n;++k)
+				sum += values[k][c]*std::cos(M_PI*j*(k+0.5)/n);
+			segment->coefficients[c][j] = sum*2./n;
+		}
+		segment->coefficients[c][0] *= 0.5;
+	}
+
+	// Check between the nodes, where the interpolation error is the largest
+	static const int checks[4] = {0, n/3, (2*n)/3, n-2};
+	segment->valid = true;
+	for (int i=0;i<4;++i)
+	{
+		const double x = std::cos(M_PI*(checks[i]+1.)/n);
+		double expected[3], actual[3];
+		computeSeries(mid+half*x, expected);
+		evaluate(segment, x, actual);
+		const double dx = actual[0]-expected[0];
+		const double dy = actual[1]-expected[1];
+		const double dz = actual[2]-expected[2];
+		const double r2 = expected[0]*expected[0]+expected[1]*expected[1]+expected[2]*expected[2];
+		if (dx*dx+dy*dy+dz*dz > MaxRelativeError*MaxRelativeError*r2)
+		{
+			segment->valid = false;
+			++rejectedSegments;
+			break;
+		}
+	}
+	return segment;
+}
+
+void EphemerisCache::computeSeries(double jd, double xyz[3])
+{
+	// A fresh context evaluates the series at jd instead of interpolating
+	// the elements between earlier dates.
+	InitEphemerisContext(context);
+	func(jd, xyz, context);
+	++seriesEvaluations;
+}
+
+void EphemerisCache::evaluate(const Segment* segment, double x, double xyz[3])
+{
+	// Clenshaw recurrence
+	const double x2 = 2.*x;
+	for (int c=0;c<3;++c)
+	{
+		const double* coef = segment->coefficients[c];
+		double b1 = 0., b2 = 0.;
+		for (int j=NbCoefficients-1;j>=1;--j)
+		{
+			const double b = x2*b1-b2+coef[j];
+			b2 = b1;
+			b1 = b;
+		}
+		xyz[c] = x*b1-b2+coef[0];
+	}
+}
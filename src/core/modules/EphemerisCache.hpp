@@ -0,0 +1,147 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _EPHEMERISCACHE_HPP_
+#define _EPHEMERISCACHE_HPP_
+
+#include "Planet.hpp"
+
+#include <QCache>
+#include <QElapsedTimer>
+
+struct EphemerisContext;
+
+//! @class EphemerisCache
+//! Approximates the positions given by an analytical theory (VSOP87, ELP82B, L1...)
+//! by Chebyshev polynomials.
+//! The time is split in segments of 1/SegmentsPerPeriod of the orbital period
+//! of the body. When dates inside a segment are requested, the series is evaluated
+//! at the Chebyshev nodes of the segment and the coefficients are stored. Later
+//! dates inside the segment are then computed with a few multiply-adds instead of
+//! the series. Only the MaxSegments most recently used segments are kept,
+//! so that the cache follows the current date.
+//!
+//! The series is evaluated without the linear interpolation of the elements the
+//! position functions normally use, so the fit does not depend on earlier dates.
+//! After fitting, each segment is checked against the series at 4 dates between
+//! the nodes. If the error exceeds MaxRelativeError times the distance of the body
+//! to its parent, the segment is rejected and the series is used for all dates
+//! inside it. Over many periods, the largest errors measured against the series
+//! are about 1e-10 for the planets and the Moon, 3e-9 for Io and 1.6e-8 for Phobos.
+//! The linear interpolation of the elements alone causes larger differences.
+//!
+//! A fit costs FitCost evaluations of the series without interpolation, which can be
+//! hundreds of times slower than the interpolated ones of the position functions, so
+//! it only pays off if many dates fall inside the segment. A segment is only fitted
+//! once getFitAfterCalls() successive dates fell inside it, and the position function
+//! is used directly until then. This number is doubled, up to MaxFitAfterCalls, when
+//! the positions computed from the polynomials since the previous fit would have cost
+//! less than twice the time of that fit with the position function, and halved
+//! otherwise. The time of the position function is the fastest of the successive
+//! dates inside the segment before it is fitted, i.e. with the interpolation of the
+//! elements, which favours the position function. E.g. for the short-period moons at
+//! high time rates, the date soon leaves the segments before they are fitted, and the
+//! cost is about the same as without cache.
+//!
+//! The cache is not thread safe.
+class EphemerisCache
+{
+public:
+	//! Create a cache for a body.
+	//! @param func the position function of the body. Its user data pointer must be
+	//! unused, i.e. it must be one of the get_*_coordsv() functions of stellplanet.h.
+	//! @param period the orbital period of the body in days.
+	EphemerisCache(posFuncType func, double period);
+	~EphemerisCache();
+
+	//! Compute the position at the given date, in the frame of the position function.
+	void computePosition(double jd, double xyz[3]);
+
+	//! Get the position function of the body.
+	posFuncType getFunction() const {return func;}
+	//! Get the orbital period of the body in days.
+	double getPeriod() const {return segmentLength*SegmentsPerPeriod;}
+	//! Get the length of the segments in days.
+	double getSegmentLength() const {return segmentLength;}
+	//! Get the number of positions computed from the polynomials.
+	quint64 getCachedEvaluations() const {return cachedEvaluations;}
+	//! Get the number of positions computed from the series, including the fits.
+	quint64 getSeriesEvaluations() const {return seriesEvaluations;}
+	//! Get the number of segments which did not pass the error check.
+	int getRejectedSegments() const {return rejectedSegments;}
+	//! Get the number of dates outside of the cached segments for which the segment was
+	//! not fitted yet.
+	quint64 getSkippedFits() const {return skippedFits;}
+	//! Get the current number of successive dates inside a segment before it is fitted.
+	int getFitAfterCalls() const {return fitAfterCalls;}
+
+	//! Number of segments per orbital period.
+	static const int SegmentsPerPeriod = 32;
+	//! Number of Chebyshev coefficients per coordinate.
+	static const int NbCoefficients = 14;
+	//! Number of evaluations of the series for fitting and checking a segment.
+	static const int FitCost = NbCoefficients+4;
+	//! Bounds of the number of successive dates inside a segment before it is fitted.
+	static const int MinFitAfterCalls = 4;
+	static const int MaxFitAfterCalls = 65536;
+	//! Number of segments kept in memory.
+	static const int MaxSegments = 64;
+	//! Maximum error of a cached position relative to the distance to the parent body.
+	static const double MaxRelativeError;
+
+private:
+	struct Segment
+	{
+		//! Whether the polynomials passed the error check.
+		bool valid;
+		double coefficients[3][NbCoefficients];
+	};
+
+	//! Fit the segment starting at the given date.
+	Segment* fitSegment(double start);
+	//! Evaluate the series at the given date, without interpolation.
+	void computeSeries(double jd, double xyz[3]);
+	//! Evaluate the polynomials of a segment at x in [-1, 1].
+	static void evaluate(const Segment* segment, double x, double xyz[3]);
+
+	posFuncType func;
+	double segmentLength;
+	//! Fitted segments by index, i.e. floor(jd/segmentLength).
+	QCache<qint64, Segment> segments;
+	//! Interpolation caches used when evaluating the series.
+	EphemerisContext* context;
+	//! Index of the last segment which was not fitted, and number of successive dates inside it.
+	qint64 missedSegment;
+	int missedCalls;
+	int fitAfterCalls;
+	//! Number of positions computed from the polynomials since the last fit.
+	quint64 hitsSinceFit;
+	//! Time of the last fit in ns, 0 before the first one.
+	qint64 fitTime;
+	//! Fastest call of the position function inside the last segment which was not fitted, in ns.
+	qint64 directTime;
+	QElapsedTimer timer;
+
+	quint64 cachedEvaluations;
+	quint64 seriesEvaluations;
+	int rejectedSegments;
+	quint64 skippedFits;
+};
+
+#endif // _EPHEMERISCACHE_HPP_
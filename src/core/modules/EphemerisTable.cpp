@@ -0,0 +1,198 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "EphemerisTable.hpp"
+#include "SolarSystem.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelObjectMgr.hpp"
+#include "StelSkyDrawer.hpp"
+#include "StelUtils.hpp"
+#include "stellplanet.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <cmath>
+
+//! Range of dates computed by a worker thread.
+struct EphemerisTable::Job
+{
+	const EphemerisTable* table;
+	int begin;
+	int end;
+	Ephemeris* entries;
+};
+
+EphemerisTable::EphemerisTable(const StelCore* core, const QStringList& objectNames)
+	: core(core),
+	  longitude(core->getCurrentLocation().longitude),
+	  latitude(qBound(-90., (double)core->getCurrentLocation().latitude, 90.)),
+	  distanceFromCenter(0.),
+	  onEarth(false),
+	  flagLightTravelTime(false),
+	  refraction(core->getSkyDrawer()->getRefraction()),
+	  extinction(core->getSkyDrawer()->getExtinction())
+{
+	const SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	flagLightTravelTime = ssystem->getFlagLightTravelTime();
+	// The planet of the location rather than the home planet of the core, which is not a real
+	// planet while the observer travels between planets
+	const StelLocation& loc = core->getCurrentLocation();
+	homePlanet = ssystem->searchByEnglishName(loc.planetName);
+	if (!homePlanet)
+		homePlanet = ssystem->getEarth();
+	distanceFromCenter = homePlanet->getRadius() + loc.altitude/(1000*AU);
+	onEarth = homePlanet->getEnglishName()=="Earth";
+
+	const StelObjectMgr* omgr = GETSTELMODULE(StelObjectMgr);
+	foreach (const QString& name, objectNames)
+	{
+		StelObjectP obj = omgr->searchByName(name);
+		if (!obj)
+		{
+			unknownNames.append(name);
+			continue;
+		}
+		Target t;
+		t.planet = qSharedPointerDynamicCast<Planet>(obj);
+		if (!t.planet)
+		{
+			t.j2000Pos = obj->getJ2000EquatorialPos(core);
+			t.j2000Pos.normalize();
+			t.vmag = obj->getVMagnitude(core);
+		}
+		else
+			t.vmag = 0.f;
+		targets.append(t);
+		names.append(name);
+	}
+}
+
+bool EphemerisTable::compute(double jdStart, double jdEnd, double step)
+{
+	dates.clear();
+	entries.clear();
+	if (!(step>0.) || !(jdEnd>=jdStart))
+		return false;
+	// The small margin keeps jdEnd when the range is a multiple of the step
+	const double nbSteps = std::floor((jdEnd-jdStart)/step + 1e-9);
+	if ((nbSteps+1.)*qMax(1, targets.size()) > MaxEntries)
+		return false;
+	const int nbDates = (int)nbSteps+1;
+	dates.resize(nbDates);
+	for (int i=0;i<nbDates;++i)
+		dates[i] = jdStart+i*step;
+	entries.resize(nbDates*targets.size());
+	if (targets.isEmpty())
+		return true;
+
+	// Contiguous ranges of dates, so that each job reuses the interpolation caches of the theories
+	const int nbJobs = qMax(1, qMin(nbDates/16, QThread::idealThreadCount()));
+	QVector<Job> jobs(nbJobs);
+	for (int j=0;j<nbJobs;++j)
+	{
+		Job& job = jobs[j];
+		job.table = this;
+		job.begin = (qint64)nbDates*j/nbJobs;
+		job.end = (qint64)nbDates*(j+1)/nbJobs;
+		job.entries = entries.data();
+	}
+	if (nbJobs>1)
+		QtConcurrent::blockingMap(jobs, runJob);
+	else
+		runJob(jobs[0]);
+	return true;
+}
+
+void EphemerisTable::runJob(Job& job)
+{
+	EphemerisContext ctx;
+	InitEphemerisContext(&ctx);
+	const EphemerisTable* t = job.table;
+	const int nbDates = t->dates.size();
+	const int nbObjects = t->targets.size();
+	Frame frame;
+	for (int d=job.begin;d<job.end;++d)
+	{
+		t->computeFrame(t->dates.at(d), &ctx, frame);
+		for (int i=0;i<nbObjects;++i)
+			t->computeEphemeris(i, frame, &ctx, job.entries[i*nbDates+d]);
+	}
+}
+
+void EphemerisTable::computeFrame(double jd, EphemerisContext* ctx, Frame& frame) const
+{
+	// Same as StelObserver::getRotAltAzToEquatorial() and StelCore::updateTransformMatrices()
+	const double deltaT = onEarth ? core->getDeltaT(jd)/240. : 0.;
+	frame.siderealTime = (homePlanet->getSiderealTime(jd)+longitude-deltaT)*M_PI/180.;
+	const Mat4d altAzToEquinoxEqu = Mat4d::zrotation(frame.siderealTime) * Mat4d::yrotation((90.-latitude)*M_PI/180.);
+	const Mat4d equinoxEquToVsop87 = homePlanet->computeRotEquatorialToVsop87(jd);
+	frame.jd = jd;
+	frame.observerPos = homePlanet->computeHeliocentricEclipticPosAt(jd, ctx)
+			+ equinoxEquToVsop87.multiplyWithoutTranslation(altAzToEquinoxEqu.multiplyWithoutTranslation(Vec3d(0., 0., distanceFromCenter)));
+	frame.vsop87ToEquinoxEqu = equinoxEquToVsop87.transpose();
+	frame.vsop87ToAltAz = altAzToEquinoxEqu.transpose() * frame.vsop87ToEquinoxEqu;
+}
+
+void EphemerisTable::computeEphemeris(int object, const Frame& frame, EphemerisContext* ctx, Ephemeris& e) const
+{
+	const Target& t = targets.at(object);
+	// Position relative to the observer in the heliocentric ecliptic frame
+	Vec3d pos;
+	if (t.planet)
+	{
+		double jd = frame.jd;
+		Vec3d helioPos = t.planet->computeHeliocentricEclipticPosAt(jd, ctx);
+		if (flagLightTravelTime)
+		{
+			// Same correction as SolarSystem::computePositions()
+			jd -= (helioPos-frame.observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
+			helioPos = t.planet->computeHeliocentricEclipticPosAt(jd, ctx);
+		}
+		pos = helioPos - frame.observerPos;
+		e.distance = pos.length();
+		const PlanetP parent = t.planet->getParent();
+		const Vec3d parentHelioPos = parent ? parent->computeHeliocentricEclipticPosAt(jd, ctx) : Vec3d(0.);
+		e.vmag = t.planet->computeVMagnitude(frame.observerPos, helioPos, parentHelioPos, frame.jd, onEarth);
+	}
+	else
+	{
+		pos = StelCore::matJ2000ToVsop87.multiplyWithoutTranslation(t.j2000Pos);
+		e.distance = 0.;
+		e.vmag = t.vmag;
+	}
+
+	e.pos = pos;
+	StelUtils::rectToSphe(&e.ra, &e.dec, frame.vsop87ToEquinoxEqu.multiplyWithoutTranslation(pos));
+	Vec3d altAz = frame.vsop87ToAltAz.multiplyWithoutTranslation(pos);
+	altAz.normalize();
+	StelUtils::rectToSphe(&e.azimuthGeometric, &e.altitudeGeometric, altAz);
+	e.vmagExtincted = e.vmag;
+	extinction.forward(altAz, &e.vmagExtincted);
+	refraction.forward(altAz);
+	StelUtils::rectToSphe(&e.azimuth, &e.altitude, altAz);
+
+	// The Sun is at the origin
+	const Vec3d sun = -frame.observerPos;
+	const double norms = pos.length()*sun.length();
+	e.elongation = norms>0. ? std::acos(qBound(-1., pos*sun/norms, 1.)) : 0.;
+}
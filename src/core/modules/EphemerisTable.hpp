@@ -0,0 +1,142 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef _EPHEMERISTABLE_HPP_
+#define _EPHEMERISTABLE_HPP_
+
+#include "Planet.hpp"
+#include "RefractionExtinction.hpp"
+#include "VecMath.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class StelCore;
+struct EphemerisContext;
+
+//! @class EphemerisTable
+//! Positions and magnitudes of a list of objects over a range of dates, as seen by the current observer.
+//! The observer location, the atmosphere and the objects are captured when the table is created. The
+//! dates are then computed in parallel by worker threads, from the position functions of the solar
+//! system bodies, without changing the date of the core nor the state of the planets and the GUI.
+//! The results follow the conventions of StelMainScriptAPI::getObjectInfo().
+//!
+//! The objects which are not solar system bodies, e.g. stars and nebulae, keep the J2000 position and
+//! magnitude they have when the table is created.
+class EphemerisTable
+{
+public:
+	//! Position and magnitude of an object at a date. Angles are in radians.
+	struct Ephemeris
+	{
+		//! Right ascension and declination in the equatorial frame of date.
+		double ra, dec;
+		//! Azimuth and altitude with refraction, as returned by StelUtils::rectToSphe().
+		double azimuth, altitude;
+		//! Azimuth and altitude without refraction.
+		double azimuthGeometric, altitudeGeometric;
+		//! Angular distance to the Sun.
+		double elongation;
+		//! Distance to the observer in AU, 0 for the objects outside the solar system.
+		double distance;
+		//! Position relative to the observer in the heliocentric ecliptic frame, in AU. It is a unit
+		//! vector for the objects outside the solar system.
+		Vec3d pos;
+		float vmag;
+		//! Magnitude with the extinction at the geometric altitude.
+		float vmagExtincted;
+	};
+
+	//! Frame of the observer at a date.
+	struct Frame
+	{
+		double jd;
+		//! Local apparent sidereal time in radians.
+		double siderealTime;
+		//! Heliocentric ecliptic position of the observer in AU.
+		Vec3d observerPos;
+		//! Rotations from the heliocentric ecliptic frame to the equatorial frame of date and to the
+		//! horizontal frame of the observer.
+		Mat4d vsop87ToEquinoxEqu;
+		Mat4d vsop87ToAltAz;
+	};
+
+	//! Capture the current observer and the objects.
+	//! @param names the English names of the objects, as accepted by StelObjectMgr::searchByName().
+	EphemerisTable(const StelCore* core, const QStringList& names);
+
+	//! Get the names of the objects of the table, i.e. the names given to the constructor which were found.
+	const QStringList& getNames() const {return names;}
+	//! Get the names given to the constructor which were not found.
+	const QStringList& getUnknownNames() const {return unknownNames;}
+	int getNbObjects() const {return targets.size();}
+	//! Get the solar system body of an object, or NULL for the objects outside the solar system.
+	PlanetP getPlanet(int object) const {return targets.at(object).planet;}
+
+	//! Compute the ephemerides of all the objects every step days from jdStart to jdEnd included.
+	//! @return false if the range is invalid, or if the table would have more than MaxEntries entries.
+	bool compute(double jdStart, double jdEnd, double step);
+	//! Get the dates of the last compute().
+	const QVector<double>& getDates() const {return dates;}
+	//! Get the ephemeris of an object at a date of the last compute().
+	const Ephemeris& at(int object, int date) const {return entries[object*dates.size()+date];}
+
+	//! Compute the frame of the observer at any date.
+	//! This and computeEphemeris() are thread safe as long as each thread uses its own context.
+	void computeFrame(double jd, EphemerisContext* ctx, Frame& frame) const;
+	//! Compute the ephemeris of an object in a frame of the observer.
+	void computeEphemeris(int object, const Frame& frame, EphemerisContext* ctx, Ephemeris& e) const;
+
+	//! Maximum number of entries, i.e. objects times dates, of a table.
+	static const int MaxEntries = 10000000;
+
+private:
+	struct Target
+	{
+		//! NULL for the objects outside the solar system.
+		PlanetP planet;
+		//! J2000 direction and magnitude of the objects outside the solar system.
+		Vec3d j2000Pos;
+		float vmag;
+	};
+	struct Job;
+	static void runJob(Job& job);
+
+	const StelCore* core;
+	QStringList names;
+	QStringList unknownNames;
+	QVector<Target> targets;
+
+	PlanetP homePlanet;
+	double longitude, latitude;
+	//! Distance of the observer to the center of the home planet in AU.
+	double distanceFromCenter;
+	bool onEarth;
+	bool flagLightTravelTime;
+	Refraction refraction;
+	Extinction extinction;
+
+	QVector<double> dates;
+	//! Object major, see at().
+	QVector<Ephemeris> entries;
+};
+
+#endif // _EPHEMERISTABLE_HPP_
@@ -0,0 +1,545 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "EventSearch.hpp"
+#include "SolarSystem.hpp"
+#include "StelApp.hpp"
+#include "StelModuleMgr.hpp"
+#include "stellplanet.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Steps between the samples in days. The rises, transits and sets need the altitude every hour.
+static const double HORIZON_STEP = 1./24.;
+static const double STEP = 0.5;
+// Length of the range of dates searched by a job, in days
+static const double CHUNK_LENGTH = 30.;
+// Precision of the dates of the events, in days
+static const double TOLERANCE = 1e-5;
+// Half width of the range searched for the maximum of an occultation or an eclipse around a
+// conjunction or an opposition, in days. Even for the Moon, the maximum is less than a few hours away.
+static const double MAXIMUM_WINDOW = 0.25;
+// Step of the numerical derivatives, in days
+static const double DERIVATIVE_STEP = 1e-4;
+// Enlargement of the shadow of the Earth by its atmosphere
+static const double SHADOW_ENLARGEMENT = 1.02;
+
+// Searches started and not destroyed yet, only used from the main thread
+static QList<EventSearch*> activeSearches;
+
+namespace
+{
+	// Root of f between a and b, where f has the values fa and fb of opposite signs, by Brent's method.
+	// Steps of inverse quadratic interpolation or secant are taken when they stay inside the bracket
+	// and converge fast enough, else bisection steps.
+	template<class F> double findRoot(F& f, double a, double b, double fa, double fb)
+	{
+		double c = a, fc = fa;
+		double d = b-a, e = d;
+		for (int i=0;i<100;++i)
+		{
+			if ((fb>0.)==(fc>0.))
+			{
+				c = a;
+				fc = fa;
+				d = e = b-a;
+			}
+			if (std::fabs(fc)<std::fabs(fb))
+			{
+				a = b;
+				b = c;
+				c = a;
+				fa = fb;
+				fb = fc;
+				fc = fa;
+			}
+			const double tol = 2.*DBL_EPSILON*std::fabs(b) + 0.5*TOLERANCE;
+			const double m = 0.5*(c-b);
+			if (std::fabs(m)<=tol || fb==0.)
+				return b;
+			if (std::fabs(e)>=tol && std::fabs(fa)>std::fabs(fb))
+			{
+				const double s = fb/fa;
+				double p, q;
+				if (a==c)
+				{
+					// Secant
+					p = 2.*m*s;
+					q = 1.-s;
+				}
+				else
+				{
+					// Inverse quadratic interpolation
+					const double r = fb/fc;
+					q = fa/fc;
+					p = s*(2.*m*q*(q-r)-(b-a)*(r-1.));
+					q = (q-1.)*(r-1.)*(s-1.);
+				}
+				if (p>0.)
+					q = -q;
+				else
+					p = -p;
+				if (2.*p<qMin(3.*m*q-std::fabs(tol*q), std::fabs(e*q)))
+				{
+					e = d;
+					d = p/q;
+				}
+				else
+				{
+					d = m;
+					e = m;
+				}
+			}
+			else
+			{
+				d = m;
+				e = m;
+			}
+			a = b;
+			fa = fb;
+			b += std::fabs(d)>tol ? d : (m>0. ? tol : -tol);
+			fb = f(b);
+		}
+		return b;
+	}
+
+	// Angle between 2 vectors, accurate for small angles
+	double angle(const Vec3d& a, const Vec3d& b)
+	{
+		return std::atan2((a^b).length(), a*b);
+	}
+
+	double eclipticLongitude(const Vec3d& pos)
+	{
+		return std::atan2(pos[1], pos[0]);
+	}
+
+	EventSearch::Event makeEvent(EventSearch::EventType type, double jd, int object, int object2, double value)
+	{
+		EventSearch::Event event;
+		event.type = type;
+		event.jd = jd;
+		event.object = object;
+		event.object2 = object2;
+		event.value = value;
+		return event;
+	}
+
+	bool eventLessThan(const EventSearch::Event& a, const EventSearch::Event& b)
+	{
+		return a.jd<b.jd;
+	}
+}
+
+//! Function of the date whose roots are events.
+class EventSearch::Function
+{
+public:
+	enum Kind
+	{
+		//! Altitude of the upper limb.
+		Horizon,
+		//! Sine of the hour angle.
+		HourAngle,
+		//! Sine of the difference of right ascension.
+		RightAscension,
+		//! Sine of the difference of ecliptic longitude.
+		Longitude,
+		//! Derivative of the angular distance.
+		SeparationRate,
+		//! Derivative of the distance of the Moon to the axis of the shadow of the Earth.
+		ShadowRate
+	};
+
+	Function(const EventSearch* search, Kind kind, int object1, int object2, EphemerisContext* ctx)
+		: search(search), kind(kind), object1(object1), object2(object2), ctx(ctx)
+	{
+	}
+
+	double operator()(double jd)
+	{
+		switch (kind)
+		{
+			case Horizon:
+				compute(jd);
+				return e1.altitude + search->getAngularRadius(object1, e1);
+			case HourAngle:
+				compute(jd);
+				return std::sin(frame.siderealTime-e1.ra);
+			case RightAscension:
+				compute(jd);
+				return std::sin(e1.ra-e2.ra);
+			case Longitude:
+				compute(jd);
+				return std::sin(eclipticLongitude(e1.pos)-eclipticLongitude(e2.pos));
+			case SeparationRate:
+			{
+				compute(jd+DERIVATIVE_STEP);
+				const double after = angle(e1.pos, e2.pos);
+				compute(jd-DERIVATIVE_STEP);
+				return (after-angle(e1.pos, e2.pos))/(2.*DERIVATIVE_STEP);
+			}
+			case ShadowRate:
+				return (shadowDistance(jd+DERIVATIVE_STEP)-shadowDistance(jd-DERIVATIVE_STEP))/(2.*DERIVATIVE_STEP);
+		}
+		return 0.;
+	}
+
+	//! Compute the ephemerides of the objects at a date.
+	void compute(double jd)
+	{
+		search->table.computeFrame(jd, ctx, frame);
+		search->table.computeEphemeris(object1, frame, ctx, e1);
+		if (object2>=0)
+			search->table.computeEphemeris(object2, frame, ctx, e2);
+	}
+
+	//! Compute the distance of the center of the Moon to the axis of the shadow of the Earth in AU.
+	//! @param along if not NULL, receives the distance of the Moon to the Earth along the axis.
+	double shadowDistance(double jd, double* along=NULL)
+	{
+		Vec3d axis = search->earth->computeHeliocentricEclipticPosAt(jd, ctx);
+		axis.normalize();
+		Vec3d moonPos;
+		search->moon->computePositionAt(jd, moonPos, ctx);
+		const double a = moonPos*axis;
+		if (along)
+			*along = a;
+		return (moonPos-axis*a).length();
+	}
+
+	EphemerisTable::Frame frame;
+	EphemerisTable::Ephemeris e1;
+	EphemerisTable::Ephemeris e2;
+
+private:
+	const EventSearch* search;
+	Kind kind;
+	int object1;
+	int object2;
+	EphemerisContext* ctx;
+};
+
+EventSearch::EventSearch(const StelCore* core, const QStringList& names)
+	: table(core, QStringList(names) << "Sun" << "Moon"),
+	  nbObjects(table.getNbObjects()),
+	  sunIndex(-1),
+	  moonIndex(-1),
+	  canceled(0)
+{
+	const SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	earth = ssystem->getEarth();
+	moon = ssystem->getMoon();
+	const QStringList& found = table.getNames();
+	if (nbObjects>=2 && found.at(nbObjects-2)=="Sun" && found.at(nbObjects-1)=="Moon" && earth && moon)
+	{
+		nbObjects -= 2;
+		sunIndex = nbObjects;
+		moonIndex = nbObjects+1;
+	}
+}
+
+EventSearch::~EventSearch()
+{
+	cancel();
+	waitForFinished();
+	activeSearches.removeOne(this);
+}
+
+void EventSearch::start(double jdStart, double jdEnd, EventTypes eventTypes)
+{
+	cancel();
+	waitForFinished();
+	canceled.store(0);
+	types = eventTypes;
+	if (sunIndex<0)
+		types &= ~EventTypes(Opposition | SolarEclipse | LunarEclipse);
+
+	jobs.clear();
+	for (double begin=jdStart;begin<jdEnd;begin+=CHUNK_LENGTH)
+	{
+		Job job;
+		job.search = this;
+		job.begin = begin;
+		job.end = qMin(begin+CHUNK_LENGTH, jdEnd);
+		jobs.append(job);
+	}
+	future = QtConcurrent::map(jobs, runJob);
+	if (!activeSearches.contains(this))
+		activeSearches.append(this);
+}
+
+void EventSearch::waitForFinished()
+{
+	future.waitForFinished();
+}
+
+void EventSearch::cancelAll()
+{
+	foreach (EventSearch* search, activeSearches)
+	{
+		search->cancel();
+		search->waitForFinished();
+	}
+}
+
+void EventSearch::cancel()
+{
+	canceled.store(1);
+	// The jobs which are not started yet are dropped, the running ones stop at their next sample
+	future.cancel();
+}
+
+QVector<EventSearch::Event> EventSearch::getEvents()
+{
+	waitForFinished();
+	QVector<Event> events;
+	foreach (const Job& job, jobs)
+		events += job.events;
+	// The maxima of the occultations and eclipses may be slightly outside of their chunk
+	std::stable_sort(events.begin(), events.end(), eventLessThan);
+	return events;
+}
+
+QVector<EventSearch::Event> EventSearch::search(double jdStart, double jdEnd, EventTypes eventTypes)
+{
+	start(jdStart, jdEnd, eventTypes);
+	return getEvents();
+}
+
+void EventSearch::runJob(Job& job)
+{
+	const EventSearch* s = job.search;
+	EphemerisContext ctx;
+	InitEphemerisContext(&ctx);
+	const double step = (s->types & (Rise | Transit | Set)) ? HORIZON_STEP : STEP;
+	const int nbSteps = qMax(1, (int)std::ceil((job.end-job.begin)/step - 1e-9));
+	Sample s0, s1;
+	s->computeSample(job.begin, &ctx, s0);
+	for (int i=1;i<=nbSteps && !s->isCanceled();++i)
+	{
+		s->computeSample(i==nbSteps ? job.end : job.begin+i*step, &ctx, s1);
+		s->searchInterval(s0, s1, &ctx, job.events);
+		qSwap(s0, s1);
+	}
+	std::sort(job.events.begin(), job.events.end(), eventLessThan);
+}
+
+void EventSearch::computeSample(double jd, EphemerisContext* ctx, Sample& sample) const
+{
+	table.computeFrame(jd, ctx, sample.frame);
+	sample.ephemerides.resize(table.getNbObjects());
+	for (int i=0;i<table.getNbObjects();++i)
+		table.computeEphemeris(i, sample.frame, ctx, sample.ephemerides[i]);
+}
+
+double EventSearch::getAngularRadius(int object, const EphemerisTable::Ephemeris& e) const
+{
+	const PlanetP planet = table.getPlanet(object);
+	if (!planet || e.distance<=0.)
+		return 0.;
+	return std::asin(qMin(1., planet->getRadius()/e.distance));
+}
+
+void EventSearch::searchInterval(const Sample& s0, const Sample& s1, EphemerisContext* ctx, QVector<Event>& events) const
+{
+	const double jd0 = s0.frame.jd;
+	const double jd1 = s1.frame.jd;
+	const QVector<EphemerisTable::Ephemeris>& e0 = s0.ephemerides;
+	const QVector<EphemerisTable::Ephemeris>& e1 = s1.ephemerides;
+
+	for (int i=0;i<nbObjects;++i)
+	{
+		if (types & (Rise | Set))
+		{
+			const double h0 = e0[i].altitude + getAngularRadius(i, e0[i]);
+			const double h1 = e1[i].altitude + getAngularRadius(i, e1[i]);
+			const EventType type = h0<0. ? Rise : Set;
+			if ((h0<0.)!=(h1<0.) && (types & type))
+			{
+				Function f(this, Function::Horizon, i, -1, ctx);
+				const double jd = findRoot(f, jd0, jd1, h0, h1);
+				f.compute(jd);
+				events.append(makeEvent(type, jd, i, -1, f.e1.azimuth));
+			}
+		}
+		if (types & Transit)
+		{
+			// The hour angle increases, the upper culmination is when its sine becomes positive
+			const double h0 = std::sin(s0.frame.siderealTime-e0[i].ra);
+			const double h1 = std::sin(s1.frame.siderealTime-e1[i].ra);
+			if (h0<0. && h1>=0. && std::cos(s1.frame.siderealTime-e1[i].ra)>0.)
+			{
+				Function f(this, Function::HourAngle, i, -1, ctx);
+				const double jd = findRoot(f, jd0, jd1, h0, h1);
+				f.compute(jd);
+				events.append(makeEvent(Transit, jd, i, -1, f.e1.altitude));
+			}
+		}
+		if ((types & Opposition) && table.getPlanet(i) && table.getPlanet(i)!=table.getPlanet(sunIndex))
+		{
+			const double l0 = std::sin(eclipticLongitude(e0[i].pos)-eclipticLongitude(e0[sunIndex].pos));
+			const double l1 = std::sin(eclipticLongitude(e1[i].pos)-eclipticLongitude(e1[sunIndex].pos));
+			if ((l0<0.)!=(l1<0.) && std::cos(eclipticLongitude(e1[i].pos)-eclipticLongitude(e1[sunIndex].pos))<0.)
+			{
+				Function f(this, Function::Longitude, i, sunIndex, ctx);
+				const double jd = findRoot(f, jd0, jd1, l0, l1);
+				f.compute(jd);
+				events.append(makeEvent(Opposition, jd, i, -1, f.e1.elongation));
+			}
+		}
+		if (!(types & (Conjunction | Occultation)))
+			continue;
+		for (int j=i+1;j<nbObjects;++j)
+		{
+			// The objects outside the solar system do not move relative to each other
+			if (!table.getPlanet(i) && !table.getPlanet(j))
+				continue;
+			const double r0 = std::sin(e0[i].ra-e0[j].ra);
+			const double r1 = std::sin(e1[i].ra-e1[j].ra);
+			if ((r0<0.)==(r1<0.) || std::cos(e1[i].ra-e1[j].ra)<0.)
+				continue;
+			Function f(this, Function::RightAscension, i, j, ctx);
+			const double jd = findRoot(f, jd0, jd1, r0, r1);
+			if (types & Conjunction)
+			{
+				f.compute(jd);
+				events.append(makeEvent(Conjunction, jd, i, j, angle(f.e1.pos, f.e2.pos)));
+			}
+			if (types & Occultation)
+				searchOccultation(jd, i, j, Occultation, ctx, events);
+		}
+	}
+
+	if (types & SolarEclipse)
+	{
+		const double r0 = std::sin(e0[moonIndex].ra-e0[sunIndex].ra);
+		const double r1 = std::sin(e1[moonIndex].ra-e1[sunIndex].ra);
+		if ((r0<0.)!=(r1<0.) && std::cos(e1[moonIndex].ra-e1[sunIndex].ra)>0.)
+		{
+			Function f(this, Function::RightAscension, moonIndex, sunIndex, ctx);
+			searchOccultation(findRoot(f, jd0, jd1, r0, r1), moonIndex, sunIndex, SolarEclipse, ctx, events);
+		}
+	}
+	if (types & LunarEclipse)
+	{
+		const double l0 = std::sin(eclipticLongitude(e0[moonIndex].pos)-eclipticLongitude(e0[sunIndex].pos));
+		const double l1 = std::sin(eclipticLongitude(e1[moonIndex].pos)-eclipticLongitude(e1[sunIndex].pos));
+		if ((l0<0.)!=(l1<0.) && std::cos(eclipticLongitude(e1[moonIndex].pos)-eclipticLongitude(e1[sunIndex].pos))<0.)
+		{
+			Function f(this, Function::Longitude, moonIndex, sunIndex, ctx);
+			searchLunarEclipse(findRoot(f, jd0, jd1, l0, l1), ctx, events);
+		}
+	}
+}
+
+void EventSearch::searchOccultation(double jd, int object1, int object2, EventType type, EphemerisContext* ctx, QVector<Event>& events) const
+{
+	// Closest approach, where the angular distance stops decreasing
+	Function f(this, Function::SeparationRate, object1, object2, ctx);
+	const double a = jd-MAXIMUM_WINDOW;
+	const double b = jd+MAXIMUM_WINDOW;
+	const double fa = f(a);
+	const double fb = f(b);
+	if (fa>=0. || fb<0.)
+		return;
+	const double maximum = findRoot(f, a, b, fa, fb);
+	f.compute(maximum);
+	const double separation = angle(f.e1.pos, f.e2.pos);
+	const double radius1 = getAngularRadius(object1, f.e1);
+	const double radius2 = getAngularRadius(object2, f.e2);
+	if (separation>=radius1+radius2)
+		return;
+	if (type==SolarEclipse)
+	{
+		events.append(makeEvent(SolarEclipse, maximum, -1, -1, (radius1+radius2-separation)/(2.*radius2)));
+		return;
+	}
+	// The nearest object occults the other one, the objects outside the solar system are the farthest
+	const bool firstIsNearer = f.e2.distance<=0. || (f.e1.distance>0. && f.e1.distance<f.e2.distance);
+	if (firstIsNearer)
+		events.append(makeEvent(Occultation, maximum, object1, object2, separation));
+	else
+		events.append(makeEvent(Occultation, maximum, object2, object1, separation));
+}
+
+void EventSearch::searchLunarEclipse(double jd, EphemerisContext* ctx, QVector<Event>& events) const
+{
+	// Closest approach of the Moon to the axis of the shadow
+	Function f(this, Function::ShadowRate, -1, -1, ctx);
+	const double a = jd-MAXIMUM_WINDOW;
+	const double b = jd+MAXIMUM_WINDOW;
+	const double fa = f(a);
+	const double fb = f(b);
+	if (fa>=0. || fb<0.)
+		return;
+	const double maximum = findRoot(f, a, b, fa, fb);
+	double along;
+	const double distance = f.shadowDistance(maximum, &along);
+	const double sunRadius = table.getPlanet(sunIndex)->getRadius();
+	const double earthRadius = earth->getRadius();
+	const double moonRadius = moon->getRadius();
+	const double sunDistance = earth->computeHeliocentricEclipticPosAt(maximum, ctx).length();
+	// Radii of the cones of the umbra and the penumbra at the distance of the Moon
+	const double umbra = SHADOW_ENLARGEMENT*(earthRadius - along*(sunRadius-earthRadius)/sunDistance);
+	const double penumbra = SHADOW_ENLARGEMENT*(earthRadius + along*(sunRadius+earthRadius)/sunDistance);
+	if (distance>=penumbra+moonRadius)
+		return;
+	events.append(makeEvent(LunarEclipse, maximum, -1, -1, (umbra+moonRadius-distance)/(2.*moonRadius)));
+}
+
+QString EventSearch::getTypeName(EventType type)
+{
+	switch (type)
+	{
+		case Rise:
+			return "rise";
+		case Transit:
+			return "transit";
+		case Set:
+			return "set";
+		case Conjunction:
+			return "conjunction";
+		case Opposition:
+			return "opposition";
+		case Occultation:
+			return "occultation";
+		case SolarEclipse:
+			return "solar-eclipse";
+		case LunarEclipse:
+			return "lunar-eclipse";
+		default:
+			return QString();
+	}
+}
+
+EventSearch::EventType EventSearch::getType(const QString& name)
+{
+	for (int type=Rise;type<AllEvents;type<<=1)
+	{
+		if (getTypeName((EventType)type)==name)
+			return (EventType)type;
+	}
+	return (EventType)0;
+}
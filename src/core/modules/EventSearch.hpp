@@ -0,0 +1,164 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#ifndef _EVENTSEARCH_HPP_
+#define _EVENTSEARCH_HPP_
+
+#include "EphemerisTable.hpp"
+
+#include <QAtomicInt>
+#include <QFlags>
+#include <QFuture>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class StelCore;
+
+//! @class EventSearch
+//! Search of the rises, transits and sets, conjunctions, oppositions, occultations and eclipses of a
+//! list of objects over a range of dates, as seen by the current observer.
+//! The functions whose roots are the events, e.g. the altitude for the rises and sets, are sampled
+//! with a coarse step using an EphemerisTable. Each change of sign between two samples is then
+//! refined with Brent's method. The maxima of the occultations and eclipses are found as the roots
+//! of the derivative of the distance between the bodies, around the conjunctions and oppositions.
+//!
+//! The range of dates is split into chunks, which are searched by worker threads. The search can be
+//! canceled at any time from the thread which started it. The workers use the orbits of SolarSystem,
+//! so the running searches are canceled by cancelAll() before the Solar System is reloaded.
+class EventSearch
+{
+public:
+	enum EventType
+	{
+		//! The upper limb of the object crosses the horizon, with refraction.
+		Rise		= 0x01,
+		//! Upper culmination, i.e. the hour angle of the object is 0.
+		Transit		= 0x02,
+		Set		= 0x04,
+		//! 2 objects have the same right ascension.
+		Conjunction	= 0x08,
+		//! The ecliptic longitude of a solar system body differs by 180 degrees from the Sun's.
+		Opposition	= 0x10,
+		//! The disk of a solar system body covers at least partly another object.
+		Occultation	= 0x20,
+		//! The Moon covers at least partly the Sun, as seen by the observer.
+		SolarEclipse	= 0x40,
+		//! The Moon enters the penumbra of the Earth.
+		LunarEclipse	= 0x80,
+		AllEvents	= 0xff
+	};
+	typedef QFlags<EventType> EventTypes;
+
+	struct Event
+	{
+		EventType type;
+		double jd;
+		//! Index of the object in getNames(), -1 for the eclipses.
+		int object;
+		//! Index of the second object of conjunctions and occultations, i.e. the occulted one, else -1.
+		int object2;
+		//! Azimuth for the rises and sets, altitude for the transits, angular distance between the
+		//! objects for the conjunctions and occultations, and elongation for the oppositions, in
+		//! radians. Magnitude of the solar eclipses, i.e. the fraction of the diameter of the Sun
+		//! which is covered, and umbral magnitude of the lunar eclipses, which is negative for the
+		//! penumbral eclipses.
+		double value;
+	};
+
+	//! Capture the current observer and the objects, see EphemerisTable.
+	EventSearch(const StelCore* core, const QStringList& names);
+	~EventSearch();
+
+	//! Get the names of the objects which were found.
+	QStringList getNames() const {return table.getNames().mid(0, nbObjects);}
+	//! Get the names which were not found.
+	const QStringList& getUnknownNames() const {return table.getUnknownNames();}
+
+	//! Start searching the events from jdStart to jdEnd on worker threads.
+	//! The eclipses do not depend on the list of objects.
+	void start(double jdStart, double jdEnd, EventTypes types);
+	bool isFinished() const {return future.isFinished();}
+	void waitForFinished();
+	//! Stop the search as soon as possible. The events found meanwhile are kept.
+	void cancel();
+	bool isCanceled() const {return canceled.load()!=0;}
+	//! Get the future of the search, e.g. to be notified by a QFutureWatcher when it is finished.
+	QFuture<void> getFuture() const {return future;}
+	//! Get the events by date. It waits for the end of the search.
+	QVector<Event> getEvents();
+
+	//! Search the events and wait for the result.
+	QVector<Event> search(double jdStart, double jdEnd, EventTypes types);
+
+	//! Cancel all the searches and wait for their workers, which must be done before the orbits of
+	//! the solar system bodies are deleted. The events found meanwhile are kept, but the canceled
+	//! searches must not be started again. Must be called from the main thread, like start().
+	static void cancelAll();
+
+	//! Get the name of an event type, as used by the scripts, e.g. "solar-eclipse".
+	static QString getTypeName(EventType type);
+	//! Get the event type of a name, or 0 if the name is unknown.
+	static EventType getType(const QString& name);
+
+private:
+	//! Chunk of the range of dates searched by a worker thread.
+	struct Job
+	{
+		const EventSearch* search;
+		double begin;
+		double end;
+		QVector<Event> events;
+	};
+	//! Ephemerides of all the objects of the table at a date.
+	struct Sample
+	{
+		EphemerisTable::Frame frame;
+		QVector<EphemerisTable::Ephemeris> ephemerides;
+	};
+	class Function;
+	static void runJob(Job& job);
+	void computeSample(double jd, EphemerisContext* ctx, Sample& sample) const;
+	//! Look for the events between 2 consecutive samples.
+	void searchInterval(const Sample& s0, const Sample& s1, EphemerisContext* ctx, QVector<Event>& events) const;
+	//! Look for an occultation of 2 objects, or a solar eclipse, around a conjunction.
+	void searchOccultation(double jd, int object1, int object2, EventType type, EphemerisContext* ctx, QVector<Event>& events) const;
+	//! Look for a lunar eclipse around a full Moon.
+	void searchLunarEclipse(double jd, EphemerisContext* ctx, QVector<Event>& events) const;
+	//! Get the angular radius of an object in radians, 0 for the objects outside the solar system.
+	double getAngularRadius(int object, const EphemerisTable::Ephemeris& e) const;
+
+	EphemerisTable table;
+	//! Number of objects asked for. The Sun and the Moon follow them in the table.
+	int nbObjects;
+	int sunIndex;
+	int moonIndex;
+	PlanetP earth;
+	PlanetP moon;
+
+	EventTypes types;
+	QVector<Job> jobs;
+	QFuture<void> future;
+	QAtomicInt canceled;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(EventSearch::EventTypes)
+
+#endif // _EVENTSEARCH_HPP_
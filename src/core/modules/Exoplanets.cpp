@@ -178,6 +178,7 @@ void Exoplanets::init()
 	updateTimer->start();
 
 	connect(this, SIGNAL(jsonUpdateComplete(void)), this, SLOT(reloadCatalog()));
+	connect(&StelApp::getInstance(), SIGNAL(languageChanged()), this, SLOT(updateI18n()));
 
 	GETSTELMODULE(StelObjectMgr)->registerStelObjectMgr(this);
 }
@@ -223,12 +224,17 @@ void Exoplanets::drawPointer(StelCore* core, StelPainter& painter)
 	}
 }
 
-QList<StelObjectP> Exoplanets::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
+QList<StelObjectP> Exoplanets::searchAround(const Vec3d& av, double limitFov, const StelCore* core) const
 {
-	QList<StelObjectP> result;
+	StelObjectListVisitor visitor;
+	visitAround(av, limitFov, core, visitor);
+	return visitor.result;
+}
 
+void Exoplanets::visitAround(const Vec3d& av, double limitFov, const StelCore*, StelObjectVisitor& visitor) const
+{
 	if (!flagShowExoplanets)
-		return result;
+		return;
 
 	Vec3d v(av);
 	v.normalize();
@@ -243,12 +249,11 @@ QList<StelObjectP> Exoplanets::searchAround(const Vec3d& av, double limitFov, co
 			equPos.normalize();
 			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
 			{
-				result.append(qSharedPointerCast<StelObject>(eps));
+				if (!visitor.visit(qSharedPointerCast<StelObject>(eps)))
+					return;
 			}
 		}
 	}
-
-	return result;
 }
 
 StelObjectP Exoplanets::searchByName(const QString& englishName) const
@@ -321,80 +326,25 @@ StelObjectP Exoplanets::searchByNameI18n(const QString& nameI18n) const
 
 QStringList Exoplanets::listMatchingObjectsI18n(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
-    QStringList result;
-    bool find;
-
-    QString objw = objPrefix.toUpper();
-
-    if (flagShowExoplanets)
-    {
-        for (const auto&eps : ep)
-        {
-            find = false;
-            if (useStartOfWords)
-            {
-                if (eps->getNameI18n().toUpper().left(objw.length()) == objw)
-                {
-                    find = true;
-                }
-            }
-            else
-            {
-                if (eps->getNameI18n().toUpper().contains(objw, Qt::CaseInsensitive))
-                {
-                    find = true;
-                }
-            }
-            if (find)
-            {
-                result << eps->getNameI18n().toUpper();
-            }
-        }
-    }
-
-    result.sort();
-    if (result.size()>maxNbItem) result.erase(result.begin()+maxNbItem, result.end());
-
-    return result;
+	QStringList result;
+	if (flagShowExoplanets)
+	{
+		// Names match from the start of any word, unless useStartOfWords asks for the start of the name
+		result = nameIndexI18n.listMatching(objPrefix, maxNbItem, !useStartOfWords);
+		result.sort();
+	}
+	return result;
 }
 
 QStringList Exoplanets::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
-    QStringList result;
-    bool find;
-
-    QString objw = objPrefix.toUpper();
-
-    if (flagShowExoplanets)
-    {
-        for (const auto&eps: ep)
-        {
-            find = false;
-            if (useStartOfWords)
-            {
-                if (eps->getEnglishName().toUpper().left(objw.length()) == objw)
-                {
-                    find = true;
-                }
-            }
-            else
-            {
-                if (eps->getEnglishName().toUpper().contains(objw, Qt::CaseInsensitive))
-                {
-                    find = true;
-                }
-            }
-            if (find)
-            {
-                result << eps->getEnglishName().toUpper();
-            }
-        }
-    }
-
-    result.sort();
-    if (result.size()>maxNbItem) result.erase(result.begin()+maxNbItem, result.end());
-
-    return result;
+	QStringList result;
+	if (flagShowExoplanets)
+	{
+		result = nameIndex.listMatching(objPrefix, maxNbItem, !useStartOfWords);
+		result.sort();
+	}
+	return result;
 }
 
 QStringList Exoplanets::listAllObjects(bool inEnglish) const
@@ -600,6 +550,26 @@ void Exoplanets::setEPMap(const QVariantMap& map)
 			EPCountPH += eps->getCountHabitableExoplanets();
 		}
 	}
+
+	nameIndex.clear();
+	for (int i=0;i<ep.size();++i)
+	{
+		const QString name = ep.at(i)->getEnglishName().toUpper();
+		nameIndex.insert(name, name);
+	}
+	nameIndex.build();
+	updateI18n();
+}
+
+void Exoplanets::updateI18n(void)
+{
+	nameIndexI18n.clear();
+	for (const auto& eps : ep)
+	{
+		const QString name = eps->getNameI18n().toUpper();
+		nameIndexI18n.insert(name, name);
+	}
+	nameIndexI18n.build();
 }
 
 int Exoplanets::getJsonFileFormatVersion(void) const
@@ -22,6 +22,7 @@
 #include "StelObjectModule.hpp"
 #include "StelObject.hpp"
 #include "StelFader.hpp"
+#include "StelNameIndex.hpp"
 #include "StelTextureTypes.hpp"
 #include "Exoplanet.hpp"
 #include <QFont>
@@ -126,6 +127,9 @@ public:
 	//! @return a list containing the exoplanets located inside the limitFov circle around position v.
 	virtual QList<StelObjectP> searchAround(const Vec3d& v, double limitFov, const StelCore* core) const;
 
+	//! Pass the objects which searchAround() would return to a visitor, without building a list.
+	virtual void visitAround(const Vec3d& v, double limitFov, const StelCore* core, StelObjectVisitor& visitor) const;
+
 	//! Return the matching exoplanet system object's pointer if exists or Q_NULLPTR.
 	//! @param nameI18n The case in-sensitive localized exoplanet system name
 	virtual StelObjectP searchByNameI18n(const QString& nameI18n) const;
@@ -422,6 +426,9 @@ private:
 
 	StelTextureSP texPointer;
 	QList<ExoplanetP> ep;
+	//! Uppercase English and translated names for auto-completion.
+	StelNameIndex nameIndex;
+	StelNameIndex nameIndexI18n;
 
 	// variables and functions for the updater
 	UpdateState updateState;
@@ -459,6 +466,9 @@ private slots:
 	void displayMessage(const QString& message, const QString hexColor="#999999");
 
 	void reloadCatalog(void);	
+
+	//! Rebuild the index of the translated names.
+	void updateI18n(void);
 };
 
 #endif /* EXOPLANETS_HPP */
@@ -21,6 +21,7 @@
 #include "StelTranslator.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
+#include "StelLocationMgr.hpp"
 #include "StelModuleMgr.hpp"
 #include "StelQuickView.hpp"
 #include <QDebug>
@@ -68,9 +69,14 @@ void GPSMgr::positionUpdated(const QGeoPositionInfo &info)
 	loc.planetName = "Earth";
 	loc.latitude = info.coordinate().latitude();
 	loc.longitude = info.coordinate().longitude();
-	loc.altitude = info.coordinate().altitude();
-	if (info.coordinate().altitude() == qQNaN())
-		loc.altitude = 0;
+	if (qIsNaN(info.coordinate().altitude()))
+	{
+		// Without a 3D fix, take the altitude of the nearest known location within about 25 km
+		const StelLocation nearby = StelApp::getInstance().getLocationMgr().locationNearest(loc.planetName, loc.longitude, loc.latitude, 0.25f);
+		loc.altitude = nearby.isValid() ? nearby.altitude : 0;
+	}
+	else
+		loc.altitude = info.coordinate().altitude();
 	loc.name = "GPS";
 	StelApp::getInstance().getCore()->moveObserverTo(loc, 0.);
 	StelApp::getInstance().getCore()->setDefaultLocationID(loc.getID());
@@ -152,12 +152,18 @@ QList<MeteorShowers::SearchResult> MeteorShowers::searchEvents(QDate dateFrom, Q
 	return result;
 }
 
-QList<StelObjectP> MeteorShowers::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
+QList<StelObjectP> MeteorShowers::searchAround(const Vec3d& av, double limitFov, const StelCore* core) const
+{
+	StelObjectListVisitor visitor;
+	visitAround(av, limitFov, core, visitor);
+	return visitor.result;
+}
+
+void MeteorShowers::visitAround(const Vec3d& av, double limitFov, const StelCore*, StelObjectVisitor& visitor) const
 {
-	QList<StelObjectP> result;
 	if (!m_mgr->getEnablePlugin())
 	{
-		return result;
+		return;
 	}
 
 	Vec3d v(av);
@@ -172,11 +178,13 @@ QList<StelObjectP> MeteorShowers::searchAround(const Vec3d& av, double limitFov,
 			equPos.normalize();
 			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2] >= cosLimFov)
 			{
-				result.append(qSharedPointerCast<StelObject>(ms));
+				if (!visitor.visit(qSharedPointerCast<StelObject>(ms)))
+				{
+					return;
+				}
 			}
 		}
 	}
-	return result;
 }
 
 StelObjectP MeteorShowers::searchByName(const QString& englishName) const
@@ -74,6 +74,9 @@ public:
 	// Methods defined in StelObjectModule class
 	//
 	virtual QList<StelObjectP> searchAround(const Vec3d& v, double limitFov, const StelCore* core) const;
+
+	//! Pass the objects which searchAround() would return to a visitor, without building a list.
+	virtual void visitAround(const Vec3d& v, double limitFov, const StelCore* core, StelObjectVisitor& visitor) const;
 	virtual StelObjectP searchByNameI18n(const QString& nameI18n) const;
 	virtual StelObjectP searchByName(const QString& name) const;
 	virtual StelObjectP searchByID(const QString &id) const;
@@ -0,0 +1,704 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "MinorBodyCatalog.hpp"
+#include "Orbit.hpp"
+#include "StelCore.hpp"
+#include "StelPainter.hpp"
+#include "StelProfiler.hpp"
+#include "StelProjector.hpp"
+#include "StelSimd.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QtConcurrent>
+
+#include <cmath>
+#include <cstring>
+
+static const char Magic[4] = {'S', 'M', 'B', 'C'};
+static const quint32 ByteOrderMark = 0x01020304;
+static const quint8 CometFlag = 1;
+
+// Largest eccentricity of the orbits solved with SIMD instructions. Up to it, KEPLER_ITERATIONS
+// Newton iterations from the starting value of Danby reach the precision of floats for any mean anomaly.
+static const double SIMD_MAX_ECCENTRICITY = 0.8;
+static const int KEPLER_ITERATIONS = 5;
+// The candidates are computed for a limiting magnitude a bit higher than the current one, so that
+// small changes of the limiting magnitude do not need a new computation.
+static const float LIMIT_MAG_MARGIN = 0.5f;
+// Time in days after which the positions are computed again. The fastest near Earth objects move
+// by less than 0.1 arcmin in that time.
+static const double POSITION_TOLERANCE = 1e-3;
+// Distance in AU the observer can move from the Sun before the candidates are computed again
+static const double OBSERVER_TOLERANCE = 0.01;
+// Smallest distance from the observer used for the magnitude bounds, in AU
+static const double MIN_DISTANCE = 0.001;
+// Index of B-V 0.7 in the color table of StelSkyDrawer, close to the color of the Sun
+static const unsigned int BV_INDEX = 38;
+// Magnitudes of the RCMag table
+static const float MAG_MIN = -2.f;
+static const float MAG_STEP = 0.05f;
+static const int RCMAG_TABLE_SIZE = 512;
+
+struct MinorBodyCatalog::Header
+{
+	char magic[4];
+	quint32 version;
+	quint32 byteOrder;
+	quint32 nbBodies;
+	//! Number of elliptic orbits solved with SIMD instructions, at the start of the columns.
+	quint32 nbSimd;
+	//! Number of elliptic orbits, including the SIMD ones.
+	quint32 nbElliptic;
+	quint32 nbParabolic;
+	//! Number of slots of the hash table, a power of 2.
+	quint32 hashSize;
+	quint32 stringsSize;
+	quint32 reserved;
+};
+
+//! Search of the candidates in a range of bodies, and computation of their positions.
+struct MinorBodyCatalog::CandidateJob
+{
+	const MinorBodyCatalog* catalog;
+	int begin;
+	int end;
+	double jde;
+	float limitMag;
+	//! Distance of the observer from the Sun, in AU.
+	double observerDistance;
+	Chunk* chunk;
+};
+
+//! Projection of the candidates of a chunk, run by a worker thread.
+struct MinorBodyCatalog::DrawJob
+{
+	const MinorBodyCatalog* catalog;
+	const StelCore* core;
+	const StelProjector* prj;
+	Vec3d observerPos;
+	const RCMag* rcmagTable;
+	int limitMagIndex;
+	Chunk* chunk;
+};
+
+namespace
+{
+	// FNV-1a, which unlike qHash() does not depend on the Qt version or on a random seed
+	quint32 hashName(const QByteArray& name)
+	{
+		quint32 h = 2166136261u;
+		for (int i=0;i<name.size();++i)
+		{
+			h ^= (uchar)name[i];
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	// Orbit types, in the order of the file
+	int orbitGroup(const MinorBodyCatalog::Body& b)
+	{
+		if (b.e<=SIMD_MAX_ECCENTRICITY)
+			return 0;
+		if (b.e<1.)
+			return 1;
+		if (b.e==1.)
+			return 2;
+		return 3;
+	}
+
+	template <class T> void writeColumn(QFile& out, const QVector<T>& column, bool& ok)
+	{
+		const qint64 size = column.size()*sizeof(T);
+		ok = ok && out.write((const char*)column.constData(), size)==size;
+	}
+
+#ifdef STEL_SIMD
+	// Sine and cosine of 4 floats. The argument is reduced to [-pi/2, pi/2], where Taylor series
+	// are accurate to about 1e-7.
+	void simdSinCos(SimdFloat4 x, SimdFloat4& s, SimdFloat4& c)
+	{
+		// Round to the nearest integer by adding and removing 1.5*2^23
+		const SimdFloat4 magic = simdSet(12582912.f);
+		const SimdFloat4 k = (x*simdSet((float)(0.5/M_PI)) + magic) - magic;
+		// 2*pi in 2 parts, the first one having few significant bits so that k*part is exact
+		x = (x - k*simdSet(6.28125f)) - k*simdSet(1.93530717958647692e-3f);
+
+		const SimdFloat4 halfPi = simdSet((float)M_PI_2);
+		const SimdFloat4 pi = simdSet((float)M_PI);
+		const SimdMask4 above = x > halfPi;
+		const SimdMask4 below = x < -halfPi;
+		x = simdSelect(above, pi - x, simdSelect(below, -pi - x, x));
+		const SimdFloat4 one = simdSet(1.f);
+		const SimdFloat4 cosSign = simdSelect(above, -one, simdSelect(below, -one, one));
+
+		const SimdFloat4 x2 = x*x;
+		s = simdSet(-1.f/39916800.f);
+		s = s*x2 + simdSet(1.f/362880.f);
+		s = s*x2 + simdSet(-1.f/5040.f);
+		s = s*x2 + simdSet(1.f/120.f);
+		s = s*x2 + simdSet(-1.f/6.f);
+		s = (s*x2 + one)*x;
+		c = simdSet(1.f/479001600.f);
+		c = c*x2 + simdSet(-1.f/3628800.f);
+		c = c*x2 + simdSet(1.f/40320.f);
+		c = c*x2 + simdSet(-1.f/720.f);
+		c = c*x2 + simdSet(1.f/24.f);
+		c = c*x2 + simdSet(-0.5f);
+		c = (c*x2 + one)*cosSign;
+	}
+#endif
+}
+
+MinorBodyCatalog::MinorBodyCatalog()
+	: header(NULL), q(NULL), e(NULL), n(NULL), t0(NULL), absoluteMagnitude(NULL), slope(NULL),
+	  names(NULL), hashTable(NULL), flags(NULL), strings(NULL), threadCount(1),
+	  candidatesValid(false), candidatesJDE(0.), candidatesLimitMag(0.f)
+{
+	for (int i=0;i<3;++i)
+	{
+		p[i] = NULL;
+		qv[i] = NULL;
+	}
+}
+
+MinorBodyCatalog::~MinorBodyCatalog()
+{
+	close();
+}
+
+double MinorBodyCatalog::meanMotion(double q, double e)
+{
+	if (e==1.)
+		return 0.01720209895 * (1.5/q) * std::sqrt(0.5/q);
+	const double a = std::fabs(q/(1.-e));
+	return 0.01720209895 / (a*std::sqrt(a));
+}
+
+bool MinorBodyCatalog::write(const QString& path, QVector<Body> bodies)
+{
+	Writer writer;
+	for (int i=0;i<bodies.size();++i)
+		writer.append(bodies.at(i));
+	return writer.write(path);
+}
+
+MinorBodyCatalog::Writer::Writer()
+	: pool(1, '\0') // Offset 0 is the empty string
+{
+}
+
+void MinorBodyCatalog::Writer::append(const Body& b)
+{
+	Group& g = groups[orbitGroup(b)];
+	g.doubles[0].append(b.q);
+	g.doubles[1].append(b.e);
+	g.doubles[2].append(b.n);
+	g.doubles[3].append(b.t0);
+	// P and Q vectors of the orbit, as in Init3D() of Orbit.cpp
+	const double cw = std::cos(b.w);
+	const double sw = std::sin(b.w);
+	const double cOm = std::cos(b.Om);
+	const double sOm = std::sin(b.Om);
+	const double ci = std::cos(b.i);
+	const double si = std::sin(b.i);
+	g.floats[0].append(-sw*sOm*ci+cw*cOm);
+	g.floats[1].append(sw*cOm*ci+cw*sOm);
+	g.floats[2].append(sw*si);
+	g.floats[3].append(-cw*sOm*ci-sw*cOm);
+	g.floats[4].append(cw*cOm*ci-sw*sOm);
+	g.floats[5].append(cw*si);
+	g.floats[6].append(b.H);
+	g.floats[7].append(b.slope);
+	g.flags.append(b.comet ? CometFlag : 0);
+	if (b.name.isEmpty())
+	{
+		g.names.append(0);
+		return;
+	}
+	g.names.append(pool.size());
+	pool.append(b.name.toUtf8());
+	pool.append('\0');
+}
+
+int MinorBodyCatalog::Writer::size() const
+{
+	int nb = 0;
+	for (int k=0;k<4;++k)
+		nb += groups[k].flags.size();
+	return nb;
+}
+
+bool MinorBodyCatalog::Writer::write(const QString& path) const
+{
+	const int nb = size();
+	quint32 hashSize = 16;
+	while (hashSize < 2*(quint32)nb)
+		hashSize *= 2;
+	QVector<quint32> table(hashSize, 0);
+	quint32 index = 0;
+	for (int k=0;k<4;++k)
+	{
+		const QVector<quint32>& names = groups[k].names;
+		for (int i=0;i<names.size();++i)
+		{
+			// The table stores the indexes plus 1, 0 being an empty slot
+			++index;
+			if (names.at(i)==0)
+				continue;
+			const char* name = pool.constData()+names.at(i);
+			quint32 h = hashName(QByteArray::fromRawData(name, qstrlen(name))) & (hashSize-1);
+			while (table[h]!=0)
+				h = (h+1) & (hashSize-1);
+			table[h] = index;
+		}
+	}
+
+	Header h;
+	memcpy(h.magic, Magic, 4);
+	h.version = Version;
+	h.byteOrder = ByteOrderMark;
+	h.nbBodies = nb;
+	h.nbSimd = groups[0].flags.size();
+	h.nbElliptic = groups[0].flags.size()+groups[1].flags.size();
+	h.nbParabolic = groups[2].flags.size();
+	h.hashSize = hashSize;
+	h.stringsSize = pool.size();
+	h.reserved = 0;
+
+	// Write to a temporary file, so that a partial file is never opened
+	const QString tmpPath = path + ".tmp";
+	QFile out(tmpPath);
+	if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "ERROR: Could not write minor body catalogue: " << QDir::toNativeSeparators(tmpPath);
+		return false;
+	}
+	bool ok = out.write((const char*)&h, sizeof(h)) == sizeof(h);
+	// Each column of the file is the concatenation of the columns of the groups
+	for (int c=0;c<4;++c)
+		for (int k=0;k<4;++k)
+			writeColumn(out, groups[k].doubles[c], ok);
+	for (int c=0;c<8;++c)
+		for (int k=0;k<4;++k)
+			writeColumn(out, groups[k].floats[c], ok);
+	for (int k=0;k<4;++k)
+		writeColumn(out, groups[k].names, ok);
+	writeColumn(out, table, ok);
+	for (int k=0;k<4;++k)
+		writeColumn(out, groups[k].flags, ok);
+	ok = ok && out.write(pool) == pool.size();
+	out.close();
+	QFile::remove(path);
+	if (!ok || !QFile::rename(tmpPath, path))
+	{
+		qWarning() << "ERROR: Could not write minor body catalogue: " << QDir::toNativeSeparators(path);
+		QFile::remove(tmpPath);
+		return false;
+	}
+	return true;
+}
+
+bool MinorBodyCatalog::open(const QString& path)
+{
+	close();
+	QElapsedTimer timer;
+	timer.start();
+	file.setFileName(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	const qint64 fileSize = file.size();
+	if (fileSize < (qint64)sizeof(Header))
+	{
+		close();
+		return false;
+	}
+	const uchar* data = file.map(0, fileSize);
+	if (!data)
+	{
+		buffer = file.readAll();
+		data = (const uchar*)buffer.constData();
+	}
+
+	header = (const Header*)data;
+	const qint64 nb = header->nbBodies;
+	const qint64 expectedSize = sizeof(Header) + nb*(4*sizeof(double) + 8*sizeof(float) + sizeof(quint32) + sizeof(quint8))
+			+ (qint64)header->hashSize*sizeof(quint32) + header->stringsSize;
+	if (memcmp(header->magic, Magic, 4)!=0 || header->version!=Version || header->byteOrder!=ByteOrderMark
+		|| header->nbSimd>header->nbElliptic || header->nbElliptic+header->nbParabolic>header->nbBodies
+		|| header->hashSize==0 || (header->hashSize & (header->hashSize-1))!=0
+		|| header->stringsSize==0 || fileSize!=expectedSize || data[fileSize-1]!='\0')
+	{
+		qWarning() << "ERROR: Invalid minor body catalogue: " << QDir::toNativeSeparators(path);
+		close();
+		return false;
+	}
+	const double* doubles = (const double*)(data+sizeof(Header));
+	q = doubles;
+	e = q+nb;
+	n = e+nb;
+	t0 = n+nb;
+	const float* floats = (const float*)(t0+nb);
+	for (int k=0;k<3;++k)
+		p[k] = floats+k*nb;
+	for (int k=0;k<3;++k)
+		qv[k] = floats+(3+k)*nb;
+	absoluteMagnitude = floats+6*nb;
+	slope = floats+7*nb;
+	names = (const quint32*)(floats+8*nb);
+	hashTable = names+nb;
+	flags = (const quint8*)(hashTable+header->hashSize);
+	strings = (const char*)(flags+nb);
+	hidden.fill(0, nb);
+	candidatesValid = false;
+	qDebug() << "Loaded" << nb << "minor bodies from" << QDir::toNativeSeparators(path) << "in" << timer.elapsed() << "ms";
+	return true;
+}
+
+void MinorBodyCatalog::close()
+{
+	if (header && buffer.isEmpty())
+		file.unmap((uchar*)header);
+	buffer.clear();
+	file.close();
+	header = NULL;
+	q = e = n = t0 = NULL;
+	for (int i=0;i<3;++i)
+	{
+		p[i] = NULL;
+		qv[i] = NULL;
+	}
+	absoluteMagnitude = slope = NULL;
+	names = hashTable = NULL;
+	flags = NULL;
+	strings = NULL;
+	hidden.clear();
+	chunks.clear();
+	candidatesValid = false;
+}
+
+int MinorBodyCatalog::size() const
+{
+	return header ? header->nbBodies : 0;
+}
+
+QString MinorBodyCatalog::nameAt(int i) const
+{
+	Q_ASSERT(i>=0 && i<size());
+	return QString::fromUtf8(string(names[i]));
+}
+
+int MinorBodyCatalog::indexOf(const QString& name) const
+{
+	if (!header)
+		return -1;
+	const QByteArray utf8 = name.toUtf8();
+	const quint32 mask = header->hashSize-1;
+	for (quint32 h=hashName(utf8) & mask;hashTable[h]!=0;h=(h+1) & mask)
+	{
+		const int i = hashTable[h]-1;
+		if (qstrcmp(string(names[i]), utf8.constData())==0)
+			return i;
+	}
+	return -1;
+}
+
+void MinorBodyCatalog::setHidden(int i, bool b)
+{
+	Q_ASSERT(i>=0 && i<size());
+	hidden[i] = b;
+	candidatesValid = false;
+}
+
+void MinorBodyCatalog::computePositions(double jde, const int* indexes, int count, Vec3f* positions) const
+{
+	int k = 0;
+#ifdef STEL_SIMD
+	// The indexes are sorted, so the SIMD orbits come first
+	const int nbSimd = header->nbSimd;
+	for (;k+4<=count && indexes[k+3]<nbSimd;k+=4)
+		computePositionsSimd(jde, indexes+k, positions+k);
+#endif
+	for (;k<count;++k)
+	{
+		const int i = indexes[k];
+		double rCosNu, rSinNu;
+		computeKeplerAnomaly(q[i], n[i], e[i], jde-t0[i], rCosNu, rSinNu);
+		positions[k].set(p[0][i]*rCosNu+qv[0][i]*rSinNu,
+				 p[1][i]*rCosNu+qv[1][i]*rSinNu,
+				 p[2][i]*rCosNu+qv[2][i]*rSinNu);
+	}
+}
+
+#ifdef STEL_SIMD
+void MinorBodyCatalog::computePositionsSimd(double jde, const int* indexes, Vec3f* positions) const
+{
+	float mean[4], ecc[4], a[4], b[4];
+	for (int l=0;l<4;++l)
+	{
+		const int i = indexes[l];
+		// The mean anomaly is reduced to ]-pi, pi] in double precision, as the number of
+		// revolutions since the time of perihelion can be large.
+		double m = std::fmod(n[i]*(jde-t0[i]), 2.*M_PI);
+		if (m>M_PI)
+			m -= 2.*M_PI;
+		else if (m<=-M_PI)
+			m += 2.*M_PI;
+		mean[l] = m;
+		ecc[l] = e[i];
+		a[l] = q[i]/(1.-e[i]);
+		b[l] = q[i]*std::sqrt((1.+e[i])/(1.-e[i]));
+	}
+	const SimdFloat4 zero = simdSet(0.f);
+	const SimdFloat4 one = simdSet(1.f);
+	const SimdFloat4 M = simdSet(mean[0], mean[1], mean[2], mean[3]);
+	const SimdFloat4 ev = simdSet(ecc[0], ecc[1], ecc[2], ecc[3]);
+
+	// Newton iterations on Kepler's equation, starting from E = M + 0.85*e*sign(sin(M))
+	const SimdFloat4 start = simdSet(0.85f)*ev;
+	SimdFloat4 E = M + simdSelect(M < zero, -start, start);
+	SimdFloat4 s, c;
+	for (int it=0;it<KEPLER_ITERATIONS;++it)
+	{
+		simdSinCos(E, s, c);
+		E = E - (E - ev*s - M)/(one - ev*c);
+	}
+	simdSinCos(E, s, c);
+	const SimdFloat4 rCosNu = simdSet(a[0], a[1], a[2], a[3])*(c - ev);
+	const SimdFloat4 rSinNu = simdSet(b[0], b[1], b[2], b[3])*s;
+
+	SimdFloat4 xyz[3];
+	for (int k=0;k<3;++k)
+	{
+		const float* pk = p[k];
+		const float* qk = qv[k];
+		xyz[k] = simdSet(pk[indexes[0]], pk[indexes[1]], pk[indexes[2]], pk[indexes[3]])*rCosNu
+			+ simdSet(qk[indexes[0]], qk[indexes[1]], qk[indexes[2]], qk[indexes[3]])*rSinNu;
+	}
+	simdStore(positions, xyz[0], xyz[1], xyz[2]);
+}
+#endif
+
+void MinorBodyCatalog::runCandidateJob(CandidateJob& job)
+{
+	const MinorBodyCatalog& cat = *job.catalog;
+	Chunk& chunk = *job.chunk;
+	chunk.indexes.clear();
+	for (int i=job.begin;i<job.end;++i)
+	{
+		if (cat.hidden.at(i))
+			continue;
+		// Lower bound of the magnitude: the body is at least q-R from the observer, and at least q
+		// from the Sun, at the phase angle 0.
+		const double qi = cat.q[i];
+		const double minDistance = qMax(qi-job.observerDistance-OBSERVER_TOLERANCE, MIN_DISTANCE);
+		float minMag;
+		if (cat.flags[i] & CometFlag)
+		{
+			// With K<=0 the magnitude does not increase with the distance from the Sun
+			if (cat.slope[i]<=0.f)
+			{
+				chunk.indexes.append(i);
+				continue;
+			}
+			minMag = cat.absoluteMagnitude[i] + 5.*std::log10(minDistance) + 2.5*cat.slope[i]*std::log10(qi);
+		}
+		else
+			minMag = cat.absoluteMagnitude[i] + 5.*std::log10(qi*minDistance);
+		if (minMag<=job.limitMag)
+			chunk.indexes.append(i);
+	}
+	chunk.positions.resize(chunk.indexes.size());
+	cat.computePositions(job.jde, chunk.indexes.constData(), chunk.indexes.size(), chunk.positions.data());
+}
+
+void MinorBodyCatalog::updateCandidates(double jde, float limitMag, const Vec3d& observerPos)
+{
+	const double observerDistance = observerPos.length();
+	if (candidatesValid && std::fabs(jde-candidatesJDE)<POSITION_TOLERANCE && limitMag<=candidatesLimitMag
+		&& std::fabs(observerDistance-candidatesObserverPos.length())<OBSERVER_TOLERANCE)
+		return;
+
+	static const int section = StelProfiler::getSectionId("MinorBodyCatalog::propagate");
+	StelProfiler::Scope scope(section);
+	candidatesValid = true;
+	candidatesJDE = jde;
+	candidatesLimitMag = limitMag + LIMIT_MAG_MARGIN;
+	candidatesObserverPos = observerPos;
+
+	// More jobs than threads, as the number of candidates varies along the catalogue
+	const int nb = size();
+	const int nbJobs = qMax(1, qMin(nb/1024, threadCount>1 ? threadCount*4 : 1));
+	chunks.resize(nbJobs);
+	QVector<CandidateJob> jobs(nbJobs);
+	for (int j=0;j<nbJobs;++j)
+	{
+		CandidateJob& job = jobs[j];
+		job.catalog = this;
+		job.begin = (qint64)nb*j/nbJobs;
+		job.end = (qint64)nb*(j+1)/nbJobs;
+		job.jde = jde;
+		job.limitMag = candidatesLimitMag;
+		job.observerDistance = observerDistance;
+		job.chunk = &chunks[j];
+	}
+	if (nbJobs>1)
+		QtConcurrent::blockingMap(jobs, runCandidateJob);
+	else
+		runCandidateJob(jobs[0]);
+}
+
+void MinorBodyCatalog::runDrawJob(DrawJob& job)
+{
+	const MinorBodyCatalog& cat = *job.catalog;
+	Chunk& chunk = *job.chunk;
+	chunk.vertices.clear();
+	chunk.bigHalos.clear();
+	const StelSkyDrawer* drawer = job.core->getSkyDrawer();
+	const Extinction& extinction = drawer->getExtinction();
+	const bool withExtinction = drawer->getFlagHasAtmosphere() && extinction.getExtinctionCoefficient()>=0.01f;
+	const double observerRq = job.observerPos.lengthSquared();
+	StelSkyDrawer::StarVertex vertices[6];
+	for (int k=0;k<chunk.indexes.size();++k)
+	{
+		const int i = chunk.indexes.at(k);
+		const Vec3f& pos = chunk.positions.at(k);
+		const Vec3d helio(pos[0], pos[1], pos[2]);
+		const Vec3d geo = helio - job.observerPos;
+		const double planetRq = helio.lengthSquared();
+		const double observerPlanetRq = geo.lengthSquared();
+		double mag;
+		if (cat.flags[i] & CometFlag)
+			mag = cat.absoluteMagnitude[i] + 2.5*std::log10(observerPlanetRq) + 1.25*cat.slope[i]*std::log10(planetRq);
+		else
+		{
+			// H-G system, as in MinorPlanet::computeVMagnitude()
+			const double cosChi = (observerPlanetRq + planetRq - observerRq)/(2.0*std::sqrt(observerPlanetRq*planetRq));
+			const double tanHalfPhase = std::tan(0.5*std::acos(qBound(-1., cosChi, 1.)));
+			const double phi1 = std::exp(-3.33 * std::pow(tanHalfPhase, 0.63));
+			const double phi2 = std::exp(-1.87 * std::pow(tanHalfPhase, 1.22));
+			const double g = cat.slope[i];
+			mag = cat.absoluteMagnitude[i] - 2.5*std::log10((1-g)*phi1 + g*phi2) + 2.5*std::log10(planetRq*observerPlanetRq);
+		}
+
+		Vec3d j2000 = StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(geo);
+		j2000.normalize();
+		const Vec3f v(j2000[0], j2000[1], j2000[2]);
+		if (withExtinction)
+		{
+			Vec3f altAz(v);
+			job.core->j2000ToAltAzInPlaceNoRefraction(&altAz);
+			float extMagShift = 0.f;
+			extinction.forward(altAz, &extMagShift);
+			mag += extMagShift;
+		}
+		const int magIndex = (int)((mag-MAG_MIN)/MAG_STEP);
+		if (magIndex>job.limitMagIndex)
+			continue;
+		const RCMag& rcMag = job.rcmagTable[qMax(0, magIndex)];
+
+		bool bigHalo = false;
+		if (!drawer->computePointSource(job.prj, v, rcMag, BV_INDEX, true, vertices, bigHalo))
+			continue;
+		if (bigHalo)
+		{
+			Chunk::BigHalo h;
+			h.pos = v;
+			h.rcMag = rcMag;
+			chunk.bigHalos.append(h);
+		}
+		else
+		{
+			for (int l=0;l<6;++l)
+				chunk.vertices.append(vertices[l]);
+		}
+	}
+}
+
+void MinorBodyCatalog::draw(StelCore* core, float intensity)
+{
+	if (!header || intensity<=0.f)
+		return;
+	StelSkyDrawer* skyDrawer = core->getSkyDrawer();
+
+	RCMag rcmagTable[RCMAG_TABLE_SIZE];
+	int limitMagIndex = -1;
+	for (int i=0;i<RCMAG_TABLE_SIZE;++i)
+	{
+		if (!skyDrawer->computeRCMag(MAG_MIN+MAG_STEP*i, &rcmagTable[i]))
+			break;
+		rcmagTable[i].radius *= intensity;
+		limitMagIndex = i;
+	}
+	if (limitMagIndex<0)
+		return;
+
+	static const int section = StelProfiler::getSectionId("MinorBodyCatalog::points");
+	StelProfiler::Scope scope(section);
+	const Vec3d observerPos = core->getObserverHeliocentricEclipticPos();
+	updateCandidates(core->getJDay(), MAG_MIN+MAG_STEP*(limitMagIndex+1), observerPos);
+
+	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
+	const int nbJobs = chunks.size();
+	QVector<DrawJob> jobs(nbJobs);
+	for (int j=0;j<nbJobs;++j)
+	{
+		DrawJob& job = jobs[j];
+		job.catalog = this;
+		job.core = core;
+		job.prj = prj.data();
+		job.observerPos = observerPos;
+		job.rcmagTable = rcmagTable;
+		job.limitMagIndex = limitMagIndex;
+		job.chunk = &chunks[j];
+	}
+	if (nbJobs>1)
+		QtConcurrent::blockingMap(jobs, runDrawJob);
+	else if (nbJobs==1)
+		runDrawJob(jobs[0]);
+
+	// Merge the vertices of all chunks and draw them in one batch
+	int nbVertices = 0;
+	for (int j=0;j<nbJobs;++j)
+		nbVertices += chunks.at(j).vertices.size();
+	mergedVertices.resize(nbVertices);
+	StelSkyDrawer::StarVertex* dst = mergedVertices.data();
+	for (int j=0;j<nbJobs;++j)
+	{
+		const QVector<StelSkyDrawer::StarVertex>& src = chunks.at(j).vertices;
+		if (!src.isEmpty())
+			memcpy(dst, src.constData(), src.size()*sizeof(StelSkyDrawer::StarVertex));
+		dst += src.size();
+	}
+	scope.stop();
+
+	StelPainter sPainter(prj);
+	skyDrawer->preDrawPointSource(&sPainter);
+	skyDrawer->drawPointSources(&sPainter, mergedVertices.constData(), nbVertices/6);
+	for (int j=0;j<nbJobs;++j)
+	{
+		foreach (const Chunk::BigHalo& h, chunks.at(j).bigHalos)
+			skyDrawer->drawPointSource(&sPainter, h.pos, h.rcMag, BV_INDEX);
+	}
+	skyDrawer->postDrawPointSource(&sPainter);
+}
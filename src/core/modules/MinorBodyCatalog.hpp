@@ -0,0 +1,209 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _MINORBODYCATALOG_HPP_
+#define _MINORBODYCATALOG_HPP_
+
+#include "StelSkyDrawer.hpp"
+#include "VecMath.hpp"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+class StelCore;
+
+//! @class MinorBodyCatalog
+//! Orbital elements of a large number of asteroids and comets, e.g. the whole MPCORB file, stored
+//! column by column in a binary file which is mapped in memory.
+//! The bodies are drawn as point sources without creating Planet objects. Their positions are
+//! computed in parallel, only for the bodies which can be brighter than the limiting magnitude,
+//! and only again when the date moved by more than a few minutes. The elliptic orbits of moderate
+//! eccentricity, i.e. nearly all the asteroids, are solved 4 at a time with SIMD instructions in
+//! single precision, which is enough for drawing points. The other ones use the double precision
+//! solvers of CometOrbit.
+//!
+//! The file is made of:
+//! - a header with a version number and the number of bodies of each orbit type;
+//! - the columns of the bodies: perihelion distance, eccentricity, mean motion and time of perihelion
+//!   in double precision, the P and Q vectors of the orbit in the VSOP87 frame, the absolute
+//!   magnitude and slope in single precision, and the offsets of the names in the string pool;
+//! - an open addressing hash table of the body indexes, with the names as keys;
+//! - a column of flags;
+//! - a pool of the null terminated UTF-8 names.
+//!
+//! The bodies are sorted by orbit type: first the elliptic orbits solved with SIMD instructions,
+//! then the other elliptic orbits, the parabolic and the hyperbolic ones.
+//! The file uses the byte order of the machine which writes it, and it is rejected by open() if it
+//! was written with another byte order.
+class MinorBodyCatalog
+{
+public:
+	//! Orbital elements of a body, as given to write() and Writer.
+	struct Body
+	{
+		QString name;
+		//! Perihelion distance in AU.
+		double q;
+		double e;
+		//! Inclination, longitude of the ascending node and argument of perihelion in radians,
+		//! referred to the J2000 ecliptic.
+		double i, Om, w;
+		//! Time of perihelion, JDE.
+		double t0;
+		//! Mean motion in rad/day. For parabolic orbits, W/dt as used by CometOrbit.
+		double n;
+		//! Absolute magnitude.
+		float H;
+		//! Slope parameter G of the H-G system for asteroids, or K for comets.
+		float slope;
+		bool comet;
+	};
+
+	MinorBodyCatalog();
+	~MinorBodyCatalog();
+
+	//! Get the mean motion of an orbit around the Sun in rad/day, or W/dt for a parabolic orbit.
+	static double meanMotion(double q, double e);
+
+	//! Write the bodies to a catalogue file.
+	static bool write(const QString& path, QVector<Body> bodies);
+
+	//! Builds a catalogue file from bodies given one at a time, e.g. while a large file is parsed.
+	//! Only the columns of the file are kept in memory, grouped by orbit type, with the names in
+	//! a single pool of UTF-8 strings.
+	class Writer
+	{
+	public:
+		Writer();
+		//! Add a body at the end of the bodies of its orbit type.
+		void append(const Body& body);
+		//! Get the number of bodies added.
+		int size() const;
+		//! Write the bodies to a catalogue file.
+		bool write(const QString& path) const;
+
+	private:
+		//! Columns of the bodies of an orbit type, in the order of the file.
+		struct Group
+		{
+			//! Perihelion distance, eccentricity, mean motion and time of perihelion.
+			QVector<double> doubles[4];
+			//! P and Q vectors, absolute magnitude and slope.
+			QVector<float> floats[8];
+			QVector<quint32> names;
+			QVector<quint8> flags;
+		};
+		Group groups[4];
+		QByteArray pool;
+	};
+
+	//! Open a catalogue file.
+	//! @return false if the file is missing, corrupted, or has an unknown version.
+	bool open(const QString& path);
+	void close();
+	bool isOpen() const {return header!=NULL;}
+
+	//! Get the number of bodies.
+	int size() const;
+	//! Get the name of a body, in [0, size()[.
+	QString nameAt(int i) const;
+	//! Get the index of the body with the given name, or -1.
+	int indexOf(const QString& name) const;
+	//! Hide a body, e.g. because it is also loaded as a Planet.
+	void setHidden(int i, bool b);
+
+	//! Set the number of threads used for computing the positions.
+	void setThreadCount(int n) {threadCount = qMax(1, n);}
+
+	//! Draw the bodies which are brighter than the limiting magnitude of the sky drawer.
+	//! @param intensity factor applied to the radius of the points.
+	void draw(StelCore* core, float intensity);
+
+	//! Compute the heliocentric positions in the VSOP87 frame of some bodies at a given date.
+	//! @param indexes the indexes of the bodies, sorted in increasing order.
+	//! @param positions receives the positions in AU.
+	void computePositions(double jde, const int* indexes, int count, Vec3f* positions) const;
+
+	//! Version of the file format.
+	static const quint32 Version = 1;
+
+private:
+	struct Header;
+
+	//! Bodies possibly brighter than the limiting magnitude and their positions, for a part of
+	//! the catalogue.
+	struct Chunk
+	{
+		QVector<int> indexes;
+		QVector<Vec3f> positions;
+		QVector<StelSkyDrawer::StarVertex> vertices;
+		//! Points which need drawing with StelSkyDrawer::drawPointSource().
+		struct BigHalo
+		{
+			Vec3f pos;
+			RCMag rcMag;
+		};
+		QVector<BigHalo> bigHalos;
+	};
+
+	struct CandidateJob;
+	struct DrawJob;
+	static void runCandidateJob(CandidateJob& job);
+	static void runDrawJob(DrawJob& job);
+
+	//! Update the list of candidates and their positions.
+	void updateCandidates(double jde, float limitMag, const Vec3d& observerPos);
+	//! Compute the positions of 4 bodies among the first nbSimd ones with SIMD instructions.
+	void computePositionsSimd(double jde, const int* indexes, Vec3f* positions) const;
+
+	const char* string(quint32 offset) const {return strings+offset;}
+
+	QFile file;
+	//! Copy of the file, used when it cannot be mapped.
+	QByteArray buffer;
+	const Header* header;
+	// Columns of the file
+	const double* q;
+	const double* e;
+	const double* n;
+	const double* t0;
+	const float* p[3];
+	const float* qv[3];
+	const float* absoluteMagnitude;
+	const float* slope;
+	const quint32* names;
+	const quint32* hashTable;
+	const quint8* flags;
+	const char* strings;
+
+	QVector<char> hidden;
+	int threadCount;
+
+	QVector<Chunk> chunks;
+	QVector<StelSkyDrawer::StarVertex> mergedVertices;
+	//! Parameters used for computing the candidates.
+	bool candidatesValid;
+	double candidatesJDE;
+	float candidatesLimitMag;
+	Vec3d candidatesObserverPos;
+};
+
+#endif // _MINORBODYCATALOG_HPP_
@@ -291,20 +291,18 @@ double MinorPlanet::getSiderealPeriod() const
 	return period;
 }
 
-float MinorPlanet::getVMagnitude(const StelCore* core) const
+float MinorPlanet::computeVMagnitude(const Vec3d& observerHelioPos, const Vec3d& planetHelioPos, const Vec3d& parentHelioPos, double jd, bool fromEarth) const
 {
 	//If the H-G system is not used, use the default radius/albedo mechanism
 	if (slopeParameter < 0)
 	{
-		return Planet::getVMagnitude(core);
+		return Planet::computeVMagnitude(observerHelioPos, planetHelioPos, parentHelioPos, jd, fromEarth);
 	}
 
 	//Calculate phase angle
-	//(Code copied from Planet::getVMagnitude())
+	//(Code copied from Planet::computeVMagnitude())
 	//(LOL, this is actually vector subtraction + the cosine theorem :))
-	const Vec3d& observerHelioPos = core->getObserverHeliocentricEclipticPos();
 	const double observerRq = observerHelioPos.lengthSquared();
-	const Vec3d& planetHelioPos = getHeliocentricEclipticPos();
 	const double planetRq = planetHelioPos.lengthSquared();
 	const double observerPlanetRq = (observerHelioPos - planetHelioPos).lengthSquared();
 	const double cos_chi = (observerPlanetRq + planetRq - observerRq)/(2.0*sqrt(observerPlanetRq*planetRq));
@@ -71,7 +71,8 @@ public:
 	//was not designed to handle different types of objects.
 	// \todo Decide if this is going to be "MinorPlanet" or "Asteroid"
 	//virtual QString getType() const {return "MinorPlanet";}
-	virtual float getVMagnitude(const StelCore* core) const;
+	virtual float computeVMagnitude(const Vec3d& observerHelioPos, const Vec3d& planetHelioPos,
+					const Vec3d& parentHelioPos, double jd, bool fromEarth) const;
 	//! sets the nameI18 property with the appropriate translation.
 	//! Function overriden to handle the problem with name conflicts.
 	virtual void translateName(const StelTranslator& trans);
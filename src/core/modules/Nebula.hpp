@@ -26,10 +26,12 @@
 #include "StelTranslator.hpp"
 #include "StelTextureTypes.hpp"
 
+#include <QSharedPointer>
+
 class StelPainter;
 class QDataStream;
 
-class Nebula : public StelObject
+class Nebula : public StelObject, public QEnableSharedFromThis<Nebula>
 {
 friend class NebulaMgr;
 public:
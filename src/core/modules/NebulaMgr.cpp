@@ -182,6 +182,47 @@ void NebulaMgr::init()
 	addAction("actionShow_Nebulas", N_("Display Options"), N_("Deep-sky objects"), "flagHintDisplayed", "D", "N");
 }
 
+namespace
+{
+	//! Collect the nebulae found in the grid.
+	struct CollectNebulaFuncObject
+	{
+		CollectNebulaFuncObject(QVector<Nebula*>& result) : result(result) {}
+		void operator()(StelRegionObject* obj)
+		{
+			result.append(static_cast<Nebula*>(obj));
+		}
+		QVector<Nebula*>& result;
+	};
+
+	//! Pass the nebulae found in the grid to a visitor.
+	struct VisitNebulaFuncObject
+	{
+		VisitNebulaFuncObject(StelObjectVisitor& visitor) : visitor(visitor), stopped(false) {}
+		void operator()(StelRegionObject* obj)
+		{
+			if (!stopped)
+				stopped = !visitor.visit(qSharedPointerCast<StelObject>(static_cast<Nebula*>(obj)->sharedFromThis()));
+		}
+		StelObjectVisitor& visitor;
+		bool stopped;
+	};
+
+	//! Parse a catalog designation like "M31" or "M 31" (objw in uppercase).
+	bool parseCatalogNumber(const QString& objw, const QString& prefix, unsigned int& nb)
+	{
+		if (!objw.startsWith(prefix))
+			return false;
+		int start = prefix.size();
+		if (objw.size()>start && objw.at(start)==' ')
+			++start;
+		const QString digits = objw.mid(start);
+		bool ok;
+		nb = digits.toUInt(&ok);
+		return ok && nb!=0 && QString::number(nb)==digits;
+	}
+}
+
 struct DrawNebulaFuncObject
 {
 	DrawNebulaFuncObject(float amaxMagHints, float amaxMagLabels, StelPainter* p, StelCore* aCore, bool acheckMaxMagHints) : maxMagHints(amaxMagHints), maxMagLabels(amaxMagLabels), sPainter(p), core(aCore), checkMaxMagHints(acheckMaxMagHints)
@@ -291,11 +332,9 @@ NebulaP NebulaMgr::search(const QString& name)
 {
 	QString uname = name.toUpper();
 
-	foreach (const NebulaP& n, nebArray)
-	{
-		QString testName = n->getEnglishName().toUpper();
-		if (testName==uname) return n;
-	}
+	const NebulaP n = englishNameIndex.value(uname);
+	if (n)
+		return n;
 
 	// If no match found, try search by catalog reference
 	static QRegExp catNumRx("^(M|NGC|IC|C)\\s*(\\d+)$");
@@ -515,6 +554,59 @@ void NebulaMgr::loadNebulaSet(const QString& setName)
 	}
 	loadNGC(ngcPath);
 	loadNGCNames(ngcNamesPath);
+	buildNameIndexes();
+}
+
+void NebulaMgr::buildNameIndexes()
+{
+	mIndex.clear();
+	cIndex.clear();
+	englishNameIndex.clear();
+	// Keep the first match, as the linear searches did
+	foreach (const NebulaP& n, nebArray)
+	{
+		if (n->M_nb!=0 && !mIndex.contains(n->M_nb))
+			mIndex.insert(n->M_nb, n);
+		if (n->C_nb!=0 && !cIndex.contains(n->C_nb))
+			cIndex.insert(n->C_nb, n);
+		const QString name = n->englishName.toUpper();
+		if (!englishNameIndex.contains(name))
+			englishNameIndex.insert(name, n);
+	}
+
+	completionIndex.clear();
+	insertDesignations(completionIndex);
+	foreach (const NebulaP& n, nebArray)
+		completionIndex.insert(n->englishName, n->englishName);
+	completionIndex.build();
+}
+
+void NebulaMgr::insertDesignations(StelNameIndex& index) const
+{
+	// Both forms, e.g. "M31" and "M 31"
+	foreach (const NebulaP& n, nebArray)
+	{
+		if (n->M_nb!=0)
+		{
+			index.insert(QString("M%1").arg(n->M_nb), QString("M%1").arg(n->M_nb), StelNameIndex::Designation);
+			index.insert(QString("M %1").arg(n->M_nb), QString("M %1").arg(n->M_nb), StelNameIndex::Designation);
+		}
+		if (n->IC_nb!=0 && n->IC_nb<=5386)
+		{
+			index.insert(QString("IC%1").arg(n->IC_nb), QString("IC%1").arg(n->IC_nb), StelNameIndex::Designation);
+			index.insert(QString("IC %1").arg(n->IC_nb), QString("IC %1").arg(n->IC_nb), StelNameIndex::Designation);
+		}
+		if (n->NGC_nb!=0)
+		{
+			index.insert(QString("NGC%1").arg(n->NGC_nb), QString("NGC%1").arg(n->NGC_nb), StelNameIndex::Designation);
+			index.insert(QString("NGC %1").arg(n->NGC_nb), QString("NGC %1").arg(n->NGC_nb), StelNameIndex::Designation);
+		}
+		if (n->C_nb!=0)
+		{
+			index.insert(QString("C%1").arg(n->C_nb), QString("C%1").arg(n->C_nb), StelNameIndex::Designation);
+			index.insert(QString("C %1").arg(n->C_nb), QString("C %1").arg(n->C_nb), StelNameIndex::Designation);
+		}
+	}
 }
 
 // Look for a nebulae by XYZ coords
@@ -522,9 +614,14 @@ NebulaP NebulaMgr::search(const Vec3d& apos)
 {
 	Vec3d pos = apos;
 	pos.normalize();
-	NebulaP plusProche;
-	float anglePlusProche=0.;
-	foreach (const NebulaP& n, nebArray)
+	QVector<Nebula*> candidates;
+	CollectNebulaFuncObject func(candidates);
+	const SphericalCap cap(pos, 0.999);
+	nebGrid.processIntersectingPointInRegions(&cap, func);
+
+	Nebula* plusProche = NULL;
+	double anglePlusProche=0.;
+	foreach (Nebula* n, candidates)
 	{
 		if (n->XYZ*pos>anglePlusProche)
 		{
@@ -532,67 +629,53 @@ NebulaP NebulaMgr::search(const Vec3d& apos)
 			plusProche=n;
 		}
 	}
-	if (anglePlusProche>0.999)
+	if (plusProche && anglePlusProche>0.999)
 	{
-		return plusProche;
+		return plusProche->sharedFromThis();
 	}
 	else return NebulaP();
 }
 
 
-QList<StelObjectP> NebulaMgr::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
+QList<StelObjectP> NebulaMgr::searchAround(const Vec3d& av, double limitFov, const StelCore* core) const
+{
+	StelObjectListVisitor visitor;
+	visitAround(av, limitFov, core, visitor);
+	return visitor.result;
+}
+
+void NebulaMgr::visitAround(const Vec3d& av, double limitFov, const StelCore*, StelObjectVisitor& visitor) const
 {
-	QList<StelObjectP> result;
 	if (!getFlagShow())
-		return result;
+		return;
 
 	Vec3d v(av);
 	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
-	foreach (const NebulaP& n, nebArray)
-	{
-		equPos = n->XYZ;
-		equPos.normalize();
-		if (equPos*v>=cosLimFov)
-		{
-			result.push_back(qSharedPointerCast<StelObject>(n));
-		}
-	}
-	return result;
+	VisitNebulaFuncObject func(visitor);
+	const SphericalCap cap(v, cos(limitFov * M_PI/180.));
+	nebGrid.processIntersectingPointInRegions(&cap, func);
 }
 
 NebulaP NebulaMgr::searchM(unsigned int M)
 {
-	foreach (const NebulaP& n, nebArray)
-		if (n->M_nb == M)
-			return n;
-	return NebulaP();
+	return mIndex.value(M);
 }
 
 NebulaP NebulaMgr::searchNGC(unsigned int NGC)
 {
-	if (ngcIndex.contains(NGC))
-		return ngcIndex[NGC];
-	return NebulaP();
+	return ngcIndex.value(NGC);
 }
 
 NebulaP NebulaMgr::searchIC(unsigned int IC)
 {
-	foreach (const NebulaP& n, nebArray)
-		if (n->IC_nb == IC) return n;
-	return NebulaP();
+	return icIndex.value(IC);
 }
 
 NebulaP NebulaMgr::searchC(unsigned int C)
 {
-	foreach (const NebulaP& n, nebArray)
-		if (n->C_nb == C)
-			return n;
-	return NebulaP();
+	return cIndex.value(C);
 }
 
-
 #if 0
 // read from stream
 bool NebulaMgr::loadNGCOld(const QString& catNGC)
@@ -828,6 +911,8 @@ bool NebulaMgr::loadNGC(const QString& catNGC)
             nebGrid.insert(qSharedPointerCast<StelRegionObject>(e));
             if (e->NGC_nb!=0)
                 ngcIndex.insert(e->NGC_nb, e);
+            if (e->IC_nb!=0 && !icIndex.contains(e->IC_nb))
+                icIndex.insert(e->IC_nb, e);
         }
 		++totalRecords;
 	}
@@ -943,8 +1028,20 @@ bool NebulaMgr::loadNGCNames(const QString& catNGCNames)
 void NebulaMgr::updateI18n()
 {
 	const StelTranslator& trans = StelApp::getInstance().getLocaleMgr().getSkyTranslator();
+	nameI18nIndex.clear();
 	foreach (NebulaP n, nebArray)
+	{
 		n->translateName(trans);
+		const QString name = n->nameI18.toUpper();
+		if (!nameI18nIndex.contains(name))
+			nameI18nIndex.insert(name, n);
+	}
+
+	completionIndexI18n.clear();
+	insertDesignations(completionIndexI18n);
+	foreach (const NebulaP& n, nebArray)
+		completionIndexI18n.insert(n->nameI18, n->nameI18);
+	completionIndexI18n.build();
 }
 
 
@@ -952,149 +1049,71 @@ void NebulaMgr::updateI18n()
 StelObjectP NebulaMgr::searchByNameI18n(const QString& nameI18n) const
 {
 	QString objw = nameI18n.toUpper();
+	unsigned int nb;
+	NebulaP n;
 
 	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	if (objw.mid(0, 3) == "NGC")
-	{
-		foreach (const NebulaP& n, nebArray)
-		{
-			if (QString("NGC%1").arg(n->NGC_nb) == objw || QString("NGC %1").arg(n->NGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
+	if (parseCatalogNumber(objw, "NGC", nb) && (n = ngcIndex.value(nb)))
+		return qSharedPointerCast<StelObject>(n);
 
 	// Search by common names
-	foreach (const NebulaP& n, nebArray)
-	{
-		QString objwcap = n->nameI18.toUpper();
-		if (objwcap==objw)
-			return qSharedPointerCast<StelObject>(n);
-	}
+	if ((n = nameI18nIndex.value(objw)))
+		return qSharedPointerCast<StelObject>(n);
 
 	// Search by IC numbers (possible formats are "IC466" or "IC 466")
-	if (objw.mid(0, 2) == "IC")
-	{
-		foreach (const NebulaP& n, nebArray)
-		{
-			if (QString("IC%1").arg(n->IC_nb) == objw || QString("IC %1").arg(n->IC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
-
+	if (parseCatalogNumber(objw, "IC", nb) && (n = icIndex.value(nb)))
+		return qSharedPointerCast<StelObject>(n);
 
 	// Search by Messier numbers (possible formats are "M31" or "M 31")
-	if (objw.mid(0, 1) == "M")
-	{
-		foreach (const NebulaP& n, nebArray)
-		{
-			if (QString("M%1").arg(n->M_nb) == objw || QString("M %1").arg(n->M_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
+	if (parseCatalogNumber(objw, "M", nb) && (n = mIndex.value(nb)))
+		return qSharedPointerCast<StelObject>(n);
 
 	// Search by Caldwell numbers (possible formats are "C31" or "C 31")
-	if (objw.mid(0, 1) == "C")
-	{
-		foreach (const NebulaP& n, nebArray)
-		{
-			if (QString("C%1").arg(n->C_nb) == objw || QString("C %1").arg(n->C_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
-		}
-	}
+	if (parseCatalogNumber(objw, "C", nb) && (n = cIndex.value(nb)))
+		return qSharedPointerCast<StelObject>(n);
 
 	return StelObjectP();
 }
 
-
 //! Return the matching Nebula object's pointer if exists or NULL
 //! TODO split common parts of this and I18 fn above into a separate fn.
 StelObjectP NebulaMgr::searchByName(const QString& name) const
 {
 	QString objw = name.toUpper();
+	unsigned int nb;
+	NebulaP n;
 
 	    //silas
 	    QRegExp catNumRx1("^(\\d{1,4})$");
-	    if (catNumRx1.exactMatch(objw))
-	    {
-		int num = catNumRx1.capturedTexts().at(1).toInt();
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (QString("NGC%1").arg(n->NGC_nb) == QString("NGC%1").arg(num) || QString("NGC %1").arg(n->NGC_nb) == QString("NGC %1").arg(num))
-			return qSharedPointerCast<StelObject>(n);
-		}
-	    }
-
-
+	    if (catNumRx1.exactMatch(objw) && (n = ngcIndex.value(catNumRx1.capturedTexts().at(1).toUInt())))
+		return qSharedPointerCast<StelObject>(n);
 
 	    QRegExp catNumRx8("^N(\\d+)$");
-	    if (catNumRx8.exactMatch(objw))
-	    {
-		int num = catNumRx8.capturedTexts().at(1).toInt();
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (QString("NGC%1").arg(n->NGC_nb) == QString("NGC%1").arg(num) || QString("NGC %1").arg(n->NGC_nb) == QString("NGC %1").arg(num))
-			return qSharedPointerCast<StelObject>(n);
-		}
-	    }
+	    if (catNumRx8.exactMatch(objw) && (n = ngcIndex.value(catNumRx8.capturedTexts().at(1).toUInt())))
+		return qSharedPointerCast<StelObject>(n);
 	    QRegExp catNumRx81("^I(\\d+)$");
-	    if (catNumRx81.exactMatch(objw))
-	    {
-		int num = catNumRx81.capturedTexts().at(1).toInt();
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (QString("IC%1").arg(n->IC_nb) == QString("IC%1").arg(num) || QString("IC %1").arg(n->IC_nb) == QString("IC %1").arg(num))
-			return qSharedPointerCast<StelObject>(n);
-		}
-	    }
-
+	    if (catNumRx81.exactMatch(objw) && (n = icIndex.value(catNumRx81.capturedTexts().at(1).toUInt())))
+		return qSharedPointerCast<StelObject>(n);
 
 	    // Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	    if (objw.mid(0, 3) == "NGC")
-	    {
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (QString("NGC%1").arg(n->NGC_nb) == objw || QString("NGC %1").arg(n->NGC_nb) == objw)
-			return qSharedPointerCast<StelObject>(n);
-		}
-	    }
+	    if (parseCatalogNumber(objw, "NGC", nb) && (n = ngcIndex.value(nb)))
+		return qSharedPointerCast<StelObject>(n);
 
 	    // Search by common names
-	    foreach (const NebulaP& n, nebArray)
-	    {
-		QString objwcap = n->englishName.toUpper();
-		if (objwcap==objw)
-		    return qSharedPointerCast<StelObject>(n);
-	    }
+	    if ((n = englishNameIndex.value(objw)))
+		return qSharedPointerCast<StelObject>(n);
 
 	    // Search by IC numbers (possible formats are "IC466" or "IC 466")
-	    if (objw.mid(0, 2) == "IC")
-	    {
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (QString("IC%1").arg(n->IC_nb) == objw || QString("IC %1").arg(n->IC_nb) == objw)
-			return qSharedPointerCast<StelObject>(n);
-		}
-	    }
+	    if (parseCatalogNumber(objw, "IC", nb) && (n = icIndex.value(nb)))
+		return qSharedPointerCast<StelObject>(n);
 
 	    // Search by Messier numbers (possible formats are "M31" or "M 31")
-	    if (objw.mid(0, 1) == "M")
-	    {
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (QString("M%1").arg(n->M_nb) == objw || QString("M %1").arg(n->M_nb) == objw)
-			return qSharedPointerCast<StelObject>(n);
-		}
-	    }
+	    if (parseCatalogNumber(objw, "M", nb) && (n = mIndex.value(nb)))
+		return qSharedPointerCast<StelObject>(n);
 
 	    // Search by Caldwell numbers (possible formats are "C31" or "C 31")
-	    if (objw.mid(0, 1) == "C")
-	    {
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (QString("C%1").arg(n->C_nb) == objw || QString("C %1").arg(n->C_nb) == objw)
-			return qSharedPointerCast<StelObject>(n);
-		}
-	    }
+	    if (parseCatalogNumber(objw, "C", nb) && (n = cIndex.value(nb)))
+		return qSharedPointerCast<StelObject>(n);
 
 	    return NULL;
 	/*QString objw = name.toUpper();
@@ -1155,533 +1174,43 @@ StelObjectP NebulaMgr::searchByName(const QString& name) const
 //! Find and return the list of at most maxNbItem objects auto-completing the passed object I18n name
 QStringList NebulaMgr::listMatchingObjectsI18n(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
-	QStringList result;
-	    if (maxNbItem==0) return result;
-
-	    QString objw = objPrefix.toUpper();
-	    // Search by Messier objects number (possible formats are "M31" or "M 31")
-	    if (objw.size()>=1 && objw[0]=='M')
-	    {
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (n->M_nb==0) continue;
-		    QString constw = QString("M%1").arg(n->M_nb);
-		    QString constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-		    {
-			result << constws;
-			continue;	// Prevent adding both forms for name
-		    }
-		    constw = QString("M %1").arg(n->M_nb);
-		    constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-			result << constw;
-		}
-	    }
-
-	    // Search by IC objects number (possible formats are "IC466" or "IC 466")
-	    if (objw.size()>=1 && objw[0]=='I')
-	    {
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (n->IC_nb==0 || n->IC_nb>5386) continue;
-		    QString constw = QString("IC%1").arg(n->IC_nb);
-		    QString constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-		    {
-			result << constws;
-			continue;	// Prevent adding both forms for name
-		    }
-		    constw = QString("IC %1").arg(n->IC_nb);
-		    constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-			result << constw;
-		}
-	    }
-
-	    // Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	    foreach (const NebulaP& n, nebArray)
-	    {
-		if (n->NGC_nb==0) continue;
-		QString constw = QString("NGC%1").arg(n->NGC_nb);
-		QString constws = constw.mid(0, objw.size());
-		if (constws==objw)
-		{
-		    result << constws;
-		    continue;
-		}
-		constw = QString("NGC %1").arg(n->NGC_nb);
-		constws = constw.mid(0, objw.size());
-		if (constws==objw)
-		    result << constw;
-	    }
-
-	    //silas
-	    if (objw.size()>=1 && objw[0]=='N'){
-
-		QRegExp catNumRx11("^N(\\d+)$");
-		if (catNumRx11.exactMatch(objw))
-		{
-		    int num = catNumRx11.capturedTexts().at(1).toInt();
-		    foreach (const NebulaP& n, nebArray)
-		    {
-
-			if (n->NGC_nb==0) continue;
-			QString constw = QString("NGC%1").arg(n->NGC_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==QString("NGC%1").arg(num))
-			{
-			    result << constws;
-			    continue;
-			}
-			constw = QString("NGC %1").arg(n->NGC_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==QString("NGC %1").arg(num))
-			    result << constw;
-		    }
-		}
-	    }
-
-	    // Search by caldwell objects number (possible formats are "C31" or "C 31")
-	    if (objw.size()>=1 && objw[0]=='C')
-	    {
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (n->C_nb==0) continue;
-		    QString constw = QString("C%1").arg(n->C_nb);
-		    QString constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-		    {
-			result << constws;
-			continue;	// Prevent adding both forms for name
-		    }
-		    constw = QString("C %1").arg(n->C_nb);
-		    constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-			result << constw;
-		}
-	    }
-
-	    QString dson;
-	    bool find;
-	    // Search by common names
-	    //exclude pure number
-	    //silas
-	    QRegExp catNumRx11("^(\\d+)$");
-	    if (catNumRx11.exactMatch(objw))
-	    {
-	    }
-	    else{
-		foreach (const NebulaP& n, nebArray)
-		{
-		    dson = n->nameI18;
-		    find = false;
-		    if (useStartOfWords)
-		    {
-			if (dson.mid(0, objw.size()).toUpper()==objw)
-			    find = true;
-
-		    }
-		    else
-		    {
-			if (dson.contains(objPrefix, Qt::CaseInsensitive))
-			    find = true;
-		    }
-		    if (find)
-			result << dson;
-		}
-	    }
-
-
-
-
-
-	    //result.sort();
-	    if (maxNbItem > 0)
-	    {
-		if (result.size()>maxNbItem) result.erase(result.begin()+maxNbItem, result.end());
-	    }
-	    return result;
-	/*QStringList result;
-	if (maxNbItem==0) return result;
-
-	QString objw = objPrefix.toUpper();
-	// Search by Messier objects number (possible formats are "M31" or "M 31")
-	if (objw.size()>=1 && objw[0]=='M')
-	{
-		foreach (const NebulaP& n, nebArray)
-		{
-			if (n->M_nb==0) continue;
-			QString constw = QString("M%1").arg(n->M_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("M %1").arg(n->M_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by IC objects number (possible formats are "IC466" or "IC 466")
-	if (objw.size()>=1 && objw[0]=='I')
-	{
-		foreach (const NebulaP& n, nebArray)
-		{
-            if (n->IC_nb==0 || n->IC_nb>5386) continue;
-			QString constw = QString("IC%1").arg(n->IC_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("IC %1").arg(n->IC_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	foreach (const NebulaP& n, nebArray)
-	{
-		if (n->NGC_nb==0) continue;
-		QString constw = QString("NGC%1").arg(n->NGC_nb);
-		QString constws = constw.mid(0, objw.size());
-		if (constws==objw)
-		{
-			result << constws;
-			continue;
-		}
-		constw = QString("NGC %1").arg(n->NGC_nb);
-		constws = constw.mid(0, objw.size());
-		if (constws==objw)
-			result << constw;
-	}
-
-	// Search by caldwell objects number (possible formats are "C31" or "C 31")
-	if (objw.size()>=1 && objw[0]=='C')
-	{
-		foreach (const NebulaP& n, nebArray)
-		{
-			if (n->C_nb==0) continue;
-			QString constw = QString("C%1").arg(n->C_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("C %1").arg(n->C_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	QString dson;
-	bool find;
-	// Search by common names
-	foreach (const NebulaP& n, nebArray)
-	{
-		dson = n->nameI18;
-		find = false;
-		if (useStartOfWords)
-		{
-			if (dson.mid(0, objw.size()).toUpper()==objw)
-				find = true;
-
-		}
-		else
-		{
-			if (dson.contains(objPrefix, Qt::CaseInsensitive))
-				find = true;
-		}
-		if (find)
-			result << dson;
-	}
-
+	// Names match from the start of any word, unless useStartOfWords asks
+	// for the start of the name. Designations always match from their start.
+	QStringList result = completionIndexI18n.listMatching(objPrefix, maxNbItem, !useStartOfWords);
 	result.sort();
-	if (maxNbItem > 0)
-	{
-		if (result.size()>maxNbItem) result.erase(result.begin()+maxNbItem, result.end());
-	}
 	return result;
-	*/
 }
 
 //! Find and return the list of at most maxNbItem objects auto-completing the passed object English name
 QStringList NebulaMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
 	QStringList result;
-	    if (maxNbItem==0) return result;
-
-	     QString objw = objPrefix.toUpper();
-
-
-	     //silas
-	     if (objw.size()>=1 && objw[0]=='N'){
-
-		 QRegExp catNumRx11("^N(\\d+)$");
-		 if (catNumRx11.exactMatch(objw))
-		 {
-		     int num = catNumRx11.capturedTexts().at(1).toInt();
-		     result << QString("NGC%1").arg(num);
-
-		 }
-	     }
-	     //silas
-	     if (objw.size()>=1 && objw[0]=='I'){
-
-		 QRegExp catNumRx11("^I(\\d+)$");
-		 if (catNumRx11.exactMatch(objw))
-		 {
-		     int num = catNumRx11.capturedTexts().at(1).toInt();
-		     result << QString("IC%1").arg(num);
-
-		 }
-	     }
-	     else if (objw.size()>=1){
-		 QRegExp catNumRx11("^(\\d+)$");
-		 if (catNumRx11.exactMatch(objw))
-		 {
-		     int num = catNumRx11.capturedTexts().at(1).toInt();
-		     if (num <= 110 && num > 0)
-			 result << QString("M%1").arg(num);
-		     if (num <= 7840 && num > 0)
-			 result << QString("NGC%1").arg(num);
-		 }
-	     }
-
-	    // Search by Messier objects number (possible formats are "M31" or "M 31")
-	    if (objw.size()>=1 && objw[0]=='M')
-	    {
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (n->M_nb==0) continue;
-		    QString constw = QString("M%1").arg(n->M_nb);
-		    QString constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-		    {
-			result << constws;
-			continue;	// Prevent adding both forms for name
-		    }
-		    constw = QString("M %1").arg(n->M_nb);
-		    constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-			result << constw;
-		}
-	    }
-
-	    // Search by IC objects number (possible formats are "IC466" or "IC 466")
-	    if (objw.size()>=1 && objw[0]=='I')
-	    {
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (n->IC_nb==0||n->IC_nb>5386) continue;
-		    QString constw = QString("IC%1").arg(n->IC_nb);
-		    QString constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-		    {
-			result << constws;
-			continue;	// Prevent adding both forms for name
-		    }
-		    constw = QString("IC %1").arg(n->IC_nb);
-		    constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-			result << constw;
-		}
-	    }
-
-	    // Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	    foreach (const NebulaP& n, nebArray)
-	    {
-		if (n->NGC_nb==0) continue;
-		QString constw = QString("NGC%1").arg(n->NGC_nb);
-		QString constws = constw.mid(0, objw.size());
-		if (constws==objw)
-		{
-		    result << constws;
-		    continue;
-		}
-		constw = QString("NGC %1").arg(n->NGC_nb);
-		constws = constw.mid(0, objw.size());
-		if (constws==objw)
-		    result << constw;
-	    }
-
-	    // Search by caldwell objects number (possible formats are "C31" or "C 31")
-	    if (objw.size()>=1 && objw[0]=='C')
-	    {
-		foreach (const NebulaP& n, nebArray)
-		{
-		    if (n->C_nb==0) continue;
-		    QString constw = QString("C%1").arg(n->C_nb);
-		    QString constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-		    {
-			result << constws;
-			continue;	// Prevent adding both forms for name
-		    }
-		    constw = QString("C %1").arg(n->C_nb);
-		    constws = constw.mid(0, objw.size());
-		    if (constws==objw)
-			result << constw;
-		}
-	    }
-
-	    QString dson;
-	    bool find;
-	    // Search by common names
-	    //exclude pure number
-	    //silas
-	    QRegExp catNumRx11("^(\\d+)$");
-	    if (catNumRx11.exactMatch(objw))
-	    {
-	    }
-	    else{
-		foreach (const NebulaP& n, nebArray)
-		{
-		    dson = n->englishName;
-		    find = false;
-		    if (useStartOfWords)
-		    {
-			if (dson.mid(0, objw.size()).toUpper()==objw)
-			    find = true;
-
-		    }
-		    else
-		    {
-			if (dson.contains(objPrefix, Qt::CaseInsensitive))
-			    find = true;
-		    }
-		    if (find)
-			result << dson;
-		}
-	    }
-
-
-	    //result.sort();
-	    if (maxNbItem > 0)
-	    {
-		if (result.size()>maxNbItem) result.erase(result.begin()+maxNbItem, result.end());
-	    }
-
-	    return result;
-	/*QStringList result;
-	if (maxNbItem==0) return result;
-
-	 QString objw = objPrefix.toUpper();
-	// Search by Messier objects number (possible formats are "M31" or "M 31")
-	if (objw.size()>=1 && objw[0]=='M')
-	{
-		foreach (const NebulaP& n, nebArray)
-		{
-			if (n->M_nb==0) continue;
-			QString constw = QString("M%1").arg(n->M_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("M %1").arg(n->M_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
+	if (maxNbItem<=0)
+		return result;
 
-	// Search by IC objects number (possible formats are "IC466" or "IC 466")
-	if (objw.size()>=1 && objw[0]=='I')
+	// Shortcuts: "N31" for NGC 31, "I31" for IC 31, and a number for M and NGC
+	const QString objw = objPrefix.toUpper();
+	unsigned int nb;
+	if (parseCatalogNumber(objw, "N", nb))
+		result << QString("NGC%1").arg(nb);
+	else if (parseCatalogNumber(objw, "I", nb))
+		result << QString("IC%1").arg(nb);
+	else if (parseCatalogNumber(objw, "", nb))
 	{
-		foreach (const NebulaP& n, nebArray)
-		{
-            if (n->IC_nb==0 || n->IC_nb>5386) continue;
-			QString constw = QString("IC%1").arg(n->IC_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("IC %1").arg(n->IC_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
+		if (nb<=110)
+			result << QString("M%1").arg(nb);
+		if (nb<=7840)
+			result << QString("NGC%1").arg(nb);
 	}
 
-	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	foreach (const NebulaP& n, nebArray)
+	foreach (const QString& name, completionIndex.listMatching(objw, maxNbItem, !useStartOfWords))
 	{
-		if (n->NGC_nb==0) continue;
-		QString constw = QString("NGC%1").arg(n->NGC_nb);
-		QString constws = constw.mid(0, objw.size());
-		if (constws==objw)
-		{
-			result << constws;
-			continue;
-		}
-		constw = QString("NGC %1").arg(n->NGC_nb);
-		constws = constw.mid(0, objw.size());
-		if (constws==objw)
-			result << constw;
+		if (result.size()>=maxNbItem)
+			break;
+		if (!result.contains(name))
+			result << name;
 	}
-
-	// Search by caldwell objects number (possible formats are "C31" or "C 31")
-	if (objw.size()>=1 && objw[0]=='C')
-	{
-		foreach (const NebulaP& n, nebArray)
-		{
-			if (n->C_nb==0) continue;
-			QString constw = QString("C%1").arg(n->C_nb);
-			QString constws = constw.mid(0, objw.size());
-			if (constws==objw)
-			{
-				result << constws;
-				continue;	// Prevent adding both forms for name
-			}
-			constw = QString("C %1").arg(n->C_nb);
-			constws = constw.mid(0, objw.size());
-			if (constws==objw)
-				result << constw;
-		}
-	}
-
-	QString dson;
-	bool find;
-	// Search by common names
-	foreach (const NebulaP& n, nebArray)
-	{
-		dson = n->englishName;
-		find = false;
-		if (useStartOfWords)
-		{
-			if (dson.mid(0, objw.size()).toUpper()==objw)
-				find = true;
-
-		}
-		else
-		{
-			if (dson.contains(objPrefix, Qt::CaseInsensitive))
-				find = true;
-		}
-		if (find)
-			result << dson;
-	}
-
 	result.sort();
-	if (maxNbItem > 0)
-	{
-		if (result.size()>maxNbItem) result.erase(result.begin()+maxNbItem, result.end());
-	}
-
 	return result;
-	*/
 }
 
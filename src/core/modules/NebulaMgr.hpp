@@ -26,6 +26,7 @@
 #include <QFont>
 #include "StelObjectType.hpp"
 #include "StelFader.hpp"
+#include "StelNameIndex.hpp"
 #include "StelSphericalIndex.hpp"
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
@@ -96,6 +97,10 @@ public:
 	//! @return an list containing the nebulae located inside the limitFov circle around position v.
 	virtual QList<StelObjectP> searchAround(const Vec3d& v, double limitFov, const StelCore* core) const;
 
+	//! Pass the nebulae located inside the limitFov circle around position v to a visitor,
+	//! using the spatial index of the nebulae.
+	virtual void visitAround(const Vec3d& v, double limitFov, const StelCore* core, StelObjectVisitor& visitor) const;
+
 	//! Return the matching nebula object's pointer if exists or NULL.
 	//! @param nameI18n The case in-sensistive nebula name or NGC M catalog name : format can
 	//! be M31, M 31, NGC31, NGC 31
@@ -250,6 +255,23 @@ private:
 
 	QVector<NebulaP> nebArray;		// The nebulas list
 	QHash<unsigned int, NebulaP> ngcIndex;
+	QHash<unsigned int, NebulaP> icIndex;
+	QHash<unsigned int, NebulaP> mIndex;
+	QHash<unsigned int, NebulaP> cIndex;
+	//! Nebulae by uppercase English name
+	QHash<QString, NebulaP> englishNameIndex;
+	//! Nebulae by uppercase translated name, updated by updateI18n()
+	QHash<QString, NebulaP> nameI18nIndex;
+
+	//! English names and designations for auto-completion.
+	StelNameIndex completionIndex;
+	//! Translated names and designations for auto-completion, updated by updateI18n().
+	StelNameIndex completionIndexI18n;
+
+	//! Build the Messier, Caldwell and English name indexes, once the names are loaded.
+	void buildNameIndexes();
+	//! Add the M, IC, NGC and Caldwell designations of all the nebulae to an auto-completion index.
+	void insertDesignations(StelNameIndex& index) const;
 	LinearFader hintsFader;
 	LinearFader flagShow;
 
@@ -208,6 +208,17 @@ void Init3D(const double i, const double Omega, const double w, const double rCo
 }
 
 
+void computeKeplerAnomaly(const double q, const double n, const double e, const double dt, double &rCosNu, double &rSinNu)
+{
+	if (e < 1.0) InitEll(q,n,e,dt,rCosNu,rSinNu); // Laguerre-Conway seems stable enough to go for <1.0.
+	else if (e > 1.0)
+	{
+		// qDebug() << "Hyperbolic orbit for ecc=" << e << ", i=" << i << ", w=" << w << ", Mean Motion n=" << n;
+		InitHyp(q,n,e,dt,rCosNu,rSinNu);
+	}
+	else InitPar(q,n,dt,rCosNu,rSinNu);
+}
+
 CometOrbit::CometOrbit(double pericenterDistance,
                        double eccentricity,
                        double inclination,
@@ -255,13 +266,7 @@ void CometOrbit::positionAtTimevInVSOP87Coordinates(double JDE, double *v, bool
 {
 	JDE -= t0;
 	double rCosNu,rSinNu;
-	if (e < 1.0) InitEll(q,n,e,JDE,rCosNu,rSinNu); // Laguerre-Conway seems stable enough to go for <1.0.
-	else if (e > 1.0)
-	{
-		// qDebug() << "Hyperbolic orbit for ecc=" << e << ", i=" << i << ", w=" << w << ", Mean Motion n=" << n;
-		InitHyp(q,n,e,JDE,rCosNu,rSinNu);
-	}
-	else InitPar(q,n,JDE,rCosNu,rSinNu);
+	computeKeplerAnomaly(q,n,e,JDE,rCosNu,rSinNu);
 	double p0,p1,p2, s0, s1, s2;
 	Init3D(i,Om,w,rCosNu,rSinNu,p0,p1,p2, s0, s1, s2, updateVelocityVector, e, q);
 	v[0] = rotateToVsop87[0]*p0 + rotateToVsop87[1]*p1 + rotateToVsop87[2]*p2;
@@ -122,6 +122,16 @@ private:
 
 typedef CometOrbit KeplerOrbit;
 
+//! Solve the position on a Keplerian orbit around the Sun, using the elliptic, parabolic or hyperbolic
+//! solver depending on the eccentricity, like CometOrbit does.
+//! @param q perihel distance, AU
+//! @param n mean motion, rad/day (for parabolic orbits: W/dt in Heafner's presentation)
+//! @param e eccentricity
+//! @param dt days from perihel
+//! @param rCosNu receives r*cos(nu), nu being the true anomaly
+//! @param rSinNu receives r*sin(nu)
+void computeKeplerAnomaly(const double q, const double n, const double e, const double dt, double &rCosNu, double &rSinNu);
+
 
 class OrbitSampleProc
 {
@@ -30,6 +30,8 @@
 #include "StelSkyDrawer.hpp"
 #include "SolarSystem.hpp"
 #include "Planet.hpp"
+#include "EphemerisCache.hpp"
+#include "stellplanet.h"
 
 #include "StelProjector.hpp"
 #include "sideral_time.h"
@@ -67,6 +69,10 @@ Planet::Planet(const QString& englishName,
 	  lastJD(J2000),
 	  coordFunc(coordFunc),
 	  userDataPtr(auserDataPtr),
+	  ephemerisCache(NULL),
+	  orbitFunc(coordFunc),
+	  orbitRequestJD(0.),
+	  nextOrbitMiddleJD(0.),
 	  osculatingFunc(osculatingFunc),
 	  parent(NULL),
 	  hidden(hidden),
@@ -95,6 +101,7 @@ Planet::~Planet()
 {
 	if (rings)
 		delete rings;
+	delete ephemerisCache;
 }
 
 void Planet::translateName(const StelTranslator& trans)
@@ -289,142 +296,193 @@ Vec3d Planet::getJ2000EquatorialPos(const StelCore *core) const
 	return StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(getHeliocentricEclipticPos() - core->getObserverHeliocentricEclipticPos());
 }
 
+void Planet::enableEphemerisCache(double period)
+{
+	Q_ASSERT(userDataPtr==NULL);
+	delete ephemerisCache;
+	ephemerisCache = new EphemerisCache(coordFunc, period);
+	// Positions now come from different polynomials
+	lastJD = -1e100;
+	orbitCached = 0;
+}
+
+void Planet::computeCoordFunc(double jd, Vec3d& pos)
+{
+	if (ephemerisCache)
+		ephemerisCache->computePosition(jd, pos);
+	else
+		coordFunc(jd, pos, userDataPtr);
+}
+
 // Compute the position in the parent Planet coordinate system
 // Actually call the provided function to compute the ecliptical position
-void Planet::computePositionWithoutOrbits(const double date)
+void Planet::computePosition(const double date)
 {
 	if (fabs(lastJD-date)>deltaJD)
 	{
-		coordFunc(date, eclipticPos, userDataPtr);
+		computeCoordFunc(date, eclipticPos);
 		lastJD = date;
 	}
 }
 
-void Planet::computePosition(const double date)
+void Planet::computePositionAt(double jd, Vec3d& pos, EphemerisContext* ctx) const
 {
+	// orbitFunc is the thread safe coordFunc, the comet coordFunc updates the velocity used by the tails
+	orbitFunc(jd, pos, userDataPtr ? userDataPtr : ctx);
+}
 
-	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJD > 0 && (fabs(lastOrbitJD-date)>deltaOrbitJD || !orbitCached))
+Vec3d Planet::computeHeliocentricEclipticPosAt(double jd, EphemerisContext* ctx) const
+{
+	// Same sum as getHeliocentricEclipticPos(), the Sun is at the origin
+	Vec3d pos(0.);
+	for (const Planet* p=this;p->parent;p=p->parent.data())
 	{
-		double calc_date;
-		// int delta_points = (int)(0.5 + (date - lastOrbitJD)/date_increment);
-		int delta_points;
+		Vec3d local;
+		p->computePositionAt(jd, local, ctx);
+		pos += local;
+	}
+	return pos;
+}
 
-		if( date > lastOrbitJD )
-		{
-			delta_points = (int)(0.5 + (date - lastOrbitJD)/deltaOrbitJD);
-		}
-		else
-		{
-			delta_points = (int)(-0.5 + (date - lastOrbitJD)/deltaOrbitJD);
-		}
-		double new_date = lastOrbitJD + delta_points*deltaOrbitJD;
+bool Planet::requestOrbitUpdate(double date)
+{
+	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJD > 0 && (fabs(lastOrbitJD-date)>deltaOrbitJD || !orbitCached))
+	{
+		orbitRequestJD = date;
+		return true;
+	}
+	return false;
+}
 
-		// qDebug( "Updating orbit coordinates for %s (delta %f) (%d points)\n", name.c_str(), deltaOrbitJD, delta_points);
+void Planet::computeOrbitPos(double jd, Vec3d& pos, EphemerisContext* ctx) const
+{
+	if (osculatingFunc)
+		(*osculatingFunc)(orbitRequestJD, jd, pos, ctx);
+	else if (userDataPtr)
+		orbitFunc(jd, pos, userDataPtr);
+	else
+		orbitFunc(jd, pos, ctx);
+}
 
-		if( delta_points > 0 && delta_points < ORBIT_SEGMENTS && orbitCached)
-		{
+void Planet::computeOrbit()
+{
+	// The ephemeris cache and the static caches of the theories are used by
+	// the main thread, use a private context instead.
+	EphemerisContext ctx;
+	InitEphemerisContext(&ctx);
+
+	const double date = orbitRequestJD;
+	int deltaPoints;
+	if (date > lastOrbitJD)
+		deltaPoints = (int)(0.5 + (date - lastOrbitJD)/deltaOrbitJD);
+	else
+		deltaPoints = (int)(-0.5 + (date - lastOrbitJD)/deltaOrbitJD);
 
-			for( int d=0; d<ORBIT_SEGMENTS-1; d++ )
-			{
-				if(d + delta_points >= ORBIT_SEGMENTS )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJD;
-
-					// date increments between points will not be completely constant though
-					computeTransMatrix(calc_date);
-					if (osculatingFunc)
-					{
-						(*osculatingFunc)(date,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, userDataPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
+	nextOrbitP.clear();
+	nextOrbitJD.clear();
 
-			lastOrbitJD = new_date;
-		}
-		else if( delta_points < 0 && abs(delta_points) < ORBIT_SEGMENTS  && orbitCached)
+	// The osculating orbits change with the date, so they are always sampled again
+	if (deltaPoints && abs(deltaPoints) < ORBIT_SEGMENTS && orbitCached && !osculatingFunc && !orbitJD.isEmpty())
+	{
+		// Keep the points which are still in the line and only sample the new segments
+		nextOrbitMiddleJD = lastOrbitJD + deltaPoints*deltaOrbitJD;
+		const double start = nextOrbitMiddleJD - (ORBIT_SEGMENTS/2)*deltaOrbitJD;
+		const double end = start + ORBIT_SEGMENTS*deltaOrbitJD;
+		const double margin = 1e-6*deltaOrbitJD;
+		int first = 0;
+		int last = orbitJD.size()-1;
+		while (first < last && orbitJD.at(first) < start-margin)
+			++first;
+		while (last > first && orbitJD.at(last) > end+margin)
+			--last;
+
+		if (deltaPoints < 0)
 		{
-
-			for( int d=ORBIT_SEGMENTS-1; d>=0; d-- )
-			{
-				if(d + delta_points < 0 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJD;
-
-					computeTransMatrix(calc_date);
-					if (osculatingFunc) {
-						(*osculatingFunc)(date,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, userDataPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
-
-			lastOrbitJD = new_date;
-
+			sampleOrbit(start, -deltaPoints, NULL, &ctx);
+			// Already in the line
+			nextOrbitP.removeLast();
+			nextOrbitJD.removeLast();
 		}
-		else if( delta_points || !orbitCached)
+		for (int i=first; i<=last; ++i)
 		{
-
-			// update all points (less efficient)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				calc_date = date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJD;
-				computeTransMatrix(calc_date);
-				if (osculatingFunc)
-				{
-					(*osculatingFunc)(date,calc_date,eclipticPos);
-				}
-				else
-				{
-					coordFunc(calc_date, eclipticPos, userDataPtr);
-				}
-				orbitP[d] = eclipticPos;
-				orbit[d] = getHeliocentricEclipticPos();
-			}
-
-			lastOrbitJD = date;
-			if (!osculatingFunc) orbitCached = 1;
+			nextOrbitP.append(orbitP.at(i));
+			nextOrbitJD.append(orbitJD.at(i));
 		}
+		if (deltaPoints > 0)
+			sampleOrbit(orbitJD.at(last), deltaPoints, &orbitP.at(last), &ctx);
+	}
+	else
+	{
+		// update all points (less efficient)
+		nextOrbitMiddleJD = date;
+		sampleOrbit(date - (ORBIT_SEGMENTS/2)*deltaOrbitJD, ORBIT_SEGMENTS, NULL, &ctx);
+	}
+}
 
-
-		// calculate actual Planet position
-		coordFunc(date, eclipticPos, userDataPtr);
-
-		lastJD = date;
-
+void Planet::sampleOrbit(double jd, int nbSegments, const Vec3d* pos, EphemerisContext* ctx)
+{
+	Vec3d pos0, pos1;
+	if (pos)
+	{
+		pos0 = *pos;
 	}
-	else if (fabs(lastJD-date)>deltaJD)
+	else
 	{
-		// calculate actual Planet position
-		coordFunc(date, eclipticPos, userDataPtr);
-		// XXX: do we need to do that even when the orbit is not visible?
-		for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			orbit[d]=getHeliocentricPos(orbitP[d]);
-		lastJD = date;
+		computeOrbitPos(jd, pos0, ctx);
+		nextOrbitP.append(pos0);
+		nextOrbitJD.append(jd);
+	}
+	double jd0 = jd;
+	for (int i=1; i<=nbSegments; ++i)
+	{
+		// Computed from the start so that the dates of the kept points match the new ones
+		const double jd1 = jd + i*deltaOrbitJD;
+		computeOrbitPos(jd1, pos1, ctx);
+		subdivideOrbit(jd0, pos0, jd1, pos1, 0, ctx);
+		jd0 = jd1;
+		pos0 = pos1;
 	}
+}
 
+void Planet::subdivideOrbit(double jd0, const Vec3d& pos0, double jd1, const Vec3d& pos1, int level, EphemerisContext* ctx)
+{
+	// Maximum turn of the line at a point, squared cosine of 1.5 degrees.
+	// An arc of a circle is halved until its segments turn by half its angle,
+	// so a circular orbit ends up with the same 1 degree resolution as the
+	// previous 360 evenly spaced points. Fast moving parts of eccentric orbits
+	// are divided further, slow ones not.
+	static const double maxTurnCos2 = 0.99931477;
+
+	if (level < ORBIT_MAX_SUBDIVISIONS)
+	{
+		const double jdm = 0.5*(jd0+jd1);
+		Vec3d posm;
+		computeOrbitPos(jdm, posm, ctx);
+		const Vec3d d0 = posm-pos0;
+		const Vec3d d1 = pos1-posm;
+		const double l2 = d0.lengthSquared()*d1.lengthSquared();
+		const double c = d0.dot(d1);
+		if (l2>0. && (c<0. || c*c<maxTurnCos2*l2))
+		{
+			subdivideOrbit(jd0, pos0, jdm, posm, level+1, ctx);
+			subdivideOrbit(jdm, posm, jd1, pos1, level+1, ctx);
+			return;
+		}
+		nextOrbitP.append(posm);
+		nextOrbitJD.append(jdm);
+	}
+	nextOrbitP.append(pos1);
+	nextOrbitJD.append(jd1);
+}
+
+void Planet::applyOrbitUpdate()
+{
+	orbitP.swap(nextOrbitP);
+	orbitJD.swap(nextOrbitJD);
+	lastOrbitJD = nextOrbitMiddleJD;
+	orbitCached = 1;
+	nextOrbitP.clear();
+	nextOrbitJD.clear();
 }
 
 // Compute the transformation matrix from the local Planet coordinate to the parent Planet coordinate
@@ -436,10 +494,15 @@ void Planet::computeTransMatrix(double jd)
 	// not solar equator...
 	if (parent)
 	{
-		rotLocalToParent = Mat4d::zrotation(re.ascendingNode - re.precessionRate*(jd-re.epoch)) * Mat4d::xrotation(re.obliquity);
+		rotLocalToParent = computeRotLocalToParent(jd);
 	}
 }
 
+Mat4d Planet::computeRotLocalToParent(double jd) const
+{
+	return Mat4d::zrotation(re.ascendingNode - re.precessionRate*(jd-re.epoch)) * Mat4d::xrotation(re.obliquity);
+}
+
 Mat4d Planet::getRotEquatorialToVsop87(void) const
 {
 	Mat4d rval = rotLocalToParent;
@@ -451,6 +514,18 @@ Mat4d Planet::getRotEquatorialToVsop87(void) const
 	return rval;
 }
 
+Mat4d Planet::computeRotEquatorialToVsop87(double jd) const
+{
+	// Same chain as getRotEquatorialToVsop87(), the matrix of the Sun is never recomputed
+	Mat4d rval = parent ? computeRotLocalToParent(jd) : rotLocalToParent;
+	if (parent)
+	{
+		for (const Planet* p=parent.data();p->parent;p=p->parent.data())
+			rval = p->computeRotLocalToParent(jd) * rval;
+	}
+	return rval;
+}
+
 void Planet::setRotEquatorialToVsop87(const Mat4d &m)
 {
 	Mat4d a = Mat4d::identity();
@@ -480,7 +555,7 @@ double Planet::getSiderealTime(double jd) const
 	{
 		// use semi-empirical coefficient for GRS drift
 		// TODO: need improved
-		return remainder * 360. + re.offset - 0.2483 * std::abs(StelApp::getInstance().getCore()->getJDay() - 2456172);
+		return remainder * 360. + re.offset - 0.2483 * std::abs(jd - 2456172);
 	}
 	else
 		return remainder * 360. + re.offset;
@@ -607,18 +682,23 @@ double Planet::getElongation(const Vec3d& obsPos) const
 
 // Computation of the visual magnitude (V band) of the planet.
 float Planet::getVMagnitude(const StelCore* core) const
+{
+	const Vec3d parentHelioPos = parent ? parent->getHeliocentricEclipticPos() : Vec3d(0.);
+	return computeVMagnitude(core->getObserverHeliocentricEclipticPos(), getHeliocentricEclipticPos(), parentHelioPos,
+				 core->getJDay(), core->getCurrentLocation().planetName=="Earth");
+}
+
+float Planet::computeVMagnitude(const Vec3d& observerHelioPos, const Vec3d& planetHelioPos, const Vec3d& parentHelioPos, double jd, bool fromEarth) const
 {
 	if (parent == 0)
 	{
 		// sun, compute the apparent magnitude for the absolute mag (4.83) and observer's distance
-		const double distParsec = std::sqrt(core->getObserverHeliocentricEclipticPos().lengthSquared())*AU/PARSEC;
+		const double distParsec = std::sqrt(observerHelioPos.lengthSquared())*AU/PARSEC;
 		return 4.83 + 5.*(std::log10(distParsec)-1.);
 	}
 
 	// Compute the angular phase
-	const Vec3d& observerHelioPos = core->getObserverHeliocentricEclipticPos();
 	const double observerRq = observerHelioPos.lengthSquared();
-	const Vec3d& planetHelioPos = getHeliocentricEclipticPos();
 	const double planetRq = planetHelioPos.lengthSquared();
 	const double observerPlanetRq = (observerHelioPos - planetHelioPos).lengthSquared();
 	const double cos_chi = (observerPlanetRq + planetRq - observerRq)/(2.0*sqrt(observerPlanetRq*planetRq));
@@ -628,9 +708,8 @@ float Planet::getVMagnitude(const StelCore* core) const
 	// Check if the satellite is inside the inner shadow of the parent planet:
 	if (parent->parent != 0)
 	{
-		const Vec3d& parentHeliopos = parent->getHeliocentricEclipticPos();
-		const double parent_Rq = parentHeliopos.lengthSquared();
-		const double pos_times_parent_pos = planetHelioPos * parentHeliopos;
+		const double parent_Rq = parentHelioPos.lengthSquared();
+		const double pos_times_parent_pos = planetHelioPos * parentHelioPos;
 		if (pos_times_parent_pos > parent_Rq)
 		{
 			// The satellite is farther away from the sun than the parent planet.
@@ -657,7 +736,7 @@ float Planet::getVMagnitude(const StelCore* core) const
 	}
 
 	// Use empirical formulae for main planets when seen from earth
-	if (core->getCurrentLocation().planetName=="Earth")
+	if (fromEarth)
 	{
 		const double phaseDeg=phase*180./M_PI;
 		const double d = 5. * log10(sqrt(observerPlanetRq*planetRq));
@@ -711,12 +790,11 @@ float Planet::getVMagnitude(const StelCore* core) const
 		{
 			// add rings computation
 			// GZ: implemented from Meeus, Astr.Alg.1992
-			const double jd=core->getJDay();
 			const double T=(jd-2451545.0)/36525.0;
 			const double i=((0.000004*T-0.012998)*T+28.075216)*M_PI/180.0;
 			const double Omega=((0.000412*T+1.394681)*T+169.508470)*M_PI/180.0;
-			SolarSystem *ssystem=GETSTELMODULE(SolarSystem);
-			const Vec3d saturnEarth=getHeliocentricEclipticPos() - ssystem->getEarth()->getHeliocentricEclipticPos();
+			// The observer is on the Earth, its distance to the center does not matter here
+			const Vec3d saturnEarth=planetHelioPos - observerHelioPos;
 			double lambda=atan2(saturnEarth[1], saturnEarth[0]);
 			double beta=atan2(saturnEarth[2], sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 			const double sinB=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
@@ -1153,19 +1231,33 @@ void Planet::drawOrbit(const StelCore* core)
 
 	sPainter.setColor(orbitColor[0], orbitColor[1], orbitColor[2], orbitFader.getInterstate());
 	Vec3d onscreen;
-	// special case - use current Planet position as center vertex so that draws
-	// on it's orbit all the time (since segmented rather than smooth curve)
-	Vec3d savePos = orbit[ORBIT_SEGMENTS/2];
-	orbit[ORBIT_SEGMENTS/2]=getHeliocentricEclipticPos();
-	orbit[ORBIT_SEGMENTS]=orbit[0];
-	int nbIter = closeOrbit ? ORBIT_SEGMENTS : ORBIT_SEGMENTS-1;
+	// The line is stored relative to the parent, which has moved since
+	const Vec3d parentPos = getHeliocentricPos(Vec3d(0.,0.,0.));
+	QVarLengthArray<Vec3d, 512> points;
+	points.reserve(orbitP.size()+2);
+	bool currentPosAdded = false;
+	for (int i=0; i<orbitP.size(); ++i)
+	{
+		// special case - use current Planet position as a vertex so that it
+		// draws on its orbit all the time (since segmented rather than smooth curve)
+		if (!currentPosAdded && orbitJD.at(i)>=lastJD)
+		{
+			points.append(getHeliocentricEclipticPos());
+			currentPosAdded = true;
+			if (orbitJD.at(i)==lastJD)
+				continue;
+		}
+		points.append(parentPos+orbitP.at(i));
+	}
+	if (closeOrbit && !points.isEmpty())
+		points.append(points.at(0));
 	QVarLengthArray<float, 1024> vertexArray;
 
 	sPainter.enableClientStates(true, false, false);
 
-	for (int n=0; n<=nbIter; ++n)
+	for (int n=0; n<points.size(); ++n)
 	{
-		if (prj->project(orbit[n],onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(orbit[n-1], orbit[n])))
+		if (prj->project(points[n],onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(points[n-1], points[n])))
 		{
 			vertexArray.append(onscreen[0]);
 			vertexArray.append(onscreen[1]);
@@ -1177,7 +1269,6 @@ void Planet::drawOrbit(const StelCore* core)
 			vertexArray.clear();
 		}
 	}
-	orbit[ORBIT_SEGMENTS/2]=savePos;
 	if (!vertexArray.isEmpty())
 	{
 		sPainter.setVertexPointer(2, GL_FLOAT, vertexArray.constData());
@@ -21,6 +21,7 @@
 #define _PLANET_HPP_
 
 #include <QString>
+#include <QVector>
 
 #include "StelObject.hpp"
 #include "StelProjector.hpp"
@@ -33,14 +34,20 @@
 // The last variable is the userData pointer.
 typedef void (*posFuncType)(double, double*, void*);
 
-typedef void (OsculatingFunctType)(double jd0,double jd,double xyz[3]);
+// The last variable is the EphemerisContext pointer, see stellplanet.h.
+typedef void (OsculatingFunctType)(double jd0,double jd,double xyz[3],void*);
 
 // epoch J2000: 12 UT on 1 Jan 2000
 #define J2000 2451545.0
-#define ORBIT_SEGMENTS 360
+// Number of segments of the orbit line before subdivision
+#define ORBIT_SEGMENTS 90
+// Maximum number of times a segment of the orbit line is halved
+#define ORBIT_MAX_SUBDIVISIONS 8
 
 class StelFont;
 class StelPainter;
+class EphemerisCache;
+struct EphemerisContext;
 class StelTranslator;
 
 struct TrailPoint
@@ -155,12 +162,36 @@ public:
 	double getSiderealTime(double jd) const;
 	Mat4d getRotEquatorialToVsop87(void) const;
 	void setRotEquatorialToVsop87(const Mat4d &m);
+	//! Compute the rotation from the equatorial frame of the planet to VSOP87 at the given date,
+	//! as computeTransMatrix() would set it, without modifying the planet.
+	Mat4d computeRotEquatorialToVsop87(double jd) const;
 
 	const RotationElements &getRotationElements(void) const {return re;}
 
 	// Compute the position in the parent Planet coordinate system
-	void computePositionWithoutOrbits(const double date);
 	void computePosition(const double date);
+	//! Compute the position in the parent Planet coordinate system at the given date, without
+	//! modifying the planet. Unlike computePosition(), it does not use the ephemeris cache nor the
+	//! static caches of the theories, and can be run on worker threads, each with its own context.
+	//! It uses orbitFunc, which unlike coordFunc does not update the velocity used by the comet tails.
+	void computePositionAt(double jd, Vec3d& pos, EphemerisContext* ctx) const;
+	//! Compute the heliocentric ecliptical position at the given date, like computePositionAt().
+	Vec3d computeHeliocentricEclipticPosAt(double jd, EphemerisContext* ctx) const;
+
+	//! Return whether the orbit line must be sampled again for the given date.
+	//! If so, the date is kept for the next call to computeOrbit().
+	bool requestOrbitUpdate(double date);
+	//! Sample the orbit line for the date given to requestOrbitUpdate().
+	//! Only the samples which are not already known are computed. The new line is
+	//! kept aside until applyOrbitUpdate() is called, so that the current one can
+	//! still be drawn meanwhile. Can be run on a worker thread, concurrently with
+	//! the other planets and with the main thread.
+	void computeOrbit();
+	//! Replace the orbit line by the one sampled by computeOrbit().
+	void applyOrbitUpdate();
+	//! Set the function used by computeOrbit() instead of the position function.
+	//! It must give the same positions without modifying any shared data.
+	void setOrbitFunc(posFuncType func) {orbitFunc = func;}
 
 	// Compute the transformation matrix from the local Planet coordinate to the parent Planet coordinate
 	void computeTransMatrix(double date);
@@ -173,6 +204,15 @@ public:
 	double getSpheroidAngularSize(const StelCore* core) const;
 	// Get the planet phase for an observer at pos obsPos in heliocentric coordinates (in AU)
 	float getPhase(const Vec3d& obsPos) const;
+	//! Compute the visual magnitude without extinction from heliocentric positions in AU.
+	//! getVMagnitude() calls it with the current positions. It only reads constant data and
+	//! can be run on worker threads.
+	//! @param parentHelioPos the position of the parent planet, used for the shadow on satellites.
+	//! @param jd the date, used for the rings of Saturn.
+	//! @param fromEarth whether the observer is on the Earth, in which case empirical formulae are
+	//! used for the major planets.
+	virtual float computeVMagnitude(const Vec3d& observerHelioPos, const Vec3d& planetHelioPos,
+					const Vec3d& parentHelioPos, double jd, bool fromEarth) const;
 
 	// Set the orbital elements
 	void setRotationElements(float _period, float _offset, double _epoch,
@@ -213,6 +253,14 @@ public:
 	void setFlagLabels(bool b){flagLabels = b;}
 	bool getFlagLabels(void) const {return flagLabels;}
 
+	//! Compute the positions from Chebyshev polynomials fitted to coordFunc instead of
+	//! calling it for every date. Only for the analytical theories, i.e. when the position
+	//! function does not use its user data pointer. See EphemerisCache.
+	//! @param period the orbital period of the planet in days.
+	void enableEphemerisCache(double period);
+	//! Get the ephemeris cache of the planet, or NULL if it is not enabled.
+	const EphemerisCache* getEphemerisCache() const {return ephemerisCache;}
+
 	///////////////////////////////////////////////////////////////////////////
 	// DEPRECATED
 	///// Orbit related code
@@ -222,11 +270,11 @@ public:
 	LinearFader orbitFader;
 	// draw orbital path of Planet
 	void drawOrbit(const StelCore*);
-	Vec3d orbit[ORBIT_SEGMENTS+1];   // store heliocentric coordinates for drawing the orbit
-	Vec3d orbitP[ORBIT_SEGMENTS+1];  // store local coordinate for orbit
-	double lastOrbitJD;
+	QVector<Vec3d> orbitP;           // store local coordinate for orbit
+	QVector<double> orbitJD;         // dates of the points of orbitP
+	double lastOrbitJD;              // date at the middle of the orbit line
 	double deltaJD;
-	double deltaOrbitJD;
+	double deltaOrbitJD;             // time between two points before subdivision
 	bool orbitCached;                // whether orbit calculations are cached for drawing orbit yet
 	bool closeOrbit;                 // whether to connect the beginning of the orbit line to
 					 // the end: good for elliptical orbits, bad for parabolic
@@ -254,6 +302,22 @@ protected:
 	// Draw the circle and name of the Planet
 	void drawHints(const StelCore* core, const QFont& planetNameFont);
 
+	// Compute the position in the parent Planet coordinate system with coordFunc,
+	// or with the ephemeris cache if enabled
+	void computeCoordFunc(double jd, Vec3d& pos);
+
+	// Compute the transformation matrix from the local Planet coordinate to the parent Planet coordinate at jd
+	Mat4d computeRotLocalToParent(double jd) const;
+
+	// Compute a point of the orbit line, see computeOrbit()
+	void computeOrbitPos(double jd, Vec3d& pos, EphemerisContext* ctx) const;
+	// Sample the orbit line from jd over nbSegments, appending the points to
+	// nextOrbitP and nextOrbitJD. If pos is not NULL, it is the position at jd.
+	void sampleOrbit(double jd, int nbSegments, const Vec3d* pos, EphemerisContext* ctx);
+	// Subdivide the orbit line between two points where it turns too much,
+	// appending the points after the first one
+	void subdivideOrbit(double jd0, const Vec3d& pos0, double jd1, const Vec3d& pos1, int level, EphemerisContext* ctx);
+
 	QString englishName;             // english planet name
 	QString nameI18;                 // International translated name
 	QString texMapName;              // Texture file path	
@@ -280,6 +344,14 @@ protected:
 	// The callback for the calculation of the equatorial rect heliocentric position at time JD.
 	posFuncType coordFunc;
 	void* userDataPtr;
+	EphemerisCache* ephemerisCache;  // Approximation of coordFunc, or NULL
+	posFuncType orbitFunc;           // Thread safe coordFunc used for the orbit line
+
+	// Orbit line being sampled by computeOrbit()
+	double orbitRequestJD;
+	QVector<Vec3d> nextOrbitP;
+	QVector<double> nextOrbitJD;
+	double nextOrbitMiddleJD;
 
 	OsculatingFunctType *const osculatingFunc;
 	QSharedPointer<Planet> parent;           // Planet parent i.e. sun for earth
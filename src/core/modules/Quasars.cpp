@@ -95,6 +95,7 @@ Quasars::~Quasars()
 void Quasars::deinit()
 {
 	QSO.clear();
+	nameIndex.clear();
 	Quasar::markerTexture.clear();
 	texPointer.clear();
 }
@@ -230,12 +231,17 @@ void Quasars::drawPointer(StelCore* core, StelPainter& painter)
 	}
 }
 
-QList<StelObjectP> Quasars::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
+QList<StelObjectP> Quasars::searchAround(const Vec3d& av, double limitFov, const StelCore* core) const
 {
-	QList<StelObjectP> result;
+	StelObjectListVisitor visitor;
+	visitAround(av, limitFov, core, visitor);
+	return visitor.result;
+}
 
+void Quasars::visitAround(const Vec3d& av, double limitFov, const StelCore*, StelObjectVisitor& visitor) const
+{
 	if (!flagShowQuasars)
-		return result;
+		return;
 
 	Vec3d v(av);
 	v.normalize();
@@ -250,12 +256,11 @@ QList<StelObjectP> Quasars::searchAround(const Vec3d& av, double limitFov, const
 			equPos.normalize();
 			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
 			{
-				result.append(qSharedPointerCast<StelObject>(quasar));
+				if (!visitor.visit(qSharedPointerCast<StelObject>(quasar)))
+					return;
 			}
 		}
 	}
-
-	return result;
 }
 
 StelObjectP Quasars::searchByName(const QString& englishName) const
@@ -288,81 +293,18 @@ StelObjectP Quasars::searchByNameI18n(const QString& nameI18n) const
 
 QStringList Quasars::listMatchingObjectsI18n(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
-	QStringList result;
-    bool find;
-
-    QString objw = objPrefix.toUpper();
-
-	if (flagShowQuasars)
-	{
-        for (const auto& quasar : QSO)
-		{
-            find = false;
-			if (useStartOfWords)
-			{
-                if (quasar->getNameI18n().toUpper().left(objw.length()) == objw)
-				{
-					find = true;
-				}
-			}
-			else
-			{
-                if (quasar->getNameI18n().toUpper().contains(objw, Qt::CaseInsensitive))
-				{
-					find = true;
-				}
-			}
-			if (find)
-			{
-                result << quasar->getNameI18n().toUpper();
-			}
-		}
-	}
-
-	result.sort();
-	if (result.size()>maxNbItem) result.erase(result.begin()+maxNbItem, result.end());
-
-	return result;
+	return listMatchingObjects(objPrefix, maxNbItem, useStartOfWords);
 }
 
-
-
 QStringList Quasars::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
 	QStringList result;
-    bool find;
-
-    QString objw = objPrefix.toUpper();
-
 	if (flagShowQuasars)
 	{
-        for (const auto&quasar : QSO)
-		{
-			find = false;
-			if (useStartOfWords)
-			{
-                if (quasar->getEnglishName().toUpper().left(objw.length()) == objw)
-				{
-					find = true;
-				}
-			}
-			else
-			{
-                if (quasar->getEnglishName().toUpper().contains(objw, Qt::CaseInsensitive))
-				{
-					find = true;
-				}
-			}
-			if (find)
-			{
-                result << quasar->getEnglishName().toUpper();
-			}
-		}
+		// Names match from the start of any word, unless useStartOfWords asks for the start of the name
+		result = nameIndex.listMatching(objPrefix, maxNbItem, !useStartOfWords);
+		result.sort();
 	}
-
-	result.sort();
-	if (result.size()>maxNbItem) result.erase(result.begin()+maxNbItem, result.end());
-
 	return result;
 }
 
@@ -510,6 +452,14 @@ void Quasars::setQSOMap(const QVariantMap& map)
 		if (quasar->initialized)
 			QSO.append(quasar);
 	}
+
+	nameIndex.clear();
+	for (const auto& quasar : QSO)
+	{
+		const QString name = quasar->getEnglishName().toUpper();
+		nameIndex.insert(name, name);
+	}
+	nameIndex.build();
 }
 
 int Quasars::getJsonFileFormatVersion(void)
@@ -21,6 +21,7 @@
 
 #include "StelObjectModule.hpp"
 #include "StelObject.hpp"
+#include "StelNameIndex.hpp"
 #include "StelTextureTypes.hpp"
 #include "Quasar.hpp"
 #include <QFont>
@@ -111,6 +112,9 @@ public:
 	//! @return a list containing the quasars located inside the limitFov circle around position v.
 	virtual QList<StelObjectP> searchAround(const Vec3d& v, double limitFov, const StelCore* core) const;
 
+	//! Pass the objects which searchAround() would return to a visitor, without building a list.
+	virtual void visitAround(const Vec3d& v, double limitFov, const StelCore* core, StelObjectVisitor& visitor) const;
+
 	//! Return the matching Quasar object's pointer if exists or Q_NULLPTR.
 	//! @param nameI18n The case in-sensitive localized quasar name
 	virtual StelObjectP searchByNameI18n(const QString& nameI18n) const;
@@ -287,6 +291,8 @@ private:
 
 	StelTextureSP texPointer;
 	QList<QuasarP> QSO;
+	//! Uppercase designations for auto-completion. They are not translated.
+	StelNameIndex nameIndex;
 
 	// variables and functions for the updater
 	UpdateState updateState;
@@ -433,7 +433,17 @@ void Satellite::update(double)
     {
         StelCore* core = StelApp::getInstance().getCore();
         double JD = core->getJDay();
-        epochTime = JD - core->getDeltaT(JD)/86400; // Delta T anti-correction for artificial satellites
+        gSatWrapper::EpochData data;
+        gSatWrapper::computeEpochData(JD - core->getDeltaT(JD)/86400, data); // Delta T anti-correction for artificial satellites
+        update(data);
+    }
+}
+
+void Satellite::update(const gSatWrapper::EpochData& data)
+{
+    if (pSatWrapper && orbitValid)
+    {
+        epochTime = data.epoch;
 
         pSatWrapper->setEpoch(epochTime);
         position                 = pSatWrapper->getTEMEPos();
@@ -453,15 +463,15 @@ void Satellite::update(double)
             return;
         }
 
-        elAzPosition             = pSatWrapper->getAltAz();
+        elAzPosition             = pSatWrapper->getAltAz(data);
         elAzPosition.normalize();
 
-        pSatWrapper->getSlantRange(range, rangeRate);
-        visibility = pSatWrapper->getVisibilityPredict();
-        phaseAngle = pSatWrapper->getPhaseAngle();
+        pSatWrapper->getSlantRange(data, range, rangeRate);
+        visibility = pSatWrapper->getVisibilityPredict(data);
+        phaseAngle = pSatWrapper->getPhaseAngle(data);
 
         // Compute orbit points to draw orbit line.
-        if (orbitDisplayed) computeOrbitPoints();
+        if (orbitDisplayed) computeOrbitPoints(data);
     }
 }
 
@@ -687,8 +697,10 @@ float Satellite::calculateOrbitSegmentIntensity(int segNum)
     }
 }
 
-void Satellite::computeOrbitPoints()
+void Satellite::computeOrbitPoints(const gSatWrapper::EpochData& data)
 {
+    // Copy of data moved to the epoch of each orbit point
+    gSatWrapper::EpochData pointData = data;
     gTimeSpan computeInterval(0, 0, 0, orbitLineSegmentDuration);
     gTimeSpan orbitSpan(0, 0, 0, orbitLineSegments*orbitLineSegmentDuration/2);
     gTime epochTm;
@@ -705,7 +717,8 @@ void Satellite::computeOrbitPoints()
         for (int i=0; i<=orbitLineSegments; i++)
         {
             pSatWrapper->setEpoch(epochTm.getGmtTm());
-            elAzVector  = pSatWrapper->getAltAz();
+            gSatWrapper::setObserverDataEpoch(epochTm.getGmtTm(), pointData);
+            elAzVector  = pSatWrapper->getAltAz(pointData);
             orbitPoints.append(elAzVector);
             epochTm    += computeInterval;
         }
@@ -734,7 +747,8 @@ void Satellite::computeOrbitPoints()
                 //remove points at beginning of list and add points at end.
                 orbitPoints.removeFirst();
                 pSatWrapper->setEpoch(epochTm.getGmtTm());
-                elAzVector  = pSatWrapper->getAltAz();
+                gSatWrapper::setObserverDataEpoch(epochTm.getGmtTm(), pointData);
+                elAzVector  = pSatWrapper->getAltAz(pointData);
                 orbitPoints.append(elAzVector);
                 epochTm    += computeInterval;
             }
@@ -762,7 +776,8 @@ void Satellite::computeOrbitPoints()
             { //remove points at end of list and add points at beginning.
                 orbitPoints.removeLast();
                 pSatWrapper->setEpoch(epochTm.getGmtTm());
-                elAzVector  = pSatWrapper->getAltAz();
+                gSatWrapper::setObserverDataEpoch(epochTm.getGmtTm(), pointData);
+                elAzVector  = pSatWrapper->getAltAz(pointData);
                 orbitPoints.push_front(elAzVector);
                 epochTm -= computeInterval;
 
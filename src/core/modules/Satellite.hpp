@@ -137,6 +137,9 @@ public:
 
 	// calculate faders, new position
 	void update(double deltaTime);
+	//! Compute the new position for the epoch of data, see gSatWrapper::computeEpochData().
+	//! Only modifies this satellite, so that several satellites can be updated in parallel.
+	void update(const gSatWrapper::EpochData& data);
 
 	double getDoppler(double freq) const;
 	static float showLabels;
@@ -166,7 +169,8 @@ public:
 
 private:
 	//draw orbits methods
-	void computeOrbitPoints();
+	//! Compute the orbit line around the epoch of data, for the observer of data.
+	void computeOrbitPoints(const gSatWrapper::EpochData& data);
 	void drawOrbit(StelPainter& painter);
 	//! returns 0 - 1.0 for the DRAWORBIT_FADE_NUMBER segments at
 	//! each end of an orbit, with 1 in the middle.
@@ -246,12 +250,6 @@ private:
 	double    lastEpochCompForOrbit; //measured in Julian Days
 	double    epochTime;  //measured in Julian Days
 	QList<Vec3f> orbitPoints; //orbit points represented by ElAzPos vectors
-
-	// Used for optimization.  Where a satellite is not visible, we put it
-	// in the asleep state, where it is not updated or rendered anymore.
-	// The satellite manager takes care of waking up satellites after a
-	// while.
-	bool asleep = false;
 };
 
 typedef QSharedPointer<Satellite> SatelliteP;
@@ -50,9 +50,46 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QtConcurrent>
 
 #define SATELLITES_VERSION "0.8.1"
 
+namespace
+{
+	//! Pass the satellites found in the pick index to a visitor.
+	struct VisitSatelliteFuncObject
+	{
+		VisitSatelliteFuncObject(const QList<SatelliteP>& satellites, StelObjectVisitor& visitor) : satellites(satellites), visitor(visitor) {}
+		bool operator()(int i) {return visitor.visit(qSharedPointerCast<StelObject>(satellites.at(i)));}
+		const QList<SatelliteP>& satellites;
+		StelObjectVisitor& visitor;
+	};
+
+	//! Collect the names of the displayed satellites found in a name index.
+	struct ListSatellitesFuncObject
+	{
+		ListSatellitesFuncObject(const QList<SatelliteP>& satellites, QStringList& result, int maxNbItem) : satellites(satellites), result(result), maxNbItem(maxNbItem) {}
+		bool operator()(const QString& name, int i)
+		{
+			const Satellite* sat = satellites.at(i).data();
+			if (sat->initialized && sat->displayed && !result.contains(name))
+				result << name;
+			return result.size()<maxNbItem;
+		}
+		const QList<SatelliteP>& satellites;
+		QStringList& result;
+		const int maxNbItem;
+	};
+
+	//! Propagate a satellite to a shared epoch, used by QtConcurrent::blockingMap.
+	struct SatelliteUpdateFuncObject
+	{
+		SatelliteUpdateFuncObject(const gSatWrapper::EpochData& data) : data(data) {}
+		void operator()(Satellite* sat) const {sat->update(data);}
+		const gSatWrapper::EpochData& data;
+	};
+}
+
 
 TleSource::~TleSource()
 {
@@ -63,6 +100,8 @@ TleSource::~TleSource()
 
 Satellites::Satellites() :
 	  earth(NULL),
+	  pickIndexValid(false),
+	  nameIndexValid(false),
 	  defaultHintColor(0.0, 0.4, 0.6),
 	  defaultOrbitColor(0.0, 0.3, 0.6)
 {
@@ -217,30 +256,39 @@ double Satellites::getCallOrder(StelModuleActionName actionName) const
 	return 0;
 }
 
-QList<StelObjectP> Satellites::searchAround(const Vec3d& av, double limitFov, const StelCore*) const
+void Satellites::visitAround(const Vec3d& av, double limitFov, const StelCore*, StelObjectVisitor& visitor) const
 {
-	QList<StelObjectP> result;
 	if (!fader || StelApp::getInstance().getCore()->getCurrentLocation().planetName != earth->getEnglishName() || !isValidRangeDates())
-		return result;
-
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
+		return;
 
-	foreach(const SatelliteP& sat, satellites)
+	if (!pickIndexValid)
 	{
-		if (sat->initialized && sat->displayed)
+		pickIndex.clear();
+		for (int i=0;i<satellites.size();++i)
 		{
-			equPos = sat->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
+			const Satellite* sat = satellites.at(i).data();
+			if (sat->initialized && sat->displayed && sat->XYZ.lengthSquared()>0.)
 			{
-				result.append(qSharedPointerCast<StelObject>(sat));
+				Vec3d equPos = sat->XYZ;
+				equPos.normalize();
+				pickIndex.insert(i, equPos);
 			}
 		}
+		pickIndex.build();
+		pickIndexValid = true;
 	}
-	return result;
+
+	Vec3d v(av);
+	v.normalize();
+	VisitSatelliteFuncObject func(satellites, visitor);
+	pickIndex.processAround(v, cos(limitFov * M_PI/180.), func);
+}
+
+QList<StelObjectP> Satellites::searchAround(const Vec3d& av, double limitFov, const StelCore* core) const
+{
+	StelObjectListVisitor visitor;
+	visitAround(av, limitFov, core, visitor);
+	return visitor.result;
 }
 
 StelObjectP Satellites::searchByNameI18n(const QString& nameI18n) const
@@ -315,56 +363,8 @@ StelObjectP Satellites::searchByNoradNumber(const QString &noradNumber) const
 
 QStringList Satellites::listMatchingObjectsI18n(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
-	QStringList result;
-	if (!fader || StelApp::getInstance().getCore()->getCurrentLocation().planetName != earth->getEnglishName() || !isValidRangeDates())
-		return result;
-	if (maxNbItem==0) return result;
-
-	QString objw = objPrefix.toUpper();
-
-	QString numberPrefix;
-	QRegExp regExp("^(NORAD)\\s*(\\d+)\\s*$");
-	if (regExp.exactMatch(objw))
-	{
-		QString numberString = regExp.capturedTexts().at(2);
-		numberPrefix = numberString;
-	}
-	bool find;
-	foreach(const SatelliteP& sat, satellites)
-	{
-		if (sat->initialized && sat->displayed)
-		{
-			find = false;
-			if (useStartOfWords)
-			{
-				if (sat->getNameI18n().toUpper().left(objw.length()) == objw)
-				{
-					find = true;
-				}
-			}
-			else
-			{
-				if (sat->getNameI18n().toUpper().contains(objw, Qt::CaseInsensitive))
-				{
-					find = true;
-				}
-			}
-
-			if (find)
-			{
-				result << sat->getNameI18n().toUpper();
-			}
-			else if (!numberPrefix.isEmpty() && sat->getCatalogNumberString().left(numberPrefix.length()) == numberPrefix)
-			{
-				result << QString("NORAD %1").arg(sat->getCatalogNumberString());
-			}
-		}
-	}
-
-	result.sort();
-	if (result.size()>maxNbItem) result.erase(result.begin()+maxNbItem, result.end());
-
-	return result;
+	// The names of the satellites are not translated
+	return listMatchingObjects(objPrefix, maxNbItem, useStartOfWords);
 }
 
 QStringList Satellites::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
@@ -372,54 +372,35 @@ QStringList Satellites::listMatchingObjects(const QString& objPrefix, int maxNbI
 	QStringList result;
 	if (!fader || StelApp::getInstance().getCore()->getCurrentLocation().planetName != earth->getEnglishName() || !isValidRangeDates())
 		return result;
-	if (maxNbItem==0) return result;
+	if (maxNbItem<=0) return result;
 
-	QString objw = objPrefix.toUpper();
-
-	QString numberPrefix;
-	QRegExp regExp("^(NORAD)\\s*(\\d+)\\s*$");
-	if (regExp.exactMatch(objw))
+	if (!nameIndexValid)
 	{
-		QString numberString = regExp.capturedTexts().at(2);
-		bool ok;
-		/* int number = */ numberString.toInt(&ok);
-		if (ok)
-			numberPrefix = numberString;
-	}
-	bool find;
-	foreach(const SatelliteP& sat, satellites)
-	{
-		if (sat->initialized && sat->displayed)
+		nameIndex.clear();
+		noradIndex.clear();
+		for (int i=0;i<satellites.size();++i)
 		{
-			find = false;
-			if (useStartOfWords)
-			{
-				if (sat->getEnglishName().toUpper().left(objw.length()) == objw)
-				{
-					find = true;
-				}
-			}
-			else
-			{
-				if (sat->getEnglishName().toUpper().contains(objw, Qt::CaseInsensitive))
-				{
-					find = true;
-				}
-			}
-			if (find)
-			{
-				result << sat->getEnglishName().toUpper();
-			}
-			else if (find==false && !numberPrefix.isEmpty() && sat->getCatalogNumberString().left(numberPrefix.length()) == numberPrefix)
-			{
-				result << QString("NORAD %1").arg(sat->getCatalogNumberString());			
-			}
+			const QString name = satellites.at(i)->getEnglishName().toUpper();
+			nameIndex.insert(name, name, StelNameIndex::Name, i);
+			const QString number = satellites.at(i)->getCatalogNumberString();
+			noradIndex.insert(number, QString("NORAD %1").arg(number), StelNameIndex::Designation, i);
 		}
+		nameIndex.build();
+		noradIndex.build();
+		nameIndexValid = true;
 	}
 
-	result.sort();
-	if (result.size()>maxNbItem) result.erase(result.begin()+maxNbItem, result.end());
+	QString objw = objPrefix.toUpper();
+	ListSatellitesFuncObject func(satellites, result, maxNbItem);
+
+	// Names match from the start of any word, unless useStartOfWords asks for the start of the name
+	nameIndex.processMatching(objw, !useStartOfWords, func);
+
+	QRegExp regExp("^(NORAD)\\s*(\\d+)\\s*$");
+	if (result.size()<maxNbItem && regExp.exactMatch(objw))
+		noradIndex.processMatching(regExp.capturedTexts().at(2), false, func);
 
+	result.sort();
 	return result;
 }
 
@@ -749,6 +730,8 @@ void Satellites::setDataMap(const QVariantMap& map)
 	}
 
 	satellites.clear();
+	pickIndexValid = false;
+	nameIndexValid = false;
 	groups.clear();
 	QVariantMap satMap = map.value("satellites").toMap();
 	foreach(const QString& satId, satMap.keys())
@@ -773,6 +756,8 @@ void Satellites::setDataMap(const QVariantMap& map)
 		}
 	}
 	qSort(satellites);
+	pickIndexValid = false;
+	nameIndexValid = false;
 }
 
 void Satellites::markLastUpdate()
@@ -877,6 +862,8 @@ bool Satellites::add(const TleData& tleData)
 	{
 		//qDebug() << "Satellite added:" << tleData.id << tleData.name;
 		satellites.append(sat);
+		pickIndexValid = false;
+		nameIndexValid = false;
 		sat->setNew();
 		return true;
 	}
@@ -917,6 +904,8 @@ void Satellites::remove(const QStringList& idList)
 			
 			//qDebug() << "Satellite removed:" << sat->id << sat->name;
 			satellites.removeAt(i);
+			pickIndexValid = false;
+			nameIndexValid = false;
 			i--; //Compensate for the change in the array's indexing
 			numRemoved++;
 		}
@@ -1290,6 +1279,7 @@ void Satellites::updateSatellites(TleDataHash& newTleSets)
 				
 				// Update the name if it has been changed in the source list
 				sat->name = newTle.name;
+				nameIndexValid = false;
 
 				// we reset this to "now" when we started the update.
 				sat->lastUpdated = lastUpdate;
@@ -1450,26 +1440,23 @@ void Satellites::update(double deltaTime)
 	if (StelApp::getInstance().getCore()->getCurrentLocation().planetName != earth->getEnglishName() || !isValidRangeDates() || (!fader && fader.getInterstate() <= 0.))
 		return;
 
-	// Counter to wake up the satellites.
-	// wake_nb is the number of satellites we awake at each update.  If
-	// we don't see the hints we can make that lower.
-	const int wake_nb = hintsFader.getInterstate() == 0.0 ? 32 : 128;
-	static int t = 0;
-	t += wake_nb;
-	if (t >= satellites.size()) t = 0;
-
 	fader.update((int)(deltaTime*1000));
 	hintsFader.update((int)(deltaTime*1000));
 
-	for (int i = 0; i < satellites.size(); i++)
-	{
-		Satellite* sat = satellites.at(i).data();
-		// Wake up the next batch of asleep satellites.
-		if (i >= t && i < t + wake_nb) sat->asleep = false;
+	// The observer and the Sun are the same for all the satellites
+	StelCore* core = StelApp::getInstance().getCore();
+	const double JD = core->getJDay();
+	gSatWrapper::EpochData data;
+	gSatWrapper::computeEpochData(JD - core->getDeltaT(JD)/86400, data); // Delta T anti-correction for artificial satellites
 
-		if (!sat->asleep && sat->initialized && sat->displayed)
-			sat->update(deltaTime);
+	// Propagate all the displayed satellites every frame, on worker threads
+	updateBatch.clear();
+	foreach (const SatelliteP& sat, satellites)
+	{
+		if (sat->initialized && sat->displayed)
+			updateBatch.append(sat.data());
 	}
+	QtConcurrent::blockingMap(updateBatch, SatelliteUpdateFuncObject(data));
 }
 
 void Satellites::draw(StelCore* core)
@@ -1479,6 +1466,8 @@ void Satellites::draw(StelCore* core)
 
 	StelProjectorP prj = core->getProjection(StelCore::FrameAltAz);
 	StelPainter painter(prj);
+	// The satellites compute their J2000 position when they are drawn
+	pickIndexValid = false;
 	painter.setFont(labelFont);
 	Satellite::hintBrightness = hintsFader.getInterstate();
 
@@ -1488,8 +1477,8 @@ void Satellites::draw(StelCore* core)
 	Satellite::viewportHalfspace = painter.getProjector()->getBoundingCap();
 	foreach (const SatelliteP& sat, satellites)
 	{
-        if (sat && !sat->asleep && sat->initialized && sat->displayed)
-            sat->asleep = !sat->draw(core, painter, 1);
+        if (sat && sat->initialized && sat->displayed)
+            sat->draw(core, painter, 1);
 	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
@@ -1540,7 +1529,7 @@ void Satellites::drawPointer(StelCore* core, StelPainter& painter)
         QString name = obj->getNameI18n();
         foreach (const SatelliteP& sat, satellites)
         {
-            if (sat && !sat->asleep && sat->initialized && sat->displayed)
+            if (sat && sat->initialized && sat->displayed)
             {
                 if ((sat->name).contains(name) && !(sat->orbitDisplayed))
                 {
@@ -23,6 +23,8 @@
 #include "Satellite.hpp"
 #include "StelFader.hpp"
 #include "StelLocation.hpp"
+#include "StelNameIndex.hpp"
+#include "StelPointIndex.hpp"
 
 #include <QDateTime>
 #include <QFile>
@@ -31,6 +33,7 @@
 #include <QVariantMap>
 #include <QByteArray>
 #include <QMutex>
+#include <QVector>
 
 class Planet;
 class QNetworkAccessManager;
@@ -179,6 +182,11 @@ public:
 	//! @return an list containing the satellites located inside the limitFov circle around position v.
 	virtual QList<StelObjectP> searchAround(const Vec3d& v, double limitFov, const StelCore* core) const;
 
+	//! Pass the displayed satellites located inside the limitFov circle around position v
+	//! to a visitor. The satellites are found with a spatial index, rebuilt the first time
+	//! it is used after the satellites are drawn.
+	virtual void visitAround(const Vec3d& v, double limitFov, const StelCore* core, StelObjectVisitor& visitor) const;
+
 	//! Return the matching satellite object's pointer if exists or NULL.
 	//! @param nameI18n The case in-sensistive satellite name
 	virtual StelObjectP searchByNameI18n(const QString& nameI18n) const;
@@ -496,6 +504,8 @@ private:
 	QDir dataDir;
 	
 	QList<SatelliteP> satellites;
+	//! Satellites propagated by update(), kept to avoid reallocating it every frame.
+	QVector<Satellite*> updateBatch;
 	
 	QHash<QString, double> qsMagList;
 	//! Union of the groups used by all loaded satellites - see @ref groups.
@@ -510,6 +520,16 @@ private:
 	
 	// FIXME: Possible bug with the Solar System recreated by the SSEditor.
 	QSharedPointer<Planet> earth;
+	//! Positions of the satellites by index in satellites, for visitAround().
+	mutable StelPointIndex pickIndex;
+	//! Whether pickIndex matches the satellites and their last drawn positions.
+	mutable bool pickIndexValid;
+	//! Uppercase names and NORAD numbers of the satellites by index in satellites,
+	//! for auto-completion.
+	mutable StelNameIndex nameIndex;
+	mutable StelNameIndex noradIndex;
+	//! Whether nameIndex and noradIndex match the satellites.
+	mutable bool nameIndexValid;
 	Vec3f defaultHintColor;
 	Vec3f defaultOrbitColor;
 	QFont labelFont;
@@ -30,7 +30,48 @@
 #undef FS
 #endif
 
-Skybright::Skybright() : SN(1.f)
+// Number of intervals of the lookup tables
+static const int TABLE_SIZE = 1024;
+// Upper bounds of the sun and moon tables. Closer to the Sun or the Moon, the aureole term changes too fast
+// to be interpolated and the formulas are used.
+static const float SUN_TABLE_MAX = 0.9f;
+static const float MOON_TABLE_MAX = 0.95f;
+
+namespace
+{
+	// Linear interpolation in a table of TABLE_SIZE+1 samples over [0, 1]
+	inline float lookup(const QVector<float>& table, float x)
+	{
+		float p = x*TABLE_SIZE;
+		if (p<0.f) p = 0.f;
+		int i = (int)p;
+		if (i>=TABLE_SIZE) i = TABLE_SIZE-1;
+		const float* t = table.constData()+i;
+		return t[0] + (p-i)*(t[1]-t[0]);
+	}
+
+	// Terms of the luminance model, shared by the formulas and the tables
+	inline float extinctionTerm(float K, float cosDistZenith)
+	{
+		return stelpow10f(-0.4f * K * (1.f / (cosDistZenith + 0.025f*StelUtils::fastExp(-11.f*cosDistZenith))));
+	}
+
+	inline float daylightSunTerm(float cosDistSun, float distSun)
+	{
+		return 18886.28f / (distSun*distSun + 0.0007f)
+		       + stelpow10f(6.15f - (distSun+0.001f)* 1.43239f)
+		       + 229086.77f * ( 1.06f + cosDistSun*cosDistSun );
+	}
+
+	inline float moonTerm(float cosDistMoon, float distMoon)
+	{
+		return 18886.28f / (distMoon*distMoon + 0.0005f)	// The last 0.0005 should be 0, but it causes too fast brightness change
+			+ stelpow10f(6.15f - distMoon * 1.43239f)
+			+ 229086.77f * ( 1.06f + cosDistMoon*cosDistMoon );
+	}
+}
+
+Skybright::Skybright() : SN(1.f), useTables(false), tablesK(-1.f)
 {
 	setDate(2003, 8, 0);
 	setLocation(M_PI_4, 1000., 25.f, 40.f);
@@ -61,6 +102,58 @@ void Skybright::setLocation(float latitude, float altitude, float temperature, f
 	float KO = 0.031f * std::exp(-altitude/8200.f) * ( 3.f + 0.4f * (latitude * std::cos(RA) - std::cos(3.f*latitude)) )/3.f;
 	float KW = 0.031f * 0.94f * (relativeHumidity/100.f) * std::exp(temperature/15.f) * std::exp(-altitude/8200.f);
 	K = KR + KA + KO + KW;
+	if (useTables && K!=tablesK)
+		computeZenithTables();
+}
+
+void Skybright::setFlagLookupTables(bool b)
+{
+	useTables = b;
+	if (!useTables)
+	{
+		extinctionTable.clear();
+		twilightZenithTable.clear();
+		daylightSunTable.clear();
+		twilightSunTable.clear();
+		moonTable.clear();
+		tablesK = -1.f;
+		return;
+	}
+	if (daylightSunTable.isEmpty())
+	{
+		daylightSunTable.resize(TABLE_SIZE+1);
+		twilightSunTable.resize(TABLE_SIZE+1);
+		moonTable.resize(TABLE_SIZE+1);
+		for (int i=0; i<=TABLE_SIZE; ++i)
+		{
+			// The distance to the Sun changes fast near the antisolar point, so the samples are closer
+			// there: the sun tables are indexed by the square root of 1+cosDistSun.
+			const float u = (float)i/TABLE_SIZE;
+			const float cosDistSun = u*u*(SUN_TABLE_MAX+1.f) - 1.f;
+			const float distSun = StelUtils::fastAcos(cosDistSun);
+			daylightSunTable[i] = daylightSunTerm(cosDistSun, distSun);
+			twilightSunTable[i] = 1.7453293f / distSun;
+			const float cosDistMoon = -1.f + (MOON_TABLE_MAX+1.f)*i/TABLE_SIZE;
+			moonTable[i] = moonTerm(cosDistMoon, StelUtils::fastAcos(cosDistMoon));
+		}
+	}
+	computeZenithTables();
+}
+
+void Skybright::computeZenithTables()
+{
+	// The extinction changes fast near the horizon, so the samples are closer there:
+	// the table is indexed by the square root of the cosine. The zenith distance changes fast
+	// near the zenith, so the twilight table is indexed by the square root of 1-cosDistZenith.
+	extinctionTable.resize(TABLE_SIZE+1);
+	twilightZenithTable.resize(TABLE_SIZE+1);
+	for (int i=0; i<=TABLE_SIZE; ++i)
+	{
+		const float s = (float)i/TABLE_SIZE;
+		extinctionTable[i] = extinctionTerm(K, s*s);
+		twilightZenithTable[i] = stelpow10f(0.063661977f * StelUtils::fastAcos(1.f-s*s)/(K> 0.05f ? K : 0.05f));
+	}
+	tablesK = K;
 }
 
 // Set the moon and sun zenith angular distance (cosin given)
@@ -88,6 +181,8 @@ void Skybright::setSunMoon(float cosDistMoonZenith, float cosDistSunZenith)
 	bTwilightTerm = -6.724f + 22.918312f * (M_PI_2-std::acos(cosDistSunZenith));
 
 	C4 = stelpow10f(-0.4f*K*airMassSun);	// Term for sky brightness computation
+
+	twilightTermPow = stelpow10f(bTwilightTerm);
 }
 
 
@@ -99,14 +194,15 @@ float Skybright::getLuminance(float cosDistMoon,
                                float cosDistSun,
                                float cosDistZenith) const
 {
+	if (useTables && cosDistZenith>=0.f)
+		return getLuminanceFromTables(cosDistMoon, cosDistSun, cosDistZenith);
+
 	// Air mass
-	const float bKX = stelpow10f(-0.4f * K * (1.f / (cosDistZenith + 0.025f*StelUtils::fastExp(-11.f*cosDistZenith))));
+	const float bKX = extinctionTerm(K, cosDistZenith);
 
 	// Daylight brightness
 	const float distSun = StelUtils::fastAcos(cosDistSun);
-	const float FS = 18886.28f / (distSun*distSun + 0.0007f)
-	               + stelpow10f(6.15f - (distSun+0.001f)* 1.43239f)
-	               + 229086.77f * ( 1.06f + cosDistSun*cosDistSun );
+	const float FS = daylightSunTerm(cosDistSun, distSun);
 	const float b_daylight = 9.289663e-12f * (1.f - bKX) * (FS * C4 + 440000.f * (1.f - C4));
 
 	//Twilight brightness
@@ -126,9 +222,7 @@ float Skybright::getLuminance(float cosDistMoon,
 			dist_moon = cosDistMoon > 0.99f ? std::acos(cosDistMoon) : StelUtils::fastAcos(cosDistMoon);
 		}
 		
-		const float FM = 18886.28f / (dist_moon*dist_moon + 0.0005f)	// The last 0.0005 should be 0, but it causes too fast brightness change
-			+ stelpow10f(6.15f - dist_moon * 1.43239f)
-			+ 229086.77f * ( 1.06f + cosDistMoon*cosDistMoon );
+		const float FM = moonTerm(cosDistMoon, dist_moon);
 		b_total += bMoonTerm1 * (1.f - bKX) * (FM * C3 + 440000.f * (1.f - C3));
 	}
 	
@@ -143,3 +237,52 @@ float Skybright::getLuminance(float cosDistMoon,
 	// lambert -> cd/m^2 formula seems to be wrong...
 }
 
+float Skybright::getLuminanceFromTables(float cosDistMoon, float cosDistSun, float cosDistZenith) const
+{
+	const float bKX = lookup(extinctionTable, std::sqrt(cosDistZenith));
+
+	// Terms depending on the distance to the Sun
+	float FS, twilightSun;
+	if (cosDistSun <= SUN_TABLE_MAX)
+	{
+		const float sunIndex = std::sqrt(qMax(0.f, cosDistSun+1.f)/(SUN_TABLE_MAX+1.f));
+		FS = lookup(daylightSunTable, sunIndex);
+		twilightSun = lookup(twilightSunTable, sunIndex);
+	}
+	else
+	{
+		const float distSun = StelUtils::fastAcos(cosDistSun);
+		FS = daylightSunTerm(cosDistSun, distSun);
+		twilightSun = 1.7453293f / distSun;
+	}
+
+	// Daylight brightness
+	const float b_daylight = 9.289663e-12f * (1.f - bKX) * (FS * C4 + 440000.f * (1.f - C4));
+
+	// Twilight brightness
+	const float b_twilight = twilightTermPow * lookup(twilightZenithTable, std::sqrt(qMax(0.f, 1.f-cosDistZenith))) * twilightSun * (1.f-bKX);
+
+	// Total sky brightness
+	float b_total = ((b_twilight<b_daylight) ? b_twilight : b_daylight);
+
+	// Moonlight brightness, don't compute if less than 1% daylight
+	if ((bMoonTerm1 * (1.f - bKX) * (28860205.1341274269f * C3 + 440000.f * (1.f - C3)))/b_total>0.01f)
+	{
+		float FM;
+		if (cosDistMoon <= MOON_TABLE_MAX)
+			FM = lookup(moonTable, (cosDistMoon+1.f)/(MOON_TABLE_MAX+1.f));
+		else if (cosDistMoon >= 1.f)
+			FM = moonTerm(1.f, 0.f);
+		else
+			FM = moonTerm(cosDistMoon, std::acos(cosDistMoon));
+		b_total += bMoonTerm1 * (1.f - bKX) * (FM * C3 + 440000.f * (1.f - C3));
+	}
+
+	// Dark night sky brightness, don't compute if less than 1% daylight
+	if ((bNightTerm*bKX)/b_total>0.01f)
+	{
+		b_total += (0.4f + 0.6f / std::sqrt(0.04f + 0.96f * cosDistZenith*cosDistZenith)) * bNightTerm * bKX;
+	}
+
+	return (b_total<0.f) ? 0.f : b_total * (900900.9f * static_cast<float>(M_PI) * 1e-4f * 3239389.f*2.f *1.5f);
+}
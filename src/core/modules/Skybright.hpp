@@ -19,6 +19,8 @@
 #ifndef _SKYBRIGHT_HPP_
 #define _SKYBRIGHT_HPP_
 
+#include <QVector>
+
 //! @class Skybright
 //! Compute the luminance of the sky according to some parameters like sun moon position
 //! or time or altitude etc...
@@ -53,7 +55,27 @@ public:
 	//! @param cosDistZenith cos(angular distance between zenith and the position)
 	float getLuminance(float cosDistMoon, float cosDistSun, float cosDistZenith) const;
 
+	//! Set whether getLuminance() interpolates in precomputed tables instead of evaluating the formulas.
+	//! The terms of the model each depend on a single cosine, so they are tabulated separately. The
+	//! tables depending on the extinction coefficient are computed again by setLocation() when it changes.
+	//! Within 26 degrees of the Sun and 18 degrees of the Moon, where their aureole terms change too fast
+	//! to be interpolated, these terms are evaluated with the formulas. The relative error of each
+	//! interpolated term is below 1.3e-4, except the extinction, whose error grows with the extinction
+	//! coefficient. The relative error on the luminance is thus below 4e-4 for extinction coefficients
+	//! up to 0.3, and below 1e-3 up to 0.6. The moonlight and the dark night sky are only added when
+	//! they are more than 1% of the daylight, so near these thresholds a position may get or lose one
+	//! of them, which changes its luminance by a few % as with the formulas.
+	//! Positions below the horizon always use the formulas.
+	void setFlagLookupTables(bool b);
+	//! Get whether getLuminance() uses precomputed tables.
+	bool getFlagLookupTables() const {return useTables;}
+
 private:
+	//! getLuminance() using the tables.
+	float getLuminanceFromTables(float cosDistMoon, float cosDistSun, float cosDistZenith) const;
+	//! Compute the tables depending on the extinction coefficient.
+	void computeZenithTables();
+
 	float airMassMoon;  // Air mass for the Moon
 	float airMassSun;   // Air mass for the Sun
 	float magMoon;      // Moon magnitude
@@ -67,6 +89,21 @@ private:
 	float bNightTerm;
 	float bMoonTerm1;
 	float bTwilightTerm;
+
+	bool useTables;
+	//! Extinction coefficient used for the zenith tables.
+	float tablesK;
+	//! 10^bTwilightTerm
+	float twilightTermPow;
+	//! Table over the square root of cosDistZenith in [0, 1].
+	QVector<float> extinctionTable;
+	//! Table over the square root of 1-cosDistZenith in [0, 1].
+	QVector<float> twilightZenithTable;
+	//! Tables over the square root of (1+cosDistSun)/1.9, for cosDistSun in [-1, 0.9].
+	QVector<float> daylightSunTable;
+	QVector<float> twilightSunTable;
+	//! Table over cosDistMoon in [-1, 0.95]. Closer to the Moon, the formula is used.
+	QVector<float> moonTable;
 };
 
 #endif // _SKYBRIGHT_HPP_
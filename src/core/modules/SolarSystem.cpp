@@ -36,7 +36,9 @@
 #include "StelIniParser.hpp"
 #include "Planet.hpp"
 #include "MinorPlanet.hpp"
+#include "MinorBodyCatalog.hpp"
 #include "Comet.hpp"
+#include "EventSearch.hpp"
 
 #include "StelSkyDrawer.hpp"
 #include "StelUtils.hpp"
@@ -57,9 +59,12 @@
 #include <QMapIterator>
 #include <QDebug>
 #include <QDir>
+#include <QThread>
+#include <QtConcurrent>
 
 SolarSystem::SolarSystem()
 	: moonScale(1.),
+	  minorBodies(NULL),
 	  flagOrbits(false),
 	  flagLightTravelTime(false),
 	  allTrails(NULL)
@@ -75,6 +80,8 @@ void SolarSystem::setFontSize(float newFontSize)
 
 SolarSystem::~SolarSystem()
 {
+	finishOrbitJob(false);
+	EventSearch::cancelAll();
 	// release selected:
 	selected.clear();
 	foreach (Orbit* orb, orbits)
@@ -90,6 +97,8 @@ SolarSystem::~SolarSystem()
 
 	delete allTrails;
 	allTrails = NULL;
+	delete minorBodies;
+	minorBodies = NULL;
 
 	// Get rid of circular reference between the shared pointers which prevent proper destruction of the Planet objects.
 	foreach (PlanetP p, systemPlanets)
@@ -115,6 +124,8 @@ void SolarSystem::init()
 	Q_ASSERT(conf);
 
 	loadPlanets();	// Load planets data
+	loadMinorBodyCatalog();
+	buildNameIndexes();
 
 	// Compute position and matrix of sun and all the satellites (ie planets)
 	// for the first initialization Q_ASSERT that center is sun center (only impacts on light speed correction)	
@@ -224,6 +235,11 @@ void cometOrbitPosFunc(double jd,double xyz[3], void* userDataPtr)
 {
 	static_cast<CometOrbit*>(userDataPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz);
 }
+// Used for the orbit lines, does not update the velocity used by the tails
+void cometOrbitSampleFunc(double jd,double xyz[3], void* userDataPtr)
+{
+	static_cast<CometOrbit*>(userDataPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz, false);
+}
 
 // Init and load the solar system data
 void SolarSystem::loadPlanets()
@@ -265,6 +281,7 @@ void SolarSystem::loadPlanets()
 			//qCritical() << "We should not be here!";
 
 			qDebug() << "Removing minor bodies";
+			finishOrbitJob(false);
 			foreach (PlanetP p, systemPlanets)
 			{
 				p->satellites.clear();
@@ -297,6 +314,35 @@ void SolarSystem::loadPlanets()
 			shadowPlanetCount++;
 }
 
+void SolarSystem::loadMinorBodyCatalog()
+{
+	delete minorBodies;
+	minorBodies = NULL;
+	QSettings* conf = StelApp::getInstance().getSettings();
+	if (!conf->value("astro/flag_minor_body_catalog", true).toBool())
+		return;
+	const QString path = StelFileMgr::findFile("data/minor_bodies.cat");
+	if (path.isEmpty())
+		return;
+
+	qDebug() << "Loading Solar System data (3: minor body catalogue)...";
+	minorBodies = new MinorBodyCatalog();
+	if (!minorBodies->open(path))
+	{
+		delete minorBodies;
+		minorBodies = NULL;
+		return;
+	}
+	minorBodies->setThreadCount(conf->value("astro/minor_body_threads", QThread::idealThreadCount()).toInt());
+	// The bodies defined in ssystem_minor.ini are drawn as planets
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		const int i = minorBodies->indexOf(p->getEnglishName());
+		if (i>=0)
+			minorBodies->setHidden(i, true);
+	}
+}
+
 bool SolarSystem::loadPlanets(const QString& filePath)
 {
 	QSettings pd(filePath, StelIniFormat);
@@ -306,6 +352,9 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 		return false;
 	}
 
+	// Approximate the analytical theories by Chebyshev polynomials, see EphemerisCache
+	const bool useEphemerisCache = StelApp::getInstance().getSettings()->value("astro/flag_ephemeris_cache", true).toBool();
+
 	// QSettings does not allow us to say that the sections of the file
 	// will be listed in the same order  as in the file like the old
 	// InitParser used to so we can no longer assume that.
@@ -411,6 +460,7 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 
 		const QString funcName = pd.value(secname+"/coord_func").toString();
 		posFuncType posfunc=NULL;
+		posFuncType orbitfunc=NULL;
 		void* userDataPtr=NULL;
 		OsculatingFunctType *osculatingFunc = 0;
 		bool closeOrbit = pd.value(secname+"/closeOrbit", true).toBool();
@@ -618,6 +668,7 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			orbits.push_back(orb);
 			userDataPtr = orb;
 			posfunc = &cometOrbitPosFunc;
+			orbitfunc = &cometOrbitSampleFunc;
 		}
 
 		if (funcName=="sun_special")
@@ -899,6 +950,12 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			pd.value(secname+"/orbit_visualization_period", fabs(pd.value(secname+"/orbit_Period", 1.).toDouble())).toDouble()); // this is given in days...
 
 
+		const double orbitPeriod = pd.value(secname+"/orbit_visualization_period", pd.value(secname+"/orbit_Period", 0.).toDouble()).toDouble();
+		if (orbitfunc)
+			p->setOrbitFunc(orbitfunc);
+		if (useEphemerisCache && userDataPtr==NULL && posfunc!=&get_sun_helio_coordsv && orbitPeriod!=0.)
+			p->enableEphemerisCache(orbitPeriod);
+
 		if (pd.value(secname+"/rings", 0).toBool()) {
 			const double rMin = pd.value(secname+"/ring_inner_size").toDouble()/AU;
 			const double rMax = pd.value(secname+"/ring_outer_size").toDouble()/AU;
@@ -926,16 +983,25 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 // The order is not important since the position is computed relatively to the mother body
 void SolarSystem::computePositions(double date, const Vec3d& observerPos)
 {
+	// Only one orbit job runs at a time, the next one is started once the
+	// previous result is shown.
+	const bool orbitJobDone = orbitJob.isFinished();
+	if (orbitJobDone)
+		finishOrbitJob(true);
+	QList<PlanetP> orbitPlanets;
+
 	if (flagLightTravelTime)
 	{
 		foreach (PlanetP p, systemPlanets)
 		{
-			p->computePositionWithoutOrbits(date);
+			p->computePosition(date);
 		}
 		foreach (PlanetP p, systemPlanets)
 		{
 			const double light_speed_correction = (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
 			p->computePosition(date-light_speed_correction);
+			if (orbitJobDone && p->requestOrbitUpdate(date-light_speed_correction))
+				orbitPlanets.append(p);
 		}
 	}
 	else
@@ -943,11 +1009,43 @@ void SolarSystem::computePositions(double date, const Vec3d& observerPos)
 		foreach (PlanetP p, systemPlanets)
 		{
 			p->computePosition(date);
+			if (orbitJobDone && p->requestOrbitUpdate(date))
+				orbitPlanets.append(p);
 		}
 	}
+	if (!orbitPlanets.isEmpty())
+		startOrbitJob(orbitPlanets);
 	computeTransMatrices(date, observerPos);
 }
 
+namespace
+{
+	void computePlanetOrbit(PlanetP& p)
+	{
+		p->computeOrbit();
+	}
+}
+
+void SolarSystem::startOrbitJob(const QList<PlanetP>& planets)
+{
+	Q_ASSERT(orbitJob.isFinished());
+	orbitJobPlanets = planets;
+	orbitJob = QtConcurrent::map(orbitJobPlanets, computePlanetOrbit);
+}
+
+void SolarSystem::finishOrbitJob(bool applyResult)
+{
+	orbitJob.waitForFinished();
+	if (applyResult)
+	{
+		foreach (PlanetP p, orbitJobPlanets)
+		{
+			p->applyOrbitUpdate();
+		}
+	}
+	orbitJobPlanets.clear();
+}
+
 // Compute the transformation matrix for every elements of the solar system.
 // The elements have to be ordered hierarchically, eg. it's important to compute earth before moon.
 void SolarSystem::computeTransMatrices(double date, const Vec3d& observerPos)
@@ -1008,6 +1106,10 @@ void SolarSystem::draw(StelCore* core)
 	float maxMagLabel = (core->getSkyDrawer()->getLimitMagnitude()<5.f ? core->getSkyDrawer()->getLimitMagnitude() :
 			5.f+(core->getSkyDrawer()->getLimitMagnitude()-5.f)*1.2f) +(labelsAmount-3.f)*1.2f;
 
+	// The minor bodies of the catalogue are faint points, drawn behind the planets
+	if (minorBodies)
+		minorBodies->draw(core, 1.f);
+
 	// Draw the elements
 	foreach (const PlanetP& p, systemPlanets)
 	{
@@ -1133,9 +1235,15 @@ StelObjectP SolarSystem::search(Vec3d pos, const StelCore* core) const
 // Return a stl vector containing the planets located inside the limFov circle around position v
 QList<StelObjectP> SolarSystem::searchAround(const Vec3d& vv, double limitFov, const StelCore* core) const
 {
-	QList<StelObjectP> result;
+	StelObjectListVisitor visitor;
+	visitAround(vv, limitFov, core, visitor);
+	return visitor.result;
+}
+
+void SolarSystem::visitAround(const Vec3d& vv, double limitFov, const StelCore* core, StelObjectVisitor& visitor) const
+{
 	if (!getFlagPlanets())
-		return result;
+		return;
 
 	Vec3d v = core->j2000ToEquinoxEqu(vv);
 	v.normalize();
@@ -1152,10 +1260,10 @@ QList<StelObjectP> SolarSystem::searchAround(const Vec3d& vv, double limitFov, c
 
 		if (equPos*v>=std::min(cosLimFov, cosAngularSize))
 		{
-			result.append(qSharedPointerCast<StelObject>(p));
+			if (!visitor.visit(qSharedPointerCast<StelObject>(p)))
+				return;
 		}
 	}
-	return result;
 }
 
 // Update i18 names from english names according to current translator
@@ -1164,6 +1272,20 @@ void SolarSystem::updateI18n()
 	const StelTranslator& trans = StelApp::getInstance().getLocaleMgr().getAppStelTranslator();
 	foreach (PlanetP p, systemPlanets)
 		p->translateName(trans);
+	buildNameIndexes();
+}
+
+void SolarSystem::buildNameIndexes()
+{
+	nameIndex.clear();
+	nameIndexI18n.clear();
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		nameIndex.insert(p->getEnglishName(), p->getEnglishName());
+		nameIndexI18n.insert(p->getNameI18n(), p->getNameI18n());
+	}
+	nameIndex.build();
+	nameIndexI18n.build();
 }
 
 QString SolarSystem::getPlanetHashString(void)
@@ -1306,72 +1428,14 @@ bool SolarSystem::nearLunarEclipse()
 //! Find and return the list of at most maxNbItem objects auto-completing the passed object I18n name
 QStringList SolarSystem::listMatchingObjectsI18n(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
-	QStringList result;
-	if (maxNbItem==0)
-		return result;
-
-	QString sson;
-	bool find;
-	foreach (const PlanetP& p, systemPlanets)
-	{
-		sson = p->getNameI18n();
-		find = false;
-		if (useStartOfWords)
-		{
-			QString constw = sson.mid(0, objPrefix.size()).toUpper();
-			if (constw==objPrefix.toUpper())
-				find = true;
-		}
-		else
-		{
-			if (sson.contains(objPrefix, Qt::CaseInsensitive))
-				find = true;
-
-		}
-		if (find)
-		{
-			result << sson;
-			if (result.size()==maxNbItem)
-				return result;
-		}
-
-	}
-	return result;
+	// Names match from the start of any word, unless useStartOfWords asks for the start of the name
+	return nameIndexI18n.listMatching(objPrefix, maxNbItem, !useStartOfWords);
 }
 
 //! Find and return the list of at most maxNbItem objects auto-completing the passed object English name
 QStringList SolarSystem::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
-	QStringList result;
-	if (maxNbItem==0)
-		return result;
-
-	QString sson;
-	bool find;
-	foreach (const PlanetP& p, systemPlanets)
-	{
-		sson = p->getEnglishName();
-		find = false;
-		if (useStartOfWords)
-		{
-			QString constw = sson.mid(0, objPrefix.size()).toUpper();
-			if (constw==objPrefix.toUpper())
-				find = true;
-		}
-		else
-		{
-			if (sson.contains(objPrefix, Qt::CaseInsensitive))
-				find = true;
-
-		}
-		if (find)
-		{
-			result << sson;
-			if (result.size()==maxNbItem)
-				return result;
-		}
-	}
-	return result;
+	return nameIndex.listMatching(objPrefix, maxNbItem, !useStartOfWords);
 }
 
 QStringList SolarSystem::listAllObjects(bool inEnglish) const
@@ -1471,7 +1535,9 @@ void SolarSystem::reloadPlanets()
 	StelCore* core = StelApp::getInstance().getCore();
 	StelLocation loc = core->getCurrentLocation();
 
-	// Unload all Solar System objects
+	// Unload all Solar System objects, the running event searches use the orbits
+	finishOrbitJob(false);
+	EventSearch::cancelAll();
 	selected.clear();//Release the selected one
 	foreach (Orbit* orb, orbits)
 	{
@@ -1498,6 +1564,7 @@ void SolarSystem::reloadPlanets()
 
 	// Re-load the ssystem.ini file
 	loadPlanets();	
+	loadMinorBodyCatalog();
 	computePositions(StelUtils::getJDFromSystem());
 	setSelected("");
 	recreateTrails();
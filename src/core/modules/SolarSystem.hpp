@@ -26,10 +26,13 @@
 #endif
 
 #include <QFont>
+#include <QFuture>
 #include "StelObjectModule.hpp"
+#include "StelNameIndex.hpp"
 #include "StelTextureTypes.hpp"
 #include "Planet.hpp"
 
+class MinorBodyCatalog;
 class Orbit;
 class StelTranslator;
 class StelObject;
@@ -96,6 +99,9 @@ public:
 	//! from v.
 	virtual QList<StelObjectP> searchAround(const Vec3d& v, double limitFov, const StelCore* core) const;
 
+	//! Pass the objects which searchAround() would return to a visitor, without building a list.
+	virtual void visitAround(const Vec3d& v, double limitFov, const StelCore* core, StelObjectVisitor& visitor) const;
+
 	//! Search for a SolarSystem object based on the localised name.
 	//! @param nameI18n the case in-sensistive translated planet name.
 	//! @return a StelObjectP for the object if found, else NULL.
@@ -302,10 +308,19 @@ private:
 	//! @return a pointer to a StelObject if found, else NULL
 	StelObjectP search(Vec3d v, const StelCore* core) const;
 
+	//! Rebuild the auto-completion indexes, after the bodies are loaded or translated.
+	void buildNameIndexes();
+
 	//! Compute the transformation matrix for every elements of the solar system.
 	//! observerPos is needed for light travel time computation.
 	void computeTransMatrices(double date, const Vec3d& observerPos = Vec3d(0.));
 
+	//! Start sampling the orbit lines of the given planets on worker threads.
+	//! The planets keep drawing their current line until the job is finished.
+	void startOrbitJob(const QList<PlanetP>& planets);
+	//! Wait for the orbit job, and discard its result if applyResult is false.
+	void finishOrbitJob(bool applyResult);
+
 	//! Draw a nice animated pointer around the object.
 	void drawPointer(const StelCore* core);
 
@@ -318,6 +333,10 @@ private:
 	//! Load planet data from the given file
 	bool loadPlanets(const QString& filePath);
 
+	//! Open the catalogue of minor bodies drawn as points, if it exists and is enabled.
+	//! The bodies loaded as Planet objects are hidden from it.
+	void loadMinorBodyCatalog();
+
 	void recreateTrails();
 
 
@@ -349,6 +368,17 @@ private:
 	//! List of all the bodies of the solar system.
 	QList<PlanetP> systemPlanets;
 
+	//! English and translated names for auto-completion.
+	StelNameIndex nameIndex;
+	StelNameIndex nameIndexI18n;
+
+	//! Planets whose orbit line is being sampled by orbitJob.
+	QList<PlanetP> orbitJobPlanets;
+	QFuture<void> orbitJob;
+
+	//! Catalogue of minor bodies drawn as points, NULL if there is none.
+	MinorBodyCatalog* minorBodies;
+
 	// Master settings
 	bool flagOrbits;
 	bool flagLightTravelTime;
@@ -29,6 +29,8 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QCryptographicHash>
+#include <QThread>
+#include <QtConcurrent>
 
 #include "StelProjector.hpp"
 #include "StarMgr.hpp"
@@ -50,6 +52,7 @@
 #include "StelCore.hpp"
 #include "StelIniParser.hpp"
 #include "StelPainter.hpp"
+#include "StelProfiler.hpp"
 #include "StelJsonParser.hpp"
 #include "ZoneArray.hpp"
 #include "StelSkyDrawer.hpp"
@@ -75,6 +78,8 @@ QHash<int,QString> StarMgr::sciAdditionalNamesMapI18n;
 QMap<QString,int> StarMgr::sciAdditionalNamesIndexI18n;
 QHash<int, varstar> StarMgr::varStarsMapI18n;
 QMap<QString, int> StarMgr::varStarsIndexI18n;
+StelNameIndex StarMgr::nameIndex;
+StelNameIndex StarMgr::nameIndexI18n;
 
 QStringList initStringListFromFile(const QString& file_name)
 {
@@ -128,6 +133,8 @@ StarMgr::StarMgr(void) : hipIndex(new HipIndexStruct[NR_OF_HIP+1])
 		qFatal("ERROR: StarMgr::StarMgr: no memory");
 	}
 	maxGeodesicGridLevel = -1;
+	drawThreadCount = 1;
+	useMmap = true;
 	lastMaxSearchLevel = -1;
 	starFont.setPixelSize(StelApp::getInstance().getSettings()->value("gui/base_font_size", 13).toInt());
 	objectMgr = GETSTELMODULE(StelObjectMgr);
@@ -147,6 +154,7 @@ double StarMgr::getCallOrder(StelModuleActionName actionName) const
 
 StarMgr::~StarMgr(void)
 {
+	zoneCache.clear();
 	foreach(ZoneArray* z, gridLevels)
 		delete z;
 	gridLevels.clear();
@@ -307,6 +315,15 @@ void StarMgr::init()
 		fic2.close();
 	}
 
+	// The catalogs are mmapped. When they are not, or if mapping fails, their zones are read on
+	// demand within the memory budget, or they are loaded completely into memory if the budget is 0.
+	// Memory constrained platforms can disable mapping to bound the memory used by the catalogs.
+	useMmap = conf->value("stars/flag_use_mmap", true).toBool();
+	zoneCache.setMemoryBudget((qint64)conf->value("stars/zone_cache_size_mb", 64).toInt()*1024*1024);
+
+	// Number of threads culling and projecting the stars of the visible zones
+	drawThreadCount = qMax(1, conf->value("stars/draw_threads", QThread::idealThreadCount()).toInt());
+
 	loadData(starSettings);
 	starFont.setPixelSize(StelApp::getInstance().getSettings()->value("gui/base_font_size", 13).toInt());
 
@@ -430,7 +447,7 @@ bool StarMgr::checkAndLoadCatalog(const QVariantMap& catDesc)
 		setCheckFlag(catDesc.value("id").toString(), true);
 	}
 
-	ZoneArray* z = ZoneArray::create(catalogFilePath, true);
+	ZoneArray* z = ZoneArray::create(catalogFilePath, useMmap, zoneCache.getMemoryBudget()>0);
 	if (z)
 	{
 		if (z->level<gridLevels.size())
@@ -765,6 +782,52 @@ int StarMgr::getMaxSearchLevel() const
 }
 
 
+namespace
+{
+	//! A visible zone and whether it is fully inside the viewport.
+	struct StarZoneRef
+	{
+		const ZoneArray* array;
+		int zone;
+		bool inside;
+		//! Index of the level parameters
+		int level;
+	};
+
+	//! Drawing parameters of a ZoneArray for the current frame.
+	struct StarLevelParams
+	{
+		RCMag rcmagTable[RCMAG_TABLE_SIZE];
+		int limitMagIndex;
+		int maxMagStarName;
+	};
+
+	//! Culling of a range of visible zones into one StarDrawChunk, run by a worker thread.
+	struct StarDrawJob
+	{
+		const QVector<StarZoneRef>* zones;
+		int begin;
+		int end;
+		const QVector<StarLevelParams>* levels;
+		const StelCore* core;
+		const StelProjector* prj;
+		const QVector<SphericalCap>* viewportCaps;
+		StarDrawChunk* chunk;
+	};
+
+	void runStarDrawJob(StarDrawJob& job)
+	{
+		job.chunk->clear();
+		for (int i=job.begin;i<job.end;++i)
+		{
+			const StarZoneRef& ref = job.zones->at(i);
+			const StarLevelParams& params = job.levels->at(ref.level);
+			ref.array->cull(ref.zone, ref.inside, params.rcmagTable, params.limitMagIndex, job.core, job.prj,
+					params.maxMagStarName, *job.viewportCaps, *job.chunk);
+		}
+	}
+}
+
 // Draw all the stars
 void StarMgr::draw(StelCore* core)
 {
@@ -775,25 +838,27 @@ void StarMgr::draw(StelCore* core)
 	if (!starsFader.getInterstate())
 		return;
 
+	// Traversal of the zones, up to the merge of the projected stars
+	static const int zonesSection = StelProfiler::getSectionId("StarMgr::zones");
+	StelProfiler::Scope zonesScope(zonesSection);
+
 	int maxSearchLevel = getMaxSearchLevel();
 	QVector<SphericalCap> viewportCaps = prj->getViewportConvexPolygon()->getBoundingSphericalCaps();
 	viewportCaps.append(core->getVisibleSkyArea());
+	// Must be done before the search below, as the search result is cached by the grid
+	prefetchZones(core, viewportCaps, maxSearchLevel, 0.25*prj->getFov()*M_PI/180.);
 	const GeodesicSearchResult* geodesic_search_result = core->getGeodesicGrid(maxSearchLevel)->search(viewportCaps,maxSearchLevel);
 
 	// Set temporary static variable for optimization
 	const float names_brightness = labelsFader.getInterstate() * starsFader.getInterstate();
 
-	// Prepare openGL for drawing many stars
-	StelPainter sPainter(prj);
-	sPainter.setFont(starFont);
-	skyDrawer->preDrawPointSource(&sPainter);
-
-	// Prepare a table for storing precomputed RCMag for all ZoneArrays
-	RCMag rcmag_table[RCMAG_TABLE_SIZE];
-	
-	// Draw all the stars of all the selected zones
-	foreach(const ZoneArray* z, gridLevels)
+	// Precompute the RCMag tables of all ZoneArrays and list the zones to draw
+	QVector<StarLevelParams> levels;
+	QVector<StarZoneRef> zones;
+	foreach(ZoneArray* z, gridLevels)
 	{
+		StarLevelParams params;
+		RCMag* rcmag_table = params.rcmagTable;
 		int limitMagIndex=RCMAG_TABLE_SIZE;
 		const float mag_min = 0.001f*z->mag_min;
 		const float k = (0.001f*z->mag_range)/z->mag_steps; // MagStepIncrement
@@ -830,22 +895,134 @@ void StarMgr::draw(StelCore* core)
 			if (x > 0)
 				maxMagStarName = x;
 		}
+		params.limitMagIndex = limitMagIndex;
+		params.maxMagStarName = maxMagStarName;
+		levels.append(params);
+
 		int zone;
-		
+		StarZoneRef ref;
+		ref.array = z;
+		ref.level = levels.size()-1;
+		ref.inside = true;
 		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
-			z->draw(&sPainter, zone, true, rcmag_table, limitMagIndex, core, maxMagStarName, names_brightness, viewportCaps);
+		{
+			zoneCache.touch(z, zone);
+			ref.zone = zone;
+			zones.append(ref);
+		}
+		ref.inside = false;
 		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
-			z->draw(&sPainter, zone, false, rcmag_table, limitMagIndex, core, maxMagStarName,names_brightness, viewportCaps);
+		{
+			zoneCache.touch(z, zone);
+			ref.zone = zone;
+			zones.append(ref);
+		}
 	}
 	exit_loop:
 
+	// Cull and project the stars of the zones in parallel. There are more jobs
+	// than threads as the number of stars per zone varies a lot.
+	const int nbJobs = qMax(1, qMin(zones.size(), drawThreadCount>1 ? drawThreadCount*4 : 1));
+	if (drawChunks.size()<nbJobs)
+		drawChunks.resize(nbJobs);
+	QVector<StarDrawJob> jobs(nbJobs);
+	for (int j=0;j<nbJobs;++j)
+	{
+		StarDrawJob& job = jobs[j];
+		job.zones = &zones;
+		job.begin = zones.size()*j/nbJobs;
+		job.end = zones.size()*(j+1)/nbJobs;
+		job.levels = &levels;
+		job.core = core;
+		job.prj = prj.data();
+		job.viewportCaps = &viewportCaps;
+		job.chunk = &drawChunks[j];
+	}
+	if (nbJobs>1)
+		QtConcurrent::blockingMap(jobs, runStarDrawJob);
+	else
+		runStarDrawJob(jobs[0]);
+
+	// Merge the vertices of all chunks and draw them in one batch
+	int nbVertices = 0;
+	for (int j=0;j<nbJobs;++j)
+		nbVertices += drawChunks.at(j).vertices.size();
+	if (nbJobs>1)
+	{
+		mergedStarVertices.resize(nbVertices);
+		StelSkyDrawer::StarVertex* dst = mergedStarVertices.data();
+		for (int j=0;j<nbJobs;++j)
+		{
+			const QVector<StelSkyDrawer::StarVertex>& src = drawChunks.at(j).vertices;
+			if (!src.isEmpty())
+				memcpy(dst, src.constData(), src.size()*sizeof(StelSkyDrawer::StarVertex));
+			dst += src.size();
+		}
+	}
+	const StelSkyDrawer::StarVertex* vertices = nbJobs>1 ? mergedStarVertices.constData() : drawChunks.at(0).vertices.constData();
+	zonesScope.stop();
+
+	// Prepare openGL for drawing many stars
+	StelPainter sPainter(prj);
+	sPainter.setFont(starFont);
+	skyDrawer->preDrawPointSource(&sPainter);
+	skyDrawer->drawPointSources(&sPainter, vertices, nbVertices/6);
+
+	// The brightest stars need GL calls for their big halo
+	for (int j=0;j<nbJobs;++j)
+	{
+		foreach (const StarDrawChunk::BigHalo& h, drawChunks.at(j).bigHalos)
+			skyDrawer->drawPointSource(&sPainter, h.pos, h.rcMag, h.bV);
+	}
+
 	// Finish drawing many stars
 	skyDrawer->postDrawPointSource(&sPainter);
 
+	for (int j=0;j<nbJobs;++j)
+	{
+		foreach (const StarDrawChunk::Label& l, drawChunks.at(j).labels)
+		{
+			sPainter.setColor(l.color[0], l.color[1], l.color[2], names_brightness);
+			sPainter.drawText(Vec3d(l.pos[0], l.pos[1], l.pos[2]), l.text, 0, l.offset, l.offset, false);
+		}
+	}
+
 	if (objectMgr->getFlagSelectedObjectPointer())
 		drawPointer(sPainter, core);
 }
 
+void StarMgr::prefetchZones(const StelCore* core, const QVector<SphericalCap>& viewportCaps, int maxSearchLevel, double margin)
+{
+	zoneCache.beginFrame();
+	bool hasPagedLevel = false;
+	foreach(const ZoneArray* z, gridLevels)
+		hasPagedLevel |= (z->level<=maxSearchLevel && z->isPaged());
+	if (!hasPagedLevel)
+		return;
+
+	QVector<SphericalCap> prefetchCaps;
+	foreach(const SphericalCap& cap, viewportCaps)
+	{
+		Vec3d n(cap.n);
+		n.normalize();
+		prefetchCaps.append(SphericalCap(n, std::cos(qMin(M_PI, cap.getRadius()+margin))));
+	}
+	const GeodesicSearchResult* geodesic_search_result = core->getGeodesicGrid(maxSearchLevel)->search(prefetchCaps,maxSearchLevel);
+
+	foreach(ZoneArray* z, gridLevels)
+	{
+		if (z->level>maxSearchLevel)
+			break;
+		if (!z->isPaged())
+			continue;
+		int zone;
+		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+			zoneCache.touch(z, zone);
+		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
+			zoneCache.touch(z, zone);
+	}
+	zoneCache.trim();
+}
 
 // Return a stl vector containing the stars located
 // inside the limFov circle around position v
@@ -907,12 +1084,14 @@ QList<StelObjectP > StarMgr::searchAround(const Vec3d& vv, double limFov, const
 		int zone;
 		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
 		{
+			zoneCache.touch(z, zone);
 			z->searchAround(core, zone,v,f,result);
 			//qDebug() << " " << zone;
 		}
 		//qDebug() << endl << "search border(" << it->first << "):";
 		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level); (zone = it1.next()) >= 0;)
 		{
+			zoneCache.touch(z, zone);
 			z->searchAround(core, zone,v,f,result);
 			//qDebug() << " " << zone;
 		}
@@ -939,6 +1118,38 @@ void StarMgr::updateI18n()
 		commonNamesMapI18n[i] = t;
 		commonNamesIndexI18n[t.toUpper()] = i;
 	}
+
+	// Rebuild the auto-completion indexes
+	nameIndex.clear();
+	nameIndexI18n.clear();
+	for (QMap<QString,int>::ConstIterator it(commonNamesIndex.constBegin());it!=commonNamesIndex.constEnd();++it)
+		nameIndex.insert(it.key(), getCommonName(it.value()));
+	for (QMap<QString,int>::ConstIterator it(commonNamesIndexI18n.constBegin());it!=commonNamesIndexI18n.constEnd();++it)
+		nameIndexI18n.insert(it.key(), getCommonName(it.value()));
+	for (QMap<QString,int>::ConstIterator it(sciNamesIndexI18n.constBegin());it!=sciNamesIndexI18n.constEnd();++it)
+		insertSciName(it.key(), getSciName(it.value()));
+	for (QMap<QString,int>::ConstIterator it(sciAdditionalNamesIndexI18n.constBegin());it!=sciAdditionalNamesIndexI18n.constEnd();++it)
+		insertSciName(it.key(), getSciAdditionalName(it.value()));
+	for (QMap<QString,int>::ConstIterator it(varStarsIndexI18n.constBegin());it!=varStarsIndexI18n.constEnd();++it)
+	{
+		nameIndex.insert(it.key(), getGcvsName(it.value()), StelNameIndex::Designation);
+		nameIndexI18n.insert(it.key(), getGcvsName(it.value()), StelNameIndex::Designation);
+	}
+	nameIndex.build();
+	nameIndexI18n.build();
+}
+
+void StarMgr::insertSciName(const QString& key, const QString& name)
+{
+	nameIndex.insert(key, name, StelNameIndex::Designation);
+	nameIndexI18n.insert(key, name, StelNameIndex::Designation);
+	// Also find "alpha1 Cen" by "alpha Cen"
+	if (key.size()>1 && key.at(0).unicode()>=0x0391 && key.at(0).unicode()<=0x03A9 && key.at(1).isDigit())
+	{
+		const QString alias = QString(key).remove(1, 1);
+		nameIndex.insert(alias, name, StelNameIndex::Designation);
+		nameIndexI18n.insert(alias, name, StelNameIndex::Designation);
+	}
 }
 
 // Search the star by HP number
@@ -1033,217 +1244,38 @@ StelObjectP StarMgr::searchByName(const QString& name) const
 //! the passed object I18n name.
 QStringList StarMgr::listMatchingObjectsI18n(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
-	QStringList result;
-	if (maxNbItem==0) return result;
-
-	QString objw = objPrefix.toUpper();
-
-	// Search for common names
-	if (useStartOfWords) {
-		for (QMap<QString,int>::const_iterator it(commonNamesIndexI18n.lowerBound(objw)); it!=commonNamesIndexI18n.end(); ++it)
-		{
-			if (it.key().startsWith(objw))
-			{
-				if (maxNbItem==0)
-					break;
-				result << getCommonName(it.value());
-				--maxNbItem;
-			}
-			else
-				break;
-		}
-	}
-	else
-	{
-		QMapIterator<QString, int> i(commonNamesIndexI18n);
-		while (i.hasNext())
-		{
-			i.next();
-			if (i.key().contains(objw))
-			{
-				if (maxNbItem==0)
-					break;
-				result << getCommonName(i.value());
-				--maxNbItem;
-			}
-		}
-	}
-
-	// Search for sci names
-	QString bayerPattern = objw;
-	QRegExp bayerRegEx(bayerPattern);
-
-	// if the first character is a Greek letter, check if there's an index
-	// after it, such as "alpha1 Cen".
-	if (objw.at(0).unicode() >= 0x0391 && objw.at(0).unicode() <= 0x03A9)
-		bayerRegEx.setPattern(bayerPattern.insert(1,"\\d?"));
-
-	for (QMap<QString,int>::const_iterator it(sciNamesIndexI18n.lowerBound(objw)); it!=sciNamesIndexI18n.end(); ++it)
-	{
-		if (it.key().indexOf(bayerRegEx)==0)
-		{
-			if (maxNbItem==0)
-				break;
-			result << getSciName(it.value());
-			--maxNbItem;
-		}
-		else if (it.key().at(0) != objw.at(0))
-			break;
-	}
-
-	for (QMap<QString,int>::const_iterator it(sciAdditionalNamesIndexI18n.lowerBound(objw)); it!=sciAdditionalNamesIndexI18n.end(); ++it)
-	{
-		if (it.key().indexOf(bayerRegEx)==0)
-		{
-			if (maxNbItem==0)
-				break;
-			result << getSciAdditionalName(it.value());
-			--maxNbItem;
-		}
-		else if (it.key().at(0) != objw.at(0))
-			break;
-	}
-
-	for (QMap<QString,int>::const_iterator it(varStarsIndexI18n.lowerBound(objw)); it!=varStarsIndexI18n.end(); ++it)
-	{
-		if (it.key().startsWith(objw))
-		{
-			if (maxNbItem==0)
-				break;
-			result << getGcvsName(it.value());
-			--maxNbItem;
-		}
-		else
-			break;
-	}
-
-	// Add exact Hp catalogue numbers
-	QRegExp hpRx("^(HIP|HP)\\s*(\\d+)\\s*$");
-	hpRx.setCaseSensitivity(Qt::CaseInsensitive);
-	if (hpRx.exactMatch(objw))
-	{
-		bool ok;
-		int hpNum = hpRx.capturedTexts().at(2).toInt(&ok);
-		if (ok)
-		{
-			StelObjectP s = searchHP(hpNum);
-			if (s && maxNbItem>0)
-			{
-				result << QString("HIP%1").arg(hpNum);
-				maxNbItem--;
-			}
-		}
-	}
-
-	result.sort();
-	return result;
+	return listMatchingNames(nameIndexI18n, objPrefix, maxNbItem, useStartOfWords);
 }
 
 //! Find and return the list of at most maxNbItem objects auto-completing
 //! the passed object English name.
 QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
 {
-	QStringList result;
-	if (maxNbItem==0) return result;
-
-	QString objw = objPrefix.toUpper();
-
-	// Search for common names
-	if (useStartOfWords)
-	{
-		for (QMap<QString,int>::const_iterator it(commonNamesIndex.lowerBound(objw)); it!=commonNamesIndex.end(); ++it)
-		{
-			if (it.key().startsWith(objw))
-			{
-				if (maxNbItem==0)
-					break;
-				result << getCommonName(it.value());
-				--maxNbItem;
-			}
-			else
-				break;
-		}
-	}
-	else
-	{
-		QMapIterator<QString, int> i(commonNamesIndex);
-		while (i.hasNext())
-		{
-			i.next();
-			if (i.key().contains(objw))
-			{
-				if (maxNbItem==0)
-					break;
-				result << getCommonName(i.value());
-				--maxNbItem;
-			}
-		}
-	}
-
-	// Search for sci names
-	QString bayerPattern = objw;
-	QRegExp bayerRegEx(bayerPattern);
-
-	// if the first character is a Greek letter, check if there's an index
-	// after it, such as "alpha1 Cen".
-	if (objw.at(0).unicode() >= 0x0391 && objw.at(0).unicode() <= 0x03A9)
-		bayerRegEx.setPattern(bayerPattern.insert(1,"\\d?"));
-
-	for (QMap<QString,int>::const_iterator it(sciNamesIndexI18n.lowerBound(objw)); it!=sciNamesIndexI18n.end(); ++it)
-	{
-		if (it.key().indexOf(bayerRegEx)==0)
-		{
-			if (maxNbItem==0)
-				break;
-			result << getSciName(it.value());
-			--maxNbItem;
-		}
-		else if (it.key().at(0) != objw.at(0))
-			break;
-	}
+	return listMatchingNames(nameIndex, objPrefix, maxNbItem, useStartOfWords);
+}
 
-	for (QMap<QString,int>::const_iterator it(sciAdditionalNamesIndexI18n.lowerBound(objw)); it!=sciAdditionalNamesIndexI18n.end(); ++it)
-	{
-		if (it.key().indexOf(bayerRegEx)==0)
-		{
-			if (maxNbItem==0)
-				break;
-			result << getSciAdditionalName(it.value());
-			--maxNbItem;
-		}
-		else if (it.key().at(0) != objw.at(0))
-			break;
-	}
+QStringList StarMgr::listMatchingNames(const StelNameIndex& index, const QString& objPrefix, int maxNbItem, bool useStartOfWords) const
+{
+	if (maxNbItem<=0)
+		return QStringList();
 
-	// Search for sci names for var stars
-	for (QMap<QString,int>::const_iterator it(varStarsIndexI18n.lowerBound(objw)); it!=varStarsIndexI18n.end(); ++it)
-	{
-		if (it.key().startsWith(objw))
-		{
-			if (maxNbItem==0)
-				break;
-			result << getGcvsName(it.value());
-			--maxNbItem;
-		}
-		else
-			break;
-	}
+	// Common names match from the start of any word, unless useStartOfWords
+	// asks for the start of the name. Other names always match from their start.
+	QStringList result = index.listMatching(objPrefix, maxNbItem, !useStartOfWords);
+	maxNbItem -= result.size();
 
 	// Add exact Hp catalogue numbers
 	QRegExp hpRx("^(HIP|HP)\\s*(\\d+)\\s*$");
 	hpRx.setCaseSensitivity(Qt::CaseInsensitive);
-	if (hpRx.exactMatch(objw))
+	if (maxNbItem>0 && hpRx.exactMatch(objPrefix))
 	{
 		bool ok;
 		int hpNum = hpRx.capturedTexts().at(2).toInt(&ok);
 		if (ok)
 		{
 			StelObjectP s = searchHP(hpNum);
-			if (s && maxNbItem>0)
-			{
+			if (s)
 				result << QString("HIP%1").arg(hpNum);
-				maxNbItem--;
-			}
 		}
 	}
 
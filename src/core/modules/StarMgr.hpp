@@ -24,9 +24,12 @@
 #include <QVariantMap>
 #include <QVector>
 #include "StelFader.hpp"
+#include "StelNameIndex.hpp"
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "StelProjectorType.hpp"
+#include "StelSkyDrawer.hpp"
+#include "ZoneCache.hpp"
 
 class StelObject;
 class StelToneReproducer;
@@ -36,6 +39,7 @@ class QSettings;
 
 class ZoneArray;
 struct HipIndexStruct;
+class SphericalCap;
 
 static const int RCMAG_TABLE_SIZE = 4096;
 
@@ -54,6 +58,50 @@ typedef struct
 	QString stype;		//! Spectral type
 } varstar;
 
+//! @struct StarDrawChunk
+//! The stars of some zones after culling and projection, ready to be drawn.
+//! Zones are culled by worker threads, each writing into its own chunk,
+//! and the chunks are then drawn from the main thread.
+struct StarDrawChunk
+{
+	//! A star label to draw.
+	struct Label
+	{
+		Vec3f pos;
+		QString text;
+		Vec3f color;
+		float offset;
+	};
+	//! A star bright enough to need the big halo, drawn with StelSkyDrawer::drawPointSource().
+	struct BigHalo
+	{
+		Vec3f pos;
+		RCMag rcMag;
+		unsigned char bV;
+	};
+
+	//! Halo vertices, 6 per star.
+	QVector<StelSkyDrawer::StarVertex> vertices;
+	QVector<Label> labels;
+	QVector<BigHalo> bigHalos;
+
+	// Stars of the zone being culled which are bright enough and in the viewport caps,
+	// projected together with StelProjector::projectBatch(). Only used inside cull().
+	QVector<int> starIndexes;
+	QVector<int> magIndexes;
+	QVector<Vec3f> positions;
+	QVector<Vec3f> projected;
+	QVector<bool> projectedValid;
+
+	//! Empty the chunk, keeping its memory for the next frame.
+	void clear()
+	{
+		vertices.resize(0);
+		labels.resize(0);
+		bigHalos.resize(0);
+	}
+};
+
 //! @class StarMgr
 //! Stores the star catalogue data.
 //! Used to render the stars themselves, as well as determine the color table
@@ -237,6 +285,10 @@ public:
 
 	QVariantList getCatalogsDescription() const {return catalogsDescription;}
 
+	//! Get the cache managing the resident zones of the catalogs which are
+	//! read on demand, e.g. to query its hit, miss and eviction counters.
+	const ZoneCache& getZoneCache() const {return zoneCache;}
+
 	//! Try to load the given catalog, even if it is marched as unchecked.
 	//! Mark it as checked if checksum is correct.
 	//! @return false in case of failure.
@@ -272,6 +324,12 @@ private:
 	//! @param the path to a file containing the GCVS.
 	void loadGcvs(const QString& GcvsFile);
 
+	//! Add a scientific name to the auto-completion indexes.
+	static void insertSciName(const QString& key, const QString& name);
+
+	//! Find the names in one of the auto-completion indexes, and the HIP designation.
+	QStringList listMatchingNames(const StelNameIndex& index, const QString& objPrefix, int maxNbItem, bool useStartOfWords) const;
+
 	//! Gets the maximum search level.
 	// TODO: add a non-lame description - what is the purpose of the max search level?
 	int getMaxSearchLevel() const;
@@ -282,6 +340,11 @@ private:
 	//! Draw a nice animated pointer around the object.
 	void drawPointer(StelPainter& sPainter, const StelCore* core);
 
+	//! Make resident the zones of paged catalogs inside the viewport and in
+	//! a ring of width @em margin around it, and evict unused zones.
+	//! @param margin the width of the prefetch ring in radian.
+	void prefetchZones(const StelCore* core, const QVector<SphericalCap>& viewportCaps, int maxSearchLevel, double margin);
+
 	LinearFader labelsFader;
 	LinearFader starsFader;
 
@@ -294,6 +357,16 @@ private:
 	
 	// A ZoneArray per grid level
 	QVector<ZoneArray*> gridLevels;
+	// Residency of the zones of the paged ZoneArrays
+	mutable ZoneCache zoneCache;
+	// Whether the catalogs are mmapped, paging is then only used if mapping fails
+	bool useMmap;
+
+	// Output of the star culling jobs, kept from frame to frame to reuse the memory
+	QVector<StarDrawChunk> drawChunks;
+	// Vertices of all chunks, merged for drawing in one batch
+	QVector<StelSkyDrawer::StarVertex> mergedStarVertices;
+	int drawThreadCount;
 	static void initTriangleFunc(int lev, int index,
 								 const Vec3f &c0,
 								 const Vec3f &c1,
@@ -324,6 +397,10 @@ private:
 	static QHash<int, varstar> varStarsMapI18n;
 	static QMap<QString, int> varStarsIndexI18n;
 
+	//! Names for auto-completion, built by updateI18n().
+	static StelNameIndex nameIndex;
+	static StelNameIndex nameIndexI18n;
+
 	QFont starFont;
 	static bool flagSciNames;
 	Vec3f labelColor;
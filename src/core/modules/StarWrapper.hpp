@@ -71,7 +71,7 @@ template <class Star> class StarWrapper : public StarWrapperBase
 protected:
 	StarWrapper(const SpecialZoneArray<Star> *a,
 		const SpecialZoneData<Star> *z,
-		const Star *s) : a(a), z(z), s(s) {;}
+		const Star *s) : a(a), z(z), star(*s), s(&star) {;}
 	Vec3d getJ2000EquatorialPos(const StelCore* core) const
 	{
 		static const double d2000 = 2451545.0;
@@ -95,6 +95,8 @@ protected:
 protected:
 	const SpecialZoneArray<Star> *const a;
 	const SpecialZoneData<Star> *const z;
+	//! Copy of the star: the zone of a paged catalog may be unloaded while the wrapper lives.
+	const Star star;
 	const Star *const s;
 };
 
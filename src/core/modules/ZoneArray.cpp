@@ -23,6 +23,8 @@
 #ifdef Q_OS_WIN
 #include <io.h>
 #include <windows.h>
+#else
+#include <unistd.h>
 #endif
 
 #include "ZoneArray.hpp"
@@ -36,6 +38,19 @@ static unsigned int stel_bswap_32(unsigned int val) {
 	(((val) & 0x0000ff00) <<  8) | (((val) & 0x000000ff) << 24);
 }
 
+static qint64 getPageSize()
+{
+#ifdef Q_OS_WIN
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	// Windows file mappings must start on an allocation granularity boundary
+	return info.dwAllocationGranularity;
+#else
+	const long pageSize = sysconf(_SC_PAGESIZE);
+	return pageSize > 0 ? pageSize : 4096;
+#endif
+}
+
 static const Vec3f north(0,0,1);
 
 void ZoneArray::initTriangle(int index, const Vec3f &c0, const Vec3f &c1, const Vec3f &c2)
@@ -87,11 +102,8 @@ static inline int ReadInt(QFile& file, unsigned int &x)
 #endif
 #endif
 
-ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
+ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap, bool use_paging)
 {
-#ifdef Q_OS_ANDROID
-	use_mmap = false;
-#endif
 	QString dbStr; // for debugging output.
 	QFile* file = new QFile(catalogFilePath);
 	if (!file->open(QIODevice::ReadOnly))
@@ -117,19 +129,8 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 	const bool byte_swap = (magic == FILE_MAGIC_OTHER_ENDIAN);
 	if (byte_swap)
 	{
-		// ok, FILE_MAGIC_OTHER_ENDIAN, must swap
-		if (use_mmap)
-		{
-			dbStr += "warning - must convert catalogue ";
-#if (!defined(__GNUC__))
-			dbStr += "to native format ";
-#endif
-			dbStr += "before mmap loading";
-			qWarning() << dbStr;
-			use_mmap = false;
-			qWarning() << "Revert to not using mmmap";
-			//return 0;
-		}
+		// ok, FILE_MAGIC_OTHER_ENDIAN, must swap.
+		// When mmapped, the zones are byteswapped lazily on first access.
 		dbStr += "byteswap ";
 		type = stel_bswap_32(type);
 		major = stel_bswap_32(major);
@@ -142,16 +143,6 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 	else if (magic == FILE_MAGIC)
 	{
 		// ok, FILE_MAGIC
-#if (!defined(__GNUC__) && !defined(_MSC_BUILD))
-		if (use_mmap)
-		{
-			// mmap only with gcc:
-			dbStr += "warning - you must convert catalogue to native format before mmap loading";
-			qDebug(qPrintable(dbStr));
-
-			return 0;
-		}
-#endif
 	}
 	else if (magic == FILE_MAGIC_NATIVE)
 	{
@@ -201,7 +192,7 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 #ifndef _MSC_BUILD
 			Q_ASSERT(sizeof(Star2) == 10);
 #endif
-			rval = new SpecialZoneArray<Star2>(file, byte_swap, use_mmap, level, mag_min, mag_range, mag_steps);
+			rval = new SpecialZoneArray<Star2>(file, byte_swap, use_mmap, use_paging, level, mag_min, mag_range, mag_steps);
 			if (rval == 0)
 			{
 				dbStr += "error - no memory ";
@@ -222,7 +213,7 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 #ifndef _MSC_BUILD
 			Q_ASSERT(sizeof(Star3) == 6);
 #endif
-			rval = new SpecialZoneArray<Star3>(file, byte_swap, use_mmap, level, mag_min, mag_range, mag_steps);
+			rval = new SpecialZoneArray<Star3>(file, byte_swap, use_mmap, use_paging, level, mag_min, mag_range, mag_steps);
 			if (rval == 0)
 			{
 				dbStr += "error - no memory ";
@@ -255,7 +246,7 @@ ZoneArray::ZoneArray(const QString& fname, QFile* file, int level, int mag_min,
 			 int mag_range, int mag_steps)
 			: fname(fname), level(level), mag_min(mag_min),
 			  mag_range(mag_range), mag_steps(mag_steps),
-			  star_position_scale(0.0), zones(0), file(file)
+			  star_position_scale(0.0), zones(0), file(file), paged(false)
 {
 	nr_of_zones = StelGeodesicGrid::nrOfZones(level);
 	nr_of_stars = 0;
@@ -287,6 +278,7 @@ void HipZoneArray::updateHipIndex(HipIndexStruct hipIndex[]) const
 {
 	for (const SpecialZoneData<Star1> *z=getZones()+(nr_of_zones-1);z>=getZones();z--)
 	{
+		repackZone(z-getZones());
 		for (const Star1 *s = z->getStars()+z->size-1;s>=z->getStars();s--)
 		{
 			const int hip = s->hip;
@@ -317,11 +309,24 @@ void SpecialZoneArray<Star>::scaleAxis()
 }
 
 template<class Star>
-SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mmap,
+SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mmap,bool use_paging,
 					 int level, int mag_min, int mag_range, int mag_steps)
 		: ZoneArray(file->fileName(), file, level, mag_min, mag_range, mag_steps),
-		  stars(0), mmap_start(0)
+		  stars(0), mmap_start(0), zone_offsets(0), repacked_zones(0),
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+		  // need for byte_swap on a BE machine means that catalog is LE
+		  repack_from_be(!byte_swap)
+#else
+		  // need for byte_swap on a LE machine means that catalog is BE
+		  repack_from_be(byte_swap)
+#endif
+#if (!defined(__GNUC__))
+		  , need_repack(true)
+#else
+		  , need_repack(byte_swap)
+#endif
 {
+
 	if (nr_of_zones > 0)
 	{
 		zones = new SpecialZoneData<Star>[nr_of_zones];
@@ -370,17 +375,38 @@ SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mm
 		}
 		else
 		{
+			// Mapping is preferred, paging only bounds the memory used when it fails
+			if (use_mmap && !mapStars(need_repack))
+			{
+				qWarning() << "Revert to not using mmap for" << file->fileName();
+				use_mmap = false;
+			}
 			if (use_mmap)
 			{
-				mmap_start = file->map(file->pos(), sizeof(Star)*nr_of_stars);
-				if (mmap_start == 0)
+				Star *s = stars;
+				for (unsigned int z=0;z<nr_of_zones;z++)
 				{
-					qDebug() << "ERROR: SpecialZoneArray(" << level
-						 << ")::SpecialZoneArray: QFile(" << file->fileName()
-						 << ".map(" << file->pos()
-						 << ',' << sizeof(Star)*nr_of_stars
-						 << ") failed: " << file->errorString();
-					stars = 0;
+					getZones()[z].stars = s;
+					s += getZones()[z].size;
+				}
+				file->close();
+			}
+			else if (use_paging)
+			{
+				// Keep the file open, the zones are read by loadZone() when needed
+				zone_offsets = new qint64[nr_of_zones];
+				qint64 offset = file->pos();
+				for (unsigned int z=0;z<nr_of_zones;z++)
+				{
+					zone_offsets[z] = offset;
+					offset += (qint64)sizeof(Star)*getZones()[z].size;
+					getZones()[z].stars = 0;
+				}
+				if (offset > file->size())
+				{
+					qDebug() << "Error: truncated catalog:" << file->fileName();
+					delete[] zone_offsets;
+					zone_offsets = 0;
 					nr_of_stars = 0;
 					delete[] getZones();
 					zones = 0;
@@ -388,16 +414,8 @@ SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mm
 				}
 				else
 				{
-					stars = (Star*)mmap_start;
-					Star *s = stars;
-					for (unsigned int z=0;z<nr_of_zones;z++)
-					{
-
-						getZones()[z].stars = s;
-						s += getZones()[z].size;
-					}
+					paged = true;
 				}
-				file->close();
 			}
 			else
 			{
@@ -425,26 +443,12 @@ SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mm
 						getZones()[z].stars = s;
 						s += getZones()[z].size;
 					}
-					if (
-#if (!defined(__GNUC__))
-						true
-#else
-						byte_swap
-#endif
-					)
+					if (need_repack)
 					{
 						s = stars;
 						for (unsigned int i=0;i<nr_of_stars;i++,s++)
 						{
-							s->repack(
-#if Q_BYTE_ORDER == Q_BIG_ENDIAN
-								// need for byte_swap on a BE machine means that catalog is LE
-								!byte_swap
-#else
-								// need for byte_swap on a LE machine means that catalog is BE
-								byte_swap
-#endif
-							);
+							s->repack(repack_from_be);
 						}
 					}
 				}
@@ -456,6 +460,97 @@ SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mm
 	}
 }
 
+template<class Star>
+bool SpecialZoneArray<Star>::mapStars(bool repack)
+{
+	// Map from the page boundary preceding the star data, so that the mapping
+	// itself is page-aligned. The stars then start delta bytes into it.
+	const qint64 starsOffset = file->pos();
+	const qint64 delta = starsOffset % getPageSize();
+	const qint64 size = delta + (qint64)sizeof(Star)*nr_of_stars;
+	QFileDevice::MemoryMapFlags flags = QFileDevice::NoOptions;
+	if (repack)
+	{
+#if QT_VERSION >= 0x050400
+		// Repacking writes into the mapping: use a private copy-on-write
+		// mapping so that only the pages of touched zones get copied.
+		flags = QFileDevice::MapPrivateOption;
+#else
+		return false;
+#endif
+	}
+	mmap_start = file->map(starsOffset-delta, size, flags);
+	if (mmap_start == 0)
+	{
+		qWarning() << "WARNING: SpecialZoneArray(" << level
+			   << ")::mapStars: QFile(" << file->fileName()
+			   << ").map(" << starsOffset-delta
+			   << ',' << size
+			   << ") failed: " << file->errorString();
+		return false;
+	}
+	stars = (Star*)(mmap_start+delta);
+	if (repack)
+	{
+		repacked_zones = new bool[nr_of_zones];
+		for (unsigned int z=0;z<nr_of_zones;z++)
+			repacked_zones[z] = false;
+	}
+	return true;
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::repackZone(int index) const
+{
+	if (repacked_zones == 0 || repacked_zones[index])
+		return;
+	const SpecialZoneData<Star>* z = getZones() + index;
+	const Star* lastStar = z->getStars() + z->size;
+	for (Star* s=z->getStars();s<lastStar;++s)
+		s->repack(repack_from_be);
+	repacked_zones[index] = true;
+}
+
+template<class Star>
+bool SpecialZoneArray<Star>::loadZone(int index)
+{
+	SpecialZoneData<Star>* z = getZones() + index;
+	if (!paged || z->stars != 0 || z->size == 0)
+		return true;
+	Star* s = new Star[z->size];
+	if (!file->seek(zone_offsets[index]) || !readFile(*file, s, sizeof(Star)*z->size))
+	{
+		qWarning() << "ERROR: SpecialZoneArray(" << level
+			   << ")::loadZone: could not read zone" << index
+			   << "from" << file->fileName();
+		delete[] s;
+		return false;
+	}
+	if (need_repack)
+	{
+		for (int i=0;i<z->size;i++)
+			s[i].repack(repack_from_be);
+	}
+	z->stars = s;
+	return true;
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::unloadZone(int index)
+{
+	if (!paged)
+		return;
+	SpecialZoneData<Star>* z = getZones() + index;
+	delete[] z->getStars();
+	z->stars = 0;
+}
+
+template<class Star>
+qint64 SpecialZoneArray<Star>::getZoneMemorySize(int index) const
+{
+	return (qint64)sizeof(Star)*getZones()[index].size;
+}
+
 template<class Star>
 SpecialZoneArray<Star>::~SpecialZoneArray(void)
 {
@@ -469,29 +564,46 @@ SpecialZoneArray<Star>::~SpecialZoneArray(void)
 		{
 			delete[] stars;
 		}
-		delete file;
 		stars = 0;
 	}
+	if (paged && zones)
+	{
+		for (unsigned int z=0;z<nr_of_zones;z++)
+			unloadZone(z);
+	}
+	delete file;
+	file = 0;
+	if (zone_offsets)
+	{
+		delete[] zone_offsets;
+		zone_offsets = 0;
+	}
 	if (zones)
 	{
 		delete[] getZones();
 		zones = NULL;
 	}
+	if (repacked_zones)
+	{
+		delete[] repacked_zones;
+		repacked_zones = 0;
+	}
 	nr_of_zones = 0;
 	nr_of_stars = 0;
 }
 
 template<class Star>
-void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsideViewport, const RCMag* rcmag_table,
-	int limitMagIndex, StelCore* core, int maxMagStarName, float names_brightness, const QVector<SphericalCap> &boundingCaps) const
+void SpecialZoneArray<Star>::cull(int index, bool isInsideViewport, const RCMag* rcmag_table,
+	int limitMagIndex, const StelCore* core, const StelProjector* prj, int maxMagStarName,
+	const QVector<SphericalCap> &boundingCaps, StarDrawChunk& chunk) const
 {
-    StelSkyDrawer* drawer = core->getSkyDrawer();
+    const StelSkyDrawer* drawer = core->getSkyDrawer();
     Vec3f vf;
     static const double d2000 = 2451545.0;
     const float movementFactor = (M_PI/180)*(0.0001/3600) * ((core->getJDay()-d2000)/365.25) / star_position_scale;
     
     // GZ, added for extinction
-    const Extinction& extinction=core->getSkyDrawer()->getExtinction();
+    const Extinction& extinction=drawer->getExtinction();
     const bool withExtinction=drawer->getFlagHasAtmosphere() && extinction.getExtinctionCoefficient()>=0.01f;
     const float k = 0.001f*mag_range/mag_steps; // from StarMgr.cpp line 654
 	
@@ -507,34 +619,38 @@ void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsid
 	Q_ASSERT(cutoffMagStep<RCMAG_TABLE_SIZE);
     
 	// Go through all stars, which are sorted by magnitude (bright stars first)
+	repackZone(index);
 	const SpecialZoneData<Star>* zoneToDraw = getZones() + index;
-	const Star* lastStar = zoneToDraw->getStars() + zoneToDraw->size;
-    for (const Star* s=zoneToDraw->getStars();s<lastStar;++s)
-    {
+	// Zone of a paged catalog which could not be read
+	if (zoneToDraw->stars == 0)
+		return;
+	const Star* firstStar = zoneToDraw->getStars();
+	const Star* lastStar = firstStar + zoneToDraw->size;
+	const int nbCaps = boundingCaps.size();
+	chunk.starIndexes.resize(0);
+	chunk.magIndexes.resize(0);
+	chunk.positions.resize(0);
+	for (const Star* s=firstStar;s<lastStar;++s)
+	{
 		// Artifical cutoff per magnitude
 		if (s->mag > cutoffMagStep)
 			break;
-    
-		// Because of the test above, the star should always be visible from this point.
-		
-		// Array of 2 numbers containing radius and magnitude
-		const RCMag* tmpRcmag = &rcmag_table[s->mag];
-		
+
 		// Get the star position from the array
 		s->getJ2000Pos(zoneToDraw, movementFactor, vf);
-		
-		// If the star zone is not strictly contained inside the viewport, eliminate from the 
+
+		// If the star zone is not strictly contained inside the viewport, eliminate from the
 		// beginning the stars actually outside viewport.
 		if (!isInsideViewport)
 		{
 			bool isVisible = true;
 			vf.normalize();
-			foreach (const SphericalCap& cap, boundingCaps)
+			for (int c=0;c<nbCaps;++c)
 			{
-				if (!cap.contains(vf))
+				if (!boundingCaps.at(c).contains(vf))
 				{
 					isVisible = false;
-					continue;
+					break;
 				}
 			}
 			if (!isVisible)
@@ -552,17 +668,58 @@ void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsid
 			extinctedMagIndex = s->mag + (int)(extMagShift/k);
 			if (extinctedMagIndex >= cutoffMagStep) // i.e., if extincted it is dimmer than cutoff, so remove
 				continue;
-			tmpRcmag = &rcmag_table[extinctedMagIndex];
 		}
-	
-		if (drawer->drawPointSource(sPainter, vf, *tmpRcmag, s->bV, !isInsideViewport) && s->hasName() && extinctedMagIndex < maxMagStarName && s->hasComponentID()<=1)
+		if (rcmag_table[extinctedMagIndex].radius<=0.f)
+			continue;
+
+		chunk.starIndexes.append(s-firstStar);
+		chunk.magIndexes.append(extinctedMagIndex);
+		chunk.positions.append(vf);
+	}
+
+	// Project the remaining stars of the zone together
+	const int nbStars = chunk.positions.size();
+	chunk.projected.resize(nbStars);
+	chunk.projectedValid.resize(nbStars);
+	prj->projectBatch(nbStars, chunk.positions.constData(), chunk.projected.data(), chunk.projectedValid.data());
+
+	StelSkyDrawer::StarVertex vertices[6];
+	for (int i=0;i<nbStars;++i)
+	{
+		const Vec3f& win = chunk.projected.at(i);
+		if (!chunk.projectedValid.at(i) || (!isInsideViewport && !prj->checkInViewport(win)))
+			continue;
+		const Star* s = firstStar + chunk.starIndexes.at(i);
+		const int extinctedMagIndex = chunk.magIndexes.at(i);
+		// Array of 2 numbers containing radius and magnitude
+		const RCMag* tmpRcmag = &rcmag_table[extinctedMagIndex];
+
+		bool bigHalo;
+		if (!drawer->computeProjectedPointSource(win, *tmpRcmag, s->bV, vertices, bigHalo))
+			continue;
+		if (bigHalo)
 		{
-			const float offset = tmpRcmag->radius*0.7f;
-			const Vec3f colorr = StelSkyDrawer::indexToColor(s->bV)*0.75f;
-			sPainter->setColor(colorr[0], colorr[1], colorr[2],names_brightness);
-			sPainter->drawText(Vec3d(vf[0], vf[1], vf[2]), s->getNameI18n(), 0, offset, offset, false);
+			StarDrawChunk::BigHalo h;
+			h.pos = chunk.positions.at(i);
+			h.rcMag = *tmpRcmag;
+			h.bV = s->bV;
+			chunk.bigHalos.append(h);
 		}
-    }
+		else
+		{
+			for (int v=0;v<6;++v)
+				chunk.vertices.append(vertices[v]);
+		}
+		if (s->hasName() && extinctedMagIndex < maxMagStarName && s->hasComponentID()<=1)
+		{
+			StarDrawChunk::Label l;
+			l.pos = chunk.positions.at(i);
+			l.text = s->getNameI18n();
+			l.color = StelSkyDrawer::indexToColor(s->bV)*0.75f;
+			l.offset = tmpRcmag->radius*0.7f;
+			chunk.labels.append(l);
+		}
+	}
 }
 
 template<class Star>
@@ -571,7 +728,10 @@ void SpecialZoneArray<Star>::searchAround(const StelCore* core, int index, const
 {
 	static const double d2000 = 2451545.0;
 	const double movementFactor = (M_PI/180.)*(0.0001/3600.) * ((core->getJDay()-d2000)/365.25)/ star_position_scale;
+	repackZone(index);
 	const SpecialZoneData<Star> *const z = getZones()+index;
+	if (z->stars == 0)
+		return;
 	Vec3f tmp;
 	Vec3f vf(v[0], v[1], v[2]);
 	for (const Star* s=z->getStars();s<z->getStars()+z->size;++s)
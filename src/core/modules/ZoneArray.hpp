@@ -81,8 +81,9 @@ public:
 	//! loading.
 	//! @param extended_file_name path of the star catalog to load from
 	//! @param use_mmap whether or not to mmap the star catalog
+	//! @param use_paging whether to read zones on demand when the catalog is not mapped.
 	//! @return an instance of SpecialZoneArray or HipZoneArray
-	static ZoneArray *create(const QString &extended_file_name, bool use_mmap);
+	static ZoneArray *create(const QString &extended_file_name, bool use_mmap, bool use_paging=false);
 	virtual ~ZoneArray()
 	{
 		nr_of_zones = 0;
@@ -99,10 +100,24 @@ public:
 							  QList<StelObjectP > &result) = 0;
 
 	//! Pure virtual method. See subclass implementation.
-	virtual void draw(StelPainter* sPainter, int index,bool is_inside,
-					  const RCMag* rcmag_table, int limitMagIndex, StelCore* core,
-					  int maxMagStarName, float names_brightness,
-					  const QVector<SphericalCap>& boundingCaps) const = 0;
+	virtual void cull(int index, bool is_inside,
+					  const RCMag* rcmag_table, int limitMagIndex, const StelCore* core,
+					  const StelProjector* prj, int maxMagStarName,
+					  const QVector<SphericalCap>& boundingCaps, StarDrawChunk& chunk) const = 0;
+
+	//! Get whether the zones of this catalog are read on demand.
+	//! The residency of the zones of paged catalogs is managed by a ZoneCache.
+	bool isPaged() const { return paged; }
+
+	//! Read the stars of the given zone into memory if they are not resident yet.
+	//! @return @c false if the zone could not be read
+	virtual bool loadZone(int index) = 0;
+
+	//! Release the memory used by the stars of the given zone of a paged catalog.
+	virtual void unloadZone(int index) = 0;
+
+	//! Get the memory used by the stars of the given zone when resident, in bytes.
+	virtual qint64 getZoneMemorySize(int index) const = 0;
 
 	//! Get whether or not the catalog was successfully loaded.
 	//! @return @c true if at least one zone was loaded, otherwise @c false
@@ -141,6 +156,7 @@ protected:
 	unsigned int nr_of_stars;
 	ZoneData *zones;
 	QFile* file;
+	bool paged;
 };
 
 //! @class SpecialZoneArray
@@ -153,14 +169,21 @@ class SpecialZoneArray : public ZoneArray
 {
 public:
 	//! Handles loading of the meaty part of star catalogs.
+	//! When @em use_mmap is set the star data is mapped page-aligned and
+	//! without copying. If the catalog must be repacked (other endianness,
+	//! non-gcc compilers) the mapping is private (copy-on-write) and each zone
+	//! is repacked on first access. If mapping fails or @em use_mmap is not set,
+	//! the zones are read on demand when @em use_paging is set, otherwise the
+	//! catalog is read completely into memory.
 	//! @param file catalog to load from
 	//! @param byte_swap whether to switch endianness of catalog data
 	//! @param use_mmap whether or not to mmap the star catalog
+	//! @param use_paging whether to read zones on demand when the catalog is not mapped
 	//! @param level level in StelGeodesicGrid
 	//! @param mag_min lower bound of magnitudes
 	//! @param mag_range range of magnitudes
 	//! @param mag_steps number of steps used to describe values in range
-	SpecialZoneArray(QFile* file,bool byte_swap,bool use_mmap,int level,int mag_min,
+	SpecialZoneArray(QFile* file,bool byte_swap,bool use_mmap,bool use_paging,int level,int mag_min,
 			 int mag_range,int mag_steps);
 	~SpecialZoneArray(void);
 protected:
@@ -170,38 +193,62 @@ protected:
 		return static_cast<SpecialZoneData<Star>*>(zones);
 	}
 
-	//! Draw stars and their names onto the viewport.
-	//! @param sPainter the painter to use 
+	//! Cull and project the stars of a zone, storing their halos and names in @em chunk.
+	//! Doesn't make any GL call, so that it can be run by worker threads,
+	//! each zone being processed by one thread only.
 	//! @param index zone index to draw
 	//! @param isInsideViewport whether the zone is inside the current viewport
 	//! @param rcmag_table table of magnitudes
 	//! @param limitMagIndex index from rcmag_table at which stars are not visible anymore
 	//! @param core core to use for drawing
+	//! @param prj projector to use for drawing
 	//! @param maxMagStarName magnitude limit of stars that display labels
-	//! @param names_brightness brightness of labels
-	virtual void draw(StelPainter* sPainter, int index, bool isInsideViewport,
-			  const RCMag *rcmag_table, int limitMagIndex, StelCore* core,
-			  int maxMagStarName, float names_brightness,
-			  const QVector<SphericalCap>& boundingCaps) const;
+	//! @param boundingCaps the bounding caps of the viewport
+	//! @param chunk where to store the stars to draw
+	virtual void cull(int index, bool isInsideViewport,
+			  const RCMag *rcmag_table, int limitMagIndex, const StelCore* core,
+			  const StelProjector* prj, int maxMagStarName,
+			  const QVector<SphericalCap>& boundingCaps, StarDrawChunk& chunk) const;
 
 	virtual void scaleAxis();
 	virtual void searchAround(const StelCore* core, int index,const Vec3d &v,double cosLimFov,
 					  QList<StelObjectP > &result);
 
+	virtual bool loadZone(int index);
+	virtual void unloadZone(int index);
+	virtual qint64 getZoneMemorySize(int index) const;
+
+	//! Make sure the stars of the given zone are in native format.
+	//! Only does something for mmapped catalogs which need repacking,
+	//! in which case the zone is repacked the first time it is touched.
+	void repackZone(int index) const;
+
 	Star *stars;
 private:
+	//! Map the star data of the catalog page-aligned into memory.
+	//! @param repack whether the stars will need repacking after mapping
+	//! @return @c false if the file could not be mapped
+	bool mapStars(bool repack);
+
 	uchar *mmap_start;
+	//! For paged catalogs, the file offset of the stars of each zone.
+	qint64 *zone_offsets;
+	//! For mmapped catalogs needing repacking, whether each zone was already repacked.
+	bool *repacked_zones;
+	bool repack_from_be;
+	bool need_repack;
 };
 
 //! @class HipZoneArray
 //! ZoneArray of Hipparcos stars. It's just a SpecialZoneArray<Star1> that
 //! implements updateHipIndex(HipIndexStruct).
+//! Its zones are never paged, because the Hipparcos index points into them.
 class HipZoneArray : public SpecialZoneArray<Star1>
 {
 public:
 	HipZoneArray(QFile* file,bool byte_swap,bool use_mmap,
 		   int level,int mag_min,int mag_range,int mag_steps)
-			: SpecialZoneArray<Star1>(file,byte_swap,use_mmap,level,
+			: SpecialZoneArray<Star1>(file,byte_swap,use_mmap,false,level,
 									  mag_min,mag_range,mag_steps) {}
 
 	//! Add Hipparcos information for all stars in this catalog into @em hipIndex.
@@ -0,0 +1,76 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "ZoneCache.hpp"
+#include "ZoneArray.hpp"
+
+ZoneCache::ZoneCache() : memoryBudget(0), residentBytes(0), frame(0), hits(0), misses(0), evictions(0)
+{
+}
+
+void ZoneCache::touch(ZoneArray* array, int index)
+{
+	if (!array->isPaged())
+		return;
+	const Key key(array, index);
+	QHash<Key, EntryList::iterator>::iterator it = lookup.find(key);
+	if (it!=lookup.end())
+	{
+		++hits;
+		it.value()->frame = frame;
+		entries.splice(entries.begin(), entries, it.value());
+		return;
+	}
+	++misses;
+	if (!array->loadZone(index))
+		return;
+	Entry e;
+	e.array = array;
+	e.index = index;
+	e.bytes = array->getZoneMemorySize(index);
+	e.frame = frame;
+	entries.push_front(e);
+	lookup.insert(key, entries.begin());
+	residentBytes += e.bytes;
+}
+
+void ZoneCache::trim()
+{
+	while (residentBytes > memoryBudget && !entries.empty())
+	{
+		Entry& e = entries.back();
+		// Everything further up the list was used in this frame too
+		if (e.frame == frame)
+			break;
+		e.array->unloadZone(e.index);
+		residentBytes -= e.bytes;
+		lookup.remove(Key(e.array, e.index));
+		entries.pop_back();
+		++evictions;
+	}
+}
+
+void ZoneCache::clear()
+{
+	for (EntryList::iterator it=entries.begin();it!=entries.end();++it)
+		it->array->unloadZone(it->index);
+	entries.clear();
+	lookup.clear();
+	residentBytes = 0;
+}
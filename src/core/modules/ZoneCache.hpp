@@ -0,0 +1,96 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _ZONECACHE_HPP_
+#define _ZONECACHE_HPP_
+
+#include <QHash>
+#include <QPair>
+#include <list>
+
+class ZoneArray;
+
+//! @class ZoneCache
+//! Keeps track of the resident zones of paged ZoneArrays.
+//! When a memory budget is set, the star catalogs which cannot be mmapped are not loaded
+//! entirely into memory: their zones are read on demand when the geodesic search of StarMgr::draw
+//! touches them. When the memory used by resident zones exceeds the budget,
+//! the least recently used zones are unloaded again. Zones touched during the
+//! current frame are never unloaded.
+class ZoneCache
+{
+public:
+	ZoneCache();
+
+	//! Set the maximum memory used by resident zones.
+	//! @param bytes the budget in bytes. 0 disables paging.
+	void setMemoryBudget(qint64 bytes) {memoryBudget = bytes;}
+	//! Get the maximum memory used by resident zones in bytes.
+	qint64 getMemoryBudget() const {return memoryBudget;}
+
+	//! Start a new frame. Zones touched before are candidates for eviction again.
+	void beginFrame() {++frame;}
+
+	//! Make the given zone resident and mark it as most recently used.
+	//! Does nothing if the array is not paged.
+	void touch(ZoneArray* array, int index);
+
+	//! Unload least recently used zones until the resident memory fits into the budget.
+	void trim();
+
+	//! Unload all resident zones.
+	void clear();
+
+	//! Get the memory currently used by resident zones in bytes.
+	qint64 getResidentBytes() const {return residentBytes;}
+	//! Get the number of resident zones.
+	int getNrOfResidentZones() const {return lookup.size();}
+	//! Get the number of touches of zones which were already resident.
+	quint64 getHits() const {return hits;}
+	//! Get the number of touches of zones which had to be loaded.
+	quint64 getMisses() const {return misses;}
+	//! Get the number of zones unloaded to respect the budget.
+	quint64 getEvictions() const {return evictions;}
+	//! Reset the hit, miss and eviction counters.
+	void resetStatistics() {hits = misses = evictions = 0;}
+
+private:
+	struct Entry
+	{
+		ZoneArray* array;
+		int index;
+		qint64 bytes;
+		unsigned int frame;
+	};
+	typedef std::list<Entry> EntryList;
+	typedef QPair<ZoneArray*, int> Key;
+
+	//! Resident zones, the most recently used first.
+	EntryList entries;
+	QHash<Key, EntryList::iterator> lookup;
+
+	qint64 memoryBudget;
+	qint64 residentBytes;
+	unsigned int frame;
+	quint64 hits;
+	quint64 misses;
+	quint64 evictions;
+};
+
+#endif // _ZONECACHE_HPP_
@@ -134,12 +134,10 @@ void gSatWrapper::setEpoch(double ai_julianDaysEpoch)
 }
 
 
-void gSatWrapper::calcObserverECIPosition(Vec3f& ao_position, Vec3f& ao_velocity)
+void gSatWrapper::calcObserverECIPosition(const gTime& ai_epoch, const EpochData& ai_data, Vec3f& ao_position, Vec3f& ao_velocity)
 {
-	const StelLocation& loc   = StelApp::getInstance().getCore()->getCurrentLocation();
-
-	float radLatitude = loc.latitude * KDEG2RAD;
-	float theta       = epoch.toThetaLMST(loc.longitude * KDEG2RAD);
+	float radLatitude = ai_data.latitude * KDEG2RAD;
+	float theta       = ai_epoch.toThetaLMST(ai_data.longitude * KDEG2RAD);
 
 	/* Reference:  Explanatory supplement to the Astronomical Almanac, page 209-210. */
 	/* Elipsoid earth model*/
@@ -148,64 +146,97 @@ void gSatWrapper::calcObserverECIPosition(Vec3f& ao_position, Vec3f& ao_velocity
 	const float c = 1.f/std::sqrt(1.f + __f*(__f - 2.f)*sinradLatitude*sinradLatitude);
 	const float sq = (1 - __f)*(1 - __f)*c;
 
-	float r = (KEARTHRADIUS*c + loc.altitude/1000)*std::cos(radLatitude);
+	float r = (KEARTHRADIUS*c + ai_data.altitude/1000)*std::cos(radLatitude);
 	ao_position[0] = r * std::cos(theta);/*kilometers*/
 	ao_position[1] = r * std::sin(theta);
-	ao_position[2] = (KEARTHRADIUS*sq + loc.altitude/1000)*sinradLatitude;
+	ao_position[2] = (KEARTHRADIUS*sq + ai_data.altitude/1000)*sinradLatitude;
 	ao_velocity[0] = -KMFACTOR*ao_position[1];/*kilometers/second*/
 	ao_velocity[1] =  KMFACTOR*ao_position[0];
 	ao_velocity[2] =  0;
 }
 
+void gSatWrapper::computeObserverData(double ai_julianDaysEpoch, EpochData& ao_data)
+{
+	const StelLocation& loc = StelApp::getInstance().getCore()->getCurrentLocation();
+	ao_data.latitude  = loc.latitude;
+	ao_data.longitude = loc.longitude;
+	ao_data.altitude  = loc.altitude;
+	setObserverDataEpoch(ai_julianDaysEpoch, ao_data);
+	ao_data.sunECIPos.set(0.f, 0.f, 0.f);
+	ao_data.sunAboveHorizon = false;
+}
 
+void gSatWrapper::setObserverDataEpoch(double ai_julianDaysEpoch, EpochData& io_data)
+{
+	const gTime epoch(ai_julianDaysEpoch);
 
-Vec3f gSatWrapper::getAltAz()
+	io_data.epoch = ai_julianDaysEpoch;
+	calcObserverECIPosition(epoch, io_data, io_data.observerECIPos, io_data.observerECIVel);
+
+	const float radLatitude = io_data.latitude * KDEG2RAD;
+	const float theta       = epoch.toThetaLMST(io_data.longitude * KDEG2RAD);
+	io_data.sinLatitude = std::sin(radLatitude);
+	io_data.cosLatitude = std::cos(radLatitude);
+	io_data.sinTheta    = std::sin(theta);
+	io_data.cosTheta    = std::cos(theta);
+}
+
+void gSatWrapper::computeEpochData(double ai_julianDaysEpoch, EpochData& ao_data)
 {
-	const StelLocation& loc   = StelApp::getInstance().getCore()->getCurrentLocation();
-	Vec3f topoSatPos;
-	Vec3f observerECIPos;
-	Vec3f observerECIVel;
-	calcObserverECIPosition(observerECIPos, observerECIVel);
+	computeObserverData(ai_julianDaysEpoch, ao_data);
 
-	const Vec3f& satECIPos = getTEMEPos();
-	Vec3f slantRange = satECIPos - observerECIPos;
+	// All positions in ECI system are positions referenced in a StelCore::EquinoxEq system centered in the earth centre
+	StelCore* core = StelApp::getInstance().getCore();
+	SolarSystem *solsystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
+	const Vec3d sunEquinoxEqPos = solsystem->getSun()->getEquinoxEquatorialPos(core);
+	//sunEquinoxEqPos is measured in AU. we need meassure it in Km
+	ao_data.sunECIPos.set(sunEquinoxEqPos[0]*AU, sunEquinoxEqPos[1]*AU, sunEquinoxEqPos[2]*AU);
+	ao_data.sunECIPos += ao_data.observerECIPos; //Change ref system centre
+	ao_data.sunAboveHorizon = solsystem->getSun()->getAltAzPosGeometric(core)[2] > 0.0;
+}
 
-	const float  radLatitude    = loc.latitude * KDEG2RAD;
-	const float  theta          = epoch.toThetaLMST(loc.longitude * KDEG2RAD);
+Vec3f gSatWrapper::getAltAz()
+{
+	EpochData data;
+	computeObserverData(epoch.getGmtTm(), data);
+	return getAltAz(data);
+}
 
-	const float sinradLatitude = std::sin(radLatitude);
-	const float cosradLatitude = std::cos(radLatitude);
-	const float sintheta = std::sin(theta);
-	const float costheta = std::cos(theta);
+Vec3f gSatWrapper::getAltAz(const EpochData& data)
+{
+	Vec3f topoSatPos;
+	const Vec3f& satECIPos = getTEMEPos();
+	Vec3f slantRange = satECIPos - data.observerECIPos;
 
 	//top_s
-	topoSatPos[0] = sinradLatitude * costheta*slantRange[0]
-					 + sinradLatitude* sintheta*slantRange[1]
-					 - cosradLatitude* slantRange[2];
+	topoSatPos[0] = data.sinLatitude * data.cosTheta*slantRange[0]
+					 + data.sinLatitude* data.sinTheta*slantRange[1]
+					 - data.cosLatitude* slantRange[2];
 	//top_e
-	topoSatPos[1] = -1.0* sintheta*slantRange[0]
-					 + costheta*slantRange[1];
+	topoSatPos[1] = -1.0* data.sinTheta*slantRange[0]
+					 + data.cosTheta*slantRange[1];
 
 	//top_z
-	topoSatPos[2] = cosradLatitude * costheta*slantRange[0]
-					 + cosradLatitude * sintheta*slantRange[1]
-					 + sinradLatitude *slantRange[2];
+	topoSatPos[2] = data.cosLatitude * data.cosTheta*slantRange[0]
+					 + data.cosLatitude * data.sinTheta*slantRange[1]
+					 + data.sinLatitude *slantRange[2];
 
 	return topoSatPos;
 }
 
 void  gSatWrapper::getSlantRange(double &ao_slantRange, double &ao_slantRangeRate)
 {
+	EpochData data;
+	computeObserverData(epoch.getGmtTm(), data);
+	getSlantRange(data, ao_slantRange, ao_slantRangeRate);
+}
 
-	Vec3f observerECIPos;
-	Vec3f observerECIVel;
-
-	calcObserverECIPosition(observerECIPos, observerECIVel);
-
+void  gSatWrapper::getSlantRange(const EpochData& data, double &ao_slantRange, double &ao_slantRangeRate)
+{
 	Vec3f satECIPos            = getTEMEPos();
 	Vec3f satECIVel            = getTEMEVel();
-	Vec3f slantRange           = satECIPos - observerECIPos;
-	Vec3f slantRangeVelocity   = satECIVel - observerECIVel;
+	Vec3f slantRange           = satECIPos - data.observerECIPos;
+	Vec3f slantRangeVelocity   = satECIVel - data.observerECIVel;
 
 	ao_slantRange     = slantRange.length();
 	ao_slantRangeRate = slantRange.dot(slantRangeVelocity)/ao_slantRange;
@@ -213,44 +244,37 @@ void  gSatWrapper::getSlantRange(double &ao_slantRange, double &ao_slantRangeRat
 
 Vec3f gSatWrapper::getSunECIPos()
 {
-	// All positions in ECI system are positions referenced in a StelCore::EquinoxEq system centered in the earth centre
-	Vec3f observerECIPos;
-	Vec3f observerECIVel;
-	calcObserverECIPosition(observerECIPos, observerECIVel);
-
-	SolarSystem *solsystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
-	Vec3d sunEquinoxEqPos        = solsystem->getSun()->getEquinoxEquatorialPos(StelApp::getInstance().getCore());
-
-	Vec3f sunECIPos(sunEquinoxEqPos[0]*AU, sunEquinoxEqPos[1]*AU, sunEquinoxEqPos[2]*AU);
-	//sunEquinoxEqPos is measured in AU. we need meassure it in Km
-	sunECIPos += observerECIPos; //Change ref system centre
-
-	return sunECIPos;
+	EpochData data;
+	computeEpochData(epoch.getGmtTm(), data);
+	return data.sunECIPos;
 }
 
 // Operation getVisibilityPredict
 // @brief This operation predicts the satellite visibility contidions.
 int gSatWrapper::getVisibilityPredict()
+{
+	EpochData data;
+	computeEpochData(epoch.getGmtTm(), data);
+	return getVisibilityPredict(data);
+}
+
+int gSatWrapper::getVisibilityPredict(const EpochData& data)
 {
 	float sunSatAngle, Dist;
 	int   visibility;
 
-	const Vec3f satAltAzPos = getAltAz();
+	const Vec3f satAltAzPos = getAltAz(data);
 	if (satAltAzPos[2] > 0)
 	{
 		const Vec3f satECIPos = getTEMEPos();
-		SolarSystem *solsystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");		
-		Vec3d sunAltAzPos        = solsystem->getSun()->getAltAzPosGeometric(StelApp::getInstance().getCore());
-
-		const Vec3f sunECIPos = getSunECIPos();
 
-		if (sunAltAzPos[2] > 0.0)
+		if (data.sunAboveHorizon)
 		{
 			visibility = RADAR_SUN;
 		}
 		else
 		{
-			sunSatAngle = sunECIPos.angle(satECIPos);
+			sunSatAngle = data.sunECIPos.angle(satECIPos);
 			Dist = satECIPos.length()*std::cos(sunSatAngle - (M_PI/2));
 
 			if (Dist > KEARTHRADIUS)
@@ -271,10 +295,10 @@ int gSatWrapper::getVisibilityPredict()
 
 float gSatWrapper::getPhaseAngle()
 {
-	Vec3f sunECIPos = getSunECIPos();
-	return sunECIPos.angle(getTEMEPos());
+	return getSunECIPos().angle(getTEMEPos());
 }
 
-
-
-
+float gSatWrapper::getPhaseAngle(const EpochData& data)
+{
+	return data.sunECIPos.angle(getTEMEPos());
+}
@@ -47,9 +47,36 @@ class gSatWrapper
 {
 
 public:
+	//! Quantities which only depend on the epoch and on the observer, shared
+	//! by all the satellites. Positions in the ECI system, measured in Km.
+	struct EpochData
+	{
+		double epoch;           //!< Julian day used for the propagation
+		float latitude;         //!< observer location in degrees
+		float longitude;
+		float altitude;         //!< measured in m
+		Vec3f observerECIPos;
+		Vec3f observerECIVel;   //!< measured in Km/s
+		float sinLatitude;      //!< observer latitude
+		float cosLatitude;
+		float sinTheta;         //!< local mean sidereal time
+		float cosTheta;
+		Vec3f sunECIPos;        //!< only set by computeEpochData()
+		bool sunAboveHorizon;   //!< only set by computeEpochData()
+	};
+
 	gSatWrapper(QString designation, QString tle1,QString tle2);
 	~gSatWrapper();
 
+	//! Compute the observer related data for the current location at the given epoch.
+	static void computeObserverData(double ai_julianDaysEpoch, EpochData& ao_data);
+	//! Compute the observer related data at another epoch, for the location stored in io_data.
+	//! Does not use any shared data, so that it can be called from worker threads.
+	static void setObserverDataEpoch(double ai_julianDaysEpoch, EpochData& io_data);
+	//! Same as computeObserverData(), plus the Sun position.
+	//! Must be called from the main thread.
+	static void computeEpochData(double ai_julianDaysEpoch, EpochData& ao_data);
+
 	// Operation updateEpoch
 	//! @brief This operation update Epoch timestamp for gSatTEME object
 	//! from Stellarium Julian Date.
@@ -88,6 +115,8 @@ public:
 	//!   Dr. T.S. Kelso
 	//!   http://www.celestrak.com/columns/v02n02/
 	Vec3f getAltAz();
+	//! Same as getAltAz(), with the observer data computed for the current epoch.
+	Vec3f getAltAz(const EpochData& data);
 
 	// Operation getSlantRange
 	//! @brief This operation compute the slant range (distance between the
@@ -96,6 +125,7 @@ public:
 	//! @param &ao_slantRangeRate Reference to a output variable where the method store the slant range variation in Km/s
 	//! @return void
 	void  getSlantRange(double &ao_slantRange, double &ao_slantRangeRate); //meassured in km and km/s
+	void  getSlantRange(const EpochData& data, double &ao_slantRange, double &ao_slantRangeRate);
 
 
 	// Operation getVisibilityPredict
@@ -114,8 +144,12 @@ public:
 	//!   Fundamentals of Astrodynamis and Applications (Third Edition) pg 898
 	//!   David A. Vallado
 	int getVisibilityPredict();
+	//! Same as getVisibilityPredict(), with data computed by computeEpochData().
+	//! Does not use any other shared data, so that the satellites can be updated in parallel.
+	int getVisibilityPredict(const EpochData& data);
 
 	float getPhaseAngle();
+	float getPhaseAngle(const EpochData& data);
 
 private:
 	// Operation calcObserverECIPosition
@@ -128,9 +162,11 @@ private:
 	//!  Orbital Coordinate Systems, Part II
 	//!   Dr. T.S. Kelso
 	//!   http://www.celestrak.com/columns/v02n02/
+	//! @param[in] ai_epoch the epoch
+	//! @param[in] ai_data the observer location
 	//! @param[out] ao_position Observer ECI position vector measured in Km
 	//! @param[out] ao_vel Observer ECI velocity vector measured in Km/s
-	void calcObserverECIPosition(Vec3f &ao_position, Vec3f &ao_vel);
+	static void calcObserverECIPosition(const gTime& ai_epoch, const EpochData& ai_data, Vec3f &ao_position, Vec3f &ao_vel);
 
 private:
 	gSatTEME *pSatellite;
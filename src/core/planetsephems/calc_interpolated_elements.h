@@ -31,6 +31,17 @@ void CalcInterpolatedElements(const double t,double elem[],
                               double *t1,double e1[],
                               double *t2,double e2[]);
 
+extern
+void CalcInterpolatedElementsData(const double t,double elem[],
+                                  const int dim,
+                                  void (*calc_func)(const double t,double elem[],
+                                                    void *data),
+                                  void *data,
+                                  const double delta_t,
+                                  double *t0,double e0[],
+                                  double *t1,double e1[],
+                                  double *t2,double e2[]);
+
 /*
 Simple interpolation routine with external cache.
 The cache consists of 3 sets of values:
@@ -50,4 +61,9 @@ the user must never change them.
 The user must always supply the same delta_t
 for one set of (*t0,*t1,*t2,e0,e1,e2),
 and of course the same dim and calc_func.
+
+CalcInterpolatedElementsData is the same, but data is passed on
+to (*calc_func)(t,elem,data). This allows to pass parameters to
+calc_func without static variables, so that the interpolation is
+reentrant as long as every thread uses its own cache.
 */
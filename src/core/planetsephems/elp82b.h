@@ -79,7 +79,27 @@ void GetElp82bCoor(double jd,double xyz[3]);
      ICRF, J2000 and FK5 are the same, while the transformation
      ICRF <-> VSOP87 must be done with the matrix given above.
    */
-     
+
+struct Elp82bContext {
+  double t_0,t_1,t_2;
+  double r_0[3];
+  double r_1[3];
+  double r_2[3];
+};
+  /* Cache of interpolated coordinates. The functions above share one
+     static cache, so they must not be called from several threads.
+     Callers which need reentrancy own a context, initialize it with
+     InitElp82bContext() and pass it to the functions below.
+     The members belong to these functions and must not be changed.
+  */
+
+void InitElp82bContext(struct Elp82bContext *ctx);
+
+void GetElp82bCoorCtx(struct Elp82bContext *ctx,double jd,double xyz[3]);
+  /* Same as GetElp82bCoor(), with the cache in ctx.
+     If ctx is NULL, the shared static cache is used.
+  */
+
 
 #ifdef __cplusplus
 };
@@ -92,6 +92,34 @@ void GetGust86OsculatingCoor(const double jd0, const double jd, const int body,d
   /* The oculating orbit of epoch jd0, evatuated at jd, is returned.
   */
 
+#define GUST86_DIM (5*6)
+
+struct Gust86Context {
+  double t_0,t_1,t_2;
+  double elem_0[GUST86_DIM];
+  double elem_1[GUST86_DIM];
+  double elem_2[GUST86_DIM];
+  double jd0;
+  double elem[GUST86_DIM];
+};
+  /* Cache of interpolated elements. The functions above share one
+     static cache, so they must not be called from several threads.
+     Callers which need reentrancy own a context, initialize it with
+     InitGust86Context() and pass it to the functions below.
+     The members belong to these functions and must not be changed.
+  */
+
+void InitGust86Context(struct Gust86Context *ctx);
+
+void GetGust86CoorCtx(struct Gust86Context *ctx,double jd,int body,double *xyz);
+
+void GetGust86OsculatingCoorCtx(struct Gust86Context *ctx,
+                                const double jd0,const double jd,
+                                const int body,double *xyz);
+  /* Same as GetGust86Coor() and GetGust86OsculatingCoor(), with the cache
+     in ctx. If ctx is NULL, the shared static cache is used.
+  */
+
 #ifdef __cplusplus
 }
 #endif
@@ -69,6 +69,32 @@ void GetL1OsculatingCoor(const double jd0,const double jd, const int body,double
   /* The oculating orbit of epoch jd0, evatuated at jd, is returned.
   */
 
+struct L1Context {
+  double t_0[4],t_1[4],t_2[4];
+  double elem_0[4*6];
+  double elem_1[4*6];
+  double elem_2[4*6];
+  double jd0[4];
+  double elem[4*6];
+};
+  /* Cache of interpolated elements. The functions above share one
+     static cache, so they must not be called from several threads.
+     Callers which need reentrancy own a context, initialize it with
+     InitL1Context() and pass it to the functions below.
+     The members belong to these functions and must not be changed.
+  */
+
+void InitL1Context(struct L1Context *ctx);
+
+void GetL1CoorCtx(struct L1Context *ctx,double jd,int body,double *xyz);
+
+void GetL1OsculatingCoorCtx(struct L1Context *ctx,
+                            const double jd0,const double jd,
+                            const int body,double *xyz);
+  /* Same as GetL1Coor() and GetL1OsculatingCoor(), with the cache in ctx.
+     If ctx is NULL, the shared static cache is used.
+  */
+
 
 #ifdef __cplusplus
 }
@@ -70,6 +70,33 @@ void GetMarsSatOsculatingCoor(const double jd0, const double jd, const int body,
   /* The oculating orbit of epoch jd0, evatuated at jd, is returned.
   */
 
+struct MarsSatContext {
+  double t_0,t_1,t_2;
+  double elem_0[2*6];
+  double elem_1[2*6];
+  double elem_2[2*6];
+  double jd0;
+  double elem[2*6];
+  double mars_sat_to_vsop87[9];
+};
+  /* Cache of interpolated elements. The functions above share one
+     static cache, so they must not be called from several threads.
+     Callers which need reentrancy own a context, initialize it with
+     InitMarsSatContext() and pass it to the functions below.
+     The members belong to these functions and must not be changed.
+  */
+
+void InitMarsSatContext(struct MarsSatContext *ctx);
+
+void GetMarsSatCoorCtx(struct MarsSatContext *ctx,double jd,int body,double *xyz);
+
+void GetMarsSatOsculatingCoorCtx(struct MarsSatContext *ctx,
+                                 const double jd0,const double jd,
+                                 const int body,double *xyz);
+  /* Same as GetMarsSatCoor() and GetMarsSatOsculatingCoor(), with the cache
+     in ctx. If ctx is NULL, the shared static cache is used.
+  */
+
 #ifdef __cplusplus
 }
 #endif
@@ -207,7 +207,8 @@ static const struct nutation_coefficients coefficients[TERMS] = {
 	{-3.0,	0.0,	0.0,	0.0}};
 
 /* cache values */
-static double c_JD = 0.0, c_longitude = 0.0, c_obliquity = 0.0, c_ecliptic = 0.0; 
+static double c_JD = 0.0;
+static struct ln_nutation c_nutation = {0.0, 0.0, 0.0};
 
 
 /* Calculate nutation of longitude and obliquity in degrees from Julian Ephemeris Day
@@ -216,19 +217,16 @@ static double c_JD = 0.0, c_longitude = 0.0, c_obliquity = 0.0, c_ecliptic = 0.0
 /* GZ: Changed: ecliptic obliquity used to be constant J2000.0. 
  * If you don't compute this, you may as well forget about nutation!
  */
-void get_nutation (double JD, struct ln_nutation * nutation)
+/* Same without the cache, so that it can be called from any thread. */
+static void compute_nutation (double JD, struct ln_nutation * nutation)
 {
 
 	double D,M,MM,F,O,T;
 	double coeff_sine, coeff_cos;
+	double c_longitude = 0.0, c_obliquity = 0.0, c_ecliptic;
 	int i;
 
-	/* should we bother recalculating nutation */
-	if (fabs(JD - c_JD) > LN_NUTATION_EPOCH_THRESHOLD)
 	  {
-		/* set the new epoch */
-		c_JD = JD;
-
 		/* set ecliptic. GZ: This is constant only, J2000.0. WRONG! */
 		/* c_ecliptic = 23.0 + 26.0 / 60.0 + 27.407 / 3600.0; */
 
@@ -327,6 +325,20 @@ void get_nutation (double JD, struct ln_nutation * nutation)
 	nutation->ecliptic = c_ecliptic;
 }
 
+void get_nutation (double JD, struct ln_nutation * nutation)
+{
+	/* should we bother recalculating nutation */
+	if (fabs(JD - c_JD) > LN_NUTATION_EPOCH_THRESHOLD)
+	  {
+		/* set the new epoch */
+		c_JD = JD;
+		compute_nutation(JD, &c_nutation);
+	  }
+
+	/* return results */
+	*nutation = c_nutation;
+}
+
 /* Calculate the mean sidereal time at the meridian of Greenwich of a given date.
  * returns apparent sidereal time (degree).
  * Formula 11.1, 11.4 pg 83 */
@@ -359,8 +371,9 @@ double get_apparent_sidereal_time (double JD)
    sidereal = get_mean_sidereal_time (JD);
         
    /* add corrections for nutation in longitude and for the true obliquity of 
-   the ecliptic */   
-   get_nutation (JD, &nutation); 
+   the ecliptic. The shared cache of get_nutation() is not used, as the sidereal
+   time is also computed by worker threads. */
+   compute_nutation (JD, &nutation); 
     
    /* GZ: This was the only place where this was used. I added the summation here. */
    correction = (nutation.longitude * cos ((nutation.ecliptic+nutation.obliquity)*M_PI/180.));
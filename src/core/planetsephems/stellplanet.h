@@ -19,10 +19,36 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 #ifndef _STELLPLANET_H_
 #define _STELLPLANET_H_
 
+#include "vsop87.h"
+#include "elp82b.h"
+#include "marssat.h"
+#include "l1.h"
+#include "tass17.h"
+#include "gust86.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Interpolation caches of all the analytical theories.
+   The get_*_coordsv() functions below accept a pointer to an
+   EphemerisContext as their last argument. When it is NULL, the
+   shared static caches are used, which is not thread safe.
+   Each thread computing positions must own its own context,
+   initialized with InitEphemerisContext(). The same applies to the
+   get_*_osculating_coords() functions.
+   Pluto is computed without cache and needs no context. */
+struct EphemerisContext {
+  struct Vsop87Context vsop87;
+  struct Elp82bContext elp82b;
+  struct MarsSatContext marssat;
+  struct L1Context l1;
+  struct Tass17Context tass17;
+  struct Gust86Context gust86;
+};
+
+void InitEphemerisContext(struct EphemerisContext *ctx);
+
 void get_sun_helio_coordsv(double jd,double xyz[3], void*);
 void get_mercury_helio_coordsv(double jd,double xyz[3], void*);
 void get_venus_helio_coordsv(double jd,double xyz[3], void*);
@@ -34,15 +60,15 @@ void get_uranus_helio_coordsv(double jd,double xyz[3], void*);
 void get_neptune_helio_coordsv(double jd,double xyz[3], void*);
 void get_pluto_helio_coordsv(double jd,double xyz[3], void*);
 
-void get_mercury_helio_osculating_coords(double jd0,double jd,double xyz[3]);
-void get_venus_helio_osculating_coords(double jd0,double jd,double xyz[3]);
-void get_earth_helio_osculating_coords(double jd0,double jd,double xyz[3]);
-void get_mars_helio_osculating_coords(double jd0,double jd,double xyz[3]);
-void get_jupiter_helio_osculating_coords(double jd0,double jd,double xyz[3]);
-void get_saturn_helio_osculating_coords(double jd0,double jd,double xyz[3]);
-void get_uranus_helio_osculating_coords(double jd0,double jd,double xyz[3]);
-void get_neptune_helio_osculating_coords(double jd0,double jd,double xyz[3]);
-void get_pluto_helio_osculating_coords(double jd0,double jd,double xyz[3]);
+void get_mercury_helio_osculating_coords(double jd0,double jd,double xyz[3], void*);
+void get_venus_helio_osculating_coords(double jd0,double jd,double xyz[3], void*);
+void get_earth_helio_osculating_coords(double jd0,double jd,double xyz[3], void*);
+void get_mars_helio_osculating_coords(double jd0,double jd,double xyz[3], void*);
+void get_jupiter_helio_osculating_coords(double jd0,double jd,double xyz[3], void*);
+void get_saturn_helio_osculating_coords(double jd0,double jd,double xyz[3], void*);
+void get_uranus_helio_osculating_coords(double jd0,double jd,double xyz[3], void*);
+void get_neptune_helio_osculating_coords(double jd0,double jd,double xyz[3], void*);
+void get_pluto_helio_osculating_coords(double jd0,double jd,double xyz[3], void*);
 
 void get_lunar_parent_coordsv(double jd,double xyz[3], void*);
 
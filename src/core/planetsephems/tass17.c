@@ -54,6 +54,7 @@ My modifications are:
 #include "elliptic_to_rectangular.h"
 
 #include <math.h>
+#include <stddef.h> /* NULL */
 
 struct Tass17Term {
   double s[3];
@@ -3130,18 +3131,20 @@ const double TASS17toJ2000[9] = {
 };
 */
 
-#define TASS17_DIM (8*6)
-static double t_0 = -1e100;
-static double t_1 = -1e100;
-static double t_2 = -1e100;
-static double tass17_elem_0[TASS17_DIM];
-static double tass17_elem_1[TASS17_DIM];
-static double tass17_elem_2[TASS17_DIM];
 /* 1 day: */
 #define DELTA_T 1.0
 
-static double tass17_jd0 = -1e100;
-static double tass17_elem[TASS17_DIM];
+  /* shared cache for the functions without context */
+static struct Tass17Context tass17_static_context = {
+  -1e100,-1e100,-1e100,{0.0},{0.0},{0.0},-1e100,{0.0}
+};
+
+void InitTass17Context(struct Tass17Context *ctx) {
+  ctx->t_0 = -1e100;
+  ctx->t_1 = -1e100;
+  ctx->t_2 = -1e100;
+  ctx->jd0 = -1e100;
+}
 
 void CalcAllTass17Elem(const double t,double elem[TASS17_DIM]) {
   int body;
@@ -3151,29 +3154,40 @@ void CalcAllTass17Elem(const double t,double elem[TASS17_DIM]) {
 }
 
 void GetTass17Coor(double jd,int body,double *xyz) {
-  GetTass17OsculatingCoor(jd,jd,body,xyz);
+  GetTass17OsculatingCoorCtx(NULL,jd,jd,body,xyz);
 }
 
 void GetTass17OsculatingCoor(const double jd0,const double jd,
                              const int body,double *xyz) {
+  GetTass17OsculatingCoorCtx(NULL,jd0,jd,body,xyz);
+}
+
+void GetTass17CoorCtx(struct Tass17Context *ctx,double jd,int body,double *xyz) {
+  GetTass17OsculatingCoorCtx(ctx,jd,jd,body,xyz);
+}
+
+void GetTass17OsculatingCoorCtx(struct Tass17Context *ctx,
+                                const double jd0,const double jd,
+                                const int body,double *xyz) {
   double x[3];
-  if (jd0 != tass17_jd0) {
+  if (!ctx) ctx = &tass17_static_context;
+  if (jd0 != ctx->jd0) {
     const double t0 = jd0 - 2444240.0;
-    tass17_jd0 = jd0;
-    CalcInterpolatedElements(t0,tass17_elem,
+    ctx->jd0 = jd0;
+    CalcInterpolatedElements(t0,ctx->elem,
                              TASS17_DIM,
                              &CalcAllTass17Elem,DELTA_T,
-                             &t_0,tass17_elem_0,
-                             &t_1,tass17_elem_1,
-                             &t_2,tass17_elem_2);
+                             &ctx->t_0,ctx->elem_0,
+                             &ctx->t_1,ctx->elem_1,
+                             &ctx->t_2,ctx->elem_2);
 /*
     printf("GetTass17Coor(%d): %f %f  %f %f  %f %f\n",
            body,
-           tass17_elem[body*6+0],tass17_elem[body*6+1],tass17_elem[body*6+2],
-           tass17_elem[body*6+3],tass17_elem[body*6+4],tass17_elem[body*6+5]);
+           ctx->elem[body*6+0],ctx->elem[body*6+1],ctx->elem[body*6+2],
+           ctx->elem[body*6+3],ctx->elem[body*6+4],ctx->elem[body*6+5]);
 */
   }
-  EllipticToRectangularN(tass17bodies[body].mu,tass17_elem+(body*6),jd-jd0,x);
+  EllipticToRectangularN(tass17bodies[body].mu,ctx->elem+(body*6),jd-jd0,x);
   xyz[0] = TASS17toVSOP87[0]*x[0]+TASS17toVSOP87[1]*x[1]+TASS17toVSOP87[2]*x[2];
   xyz[1] = TASS17toVSOP87[3]*x[0]+TASS17toVSOP87[4]*x[1]+TASS17toVSOP87[5]*x[2];
   xyz[2] = TASS17toVSOP87[6]*x[0]+TASS17toVSOP87[7]*x[1]+TASS17toVSOP87[8]*x[2];
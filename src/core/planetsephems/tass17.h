@@ -69,6 +69,34 @@ extern "C" {
 void GetTass17Coor(double jd,int body,double *xyz);
 void GetTass17OsculatingCoor(const double jd0,const double jd, const int body,double *xyz);
 
+#define TASS17_DIM (8*6)
+
+struct Tass17Context {
+  double t_0,t_1,t_2;
+  double elem_0[TASS17_DIM];
+  double elem_1[TASS17_DIM];
+  double elem_2[TASS17_DIM];
+  double jd0;
+  double elem[TASS17_DIM];
+};
+  /* Cache of interpolated elements. The functions above share one
+     static cache, so they must not be called from several threads.
+     Callers which need reentrancy own a context, initialize it with
+     InitTass17Context() and pass it to the functions below.
+     The members belong to these functions and must not be changed.
+  */
+
+void InitTass17Context(struct Tass17Context *ctx);
+
+void GetTass17CoorCtx(struct Tass17Context *ctx,double jd,int body,double *xyz);
+
+void GetTass17OsculatingCoorCtx(struct Tass17Context *ctx,
+                                const double jd0,const double jd,
+                                const int body,double *xyz);
+  /* Same as GetTass17Coor() and GetTass17OsculatingCoor(), with the cache
+     in ctx. If ctx is NULL, the shared static cache is used.
+  */
+
 #ifdef __cplusplus
 }
 #endif
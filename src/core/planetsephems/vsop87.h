@@ -72,6 +72,35 @@ void GetVsop87OsculatingCoor(const double jd0,const double jd, const int body,do
   /* The oculating orbit of epoch jd0, evatuated at jd, is returned.
   */
 
+#define VSOP87_DIM (8*6)
+
+struct Vsop87Context {
+  double t_0,t_1,t_2;
+  double elem_0[VSOP87_DIM];
+  double elem_1[VSOP87_DIM];
+  double elem_2[VSOP87_DIM];
+  double jd0;
+  double elem[VSOP87_DIM];
+};
+  /* Cache of interpolated elements. The functions above share one
+     static cache, so they must not be called from several threads.
+     Callers which need reentrancy own a context, initialize it with
+     InitVsop87Context() and pass it to the functions below.
+     The members belong to these functions and must not be changed.
+  */
+
+void InitVsop87Context(struct Vsop87Context *ctx);
+
+void GetVsop87CoorCtx(struct Vsop87Context *ctx,
+                      double jd,int body,double *xyz);
+
+void GetVsop87OsculatingCoorCtx(struct Vsop87Context *ctx,
+                                const double jd0,const double jd,
+                                const int body,double *xyz);
+  /* Same as GetVsop87Coor() and GetVsop87OsculatingCoor(), with the cache
+     in ctx. If ctx is NULL, the shared static cache is used.
+  */
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,7 @@
  */
 
 #include "config.h"
+#include "StelBenchmark.hpp"
 #include "StelMainView.hpp"
 #include "StelTranslator.hpp"
 #include "StelLogger.hpp"
@@ -343,9 +344,33 @@ int main(int argc, char **argv)
 	}
 #endif
 	
-	StelMainView mainWin;
-	mainWin.init(confSettings);
-	app.exec();
+	QString benchmarkFile, benchmarkOutput;
+	int benchmarkFrames = 0;
+	try
+	{
+		benchmarkFile = CLIProcessor::argsGetOptionWithArg(argList, "", "--benchmark", "").toString();
+		benchmarkOutput = CLIProcessor::argsGetOptionWithArg(argList, "", "--benchmark-output", "").toString();
+		benchmarkFrames = CLIProcessor::argsGetOptionWithArg(argList, "", "--benchmark-frames", 0).toInt();
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "WARNING: while looking for --benchmark options: " << e.what();
+	}
+
+	int exitCode = 0;
+	if (!benchmarkFile.isEmpty())
+	{
+		// Render the scenes offscreen, without showing any window
+		StelBenchmark benchmark(confSettings);
+		if (!benchmark.run(benchmarkFile, benchmarkFrames, benchmarkOutput))
+			exitCode = 1;
+	}
+	else
+	{
+		StelMainView mainWin;
+		mainWin.init(confSettings);
+		app.exec();
+	}
 
 	delete confSettings;
 	StelLogger::deinit();
@@ -355,6 +380,6 @@ int main(int argc, char **argv)
 		timeEndPeriod(timerGrain);
 #endif //Q_OS_WIN
 
-	return 0;
+	return exitCode;
 }
 
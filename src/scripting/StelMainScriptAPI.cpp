@@ -24,6 +24,8 @@
 #include "StelLocaleMgr.hpp"
 
 #include "ConstellationMgr.hpp"
+#include "EphemerisTable.hpp"
+#include "EventSearch.hpp"
 #include "GridLinesMgr.hpp"
 #include "LandscapeMgr.hpp"
 #include "MeteorMgr.hpp"
@@ -44,6 +46,7 @@
 
 #include "StelObject.hpp"
 #include "StelObjectMgr.hpp"
+#include "StelProfiler.hpp"
 #include "StelProjector.hpp"
 #include "StelSkyCultureMgr.hpp"
 #include "StelSkyDrawer.hpp"
@@ -55,8 +58,10 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QRegExp>
 #include <QSet>
 #include <QStringList>
@@ -279,6 +284,32 @@ float StelMainScriptAPI::getMaxFps()
 	return StelMainView::getInstance().getMaxFps();
 }
 
+void StelMainScriptAPI::setProfilerEnabled(bool b)
+{
+	StelApp::getInstance().getProfiler()->setFlagEnabled(b);
+}
+
+void StelMainScriptAPI::setProfilerOverlayVisible(bool b)
+{
+	StelApp::getInstance().getProfiler()->setFlagShowOverlay(b);
+}
+
+QVariantMap StelMainScriptAPI::getProfilerStatistics()
+{
+	return StelApp::getInstance().getProfiler()->getStatistics();
+}
+
+void StelMainScriptAPI::startProfilerTrace()
+{
+	StelApp::getInstance().getProfiler()->startTrace();
+}
+
+bool StelMainScriptAPI::stopProfilerTrace(const QString& fileName)
+{
+	const QString path = QDir(StelFileMgr::getUserDir()).absoluteFilePath(fileName);
+	return StelApp::getInstance().getProfiler()->stopTrace(path);
+}
+
 QString StelMainScriptAPI::getMountMode()
 {
 	if (GETSTELMODULE(StelMovementMgr)->getMountMode() == StelMovementMgr::MountEquinoxEquatorial)
@@ -777,6 +808,108 @@ QVariantMap StelMainScriptAPI::getObjectInfo(const QString& name)
 	return map;
 }
 
+QVariantMap StelMainScriptAPI::computeEphemerides(const QStringList& names, double jdStart, double jdEnd, double step)
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	EphemerisTable table(core, names);
+	QVariantMap map;
+	map.insert("names", table.getNames());
+	map.insert("not-found", table.getUnknownNames());
+	if (!table.compute(jdStart, jdEnd, step))
+	{
+		debug("computeEphemerides WARNING - invalid or too large range of dates");
+		map.insert("error", true);
+	}
+
+	const QVector<double>& dates = table.getDates();
+	QVariantList jd;
+	jd.reserve(dates.size());
+	foreach (double d, dates)
+		jd.append(d);
+	map.insert("jd", jd);
+
+	const int n = table.getNbObjects()*dates.size();
+	QVariantList ra, dec, alt, azi, altGeom, aziGeom, elongation, distance, vmag, vmage;
+	QVariantList* lists[] = {&ra, &dec, &alt, &azi, &altGeom, &aziGeom, &elongation, &distance, &vmag, &vmage};
+	for (unsigned int l=0;l<sizeof(lists)/sizeof(lists[0]);++l)
+		lists[l]->reserve(n);
+	for (int i=0;i<table.getNbObjects();++i)
+	{
+		for (int j=0;j<dates.size();++j)
+		{
+			const EphemerisTable::Ephemeris& e = table.at(i, j);
+			ra.append(e.ra*180./M_PI);
+			dec.append(e.dec*180./M_PI);
+			alt.append(e.altitude*180./M_PI);
+			azi.append(e.azimuth*180./M_PI);
+			altGeom.append(e.altitudeGeometric*180./M_PI);
+			aziGeom.append(e.azimuthGeometric*180./M_PI);
+			elongation.append(e.elongation*180./M_PI);
+			distance.append(e.distance);
+			vmag.append(e.vmag);
+			vmage.append(e.vmagExtincted);
+		}
+	}
+	map.insert("ra", ra);
+	map.insert("dec", dec);
+	map.insert("altitude", alt);
+	map.insert("azimuth", azi);
+	map.insert("altitude-geometric", altGeom);
+	map.insert("azimuth-geometric", aziGeom);
+	map.insert("elongation", elongation);
+	map.insert("distance", distance);
+	map.insert("vmag", vmag);
+	map.insert("vmage", vmage);
+	return map;
+}
+
+QVariantList StelMainScriptAPI::searchEvents(const QStringList& names, double jdStart, double jdEnd, const QStringList& types)
+{
+	EventSearch::EventTypes eventTypes;
+	if (types.isEmpty())
+		eventTypes = EventSearch::AllEvents;
+	foreach (const QString& t, types)
+	{
+		const EventSearch::EventType type = EventSearch::getType(t);
+		if (!type)
+			debug("searchEvents WARNING - unknown event type: " + t);
+		eventTypes |= type;
+	}
+
+	EventSearch search(StelApp::getInstance().getCore(), names);
+	foreach (const QString& name, search.getUnknownNames())
+		debug("searchEvents WARNING - object not found: " + name);
+	search.start(jdStart, jdEnd, eventTypes);
+	// Keep processing the events, so that the script can be stopped during a long search
+	QEventLoop loop;
+	QFutureWatcher<void> watcher;
+	connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+	connect(&StelApp::getInstance().getScriptMgr(), &StelScriptMgr::scriptStopped, &loop, [&search]() {search.cancel();});
+	watcher.setFuture(search.getFuture());
+	if (!search.isFinished())
+		loop.exec();
+	// The search is also canceled when the Solar System is reloaded meanwhile
+	if (search.isCanceled())
+		debug("searchEvents WARNING - search canceled, the list of events is incomplete");
+
+	const QStringList found = search.getNames();
+	QVariantList list;
+	foreach (const EventSearch::Event& e, search.getEvents())
+	{
+		QVariantMap map;
+		map.insert("type", EventSearch::getTypeName(e.type));
+		map.insert("jd", e.jd);
+		if (e.object>=0)
+			map.insert("object", found.at(e.object));
+		if (e.object2>=0)
+			map.insert("object2", found.at(e.object2));
+		const bool eclipse = e.type==EventSearch::SolarEclipse || e.type==EventSearch::LunarEclipse;
+		map.insert("value", eclipse ? e.value : e.value*180./M_PI);
+		list.append(map);
+	}
+	return list;
+}
+
 QVariantMap StelMainScriptAPI::getSelectedObjectInfo()
 {
 	StelObjectMgr* omgr = GETSTELMODULE(StelObjectMgr);
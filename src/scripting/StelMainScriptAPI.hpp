@@ -187,6 +187,47 @@ public slots:
 	//! - localized-name : localized name
 	QVariantMap getSelectedObjectInfo();
 
+	//! Compute the positions and magnitudes of a list of objects over a range of dates, for the
+	//! current location. The dates are computed in parallel, without changing the simulation date
+	//! nor the display, which is much faster than calling setJDay() and getObjectInfo() in a loop.
+	//! Objects outside the solar system keep their current position and magnitude.
+	//! @param names the English names of the objects.
+	//! @param jdStart the first Julian day, see jdFromDateString().
+	//! @param jdEnd the last Julian day. It is included if jdEnd-jdStart is a multiple of the step.
+	//! @param step the step in days, e.g. 1/24 for every hour.
+	//! @return a map with the keys:
+	//! - jd : list of the dates
+	//! - names : list of the names of the objects which were found
+	//! - not-found : list of the names which were not found
+	//! - altitude, azimuth, altitude-geometric, azimuth-geometric, ra, dec, elongation : lists of
+	//!   angles in decimal degrees, as in getObjectInfo(). The elongation is the angle to the Sun.
+	//! - distance : list of distances in AU, 0 for objects outside the solar system
+	//! - vmag, vmage : lists of magnitudes without and with extinction
+	//! The lists of values have one value per object and date, the value of the object i at the
+	//! date j being at index i*jd.length+j.
+	//! - error : only set if the step is not positive, jdEnd is before jdStart or the table would
+	//!   have more than 10 million values per list. The lists are then empty.
+	QVariantMap computeEphemerides(const QStringList& names, double jdStart, double jdEnd, double step);
+
+	//! Search the rises, transits, sets, conjunctions, oppositions, occultations and eclipses of a
+	//! list of objects over a range of dates, for the current location. The search runs in parallel,
+	//! without changing the simulation date nor the display, and stops if the script is stopped.
+	//! @param names the English names of the objects. The eclipses are searched whatever the objects.
+	//! @param jdStart, jdEnd the range of Julian days, see jdFromDateString().
+	//! @param types the types of events, among "rise", "transit", "set", "conjunction",
+	//! "opposition", "occultation", "solar-eclipse" and "lunar-eclipse". All the types are searched
+	//! if the list is empty.
+	//! @return the list of the events by date. Each event is a map with the keys:
+	//! - type : type of the event, as in types
+	//! - jd : Julian day of the event, or of the maximum of the occultations and eclipses
+	//! - object : name of the object, the occulting one for occultations. Not set for the eclipses.
+	//! - object2 : name of the second object of conjunctions, the occulted one for occultations
+	//! - value : azimuth for rises and sets, altitude for transits, angular distance between the
+	//!   objects for conjunctions and occultations and elongation for oppositions, in decimal
+	//!   degrees. Magnitude for the solar eclipses, and umbral magnitude for the lunar eclipses,
+	//!   which is negative for penumbral eclipses.
+	QVariantList searchEvents(const QStringList& names, double jdStart, double jdEnd, const QStringList& types=QStringList());
+
 	//! Clear the display options, setting a "standard" view.
 	//! Preset states:
 	//! - natural : azimuthal mount, atmosphere, landscape,
@@ -317,6 +358,26 @@ public slots:
 	//! @return The current maximum frames per secon setting.
 	float getMaxFps();
 
+	//! Enable or disable the timing of the modules by the profiler.
+	void setProfilerEnabled(bool b);
+
+	//! Show or hide the profiler statistics over the sky.
+	void setProfilerOverlayVisible(bool b);
+
+	//! Get the profiler statistics of the last frames.
+	//! @return a map from the section names, e.g. "StarMgr::draw", to maps with the mean, p50, p95
+	//! and max time per frame in ms, the mean number of calls per frame and the histogram of the
+	//! times per frame. See StelProfiler::getStatistics().
+	QVariantMap getProfilerStatistics();
+
+	//! Start recording the timed sections for a trace file. This enables the profiler.
+	void startProfilerTrace();
+
+	//! Stop recording and write the trace in the Chrome trace event format.
+	//! @param fileName the trace file. A relative path is relative to the user directory.
+	//! @return false if the file could not be written.
+	bool stopProfilerTrace(const QString& fileName);
+
 	//! Get the mount mode as a string
 	//! @return "equatorial" or "azimuthal"
 	QString getMountMode();
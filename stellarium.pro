@@ -94,6 +94,7 @@ HEADERS += \
 	src/translations.h \
 	src/CLIProcessor.hpp \
 	src/StelAndroid.hpp \
+	src/StelBenchmark.hpp \
 	src/StelLogger.hpp \
 	src/StelMainView.hpp \
 
@@ -112,6 +113,7 @@ SOURCES += \
     src/core/modules/Telescope.cpp \
     src/core/modules/ToastMgr.cpp \
 	src/main.cpp \
+	src/StelBenchmark.cpp \
 	src/StelLogger.cpp \
 	src/StelMainView.cpp \
 
@@ -154,15 +156,18 @@ HEADERS += \
 	src/core/StelFader.hpp \
 	src/core/StelFileMgr.hpp \
 	src/core/StelGeodesicGrid.hpp \
+	src/core/StelGlyphAtlas.hpp \
 	src/core/StelGuiBase.hpp \
 	src/core/StelIniParser.hpp \
 	src/core/StelJsonParser.hpp \
 	src/core/StelLocaleMgr.hpp \
 	src/core/StelLocation.hpp \
+	src/core/StelLocationDB.hpp \
 	src/core/StelLocationMgr.hpp \
 	src/core/StelModule.hpp \
 	src/core/StelModuleMgr.hpp \
 	src/core/StelMovementMgr.hpp \
+	src/core/StelNameIndex.hpp \
 	src/core/StelObject.hpp \
 	src/core/StelObjectMgr.hpp \
 	src/core/StelObjectModule.hpp \
@@ -171,11 +176,14 @@ HEADERS += \
         src/core/StelOpenGL.hpp \
 	src/core/StelPainter.hpp \
 	src/core/StelPluginInterface.hpp \
+	src/core/StelPointIndex.hpp \
+	src/core/StelProfiler.hpp \
 	src/core/StelProjectorClasses.hpp \
 	src/core/StelProjector.hpp \
 	src/core/StelProjectorType.hpp \
 	src/core/StelProgressController.hpp \
 	src/core/StelRegionObject.hpp \
+	src/core/StelSimd.hpp \
 	src/core/StelSkyCultureMgr.hpp \
 	src/core/StelSkyDrawer.hpp \
 	src/core/StelSkyImageTile.hpp \
@@ -199,6 +207,9 @@ HEADERS += \
 	src/core/modules/Comet.hpp \
 	src/core/modules/Constellation.hpp \
 	src/core/modules/ConstellationMgr.hpp \
+	src/core/modules/EphemerisCache.hpp \
+	src/core/modules/EphemerisTable.hpp \
+	src/core/modules/EventSearch.hpp \
         src/core/modules/Exoplanet.hpp \
         src/core/modules/Exoplanets.hpp \
 	src/core/modules/GPSMgr.hpp \
@@ -212,6 +223,7 @@ HEADERS += \
 	src/core/modules/MeteorShowers.hpp \
 	src/core/modules/MeteorShowersMgr.hpp \
 	src/core/modules/MilkyWay.hpp \
+	src/core/modules/MinorBodyCatalog.hpp \
 	src/core/modules/MinorPlanet.hpp \
 	src/core/modules/Nebula.hpp \
 	src/core/modules/NebulaMgr.hpp \
@@ -232,6 +244,7 @@ HEADERS += \
 	src/core/modules/StarMgr.hpp \
 	src/core/modules/StarWrapper.hpp \
 	src/core/modules/ZoneArray.hpp \
+	src/core/modules/ZoneCache.hpp \
 	src/core/modules/ZoneData.hpp \
 	src/core/external/glues_stel/source/glues_error.h \
 	src/core/external/glues_stel/source/glues.h \
@@ -325,21 +338,26 @@ SOURCES += \
 	src/core/StelCore.cpp \
 	src/core/StelFileMgr.cpp \
 	src/core/StelGeodesicGrid.cpp \
+	src/core/StelGlyphAtlas.cpp \
 	src/core/StelGuiBase.cpp \
 	src/core/StelIniParser.cpp \
 	src/core/StelJsonParser.cpp \
 	src/core/StelLocaleMgr.cpp \
 	src/core/StelLocation.cpp \
+	src/core/StelLocationDB.cpp \
 	src/core/StelLocationMgr.cpp \
 	src/core/StelModule.cpp \
 	src/core/StelModuleMgr.cpp \
 	src/core/StelMovementMgr.cpp \
+	src/core/StelNameIndex.cpp \
 	src/core/StelObject.cpp \
 	src/core/StelObjectMgr.cpp \
 	src/core/StelObjectModule.cpp \
 	src/core/StelObserver.cpp \
         src/core/StelOpenGL.cpp \
 	src/core/StelPainter.cpp \
+	src/core/StelPointIndex.cpp \
+	src/core/StelProfiler.cpp \
 	src/core/StelProjectorClasses.cpp \
 	src/core/StelProjector.cpp \
 	src/core/StelSkyCultureMgr.cpp \
@@ -364,6 +382,9 @@ SOURCES += \
 	src/core/modules/Comet.cpp \
 	src/core/modules/Constellation.cpp \
 	src/core/modules/ConstellationMgr.cpp \
+	src/core/modules/EphemerisCache.cpp \
+	src/core/modules/EphemerisTable.cpp \
+	src/core/modules/EventSearch.cpp \
         src/core/modules/Exoplanet.cpp \
         src/core/modules/Exoplanets.cpp \
 	src/core/modules/GPSMgr.cpp \
@@ -377,6 +398,7 @@ SOURCES += \
 	src/core/modules/MeteorShowers.cpp \
 	src/core/modules/MeteorShowersMgr.cpp \	
 	src/core/modules/MilkyWay.cpp \
+	src/core/modules/MinorBodyCatalog.cpp \
 	src/core/modules/MinorPlanet.cpp \
 	src/core/modules/Nebula.cpp \
 	src/core/modules/NebulaMgr.cpp \
@@ -396,6 +418,7 @@ SOURCES += \
 	src/core/modules/StarMgr.cpp \
 	src/core/modules/StarWrapper.cpp \
 	src/core/modules/ZoneArray.cpp \
+	src/core/modules/ZoneCache.cpp \
 	src/core/external/glues_stel/source/glues_error.c \
 	src/core/external/glues_stel/source/libtess/dict.c \
 	src/core/external/glues_stel/source/libtess/geom.c \